@@ -0,0 +1,95 @@
+/*
+  bench_collide.c
+
+  Throughput of the kernels sweeping a ball over every brick. Every implementation the CPU supports is run over the
+  same sweeps and brick fields, and the bricks tested per second are printed.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL_timer.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+#include "game/collide.h"
+
+#define BALLS_COUNT 4096
+
+// Brick counts to run, as columns x rows
+static const uint32_t p_sizes[][2] = {{32, 32}, {100, 100}, {320, 320}};
+
+int main(void)
+{
+    static float p_ball_x[BALLS_COUNT];
+    static float p_ball_y[BALLS_COUNT];
+    static float p_ball_dx[BALLS_COUNT];
+    static float p_ball_dy[BALLS_COUNT];
+
+    srand(42);
+
+    for(size_t s = 0; s < sizeof(p_sizes) / sizeof(p_sizes[0]); ++s) {
+        uint32_t cols = p_sizes[s][0];
+        uint32_t rows = p_sizes[s][1];
+
+        deletion_stack_t* p_dstack = deletion_stack_init();
+        if(p_dstack == NULL)
+            return EXIT_FAILURE;
+
+        brick_field_t field;
+        error_t err = brick_field_init(p_dstack, cols * rows, &field);
+        if(err.code == 0)
+            err = brick_field_fill_grid(&field, cols, rows, 0.0f, 0.0f, 1.0f, 0.4f, 0.1f);
+        if(err.code != 0) {
+            fprintf(stderr, "%s\n", err.msg);
+            error_deinit(&err);
+            deletion_stack_flush(&p_dstack);
+            return EXIT_FAILURE;
+        }
+
+        // Knock out a quarter of the bricks so the alive mask matters
+        for(uint32_t i = 0; i < field.count / 4; ++i)
+            brick_field_hit(&field, (uint32_t)rand() % field.count);
+
+        for(int i = 0; i < BALLS_COUNT; ++i) {
+            p_ball_x[i] = (float)rand() / (float)RAND_MAX * (float)cols * 1.1f;
+            p_ball_y[i] = (float)rand() / (float)RAND_MAX * (float)rows * 0.5f;
+
+            // About a tick of movement of a fast ball
+            p_ball_dx[i] = ((float)rand() / (float)RAND_MAX - 0.5f) * 0.5f;
+            p_ball_dy[i] = ((float)rand() / (float)RAND_MAX - 0.5f) * 0.5f;
+        }
+
+        // Fewer passes over the large fields so each run takes about as long
+        uint32_t passes = 1 + 400000u / field.count;
+
+        for(int impl = 0; impl < COLLIDE_IMPL_COUNT; ++impl) {
+            if(!collide_impl_supported((collide_impl_t)impl))
+                continue;
+
+            uint32_t hits = 0;
+            uint64_t start_ns = SDL_GetTicksNS();
+
+            for(uint32_t pass = 0; pass < passes; ++pass) {
+                for(int i = 0; i < BALLS_COUNT; i += 16) {
+                    brick_hit_t hit;
+                    hits += collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, p_ball_x[i],
+                        p_ball_y[i], p_ball_dx[i], p_ball_dy[i], 0.25f, &hit);
+                }
+            }
+
+            uint64_t elapsed_ns = SDL_GetTicksNS() - start_ns;
+            double tests = (double)passes * (BALLS_COUNT / 16) * (double)field.count;
+
+            printf("%6u bricks %-6s %8.3f ms %10.1f Mbricks/s (%u hits)\n", field.count,
+                collide_impl_name((collide_impl_t)impl), (double)elapsed_ns / 1e6,
+                tests / ((double)elapsed_ns / 1e9) / 1e6, hits);
+        }
+
+        deletion_stack_flush(&p_dstack);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/*
+  bench_sim.c
+
+  Throughput of the game simulation. Generated levels of 1k to 100k bricks are played with 1 to 1000 balls for a fixed
+  number of ticks, without a window or vulkan. Ticks per second, nanoseconds per tick and heap allocations per tick are
+  printed as JSON, so the numbers can be tracked from run to run.
+
+  Usage: break_bench [--ticks <n>] [--workers <n>]
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_timer.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/sim.h"
+
+#define DEFAULT_TICKS 600
+#define TICK_DT (1.0f / 120.0f)
+
+// The bricks fill the top half of the field, each brick cell is this many times wider than it is high
+#define LEVEL_HEIGHT (SIM_FIELD_HEIGHT * 0.5f)
+#define BRICK_ASPECT 2.5f
+
+// Levels and ball counts to run, every combination is run
+static const uint32_t p_bricks_counts[] = {1000, 10000, 100000};
+static const uint32_t p_balls_counts[] = {1, 10, 100, 1000};
+
+#ifdef BENCH_COUNT_ALLOCS
+// The allocator is wrapped at link time (-Wl,--wrap), so every allocation break_lib makes is counted
+static SDL_AtomicInt allocs_count;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* p_block, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+    SDL_AddAtomicInt(&allocs_count, 1);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    SDL_AddAtomicInt(&allocs_count, 1);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* p_block, size_t size)
+{
+    SDL_AddAtomicInt(&allocs_count, 1);
+    return __real_realloc(p_block, size);
+}
+#endif
+
+typedef struct result_s {
+    uint32_t bricks;
+    uint32_t balls;
+    uint64_t elapsed_ns;
+    int allocs;
+    uint32_t bricks_left;
+    uint32_t balls_left;
+} result_t;
+
+static float randf(float min, float max)
+{
+    return min + (float)rand() / (float)RAND_MAX * (max - min);
+}
+
+/**
+ * Play a generated level for a number of ticks.
+ */
+static error_t run_level(job_system_t* p_jobs, uint32_t bricks_count, uint32_t balls_count, uint32_t ticks,
+    result_t* p_result)
+{
+    // Large enough for a thousand balls, kept off the stack
+    static sim_state_t state;
+    static sim_world_t world;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    if(p_dstack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "Failed to initiate deletion stack");
+
+    // A grid as close to bricks_count as fits the top half of the field
+    uint32_t cols = (uint32_t)ceilf(sqrtf((float)bricks_count * SIM_FIELD_WIDTH / LEVEL_HEIGHT / BRICK_ASPECT));
+    uint32_t rows = (bricks_count + cols - 1) / cols;
+    float cell_w = SIM_FIELD_WIDTH / (float)cols;
+    float cell_h = LEVEL_HEIGHT / (float)rows;
+    float gap = cell_h * 0.1f;
+
+    brick_field_t field;
+    broadphase_t bp;
+    error_t err = brick_field_init(p_dstack, cols * rows, &field);
+    if(err.code == 0)
+        err = brick_field_fill_grid(&field, cols, rows, gap * 0.5f, LEVEL_HEIGHT, cell_w - gap, cell_h - gap, gap);
+    if(err.code == 0)
+        err = broadphase_init(p_dstack, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT, cell_w, cell_h, &bp);
+    if(err.code == 0)
+        err = broadphase_build_bricks(&bp, &field);
+    if(err.code != 0) {
+        deletion_stack_flush(&p_dstack);
+        return err;
+    }
+
+    world.p_bricks = &field;
+    world.p_broadphase = &bp;
+    world.p_jobs = p_jobs;
+
+    // The same balls every run
+    srand(42);
+    sim_init(&state, 42);
+    for(uint32_t i = 0; i < balls_count; ++i) {
+        float angle = randf(0.3f, 2.8f);
+        sim_add_ball(&state, randf(1.0f, SIM_FIELD_WIDTH - 1.0f), randf(1.0f, LEVEL_HEIGHT - 0.5f),
+            cosf(angle) * SIM_BALL_SPEED, sinf(angle) * SIM_BALL_SPEED);
+    }
+
+#ifdef BENCH_COUNT_ALLOCS
+    SDL_SetAtomicInt(&allocs_count, 0);
+#endif
+
+    uint64_t start_ns = SDL_GetTicksNS();
+    for(uint32_t tick = 0; tick < ticks; ++tick) {
+        // Sweep the paddle from side to side and put a lost ball straight back into play
+        sim_input_t input = {0};
+        input.paddle_dir = (int8_t)((tick / 90) % 2 == 0 ? 1 : -1);
+        input.launch = true;
+        sim_tick(&state, &world, &input, TICK_DT);
+    }
+    p_result->elapsed_ns = SDL_GetTicksNS() - start_ns;
+
+#ifdef BENCH_COUNT_ALLOCS
+    p_result->allocs = SDL_GetAtomicInt(&allocs_count);
+#else
+    p_result->allocs = -1;
+#endif
+
+    p_result->bricks = field.count;
+    p_result->balls = balls_count;
+    p_result->bricks_left = field.alive_count;
+    p_result->balls_left = state.balls_count;
+
+    return deletion_stack_flush(&p_dstack);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t ticks = DEFAULT_TICKS;
+    int cpu_count = SDL_GetNumLogicalCPUCores();
+    uint32_t workers_count = cpu_count > 0 ? (uint32_t)cpu_count : 1;
+
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--ticks <n>] [--workers <n>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(ticks == 0 || workers_count == 0 || workers_count > JOB_MAX_WORKERS) {
+        fprintf(stderr, "Ticks must be above 0 and workers in [1, %d]\n", JOB_MAX_WORKERS);
+        return EXIT_FAILURE;
+    }
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    if(p_dstack == NULL)
+        return EXIT_FAILURE;
+
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, workers_count, &jobs);
+    if(err.code != 0) {
+        fprintf(stderr, "%s\n", err.msg);
+        error_deinit(&err);
+        deletion_stack_flush(&p_dstack);
+        return EXIT_FAILURE;
+    }
+
+    printf("{\n");
+    printf("  \"benchmark\": \"break_bench\",\n");
+    printf("  \"ticks\": %u,\n", ticks);
+    printf("  \"workers\": %u,\n", jobs.workers_count);
+    printf("  \"results\": [");
+
+    bool first = true;
+    for(size_t b = 0; b < sizeof(p_bricks_counts) / sizeof(p_bricks_counts[0]); ++b) {
+        for(size_t n = 0; n < sizeof(p_balls_counts) / sizeof(p_balls_counts[0]); ++n) {
+            result_t result = {0};
+            err = run_level(&jobs, p_bricks_counts[b], p_balls_counts[n], ticks, &result);
+            if(err.code != 0) {
+                fprintf(stderr, "%s\n", err.msg);
+                error_deinit(&err);
+                deletion_stack_flush(&p_dstack);
+                return EXIT_FAILURE;
+            }
+
+            double seconds = (double)result.elapsed_ns / 1e9;
+            printf("%s\n    {\"bricks\": %u, \"balls\": %u, \"ticks_per_second\": %.1f, \"ns_per_tick\": %.1f, ",
+                first ? "" : ",", result.bricks, result.balls, seconds > 0.0 ? (double)ticks / seconds : 0.0,
+                (double)result.elapsed_ns / (double)ticks);
+
+            // null where the allocator can not be wrapped
+            if(result.allocs >= 0)
+                printf("\"allocs_per_tick\": %.3f, ", (double)result.allocs / (double)ticks);
+            else
+                printf("\"allocs_per_tick\": null, ");
+
+            printf("\"bricks_left\": %u, \"balls_left\": %u}", result.bricks_left, result.balls_left);
+            fflush(stdout);
+            first = false;
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    deletion_stack_flush(&p_dstack);
+
+    return EXIT_SUCCESS;
+}
@@ -4,8 +4,14 @@
 // Check for GCC or Clang
 #if defined(__GNUC__) || defined(__clang__)
 #define FORMAT_ATTR(format_index, first_arg_index) __attribute__((format(printf, format_index, first_arg_index)))
+// Result only depends on the arguments and the memory they point to, so repeated calls can be merged
+#define PURE_ATTR __attribute__((pure))
+// Result only depends on the arguments, no memory is read
+#define CONST_ATTR __attribute__((const))
 #else
 #define FORMAT_ATTR(format_index, first_arg_index) // NOP for MSVC and other compilers
+#define PURE_ATTR                                  // NOP for MSVC and other compilers
+#define CONST_ATTR                                 // NOP for MSVC and other compilers
 #endif
 
 #endif // CONFIG_H_
@@ -33,6 +33,7 @@ typedef enum {
     ERR_FTELL,
     ERR_FREAD,
     ERR_FCLOSE,
+    ERR_FWRITE,
 
     // deletion stack
     ERR_DELETION_STACK_INIT,
@@ -57,7 +58,11 @@ typedef enum {
     ERR_WINDOW_EXTENT,
 
     // vulkan image
-    ERR_VULKAN_IMAGE
+    ERR_VULKAN_IMAGE,
+
+    // game
+    ERR_BRICK_FIELD_FULL,
+    ERR_REPLAY_FORMAT
 } core_error_code_t;
 
 /**
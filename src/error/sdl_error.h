@@ -9,7 +9,11 @@ typedef enum {
     SDL_ERR_BACKEND_INIT,
     SDL_ERR_INIT_SUB_SYSTEM,
     SDL_ERR_WINDOW,
-    SDL_ERR_VULKAN_CREATE_SURFACE
+    SDL_ERR_VULKAN_CREATE_SURFACE,
+    SDL_ERR_CREATE_THREAD,
+    SDL_ERR_CREATE_MUTEX,
+    SDL_ERR_CREATE_CONDITION,
+    SDL_ERR_CREATE_SEMAPHORE
 } sdl_error_code_t;
 
 #endif // SDL_ERROR_H_
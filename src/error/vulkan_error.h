@@ -20,7 +20,12 @@ typedef enum {
     VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
     VULKAN_ERR_CREATE_PIPELINE_LAYOUT,
     VULKAN_ERR_CREATE_SHADER_MODULE,
-    VULKAN_ERR_CREATE_COMPUTE_PIPELINES
+    VULKAN_ERR_CREATE_COMPUTE_PIPELINES,
+    VULKAN_ERR_CREATE_QUERY_POOL,
+    VULKAN_ERR_CREATE_SAMPLER,
+    VULKAN_ERR_BUFFER,
+    VULKAN_ERR_MEMORY,
+    VULKAN_ERR_CREATE_GRAPHICS_PIPELINES
 } vulkan_error_code_t;
 
 #endif // VULKAN_ERROR_H_
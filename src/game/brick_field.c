@@ -0,0 +1,190 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error/error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+
+/**
+ * Round size up to a multiple of BRICK_FIELD_ALIGNMENT.
+ */
+static size_t align_size(size_t size);
+
+/**
+ * \brief Free the arrays of a brick field.
+ *
+ * \param[in] p_void_field Pointer to the brick_field_t.
+ */
+static void brick_field_deinit(void* p_void_field);
+
+error_t brick_field_init(deletion_stack_t* p_dstack, uint32_t capacity, brick_field_t* p_field)
+{
+    if(p_dstack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_dstack is NULL", __func__);
+
+    if(p_field == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_field is NULL", __func__);
+
+    *p_field = (brick_field_t){0};
+
+    if(capacity == 0)
+        capacity = BRICK_FIELD_LANES;
+
+    // Rounding up must not wrap around to a tiny field
+    if(capacity > UINT32_MAX - (BRICK_FIELD_LANES - 1))
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Capacity %u is too large", __func__, capacity);
+
+    capacity = (capacity + BRICK_FIELD_LANES - 1) / BRICK_FIELD_LANES * BRICK_FIELD_LANES;
+
+    size_t float_size = align_size(capacity * sizeof(float));
+    size_t byte_size = align_size(capacity * sizeof(uint8_t));
+    size_t mask_size = align_size(((size_t)capacity + 63) / 64 * sizeof(uint64_t));
+    size_t total_size = 4 * float_size + 2 * byte_size + mask_size;
+
+    // One allocation for all arrays, over allocated so the start can be aligned by hand since C99 has no aligned_alloc
+    p_field->p_block = malloc(total_size + BRICK_FIELD_ALIGNMENT - 1);
+    if(p_field->p_block == NULL)
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %u bricks", __func__, capacity);
+
+    uintptr_t addr = (uintptr_t)p_field->p_block + BRICK_FIELD_ALIGNMENT - 1;
+    uint8_t* p_base = (uint8_t*)(addr & ~(uintptr_t)(BRICK_FIELD_ALIGNMENT - 1));
+    memset(p_base, 0, total_size);
+
+    p_field->p_x = (float*)(void*)p_base;
+    p_field->p_y = (float*)(void*)(p_base + float_size);
+    p_field->p_half_w = (float*)(void*)(p_base + 2 * float_size);
+    p_field->p_half_h = (float*)(void*)(p_base + 3 * float_size);
+    p_field->p_hp = p_base + 4 * float_size;
+    p_field->p_type = p_base + 4 * float_size + byte_size;
+    p_field->p_alive = (uint64_t*)(void*)(p_base + 4 * float_size + 2 * byte_size);
+    p_field->capacity = capacity;
+
+    // CLEANUP
+    error_t err = deletion_stack_push(p_dstack, p_field, brick_field_deinit);
+    if(err.code != 0) {
+        brick_field_deinit(p_field);
+        return err;
+    }
+
+    LOG_DEBUG("%s: Successful, capacity %u", __func__, capacity);
+
+    return SUCCESS;
+}
+
+static void brick_field_deinit(void* p_void_field)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_field == NULL) {
+        LOG_ERROR("%s: p_void_field is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    brick_field_t* p_field = (brick_field_t*)p_void_field;
+
+    free(p_field->p_block);
+    *p_field = (brick_field_t){0};
+
+    p_void_field = NULL;
+}
+
+void brick_field_clear(brick_field_t* p_field)
+{
+    if(p_field == NULL) {
+        LOG_ERROR("%s: p_field is NULL", __func__);
+        return;
+    }
+
+    // Keep the slots past count zeroed, vector loops read them
+    memset(p_field->p_x, 0, p_field->count * sizeof(float));
+    memset(p_field->p_y, 0, p_field->count * sizeof(float));
+    memset(p_field->p_half_w, 0, p_field->count * sizeof(float));
+    memset(p_field->p_half_h, 0, p_field->count * sizeof(float));
+    memset(p_field->p_hp, 0, p_field->count);
+    memset(p_field->p_type, 0, p_field->count);
+    memset(p_field->p_alive, 0, ((size_t)p_field->capacity + 63) / 64 * sizeof(uint64_t));
+
+    p_field->count = 0;
+    p_field->alive_count = 0;
+}
+
+error_t brick_field_add(brick_field_t* p_field, float x, float y, float width, float height, uint8_t hp, uint8_t type,
+    uint32_t* p_index)
+{
+    if(p_field == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_field is NULL", __func__);
+
+    if(p_field->count >= p_field->capacity)
+        return error_init(ERR_SRC_CORE, ERR_BRICK_FIELD_FULL, "%s: Brick field is full, capacity %u", __func__,
+            p_field->capacity);
+
+    uint32_t index = p_field->count++;
+
+    p_field->p_x[index] = x;
+    p_field->p_y[index] = y;
+    p_field->p_half_w[index] = width * 0.5f;
+    p_field->p_half_h[index] = height * 0.5f;
+    p_field->p_hp[index] = hp > 0 ? hp : 1;
+    p_field->p_type[index] = type;
+    p_field->p_alive[index >> 6] |= (uint64_t)1 << (index & 63);
+    ++p_field->alive_count;
+
+    if(p_index != NULL)
+        *p_index = index;
+
+    return SUCCESS;
+}
+
+error_t brick_field_fill_grid(brick_field_t* p_field, uint32_t cols, uint32_t rows, float min_x, float min_y,
+    float width, float height, float gap)
+{
+    if(p_field == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_field is NULL", __func__);
+
+    if((uint64_t)cols * rows > p_field->capacity)
+        return error_init(ERR_SRC_CORE, ERR_BRICK_FIELD_FULL, "%s: %u x %u bricks do not fit in capacity %u",
+            __func__, cols, rows, p_field->capacity);
+
+    brick_field_clear(p_field);
+
+    for(uint32_t row = 0; row < rows; ++row) {
+        // Top rows are tougher
+        uint32_t from_top = rows - 1 - row;
+        uint8_t hp = (uint8_t)(from_top < 2 ? 3 : (from_top < 4 ? 2 : 1));
+        uint8_t type = (uint8_t)(from_top % 8);
+        float y = min_y + (float)row * (height + gap) + height * 0.5f;
+
+        for(uint32_t col = 0; col < cols; ++col) {
+            float x = min_x + (float)col * (width + gap) + width * 0.5f;
+            error_t err = brick_field_add(p_field, x, y, width, height, hp, type, NULL);
+            if(err.code != 0)
+                return err;
+        }
+    }
+
+    return SUCCESS;
+}
+
+bool brick_field_hit(brick_field_t* p_field, uint32_t index)
+{
+    if(p_field == NULL || index >= p_field->count || !brick_field_is_alive(p_field, index))
+        return false;
+
+    if(--p_field->p_hp[index] > 0)
+        return false;
+
+    p_field->p_alive[index >> 6] &= ~((uint64_t)1 << (index & 63));
+    --p_field->alive_count;
+
+    return true;
+}
+
+static size_t align_size(size_t size)
+{
+    return (size + BRICK_FIELD_ALIGNMENT - 1) & ~(size_t)(BRICK_FIELD_ALIGNMENT - 1);
+}
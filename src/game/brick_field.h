@@ -0,0 +1,100 @@
+#ifndef BRICK_FIELD_H_
+#define BRICK_FIELD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+
+// Alignment of the brick arrays in bytes, enough for a full AVX register of floats
+#define BRICK_FIELD_ALIGNMENT 32
+
+// The capacity is rounded up to a multiple of this, so vector loops can always load whole lanes
+#define BRICK_FIELD_LANES 8
+
+/**
+ * The bricks of a level stored as a structure of arrays. Each field has its own aligned array indexed by brick, so
+ * loops that only need the positions, for example collision, stream through contiguous memory and vectorize.
+ *
+ * Destroyed bricks keep their slot and are only cleared in the alive bitmask, so indices stay stable while a level is
+ * played. Slots from count up to capacity are zeroed and never alive.
+ */
+typedef struct brick_field_s {
+    float* p_x;        // Center
+    float* p_y;
+    float* p_half_w;   // Half extents
+    float* p_half_h;
+    uint8_t* p_hp;     // Hits left before the brick is destroyed
+    uint8_t* p_type;   // Type id, decides the look of the brick
+    uint64_t* p_alive; // One bit per brick
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t alive_count;
+    void* p_block;     // The single allocation backing all arrays
+} brick_field_t;
+
+/**
+ * \brief Initiate an empty brick field.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack the arrays are freed by.
+ * \param[in] capacity The most bricks the field can hold, rounded up to a multiple of BRICK_FIELD_LANES.
+ * \param[out] p_field Pointer to the brick_field_t to initiate. The deletion stack keeps the pointer, so it must stay
+ * valid until the stack is flushed.
+ */
+error_t brick_field_init(deletion_stack_t* p_dstack, uint32_t capacity, brick_field_t* p_field);
+
+/**
+ * Remove all bricks, the capacity is kept.
+ */
+void brick_field_clear(brick_field_t* p_field);
+
+/**
+ * \brief Add a brick.
+ *
+ * \param[in] p_field Pointer to the brick_field_t.
+ * \param[in] x The center of the brick.
+ * \param[in] y The center of the brick.
+ * \param[in] width The width of the brick.
+ * \param[in] height The height of the brick.
+ * \param[in] hp Hits before the brick is destroyed, 0 is treated as 1.
+ * \param[in] type The type id of the brick.
+ * \param[out] p_index Optional, the index of the new brick.
+ */
+error_t brick_field_add(brick_field_t* p_field, float x, float y, float width, float height, uint8_t hp, uint8_t type,
+    uint32_t* p_index);
+
+/**
+ * \brief Fill the field with a grid of bricks, replacing what was in it.
+ *
+ * Rows get hit points and type ids from the top down, so a generated level looks like a classic wall. Used for the
+ * default level and for generating large test levels.
+ *
+ * \param[in] p_field Pointer to the brick_field_t.
+ * \param[in] cols Number of columns.
+ * \param[in] rows Number of rows.
+ * \param[in] min_x The left edge of the grid.
+ * \param[in] min_y The bottom edge of the grid.
+ * \param[in] width The width of a brick.
+ * \param[in] height The height of a brick.
+ * \param[in] gap The space between two bricks.
+ */
+error_t brick_field_fill_grid(brick_field_t* p_field, uint32_t cols, uint32_t rows, float min_x, float min_y,
+    float width, float height, float gap);
+
+/**
+ * \brief Hit a brick once.
+ *
+ * \return True if the hit destroyed the brick.
+ */
+bool brick_field_hit(brick_field_t* p_field, uint32_t index);
+
+/**
+ * Check if a brick is alive.
+ */
+static inline bool brick_field_is_alive(const brick_field_t* p_field, uint32_t index)
+{
+    return (p_field->p_alive[index >> 6] >> (index & 63)) & 1u;
+}
+
+#endif // BRICK_FIELD_H_
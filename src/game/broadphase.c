@@ -0,0 +1,255 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error/error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+
+/**
+ * Get the cell column or row of a coordinate, clamped to [0, cells).
+ */
+static uint16_t cell_coord(float value, float min, float inv_cell, uint32_t cells);
+
+/**
+ * Get the cells covered by a brick.
+ */
+static cell_range_t brick_range(const broadphase_t* p_bp, const brick_field_t* p_field, uint32_t index);
+
+/**
+ * Grow an array to hold at least count elements, keeping its contents.
+ *
+ * \return The grown array, or NULL if the allocation failed in which case p_array is left untouched.
+ */
+static void* grow_array(void* p_array, uint32_t* p_capacity, uint32_t count, size_t element_size);
+
+/**
+ * \brief Free the arrays of a broadphase.
+ *
+ * \param[in] p_void_bp Pointer to the broadphase_t.
+ */
+static void broadphase_deinit(void* p_void_bp);
+
+error_t broadphase_init(deletion_stack_t* p_dstack, float min_x, float min_y, float max_x, float max_y, float cell_w,
+    float cell_h, broadphase_t* p_bp)
+{
+    if(p_dstack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_dstack is NULL", __func__);
+
+    if(p_bp == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_bp is NULL", __func__);
+
+    *p_bp = (broadphase_t){0};
+
+    if(!(max_x > min_x) || !(max_y > min_y) || !(cell_w > 0.0f) || !(cell_h > 0.0f))
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Invalid grid bounds or cell size", __func__);
+
+    double cols = ceil((double)(max_x - min_x) / (double)cell_w);
+    double rows = ceil((double)(max_y - min_y) / (double)cell_h);
+    if(cols > UINT16_MAX || rows > UINT16_MAX || cols * rows > (double)(UINT32_MAX - 1))
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Grid of %.0f x %.0f cells is too large", __func__, cols,
+            rows);
+
+    p_bp->min_x = min_x;
+    p_bp->min_y = min_y;
+    p_bp->inv_cell_w = 1.0f / cell_w;
+    p_bp->inv_cell_h = 1.0f / cell_h;
+    p_bp->cols = (uint32_t)cols;
+    p_bp->rows = (uint32_t)rows;
+
+    size_t cells = (size_t)p_bp->cols * p_bp->rows;
+    p_bp->p_brick_start = (uint32_t*)calloc(cells, sizeof(uint32_t));
+    p_bp->p_brick_count = (uint32_t*)calloc(cells, sizeof(uint32_t));
+    if(p_bp->p_brick_start == NULL || p_bp->p_brick_count == NULL) {
+        broadphase_deinit(p_bp);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %zu cells", __func__, cells);
+    }
+
+    // CLEANUP
+    error_t err = deletion_stack_push(p_dstack, p_bp, broadphase_deinit);
+    if(err.code != 0) {
+        broadphase_deinit(p_bp);
+        return err;
+    }
+
+    LOG_DEBUG("%s: Successful, %u x %u cells", __func__, p_bp->cols, p_bp->rows);
+
+    return SUCCESS;
+}
+
+static void broadphase_deinit(void* p_void_bp)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_bp == NULL) {
+        LOG_ERROR("%s: p_void_bp is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    broadphase_t* p_bp = (broadphase_t*)p_void_bp;
+
+    free(p_bp->p_brick_start);
+    free(p_bp->p_brick_count);
+    free(p_bp->p_brick_items);
+    *p_bp = (broadphase_t){0};
+
+    p_void_bp = NULL;
+}
+
+cell_range_t broadphase_cell_range(const broadphase_t* p_bp, float min_x, float min_y, float max_x, float max_y)
+{
+    cell_range_t range;
+    range.min_x = cell_coord(min_x, p_bp->min_x, p_bp->inv_cell_w, p_bp->cols);
+    range.min_y = cell_coord(min_y, p_bp->min_y, p_bp->inv_cell_h, p_bp->rows);
+    range.max_x = cell_coord(max_x, p_bp->min_x, p_bp->inv_cell_w, p_bp->cols);
+    range.max_y = cell_coord(max_y, p_bp->min_y, p_bp->inv_cell_h, p_bp->rows);
+
+    return range;
+}
+
+error_t broadphase_build_bricks(broadphase_t* p_bp, const brick_field_t* p_field)
+{
+    if(p_bp == NULL || p_field == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_bp or p_field is NULL", __func__);
+
+    size_t cells = (size_t)p_bp->cols * p_bp->rows;
+    memset(p_bp->p_brick_count, 0, cells * sizeof(uint32_t));
+
+    // Count the items of each cell
+    uint32_t items_count = 0;
+    for(uint32_t i = 0; i < p_field->count; ++i) {
+        if(!brick_field_is_alive(p_field, i))
+            continue;
+
+        cell_range_t range = brick_range(p_bp, p_field, i);
+        for(uint32_t cy = range.min_y; cy <= range.max_y; ++cy) {
+            for(uint32_t cx = range.min_x; cx <= range.max_x; ++cx)
+                ++p_bp->p_brick_count[cy * p_bp->cols + cx];
+        }
+        items_count += (uint32_t)(range.max_x - range.min_x + 1) * (uint32_t)(range.max_y - range.min_y + 1);
+    }
+
+    uint32_t* p_items = (uint32_t*)grow_array(p_bp->p_brick_items, &p_bp->brick_items_capacity, items_count,
+        sizeof(uint32_t));
+    if(p_items == NULL)
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %u brick items", __func__, items_count);
+    p_bp->p_brick_items = p_items;
+
+    // Prefix sum into the start of each cell, the counts are then rebuilt while placing the items
+    uint32_t start = 0;
+    for(size_t c = 0; c < cells; ++c) {
+        p_bp->p_brick_start[c] = start;
+        start += p_bp->p_brick_count[c];
+        p_bp->p_brick_count[c] = 0;
+    }
+
+    for(uint32_t i = 0; i < p_field->count; ++i) {
+        if(!brick_field_is_alive(p_field, i))
+            continue;
+
+        cell_range_t range = brick_range(p_bp, p_field, i);
+        for(uint32_t cy = range.min_y; cy <= range.max_y; ++cy) {
+            for(uint32_t cx = range.min_x; cx <= range.max_x; ++cx) {
+                uint32_t cell = cy * p_bp->cols + cx;
+                p_bp->p_brick_items[p_bp->p_brick_start[cell] + p_bp->p_brick_count[cell]++] = i;
+            }
+        }
+    }
+
+    return SUCCESS;
+}
+
+void broadphase_remove_brick(broadphase_t* p_bp, const brick_field_t* p_field, uint32_t index)
+{
+    if(p_bp == NULL || p_field == NULL || index >= p_field->count) {
+        LOG_ERROR("%s: Invalid argument", __func__);
+        return;
+    }
+
+    cell_range_t range = brick_range(p_bp, p_field, index);
+    for(uint32_t cy = range.min_y; cy <= range.max_y; ++cy) {
+        for(uint32_t cx = range.min_x; cx <= range.max_x; ++cx) {
+            uint32_t cell = cy * p_bp->cols + cx;
+            uint32_t* p_items = p_bp->p_brick_items + p_bp->p_brick_start[cell];
+
+            // Order inside a cell does not matter, swap with the last item
+            for(uint32_t k = 0; k < p_bp->p_brick_count[cell]; ++k) {
+                if(p_items[k] == index) {
+                    p_items[k] = p_items[--p_bp->p_brick_count[cell]];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+uint32_t broadphase_query_bricks(const broadphase_t* p_bp, const brick_field_t* p_field, cell_range_t range,
+    uint32_t* p_out, uint32_t max_out)
+{
+    if(p_bp == NULL || p_field == NULL || p_out == NULL)
+        return 0;
+
+    uint32_t out_count = 0;
+    for(uint32_t cy = range.min_y; cy <= range.max_y; ++cy) {
+        for(uint32_t cx = range.min_x; cx <= range.max_x; ++cx) {
+            uint32_t cell = cy * p_bp->cols + cx;
+            const uint32_t* p_items = p_bp->p_brick_items + p_bp->p_brick_start[cell];
+
+            for(uint32_t k = 0; k < p_bp->p_brick_count[cell]; ++k) {
+                // A brick covering several cells of the query is only reported from the first of them, which is
+                // where its own range and the query range start to overlap
+                cell_range_t brick = brick_range(p_bp, p_field, p_items[k]);
+                uint32_t first_x = brick.min_x > range.min_x ? brick.min_x : range.min_x;
+                uint32_t first_y = brick.min_y > range.min_y ? brick.min_y : range.min_y;
+                if(first_x != cx || first_y != cy)
+                    continue;
+
+                if(out_count == max_out)
+                    return out_count;
+
+                p_out[out_count++] = p_items[k];
+            }
+        }
+    }
+
+    return out_count;
+}
+
+static uint16_t cell_coord(float value, float min, float inv_cell, uint32_t cells)
+{
+    float cell = floorf((value - min) * inv_cell);
+    if(!(cell > 0.0f))
+        return 0;
+    if(cell >= (float)(cells - 1))
+        return (uint16_t)(cells - 1);
+    return (uint16_t)cell;
+}
+
+static cell_range_t brick_range(const broadphase_t* p_bp, const brick_field_t* p_field, uint32_t index)
+{
+    return broadphase_cell_range(p_bp, p_field->p_x[index] - p_field->p_half_w[index],
+        p_field->p_y[index] - p_field->p_half_h[index], p_field->p_x[index] + p_field->p_half_w[index],
+        p_field->p_y[index] + p_field->p_half_h[index]);
+}
+
+static void* grow_array(void* p_array, uint32_t* p_capacity, uint32_t count, size_t element_size)
+{
+    if(count <= *p_capacity && p_array != NULL)
+        return p_array;
+
+    // Grow by half again so a slowly rising count does not reallocate every level
+    uint32_t capacity = count + count / 2 + 16;
+    void* p_grown = realloc(p_array, capacity * element_size);
+    if(p_grown == NULL)
+        return NULL;
+
+    *p_capacity = capacity;
+
+    return p_grown;
+}
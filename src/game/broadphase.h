@@ -0,0 +1,96 @@
+#ifndef BROADPHASE_H_
+#define BROADPHASE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+
+/**
+ * The cells a box covers, inclusive on both ends.
+ */
+typedef struct cell_range_s {
+    uint16_t min_x;
+    uint16_t min_y;
+    uint16_t max_x;
+    uint16_t max_y;
+} cell_range_t;
+
+/**
+ * Uniform grid broadphase for the bricks. The grid is sized so a cell is about one brick, so a ball only ever overlaps
+ * a handful of cells and each cell only holds a handful of bricks.
+ *
+ * Bricks are static. They are bucketed once per level by broadphase_build_bricks into a compressed layout, the items
+ * of cell c are p_brick_items[p_brick_start[c]] and onwards. Destroyed bricks are removed from their cells one by one.
+ *
+ * Objects outside the grid are clamped into the border cells, so nothing is ever lost. Queries only read the
+ * broadphase, so they can run on several threads at once.
+ */
+typedef struct broadphase_s {
+    float min_x;
+    float min_y;
+    float inv_cell_w;
+    float inv_cell_h;
+    uint32_t cols;
+    uint32_t rows;
+
+    // Static bricks
+    uint32_t* p_brick_start; // First item of each cell
+    uint32_t* p_brick_count; // Items of each cell, lowered when a brick is removed
+    uint32_t* p_brick_items; // Brick indices
+    uint32_t brick_items_capacity;
+} broadphase_t;
+
+/**
+ * \brief Initiate an empty broadphase.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack the arrays are freed by.
+ * \param[in] min_x The left edge of the grid.
+ * \param[in] min_y The bottom edge of the grid.
+ * \param[in] max_x The right edge of the grid.
+ * \param[in] max_y The top edge of the grid.
+ * \param[in] cell_w The width of a cell, usually the width of a brick.
+ * \param[in] cell_h The height of a cell, usually the height of a brick.
+ * \param[out] p_bp Pointer to the broadphase_t to initiate. The deletion stack keeps the pointer, so it must stay valid
+ * until the stack is flushed.
+ */
+error_t broadphase_init(deletion_stack_t* p_dstack, float min_x, float min_y, float max_x, float max_y, float cell_w,
+    float cell_h, broadphase_t* p_bp);
+
+/**
+ * Get the cells a box covers, clamped to the grid.
+ */
+cell_range_t broadphase_cell_range(const broadphase_t* p_bp, float min_x, float min_y, float max_x, float max_y)
+    PURE_ATTR;
+
+/**
+ * Bucket every alive brick of a brick field, replacing the bricks bucketed before. Done when a level is loaded.
+ */
+error_t broadphase_build_bricks(broadphase_t* p_bp, const brick_field_t* p_field);
+
+/**
+ * Remove a destroyed brick from its cells. The brick must still have the position it was bucketed with.
+ */
+void broadphase_remove_brick(broadphase_t* p_bp, const brick_field_t* p_field, uint32_t index);
+
+/**
+ * \brief Find the bricks that may overlap a box.
+ *
+ * Every brick sharing a cell with the box is returned exactly once, even if it covers several of the cells. The exact
+ * test is left to the narrow phase.
+ *
+ * \param[in] p_bp Pointer to the broadphase_t.
+ * \param[in] p_field Pointer to the brick field the bricks were bucketed from.
+ * \param[in] range The cells to search, from broadphase_cell_range.
+ * \param[out] p_out Array the brick indices are written to.
+ * \param[in] max_out Length of p_out.
+ *
+ * \return The number of bricks written to p_out, at most max_out.
+ */
+uint32_t broadphase_query_bricks(const broadphase_t* p_bp, const brick_field_t* p_field, cell_range_t range,
+    uint32_t* p_out, uint32_t max_out);
+
+#endif // BROADPHASE_H_
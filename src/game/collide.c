@@ -0,0 +1,635 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/collide.h"
+
+// The vector kernels are only built for x86 with a GCC compatible compiler, which can enable instruction sets per
+// function. Everything else uses the scalar kernel.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLLIDE_X86
+#include <immintrin.h>
+#endif
+
+// Returned by the kernels when no brick is hit
+#define NO_HIT UINT32_MAX
+
+// Most broadphase candidates for one sweep, a longer path falls back to testing every brick
+#define SWEEP_MAX_CANDIDATES 1024
+
+static float clampf(float value, float min, float max)
+{
+    if(value < min)
+        return min;
+    if(value > max)
+        return max;
+    return value;
+}
+
+/**
+ * Sweep the ball against a brick with collide_sweep_ball_box and keep the brick if it is alive and hit before
+ * *p_best_t. Ties go to the lowest index.
+ */
+static void sweep_brick(const brick_field_t* p_field, uint32_t index, float x, float y, float dx, float dy,
+    float radius, float* p_best_t, uint32_t* p_best_index);
+
+/**
+ * Keep a hit if it is before the best one so far, ties go to the lowest index.
+ */
+static void keep_first(uint32_t index, float t, float* p_best_t, uint32_t* p_best_index);
+
+/**
+ * Find the alive brick the ball hits first when swept over every brick of the field. Every kernel implements exactly
+ * this: the bricks are tested like collide_sweep_ball_box tests them, ties go to the lowest index.
+ *
+ * \return The index of the brick, or NO_HIT.
+ */
+static uint32_t first_brick_scalar(const brick_field_t* p_field, float x, float y, float dx, float dy, float radius);
+
+#ifdef COLLIDE_X86
+__attribute__((target("sse2"))) static uint32_t first_brick_sse2(const brick_field_t* p_field, float x, float y,
+    float dx, float dy, float radius);
+
+__attribute__((target("avx2"))) static uint32_t first_brick_avx2(const brick_field_t* p_field, float x, float y,
+    float dx, float dy, float radius);
+#endif
+
+/**
+ * Get the normal of the box face closest to a point inside the box, and the distance to it.
+ */
+static float closest_face(float x, float y, float min_x, float min_y, float max_x, float max_y, float* p_nx,
+    float* p_ny);
+
+bool collide_impl_supported(collide_impl_t impl)
+{
+    switch(impl) {
+    case COLLIDE_IMPL_SCALAR:
+        return true;
+#ifdef COLLIDE_X86
+    case COLLIDE_IMPL_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case COLLIDE_IMPL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+collide_impl_t collide_best_impl(void)
+{
+    if(collide_impl_supported(COLLIDE_IMPL_AVX2))
+        return COLLIDE_IMPL_AVX2;
+
+    if(collide_impl_supported(COLLIDE_IMPL_SSE2))
+        return COLLIDE_IMPL_SSE2;
+
+    return COLLIDE_IMPL_SCALAR;
+}
+
+const char* collide_impl_name(collide_impl_t impl)
+{
+    switch(impl) {
+    case COLLIDE_IMPL_SCALAR:
+        return "scalar";
+    case COLLIDE_IMPL_SSE2:
+        return "sse2";
+    case COLLIDE_IMPL_AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
+
+bool collide_sweep_ball_box(float x, float y, float dx, float dy, float radius, float min_x, float min_y, float max_x,
+    float max_y, float* p_t, float* p_nx, float* p_ny)
+{
+    // Already overlapping, only a hit if moving further in
+    float off_x = x - clampf(x, min_x, max_x);
+    float off_y = y - clampf(y, min_y, max_y);
+    float dist_sq = off_x * off_x + off_y * off_y;
+    if(dist_sq < radius * radius) {
+        float nx = 0.0f;
+        float ny = 0.0f;
+        if(dist_sq > 0.0f) {
+            float dist = sqrtf(dist_sq);
+            nx = off_x / dist;
+            ny = off_y / dist;
+        } else {
+            closest_face(x, y, min_x, min_y, max_x, max_y, &nx, &ny);
+        }
+
+        if(!(dx * nx + dy * ny < 0.0f))
+            return false;
+
+        *p_t = 0.0f;
+        *p_nx = nx;
+        *p_ny = ny;
+        return true;
+    }
+
+    float move_sq = dx * dx + dy * dy;
+    if(!(move_sq > 0.0f))
+        return false;
+
+    // Slab test against the box grown by the radius, which has square corners
+    const float p_pos[2] = {x, y};
+    const float p_move[2] = {dx, dy};
+    const float p_min[2] = {min_x - radius, min_y - radius};
+    const float p_max[2] = {max_x + radius, max_y + radius};
+
+    float t_enter = 0.0f;
+    float t_exit = 1.0f;
+    int enter_axis = -1;
+    for(int axis = 0; axis < 2; ++axis) {
+        if(!(p_move[axis] > 0.0f) && !(p_move[axis] < 0.0f)) {
+            if(p_pos[axis] < p_min[axis] || p_pos[axis] > p_max[axis])
+                return false;
+            continue;
+        }
+
+        float t_near = (p_min[axis] - p_pos[axis]) / p_move[axis];
+        float t_far = (p_max[axis] - p_pos[axis]) / p_move[axis];
+        if(t_near > t_far) {
+            float tmp = t_near;
+            t_near = t_far;
+            t_far = tmp;
+        }
+
+        if(t_near > t_enter) {
+            t_enter = t_near;
+            enter_axis = axis;
+        }
+        if(t_far < t_exit)
+            t_exit = t_far;
+        if(t_enter > t_exit)
+            return false;
+    }
+
+    float hit_x = x + dx * t_enter;
+    float hit_y = y + dy * t_enter;
+
+    // Entered through a flat side of the grown box
+    if(enter_axis == 0 && hit_y >= min_y && hit_y <= max_y) {
+        *p_t = t_enter;
+        *p_nx = dx > 0.0f ? -1.0f : 1.0f;
+        *p_ny = 0.0f;
+        return true;
+    }
+    if(enter_axis == 1 && hit_x >= min_x && hit_x <= max_x) {
+        *p_t = t_enter;
+        *p_nx = 0.0f;
+        *p_ny = dy > 0.0f ? -1.0f : 1.0f;
+        return true;
+    }
+
+    // Entered through a square corner, the real shape there is a circle around the box corner. The path can only reach
+    // a flat side from a corner by going through that circle, so testing it is enough.
+    float corner_x = hit_x < min_x ? min_x : max_x;
+    float corner_y = hit_y < min_y ? min_y : max_y;
+    float f_x = x - corner_x;
+    float f_y = y - corner_y;
+    float b = f_x * dx + f_y * dy;
+    float c = f_x * f_x + f_y * f_y - radius * radius;
+    float disc = b * b - move_sq * c;
+    if(disc < 0.0f)
+        return false;
+
+    float t = (-b - sqrtf(disc)) / move_sq;
+    if(t < 0.0f || t > 1.0f)
+        return false;
+
+    *p_t = t;
+    *p_nx = (f_x + dx * t) / radius;
+    *p_ny = (f_y + dy * t) / radius;
+
+    return true;
+}
+
+bool collide_sweep_ball_bricks(const brick_field_t* p_field, const broadphase_t* p_bp, float x, float y, float dx,
+    float dy, float radius, brick_hit_t* p_hit)
+{
+    return collide_sweep_ball_bricks_impl(collide_best_impl(), p_field, p_bp, x, y, dx, dy, radius, p_hit);
+}
+
+bool collide_sweep_ball_bricks_impl(collide_impl_t impl, const brick_field_t* p_field, const broadphase_t* p_bp,
+    float x, float y, float dx, float dy, float radius, brick_hit_t* p_hit)
+{
+    if(p_field == NULL || p_hit == NULL) {
+        LOG_ERROR("%s: p_field or p_hit is NULL", __func__);
+        return false;
+    }
+
+    if(p_field->alive_count == 0)
+        return false;
+
+    uint32_t index = NO_HIT;
+    uint32_t candidates_count = SWEEP_MAX_CANDIDATES;
+
+    if(p_bp != NULL) {
+        uint32_t p_candidates[SWEEP_MAX_CANDIDATES];
+        cell_range_t range = broadphase_cell_range(p_bp, (dx < 0.0f ? x + dx : x) - radius,
+            (dy < 0.0f ? y + dy : y) - radius, (dx > 0.0f ? x + dx : x) + radius, (dy > 0.0f ? y + dy : y) + radius);
+        candidates_count = broadphase_query_bricks(p_bp, p_field, range, p_candidates, SWEEP_MAX_CANDIDATES);
+
+        // The candidates are scattered over the brick field and only a handful, so they are swept one by one
+        float best_t = 2.0f;
+        if(candidates_count < SWEEP_MAX_CANDIDATES) {
+            for(uint32_t k = 0; k < candidates_count; ++k)
+                sweep_brick(p_field, p_candidates[k], x, y, dx, dy, radius, &best_t, &index);
+        }
+    }
+
+    // No broadphase, or a path covering too many cells, the whole field is swept lanes at a time
+    if(candidates_count == SWEEP_MAX_CANDIDATES) {
+        switch(impl) {
+#ifdef COLLIDE_X86
+        case COLLIDE_IMPL_SSE2:
+            index = first_brick_sse2(p_field, x, y, dx, dy, radius);
+            break;
+        case COLLIDE_IMPL_AVX2:
+            index = first_brick_avx2(p_field, x, y, dx, dy, radius);
+            break;
+#endif
+        default:
+            index = first_brick_scalar(p_field, x, y, dx, dy, radius);
+            break;
+        }
+    }
+
+    if(index == NO_HIT)
+        return false;
+
+    // The kernels only pick the brick, the contact comes from the same scalar test for all of them
+    float t = 0.0f;
+    float nx = 0.0f;
+    float ny = 0.0f;
+    if(!collide_sweep_ball_box(x, y, dx, dy, radius, p_field->p_x[index] - p_field->p_half_w[index],
+           p_field->p_y[index] - p_field->p_half_h[index], p_field->p_x[index] + p_field->p_half_w[index],
+           p_field->p_y[index] + p_field->p_half_h[index], &t, &nx, &ny))
+        return false;
+
+    p_hit->index = index;
+    p_hit->t = t;
+    p_hit->nx = nx;
+    p_hit->ny = ny;
+
+    return true;
+}
+
+static void sweep_brick(const brick_field_t* p_field, uint32_t index, float x, float y, float dx, float dy,
+    float radius, float* p_best_t, uint32_t* p_best_index)
+{
+    if(!brick_field_is_alive(p_field, index))
+        return;
+
+    float t = 0.0f;
+    float nx = 0.0f;
+    float ny = 0.0f;
+    if(collide_sweep_ball_box(x, y, dx, dy, radius, p_field->p_x[index] - p_field->p_half_w[index],
+           p_field->p_y[index] - p_field->p_half_h[index], p_field->p_x[index] + p_field->p_half_w[index],
+           p_field->p_y[index] + p_field->p_half_h[index], &t, &nx, &ny))
+        keep_first(index, t, p_best_t, p_best_index);
+}
+
+static void keep_first(uint32_t index, float t, float* p_best_t, uint32_t* p_best_index)
+{
+    if(t < *p_best_t || (!(t > *p_best_t) && index < *p_best_index)) {
+        *p_best_t = t;
+        *p_best_index = index;
+    }
+}
+
+static uint32_t first_brick_scalar(const brick_field_t* p_field, float x, float y, float dx, float dy, float radius)
+{
+    uint32_t best_index = NO_HIT;
+    float best_t = 2.0f;
+
+    for(uint32_t i = 0; i < p_field->count; ++i)
+        sweep_brick(p_field, i, x, y, dx, dy, radius, &best_t, &best_index);
+
+    return best_index;
+}
+
+#ifdef COLLIDE_X86
+/**
+ * Pick a where the mask is set and b elsewhere. SSE2 has no blend instruction.
+ */
+__attribute__((target("sse2"))) static inline __m128 select_sse2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// The vector kernels repeat collide_sweep_ball_box operation for operation, so each lane rounds exactly like the
+// scalar test and the same brick is picked. Balls that already overlap a brick are rare, those lanes are handed to
+// the scalar test rather than vectorizing the push out normal.
+__attribute__((target("sse2"))) static uint32_t first_brick_sse2(const brick_field_t* p_field, float x, float y,
+    float dx, float dy, float radius)
+{
+    const __m128 ball_x = _mm_set1_ps(x);
+    const __m128 ball_y = _mm_set1_ps(y);
+    const __m128 move_x = _mm_set1_ps(dx);
+    const __m128 move_y = _mm_set1_ps(dy);
+    const __m128 ball_radius = _mm_set1_ps(radius);
+    const __m128 radius_sq = _mm_set1_ps(radius * radius);
+    const __m128 move_sq = _mm_set1_ps(dx * dx + dy * dy);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i lane_step = _mm_set1_epi32(4);
+
+    // The same for every lane, so tested once rather than per brick
+    const bool moving = dx * dx + dy * dy > 0.0f;
+    const bool moving_x = dx > 0.0f || dx < 0.0f;
+    const bool moving_y = dy > 0.0f || dy < 0.0f;
+
+    __m128 best_t = _mm_set1_ps(2.0f);
+    __m128i best_index = _mm_set1_epi32(-1);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+
+    uint32_t overlap_index = NO_HIT;
+    float overlap_t = 2.0f;
+
+    // The capacity is a multiple of the lane count and the slots past count are never alive, so whole lanes can be
+    // loaded up to count rounded up
+    for(uint32_t i = 0; i < p_field->count; i += 4, index = _mm_add_epi32(index, lane_step)) {
+        uint32_t alive = (uint32_t)(p_field->p_alive[i >> 6] >> (i & 63)) & 0xFu;
+        if(alive == 0)
+            continue;
+
+        __m128 half_w = _mm_load_ps(p_field->p_half_w + i);
+        __m128 half_h = _mm_load_ps(p_field->p_half_h + i);
+        __m128 brick_x = _mm_load_ps(p_field->p_x + i);
+        __m128 brick_y = _mm_load_ps(p_field->p_y + i);
+        __m128 min_x = _mm_sub_ps(brick_x, half_w);
+        __m128 min_y = _mm_sub_ps(brick_y, half_h);
+        __m128 max_x = _mm_add_ps(brick_x, half_w);
+        __m128 max_y = _mm_add_ps(brick_y, half_h);
+        __m128 alive_mask = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)alive), lane_bits), lane_bits));
+
+        // Already overlapping
+        __m128 off_x = _mm_sub_ps(ball_x, _mm_min_ps(_mm_max_ps(ball_x, min_x), max_x));
+        __m128 off_y = _mm_sub_ps(ball_y, _mm_min_ps(_mm_max_ps(ball_y, min_y), max_y));
+        __m128 dist_sq = _mm_add_ps(_mm_mul_ps(off_x, off_x), _mm_mul_ps(off_y, off_y));
+        __m128 overlap = _mm_and_ps(_mm_cmplt_ps(dist_sq, radius_sq), alive_mask);
+
+        int overlap_bits = _mm_movemask_ps(overlap);
+        for(uint32_t lane = 0; overlap_bits != 0 && lane < 4; ++lane) {
+            if(overlap_bits & (1 << lane))
+                sweep_brick(p_field, i + lane, x, y, dx, dy, radius, &overlap_t, &overlap_index);
+        }
+
+        if(!moving)
+            continue;
+
+        // Slab test against the box grown by the radius
+        __m128 hit = _mm_andnot_ps(overlap, alive_mask);
+        __m128 t_enter = zero;
+        __m128 t_exit = one;
+        __m128 enter_x = zero;
+        __m128 enter_y = zero;
+
+        if(moving_x) {
+            __m128 t_near = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(min_x, ball_radius), ball_x), move_x);
+            __m128 t_far = _mm_div_ps(_mm_sub_ps(_mm_add_ps(max_x, ball_radius), ball_x), move_x);
+            __m128 t_first = _mm_min_ps(t_far, t_near);
+            t_far = _mm_max_ps(t_near, t_far);
+
+            enter_x = _mm_cmpgt_ps(t_first, t_enter);
+            t_enter = select_sse2(enter_x, t_first, t_enter);
+            t_exit = _mm_min_ps(t_far, t_exit);
+        } else {
+            hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(ball_x, _mm_sub_ps(min_x, ball_radius)),
+                _mm_cmple_ps(ball_x, _mm_add_ps(max_x, ball_radius))));
+        }
+
+        if(moving_y) {
+            __m128 t_near = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(min_y, ball_radius), ball_y), move_y);
+            __m128 t_far = _mm_div_ps(_mm_sub_ps(_mm_add_ps(max_y, ball_radius), ball_y), move_y);
+            __m128 t_first = _mm_min_ps(t_far, t_near);
+            t_far = _mm_max_ps(t_near, t_far);
+
+            enter_y = _mm_cmpgt_ps(t_first, t_enter);
+            enter_x = _mm_andnot_ps(enter_y, enter_x);
+            t_enter = select_sse2(enter_y, t_first, t_enter);
+            t_exit = _mm_min_ps(t_far, t_exit);
+        } else {
+            hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(ball_y, _mm_sub_ps(min_y, ball_radius)),
+                _mm_cmple_ps(ball_y, _mm_add_ps(max_y, ball_radius))));
+        }
+
+        hit = _mm_and_ps(hit, _mm_cmple_ps(t_enter, t_exit));
+        if(_mm_movemask_ps(hit) == 0)
+            continue;
+
+        // Entered through a flat side of the grown box
+        __m128 hit_x = _mm_add_ps(ball_x, _mm_mul_ps(move_x, t_enter));
+        __m128 hit_y = _mm_add_ps(ball_y, _mm_mul_ps(move_y, t_enter));
+        __m128 flat = _mm_or_ps(
+            _mm_and_ps(enter_x, _mm_and_ps(_mm_cmpge_ps(hit_y, min_y), _mm_cmple_ps(hit_y, max_y))),
+            _mm_and_ps(enter_y, _mm_and_ps(_mm_cmpge_ps(hit_x, min_x), _mm_cmple_ps(hit_x, max_x))));
+
+        // Entered through a square corner, hit the circle around the box corner
+        __m128 f_x = _mm_sub_ps(ball_x, select_sse2(_mm_cmplt_ps(hit_x, min_x), min_x, max_x));
+        __m128 f_y = _mm_sub_ps(ball_y, select_sse2(_mm_cmplt_ps(hit_y, min_y), min_y, max_y));
+        __m128 b = _mm_add_ps(_mm_mul_ps(f_x, move_x), _mm_mul_ps(f_y, move_y));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(f_x, f_x), _mm_mul_ps(f_y, f_y)), radius_sq);
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(move_sq, c));
+        __m128 t_corner = _mm_div_ps(_mm_sub_ps(_mm_xor_ps(b, sign), _mm_sqrt_ps(disc)), move_sq);
+        __m128 corner = _mm_and_ps(_mm_cmpge_ps(disc, zero),
+            _mm_and_ps(_mm_cmpge_ps(t_corner, zero), _mm_cmple_ps(t_corner, one)));
+
+        __m128 t = select_sse2(flat, t_enter, t_corner);
+        hit = _mm_and_ps(hit, _mm_or_ps(flat, corner));
+
+        // Each lane sees its bricks in index order, so a strictly earlier hit keeps ties on the lowest index
+        __m128 first = _mm_and_ps(hit, _mm_cmplt_ps(t, best_t));
+        best_t = select_sse2(first, t, best_t);
+        best_index = _mm_castps_si128(select_sse2(first, _mm_castsi128_ps(index), _mm_castsi128_ps(best_index)));
+    }
+
+    float p_lane_t[4];
+    int32_t p_lane_index[4];
+    _mm_storeu_ps(p_lane_t, best_t);
+    _mm_storeu_si128((__m128i*)(void*)p_lane_index, best_index);
+
+    // First over the lanes and the overlapped bricks
+    uint32_t result = overlap_index;
+    float result_t = overlap_t;
+    for(int lane = 0; lane < 4; ++lane) {
+        if(p_lane_index[lane] >= 0)
+            keep_first((uint32_t)p_lane_index[lane], p_lane_t[lane], &result_t, &result);
+    }
+
+    return result;
+}
+
+__attribute__((target("avx2"))) static uint32_t first_brick_avx2(const brick_field_t* p_field, float x, float y,
+    float dx, float dy, float radius)
+{
+    const __m256 ball_x = _mm256_set1_ps(x);
+    const __m256 ball_y = _mm256_set1_ps(y);
+    const __m256 move_x = _mm256_set1_ps(dx);
+    const __m256 move_y = _mm256_set1_ps(dy);
+    const __m256 ball_radius = _mm256_set1_ps(radius);
+    const __m256 radius_sq = _mm256_set1_ps(radius * radius);
+    const __m256 move_sq = _mm256_set1_ps(dx * dx + dy * dy);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i lane_step = _mm256_set1_epi32(8);
+
+    const bool moving = dx * dx + dy * dy > 0.0f;
+    const bool moving_x = dx > 0.0f || dx < 0.0f;
+    const bool moving_y = dy > 0.0f || dy < 0.0f;
+
+    __m256 best_t = _mm256_set1_ps(2.0f);
+    __m256i best_index = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    uint32_t overlap_index = NO_HIT;
+    float overlap_t = 2.0f;
+
+    for(uint32_t i = 0; i < p_field->count; i += 8, index = _mm256_add_epi32(index, lane_step)) {
+        uint32_t alive = (uint32_t)(p_field->p_alive[i >> 6] >> (i & 63)) & 0xFFu;
+        if(alive == 0)
+            continue;
+
+        __m256 half_w = _mm256_load_ps(p_field->p_half_w + i);
+        __m256 half_h = _mm256_load_ps(p_field->p_half_h + i);
+        __m256 brick_x = _mm256_load_ps(p_field->p_x + i);
+        __m256 brick_y = _mm256_load_ps(p_field->p_y + i);
+        __m256 min_x = _mm256_sub_ps(brick_x, half_w);
+        __m256 min_y = _mm256_sub_ps(brick_y, half_h);
+        __m256 max_x = _mm256_add_ps(brick_x, half_w);
+        __m256 max_y = _mm256_add_ps(brick_y, half_h);
+        __m256 alive_mask = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)alive), lane_bits), lane_bits));
+
+        // Already overlapping
+        __m256 off_x = _mm256_sub_ps(ball_x, _mm256_min_ps(_mm256_max_ps(ball_x, min_x), max_x));
+        __m256 off_y = _mm256_sub_ps(ball_y, _mm256_min_ps(_mm256_max_ps(ball_y, min_y), max_y));
+        __m256 dist_sq = _mm256_add_ps(_mm256_mul_ps(off_x, off_x), _mm256_mul_ps(off_y, off_y));
+        __m256 overlap = _mm256_and_ps(_mm256_cmp_ps(dist_sq, radius_sq, _CMP_LT_OQ), alive_mask);
+
+        int overlap_bits = _mm256_movemask_ps(overlap);
+        for(uint32_t lane = 0; overlap_bits != 0 && lane < 8; ++lane) {
+            if(overlap_bits & (1 << lane))
+                sweep_brick(p_field, i + lane, x, y, dx, dy, radius, &overlap_t, &overlap_index);
+        }
+
+        if(!moving)
+            continue;
+
+        // Slab test against the box grown by the radius
+        __m256 hit = _mm256_andnot_ps(overlap, alive_mask);
+        __m256 t_enter = zero;
+        __m256 t_exit = one;
+        __m256 enter_x = zero;
+        __m256 enter_y = zero;
+
+        if(moving_x) {
+            __m256 t_near = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(min_x, ball_radius), ball_x), move_x);
+            __m256 t_far = _mm256_div_ps(_mm256_sub_ps(_mm256_add_ps(max_x, ball_radius), ball_x), move_x);
+            __m256 t_first = _mm256_min_ps(t_far, t_near);
+            t_far = _mm256_max_ps(t_near, t_far);
+
+            enter_x = _mm256_cmp_ps(t_first, t_enter, _CMP_GT_OQ);
+            t_enter = _mm256_blendv_ps(t_enter, t_first, enter_x);
+            t_exit = _mm256_min_ps(t_far, t_exit);
+        } else {
+            hit = _mm256_and_ps(hit,
+                _mm256_and_ps(_mm256_cmp_ps(ball_x, _mm256_sub_ps(min_x, ball_radius), _CMP_GE_OQ),
+                    _mm256_cmp_ps(ball_x, _mm256_add_ps(max_x, ball_radius), _CMP_LE_OQ)));
+        }
+
+        if(moving_y) {
+            __m256 t_near = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(min_y, ball_radius), ball_y), move_y);
+            __m256 t_far = _mm256_div_ps(_mm256_sub_ps(_mm256_add_ps(max_y, ball_radius), ball_y), move_y);
+            __m256 t_first = _mm256_min_ps(t_far, t_near);
+            t_far = _mm256_max_ps(t_near, t_far);
+
+            enter_y = _mm256_cmp_ps(t_first, t_enter, _CMP_GT_OQ);
+            enter_x = _mm256_andnot_ps(enter_y, enter_x);
+            t_enter = _mm256_blendv_ps(t_enter, t_first, enter_y);
+            t_exit = _mm256_min_ps(t_far, t_exit);
+        } else {
+            hit = _mm256_and_ps(hit,
+                _mm256_and_ps(_mm256_cmp_ps(ball_y, _mm256_sub_ps(min_y, ball_radius), _CMP_GE_OQ),
+                    _mm256_cmp_ps(ball_y, _mm256_add_ps(max_y, ball_radius), _CMP_LE_OQ)));
+        }
+
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t_enter, t_exit, _CMP_LE_OQ));
+        if(_mm256_movemask_ps(hit) == 0)
+            continue;
+
+        // Entered through a flat side of the grown box
+        __m256 hit_x = _mm256_add_ps(ball_x, _mm256_mul_ps(move_x, t_enter));
+        __m256 hit_y = _mm256_add_ps(ball_y, _mm256_mul_ps(move_y, t_enter));
+        __m256 flat = _mm256_or_ps(
+            _mm256_and_ps(enter_x,
+                _mm256_and_ps(_mm256_cmp_ps(hit_y, min_y, _CMP_GE_OQ), _mm256_cmp_ps(hit_y, max_y, _CMP_LE_OQ))),
+            _mm256_and_ps(enter_y,
+                _mm256_and_ps(_mm256_cmp_ps(hit_x, min_x, _CMP_GE_OQ), _mm256_cmp_ps(hit_x, max_x, _CMP_LE_OQ))));
+
+        // Entered through a square corner, hit the circle around the box corner
+        __m256 f_x = _mm256_sub_ps(ball_x, _mm256_blendv_ps(max_x, min_x, _mm256_cmp_ps(hit_x, min_x, _CMP_LT_OQ)));
+        __m256 f_y = _mm256_sub_ps(ball_y, _mm256_blendv_ps(max_y, min_y, _mm256_cmp_ps(hit_y, min_y, _CMP_LT_OQ)));
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(f_x, move_x), _mm256_mul_ps(f_y, move_y));
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(f_x, f_x), _mm256_mul_ps(f_y, f_y)), radius_sq);
+        __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(move_sq, c));
+        __m256 t_corner = _mm256_div_ps(_mm256_sub_ps(_mm256_xor_ps(b, sign), _mm256_sqrt_ps(disc)), move_sq);
+        __m256 corner = _mm256_and_ps(_mm256_cmp_ps(disc, zero, _CMP_GE_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(t_corner, zero, _CMP_GE_OQ), _mm256_cmp_ps(t_corner, one, _CMP_LE_OQ)));
+
+        __m256 t = _mm256_blendv_ps(t_corner, t_enter, flat);
+        hit = _mm256_and_ps(hit, _mm256_or_ps(flat, corner));
+
+        __m256 first = _mm256_and_ps(hit, _mm256_cmp_ps(t, best_t, _CMP_LT_OQ));
+        best_t = _mm256_blendv_ps(best_t, t, first);
+        best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(first));
+    }
+
+    float p_lane_t[8];
+    int32_t p_lane_index[8];
+    _mm256_storeu_ps(p_lane_t, best_t);
+    _mm256_storeu_si256((__m256i*)(void*)p_lane_index, best_index);
+
+    uint32_t result = overlap_index;
+    float result_t = overlap_t;
+    for(int lane = 0; lane < 8; ++lane) {
+        if(p_lane_index[lane] >= 0)
+            keep_first((uint32_t)p_lane_index[lane], p_lane_t[lane], &result_t, &result);
+    }
+
+    return result;
+}
+#endif
+
+static float closest_face(float x, float y, float min_x, float min_y, float max_x, float max_y, float* p_nx,
+    float* p_ny)
+{
+    float p_face_dist[4] = {x - min_x, max_x - x, y - min_y, max_y - y};
+    const float p_face_nx[4] = {-1.0f, 1.0f, 0.0f, 0.0f};
+    const float p_face_ny[4] = {0.0f, 0.0f, -1.0f, 1.0f};
+
+    int face = 0;
+    for(int i = 1; i < 4; ++i) {
+        if(p_face_dist[i] < p_face_dist[face])
+            face = i;
+    }
+
+    *p_nx = p_face_nx[face];
+    *p_ny = p_face_ny[face];
+
+    return p_face_dist[face];
+}
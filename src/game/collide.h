@@ -0,0 +1,99 @@
+#ifndef COLLIDE_H_
+#define COLLIDE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+
+/**
+ * The implementations of the kernel sweeping a ball over every brick of a brick field. They all give the exact same
+ * result, the vector ones only test more bricks per instruction.
+ */
+typedef enum {
+    COLLIDE_IMPL_SCALAR = 0,
+    COLLIDE_IMPL_SSE2,
+    COLLIDE_IMPL_AVX2,
+    COLLIDE_IMPL_COUNT
+} collide_impl_t;
+
+/**
+ * A contact between a ball and a brick.
+ */
+typedef struct brick_hit_s {
+    uint32_t index; // Index of the brick in the brick field
+    float t;        // Time of impact as a fraction of the sweep
+    float nx;       // Unit contact normal, pointing from the brick towards the ball
+    float ny;
+} brick_hit_t;
+
+/**
+ * Check if the CPU can run an implementation.
+ */
+bool collide_impl_supported(collide_impl_t impl);
+
+/**
+ * Get the fastest implementation the CPU can run, it is what collide_sweep_ball_bricks uses.
+ */
+collide_impl_t collide_best_impl(void);
+
+/**
+ * Get the name of an implementation, for logging.
+ */
+const char* collide_impl_name(collide_impl_t impl) CONST_ATTR;
+
+/**
+ * \brief Sweep a ball along a straight path against a box and find the time of impact.
+ *
+ * The ball hits the box where the path enters the box grown by the radius with rounded corners. A ball that already
+ * overlaps the box only hits it if it is moving further in, so a ball that was just reflected off the box is let go.
+ *
+ * \param[in] x The center of the ball at the start of the sweep.
+ * \param[in] y The center of the ball at the start of the sweep.
+ * \param[in] dx The movement of the ball over the whole sweep.
+ * \param[in] dy The movement of the ball over the whole sweep.
+ * \param[in] radius The radius of the ball.
+ * \param[in] min_x The box.
+ * \param[in] min_y The box.
+ * \param[in] max_x The box.
+ * \param[in] max_y The box.
+ * \param[out] p_t The time of impact in [0, 1].
+ * \param[out] p_nx The unit contact normal, pointing from the box towards the ball.
+ * \param[out] p_ny The unit contact normal, pointing from the box towards the ball.
+ *
+ * \return True if the ball hits the box during the sweep.
+ */
+bool collide_sweep_ball_box(float x, float y, float dx, float dy, float radius, float min_x, float min_y, float max_x,
+    float max_y, float* p_t, float* p_nx, float* p_ny);
+
+/**
+ * \brief Sweep a ball against the alive bricks and find the first one it hits.
+ *
+ * Only the bricks in the cells the swept path covers are tested, one by one. Without a broadphase, or for a path
+ * covering too many bricks, every brick is tested with the vector kernel of collide_best_impl instead. Either way each
+ * brick is tested like collide_sweep_ball_box tests it and ties go to the lowest index.
+ *
+ * \param[in] p_field Pointer to the brick field.
+ * \param[in] p_bp Pointer to the broadphase the bricks are bucketed in, or NULL to test every brick.
+ * \param[in] x The center of the ball at the start of the sweep.
+ * \param[in] y The center of the ball at the start of the sweep.
+ * \param[in] dx The movement of the ball over the whole sweep.
+ * \param[in] dy The movement of the ball over the whole sweep.
+ * \param[in] radius The radius of the ball.
+ * \param[out] p_hit The first contact, only written if there is one.
+ *
+ * \return True if the ball hits a brick during the sweep.
+ */
+bool collide_sweep_ball_bricks(const brick_field_t* p_field, const broadphase_t* p_bp, float x, float y, float dx,
+    float dy, float radius, brick_hit_t* p_hit);
+
+/**
+ * Same as collide_sweep_ball_bricks but with a given implementation, which must be supported. Used by the tests and
+ * the benchmarks to compare the implementations.
+ */
+bool collide_sweep_ball_bricks_impl(collide_impl_t impl, const brick_field_t* p_field, const broadphase_t* p_bp,
+    float x, float y, float dx, float dy, float radius, brick_hit_t* p_hit);
+
+#endif // COLLIDE_H_
@@ -1,4 +1,7 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <SDL3/SDL.h>
 
@@ -6,20 +9,204 @@
 #include "logger.h"
 
 #include "vulkan/vulkan_context.h"
+#include "vulkan/vulkan_dynres.h"
+#include "vulkan/vulkan_particle_batch.h"
+#include "vulkan/vulkan_sprite_batch.h"
 #include "game/game.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/game_clock.h"
+#include "game/replay.h"
+#include "game/sim.h"
+#include "game/sim_thread.h"
 #include "util/deletion_stack.h"
 
-error_t game_init(struct vulkan_context_s* p_vkctx, game_t* p_game)
+// The default level, a wall of bricks across the top of the field
+#define GAME_LEVEL_COLS 14
+#define GAME_LEVEL_ROWS 8
+#define GAME_BRICK_WIDTH 1.0f
+#define GAME_BRICK_HEIGHT 0.4f
+#define GAME_BRICK_GAP 0.1f
+
+// The burst of debris a broken brick leaves behind
+#define GAME_DEBRIS_COUNT 48
+#define GAME_DEBRIS_SIZE 0.08f
+#define GAME_DEBRIS_SPEED 3.0f
+#define GAME_DEBRIS_LIFE 1.2f
+
+// Color of each brick type, linear and a little over 1 so the bricks stand out against the background
+static const float pp_brick_colors[8][4] = {
+    {1.40f, 0.25f, 0.25f, 1.0f},
+    {1.40f, 0.65f, 0.20f, 1.0f},
+    {1.30f, 1.20f, 0.25f, 1.0f},
+    {0.35f, 1.30f, 0.35f, 1.0f},
+    {0.25f, 1.10f, 1.30f, 1.0f},
+    {0.30f, 0.50f, 1.40f, 1.0f},
+    {0.85f, 0.35f, 1.40f, 1.0f},
+    {1.30f, 0.40f, 0.90f, 1.0f},
+};
+
+/**
+ * Sample the keyboard into the input used by the ticks of this frame.
+ */
+static void sample_input(game_t* p_game);
+
+/**
+ * Run the simulation ticks the time since the last posted frame adds up to and interpolate the state to render. Runs
+ * on the simulation thread.
+ */
+static void update_simulation(void* p_void_game, const sim_frame_t* p_frame, render_state_t* p_out);
+
+/**
+ * Copy the alive bits of the bricks into the render state. Runs on the simulation thread, which owns them.
+ */
+static void snapshot_bricks(const brick_field_t* p_bricks, render_state_t* p_out);
+
+/**
+ * Upload the bricks as the static sprites of the renderer, they never move so it is done once per level.
+ */
+static error_t upload_bricks(const brick_field_t* p_bricks, struct vulkan_context_s* p_vkctx);
+
+/**
+ * Hand the alive bricks of the render state to the renderer and push the paddle and the balls to the sprite batch of
+ * the frame.
+ */
+static void push_sprites(const game_t* p_game, struct vulkan_context_s* p_vkctx);
+
+/**
+ * Emit a burst of debris for each brick broken since the last frame drawn.
+ */
+static void emit_particles(game_t* p_game, struct vulkan_context_s* p_vkctx);
+
+/**
+ * Record the input of the tick about to run. Recording stops if it fails, the game goes on.
+ */
+static void record_tick(game_t* p_game);
+
+/**
+ * A hash of the simulation state, equal for equal states.
+ */
+static uint32_t hash_state(const game_t* p_game);
+
+/**
+ * \brief Save the recording to the replay path.
+ *
+ * Pushed onto the deletion stack before the simulation thread is started, so it runs once the thread has stopped.
+ *
+ * \param[in] p_void_game Pointer to the game_t.
+ */
+static void save_recording(void* p_void_game);
+
+error_t game_init(struct vulkan_context_s* p_vkctx, const game_options_t* p_options, game_t* p_game)
 {
-    // UNUSED
-    (void)p_vkctx;
-    (void)p_game;
+    if(p_game == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_game is NULL", __func__);
+
+    p_game->options = p_options != NULL ? *p_options : (game_options_t){0};
+    p_game->headless = p_vkctx == NULL;
+    p_game->p_render_state = NULL;
+    SDL_SetAtomicInt(&p_game->replay_done, 0);
 
     // Allocate game deletion queue
     p_game->p_dstack = deletion_stack_init();
     if(p_game->p_dstack == NULL)
         return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "%s: Failed to initiate queue stack", __func__);
 
+    if(p_game->options.mode != GAME_MODE_PLAY && p_game->options.p_replay_path == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: Recording or replaying without a replay path", __func__);
+
+    error_t err = SUCCESS;
+    if(p_game->options.mode == GAME_MODE_REPLAY) {
+        err = replay_load(p_game->p_dstack, p_game->options.p_replay_path, &p_game->replay);
+        if(err.code != 0)
+            return err;
+
+        // The tick length is part of the input, a replay only plays out the same at the rate it was recorded at
+        if(p_game->replay.tick_rate != GAME_TICK_RATE)
+            return error_init(ERR_SRC_CORE, ERR_REPLAY_FORMAT, "%s: Replay recorded at %u ticks per second, not %u",
+                __func__, p_game->replay.tick_rate, GAME_TICK_RATE);
+
+        p_game->options.seed = p_game->replay.seed;
+    }
+    else if(p_game->options.mode == GAME_MODE_RECORD) {
+        err = replay_init(p_game->p_dstack, p_game->options.seed, GAME_TICK_RATE, &p_game->replay);
+        if(err.code != 0)
+            return err;
+
+        err = deletion_stack_push(p_game->p_dstack, p_game, save_recording);
+        if(err.code != 0)
+            return err;
+    }
+
+    err = brick_field_init(p_game->p_dstack, GAME_LEVEL_COLS * GAME_LEVEL_ROWS, &p_game->bricks);
+    if(err.code != 0)
+        return err;
+
+    float level_width = GAME_LEVEL_COLS * (GAME_BRICK_WIDTH + GAME_BRICK_GAP) - GAME_BRICK_GAP;
+    err = brick_field_fill_grid(&p_game->bricks, GAME_LEVEL_COLS, GAME_LEVEL_ROWS,
+        (SIM_FIELD_WIDTH - level_width) * 0.5f, SIM_FIELD_HEIGHT * 0.5f, GAME_BRICK_WIDTH, GAME_BRICK_HEIGHT,
+        GAME_BRICK_GAP);
+    if(err.code != 0)
+        return err;
+
+    // One cell per brick, the bricks are bucketed once here since they never move
+    err = broadphase_init(p_game->p_dstack, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT,
+        GAME_BRICK_WIDTH + GAME_BRICK_GAP, GAME_BRICK_HEIGHT + GAME_BRICK_GAP, &p_game->broadphase);
+    if(err.code != 0)
+        return err;
+
+    err = broadphase_build_bricks(&p_game->broadphase, &p_game->bricks);
+    if(err.code != 0)
+        return err;
+
+    // The balls are moved on the job system the renderer records on. Headless there is no renderer, so the game
+    // brings a job system of its own.
+    if(p_game->headless) {
+        int cpu_count = SDL_GetNumLogicalCPUCores();
+        err = job_system_init(p_game->p_dstack, cpu_count > 0 ? (uint32_t)cpu_count : 1, &p_game->jobs);
+        if(err.code != 0)
+            return err;
+    }
+
+    p_game->world.p_bricks = &p_game->bricks;
+    p_game->world.p_broadphase = &p_game->broadphase;
+    p_game->world.p_jobs = p_game->headless ? &p_game->jobs : &p_vkctx->jobs;
+
+    game_clock_init(&p_game->clock, GAME_TICK_RATE, GAME_MAX_TICKS_PER_FRAME);
+    p_game->last_ns = SDL_GetTicksNS();
+
+    p_game->input = (sim_input_t){0};
+    p_game->tick_input = (sim_input_t){0};
+    sim_init(&p_game->curr_state, p_game->options.seed);
+    p_game->prev_state = p_game->curr_state;
+
+    if(p_game->headless) {
+        LOG_INFO("Game initialized headless");
+        return SUCCESS;
+    }
+
+    if(p_game->bricks.count > SIM_MAX_RENDER_BRICKS)
+        LOG_WARN("%u bricks, only the first %d are drawn", p_game->bricks.count, SIM_MAX_RENDER_BRICKS);
+
+    // The whole field is drawn, the window has the same aspect ratio
+    sprite_batch_set_view(&p_vkctx->sprites, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT);
+
+    err = upload_bricks(&p_game->bricks, p_vkctx);
+    if(err.code != 0)
+        return err;
+
+    render_state_t initial = {0};
+    sim_interpolate(&p_game->prev_state, &p_game->curr_state, 1.0f, &initial);
+    snapshot_bricks(&p_game->bricks, &initial);
+    memcpy(p_game->p_drawn_alive, initial.p_bricks_alive, sizeof(p_game->p_drawn_alive));
+
+    // Started last, from here on the simulation state belongs to the simulation thread. The thread is stopped first
+    // when the deletion stack is flushed, before anything it uses is destroyed.
+    err = sim_thread_init(p_game->p_dstack, update_simulation, p_game, &initial, &p_game->sim_thread);
+    if(err.code != 0)
+        return err;
+    p_game->p_render_state = sim_thread_acquire(&p_game->sim_thread);
+
     LOG_INFO("Game initialized");
 
     return SUCCESS;
@@ -42,14 +229,18 @@ error_t game_deinit(game_t* p_game)
 
 error_t game_run(struct vulkan_context_s* p_vkctx, game_t* p_game)
 {
-    // UNUSED
-    (void)p_game;
+    if(p_game == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_game is NULL", __func__);
 
     SDL_Event e;
     bool quit = false;
     bool stop_rendering = false;
 
     while(!quit) {
+        // In the low latency present policy this blocks until the last frame is on screen, so the input polled below is
+        // as fresh as possible when the next frame is built
+        vulkan_wait_for_present(p_vkctx);
+
         while(SDL_PollEvent(&e) != 0) {
             switch(e.type) {
             case SDL_EVENT_QUIT:
@@ -64,6 +255,47 @@ error_t game_run(struct vulkan_context_s* p_vkctx, game_t* p_game)
                 LOG_DEBUG("Windows restored");
                 stop_rendering = false;
                 break;
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                LOG_DEBUG("Window pixel size changed");
+                p_vkctx->swapchain_dirty = true;
+                break;
+            case SDL_EVENT_KEY_DOWN:
+                if(e.key.repeat)
+                    break;
+
+                if(e.key.key == SDLK_SPACE)
+                    p_game->input.launch = true;
+
+                // F2 switches between the blit and compute present paths so their gpu timings can be compared
+                if(e.key.key == SDLK_F2) {
+                    vulkan_set_present_path(p_vkctx, p_vkctx->present_path == PRESENT_PATH_COMPUTE ?
+                            PRESENT_PATH_BLIT :
+                            PRESENT_PATH_COMPUTE);
+                }
+
+                // F3 toggles the dynamic resolution controller
+                if(e.key.key == SDLK_F3) {
+                    dynres_set_enabled(&p_vkctx->dynres, !p_vkctx->dynres.enabled);
+                    LOG_INFO("Dynamic resolution: %s", p_vkctx->dynres.enabled ? "on" : "off");
+                }
+
+                // F4 cycles through the present policies, skipping the ones the device does not support
+                if(e.key.key == SDLK_F4) {
+                    for(int i = 1; i < PRESENT_POLICY_COUNT; ++i) {
+                        present_policy_t policy = (present_policy_t)(((int)p_vkctx->present_policy + i) %
+                            PRESENT_POLICY_COUNT);
+                        if(vulkan_set_present_policy(p_vkctx, policy))
+                            break;
+                    }
+                }
+
+                // F5 switches the compute present path between the linear and the edge adaptive upscale
+                if(e.key.key == SDLK_F5) {
+                    vulkan_set_upscale_filter(p_vkctx, p_vkctx->upscale_filter == UPSCALE_FILTER_EDGE ?
+                            UPSCALE_FILTER_LINEAR :
+                            UPSCALE_FILTER_EDGE);
+                }
+                break;
             default:
                 break;
             }
@@ -71,6 +303,26 @@ error_t game_run(struct vulkan_context_s* p_vkctx, game_t* p_game)
             // ImGui_ImplSDL3_ProcessEvent(&e);
         }
 
+        // The simulation runs at a fixed rate whatever the frame rate is. While minimized the clock keeps running but
+        // the tick cap stops the simulation from racing ahead when the window is restored.
+        sample_input(p_game);
+        sim_frame_t frame = {0};
+        frame.now_ns = SDL_GetTicksNS();
+        frame.input = p_game->input;
+
+        // If the simulation thread is a full queue behind the frame is dropped, its time and a launch press carry over
+        // to the next one
+        if(sim_thread_post(&p_game->sim_thread, &frame))
+            p_game->input.launch = false;
+
+        // The newest finished snapshot, simulated while the last frame was being rendered
+        p_game->p_render_state = sim_thread_acquire(&p_game->sim_thread);
+
+        if(SDL_GetAtomicInt(&p_game->replay_done) != 0) {
+            LOG_INFO("Replay finished");
+            quit = true;
+        }
+
         if(stop_rendering) {
             SDL_Delay(100);
             continue;
@@ -79,8 +331,258 @@ error_t game_run(struct vulkan_context_s* p_vkctx, game_t* p_game)
         // Draw imgui here
 
         // Perform drawing here
+        if(!vulkan_begin_frame(p_vkctx))
+            continue;
+
+        push_sprites(p_game, p_vkctx);
+        emit_particles(p_game, p_vkctx);
         vulkan_render_and_present_frame(p_vkctx);
     }
 
     return SUCCESS;
 }
+
+error_t game_run_headless(game_t* p_game)
+{
+    if(p_game == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_game is NULL", __func__);
+
+    if(!p_game->headless || p_game->options.mode != GAME_MODE_REPLAY)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Only a replay without a vulkan context runs headless",
+            __func__);
+
+    // The ticks are all there is to it, no frames, no clock and no interpolation
+    float dt = game_clock_dt(&p_game->clock);
+    sim_input_t input;
+
+    uint64_t start_ns = SDL_GetTicksNS();
+    while(replay_play(&p_game->replay, &input))
+        sim_tick(&p_game->curr_state, &p_game->world, &input, dt);
+    uint64_t elapsed_ns = SDL_GetTicksNS() - start_ns;
+
+    double seconds = (double)elapsed_ns / 1e9;
+    LOG_INFO("Replay played headless: %u ticks in %.3f s, %.0f ticks per second", p_game->replay.ticks_count, seconds,
+        seconds > 0.0 ? (double)p_game->replay.ticks_count / seconds : 0.0);
+    LOG_INFO("Final state: %u balls, %u bricks left, hash %08x", p_game->curr_state.balls_count,
+        p_game->bricks.alive_count, hash_state(p_game));
+
+    return SUCCESS;
+}
+
+static void sample_input(game_t* p_game)
+{
+    const bool* p_keys = SDL_GetKeyboardState(NULL);
+
+    int dir = 0;
+    if(p_keys[SDL_SCANCODE_LEFT] || p_keys[SDL_SCANCODE_A])
+        --dir;
+    if(p_keys[SDL_SCANCODE_RIGHT] || p_keys[SDL_SCANCODE_D])
+        ++dir;
+
+    p_game->input.paddle_dir = (int8_t)dir;
+}
+
+static void update_simulation(void* p_void_game, const sim_frame_t* p_frame, render_state_t* p_out)
+{
+    game_t* p_game = (game_t*)p_void_game;
+
+    // One tick per frame whatever the frame time, so every run of a replay renders the same frames
+    if(p_game->options.mode == GAME_MODE_REPLAY) {
+        p_game->prev_state = p_game->curr_state;
+
+        sim_input_t input;
+        if(replay_play(&p_game->replay, &input))
+            sim_tick(&p_game->curr_state, &p_game->world, &input, game_clock_dt(&p_game->clock));
+        else
+            SDL_SetAtomicInt(&p_game->replay_done, 1);
+
+        sim_interpolate(&p_game->prev_state, &p_game->curr_state, 1.0f, p_out);
+        snapshot_bricks(&p_game->bricks, p_out);
+        return;
+    }
+
+    uint32_t ticks = game_clock_advance(&p_game->clock, p_frame->now_ns - p_game->last_ns);
+    float dt = game_clock_dt(&p_game->clock);
+    p_game->last_ns = p_frame->now_ns;
+
+    // A frame can be too short for a tick, so a launch press is kept until one runs
+    p_game->tick_input.paddle_dir = p_frame->input.paddle_dir;
+    p_game->tick_input.launch = p_game->tick_input.launch || p_frame->input.launch;
+
+    for(uint32_t i = 0; i < ticks; ++i) {
+        if(p_game->options.mode == GAME_MODE_RECORD)
+            record_tick(p_game);
+
+        p_game->prev_state = p_game->curr_state;
+        sim_tick(&p_game->curr_state, &p_game->world, &p_game->tick_input, dt);
+
+        // A launch press is only used once
+        p_game->tick_input.launch = false;
+    }
+
+    sim_interpolate(&p_game->prev_state, &p_game->curr_state, game_clock_alpha(&p_game->clock), p_out);
+    snapshot_bricks(&p_game->bricks, p_out);
+}
+
+static void snapshot_bricks(const brick_field_t* p_bricks, render_state_t* p_out)
+{
+    uint32_t words_count = (p_bricks->count + 63) / 64;
+    if(words_count > SIM_MAX_RENDER_BRICKS / 64)
+        words_count = SIM_MAX_RENDER_BRICKS / 64;
+
+    memcpy(p_out->p_bricks_alive, p_bricks->p_alive, words_count * sizeof(uint64_t));
+}
+
+static error_t upload_bricks(const brick_field_t* p_bricks, struct vulkan_context_s* p_vkctx)
+{
+    uint32_t bricks_count = p_bricks->count < SIM_MAX_RENDER_BRICKS ? p_bricks->count : SIM_MAX_RENDER_BRICKS;
+    if(bricks_count == 0)
+        return vulkan_upload_static_sprites(p_vkctx, NULL, NULL, 0);
+
+    sprite_instance_t* p_instances = (sprite_instance_t*)malloc(bricks_count * sizeof(sprite_instance_t));
+    sprite_material_t* p_materials = (sprite_material_t*)malloc(bricks_count * sizeof(sprite_material_t));
+    if(p_instances == NULL || p_materials == NULL) {
+        free(p_instances);
+        free(p_materials);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate the sprites of %u bricks", __func__,
+            bricks_count);
+    }
+
+    // Sprite i is brick i, so the alive bits of the bricks are the visible bits of the sprites
+    for(uint32_t i = 0; i < bricks_count; ++i) {
+        const float* p_color = pp_brick_colors[p_bricks->p_type[i] % 8];
+        p_instances[i] = (sprite_instance_t){
+            {p_bricks->p_x[i], p_bricks->p_y[i]},
+            {p_bricks->p_half_w[i] * 2.0f, p_bricks->p_half_h[i] * 2.0f},
+            {p_color[0], p_color[1], p_color[2], p_color[3]},
+            {0.0f, 0.0f, 1.0f, 1.0f}
+        };
+        p_materials[i] = SPRITE_MATERIAL_SOLID;
+    }
+
+    error_t err = vulkan_upload_static_sprites(p_vkctx, p_instances, p_materials, bricks_count);
+
+    free(p_instances);
+    free(p_materials);
+
+    return err;
+}
+
+static void push_sprites(const game_t* p_game, struct vulkan_context_s* p_vkctx)
+{
+    const render_state_t* p_state = p_game->p_render_state;
+    sprite_batch_t* p_sprites = &p_vkctx->sprites;
+
+    // The bricks were uploaded once, all that changes from frame to frame is which of them are left
+    uint32_t bricks_count = p_game->bricks.count < SIM_MAX_RENDER_BRICKS ? p_game->bricks.count : SIM_MAX_RENDER_BRICKS;
+    vulkan_set_static_sprites_visible(p_vkctx, p_state->p_bricks_alive, bricks_count);
+
+    sprite_instance_t* p_paddle = sprite_batch_push(p_sprites, SPRITE_MATERIAL_SOLID, 1);
+    if(p_paddle != NULL) {
+        *p_paddle = (sprite_instance_t){
+            {p_state->paddle_x, SIM_PADDLE_Y},
+            {SIM_PADDLE_WIDTH, SIM_PADDLE_HEIGHT},
+            {0.9f, 0.9f, 1.0f, 1.0f},
+            {0.0f, 0.0f, 1.0f, 1.0f}
+        };
+    }
+
+    // Every ball in one push, they are a single contiguous run of the round material
+    sprite_instance_t* p_balls = sprite_batch_push(p_sprites, SPRITE_MATERIAL_ROUND, p_state->balls_count);
+    for(uint32_t i = 0; p_balls != NULL && i < p_state->balls_count; ++i) {
+        p_balls[i] = (sprite_instance_t){
+            {p_state->p_balls[i].x, p_state->p_balls[i].y},
+            {SIM_BALL_RADIUS * 2.0f, SIM_BALL_RADIUS * 2.0f},
+            {2.0f, 2.0f, 2.0f, 1.0f},
+            {0.0f, 0.0f, 1.0f, 1.0f}
+        };
+    }
+}
+
+static void emit_particles(game_t* p_game, struct vulkan_context_s* p_vkctx)
+{
+    const render_state_t* p_state = p_game->p_render_state;
+    uint32_t bricks_count = p_game->bricks.count < SIM_MAX_RENDER_BRICKS ? p_game->bricks.count : SIM_MAX_RENDER_BRICKS;
+
+    // Bricks never come back within a level, so a bit that was set and is now clear is a brick broken since the last
+    // frame. The positions and types never change, so reading them here does not race the simulation thread.
+    for(uint32_t word = 0; word < (bricks_count + 63) / 64; ++word) {
+        uint64_t broken = p_game->p_drawn_alive[word] & ~p_state->p_bricks_alive[word];
+        p_game->p_drawn_alive[word] = p_state->p_bricks_alive[word];
+
+        for(uint32_t bit = 0; broken != 0; ++bit, broken >>= 1) {
+            if((broken & 1) == 0)
+                continue;
+
+            uint32_t i = word * 64 + bit;
+            const float* p_color = pp_brick_colors[p_game->bricks.p_type[i] % 8];
+            particle_emitter_t emitter = {0};
+            emitter.pos[0] = p_game->bricks.p_x[i];
+            emitter.pos[1] = p_game->bricks.p_y[i];
+            emitter.size = GAME_DEBRIS_SIZE;
+            emitter.speed = GAME_DEBRIS_SPEED;
+            emitter.color[0] = p_color[0];
+            emitter.color[1] = p_color[1];
+            emitter.color[2] = p_color[2];
+            emitter.color[3] = p_color[3];
+            emitter.life = GAME_DEBRIS_LIFE;
+            emitter.count = GAME_DEBRIS_COUNT;
+
+            // A dropped burst only costs some debris
+            particle_batch_emit(&p_vkctx->particles, &emitter);
+        }
+    }
+}
+
+static void record_tick(game_t* p_game)
+{
+    error_t err = replay_record(&p_game->replay, &p_game->tick_input);
+    if(err.code != 0) {
+        LOG_ERROR("Recording stopped: %s", err.msg);
+        error_deinit(&err);
+
+        // What was recorded so far is still saved
+        p_game->options.mode = GAME_MODE_PLAY;
+    }
+}
+
+static uint32_t hash_state(const game_t* p_game)
+{
+    // FNV-1a over the paddle, the balls and which bricks are left
+    uint32_t hash = 2166136261u;
+    const sim_state_t* p_state = &p_game->curr_state;
+
+    const uint8_t* p_bytes = (const uint8_t*)&p_state->paddle_x;
+    for(size_t i = 0; i < sizeof(p_state->paddle_x); ++i)
+        hash = (hash ^ p_bytes[i]) * 16777619u;
+
+    p_bytes = (const uint8_t*)p_state->p_balls;
+    for(size_t i = 0; i < p_state->balls_count * sizeof(sim_ball_t); ++i)
+        hash = (hash ^ p_bytes[i]) * 16777619u;
+
+    for(uint32_t i = 0; i < p_game->bricks.count; ++i)
+        hash = (hash ^ (brick_field_is_alive(&p_game->bricks, i) ? 1u : 0u)) * 16777619u;
+
+    return hash;
+}
+
+static void save_recording(void* p_void_game)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_game == NULL) {
+        LOG_ERROR("%s: p_void_game is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    game_t* p_game = (game_t*)p_void_game;
+
+    error_t err = replay_save(&p_game->replay, p_game->options.p_replay_path);
+    if(err.code != 0) {
+        LOG_ERROR("Failed to save replay: %s", err.msg);
+        error_deinit(&err);
+    }
+
+    p_void_game = NULL;
+}
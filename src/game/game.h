@@ -1,19 +1,71 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include <SDL3/SDL_atomic.h>
+
 #include "error/error.h"
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/game_clock.h"
+#include "game/replay.h"
+#include "game/sim.h"
+#include "game/sim_thread.h"
+
+/**
+ * What the game does with the input.
+ */
+typedef enum game_mode_e {
+    GAME_MODE_PLAY,   // Play with live input
+    GAME_MODE_RECORD, // Play with live input and save it to a replay when the game ends
+    GAME_MODE_REPLAY  // Play a replay back, one tick per frame
+} game_mode_t;
+
+/**
+ * Options for a game, from the command line.
+ */
+typedef struct game_options_s {
+    game_mode_t mode;
+    const char* p_replay_path; // Written when recording, read when replaying
+    uint32_t seed;             // Seed of the simulation, a replay uses the seed it was recorded with
+} game_options_t;
+
 /**
  * A struct containing all the necessary game fields. Name may change from "game" to something else.
  */
 typedef struct game_s {
-    int temp;
     struct deletion_stack_s* p_dstack;
+    game_options_t options;
+    bool headless;     // No vulkan context, so no simulation thread either, game_run_headless ticks on the caller
+    job_system_t jobs; // Only used headless, otherwise the job system of the vulkan context is used
+
+    // Render thread
+    sim_input_t input;                    // Input gathered for the next frame posted to the simulation thread
+    const render_state_t* p_render_state; // The snapshot rendered this frame
+    SDL_AtomicInt replay_done;            // Set by the simulation thread when the whole replay has been played
+    uint64_t p_drawn_alive[SIM_MAX_RENDER_BRICKS / 64]; // Alive bits of the last frame drawn, to find broken bricks
+    sim_thread_t sim_thread;
+
+    // Simulation thread, only touched by it once it has started
+    game_clock_t clock;
+    uint64_t last_ns;       // When the last simulated frame started
+    sim_input_t tick_input; // Input of the last simulated frame, a launch press waits in it for the next tick
+    sim_state_t prev_state; // State before the last tick
+    sim_state_t curr_state; // State after the last tick
+    replay_t replay;        // Being recorded or played back, depending on the mode
+    brick_field_t bricks;
+    broadphase_t broadphase;
+    sim_world_t world; // Points at bricks, broadphase and the job system of the vulkan context
 } game_t;
 
 /**
  * \brief Initiate the game.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan context to render with, NULL to run a replay headless with game_run_headless.
+ * \param[in] p_options The options of the game, NULL to just play.
+ * \param[out] p_game Pointer to the game_t to initiate.
  */
-error_t game_init(struct vulkan_context_s* p_vkctx, game_t* p_game);
+error_t game_init(struct vulkan_context_s* p_vkctx, const game_options_t* p_options, game_t* p_game);
 
 /**
  * \brief Destroy the game.
@@ -25,4 +77,12 @@ error_t game_deinit(game_t* p_game);
  */
 error_t game_run(struct vulkan_context_s* p_vkctx, game_t* p_game);
 
+/**
+ * \brief Play the replay as fast as possible without rendering, then log how long it took and a hash of the final state.
+ *
+ * The game must have been initiated in replay mode without a vulkan context. Two runs of the same replay end in the
+ * same state, so the hash tells if a change to the simulation changed how it plays out.
+ */
+error_t game_run_headless(game_t* p_game);
+
 #endif // GAME_H_
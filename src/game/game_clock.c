@@ -0,0 +1,62 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "game/game_clock.h"
+
+#define NS_PER_SECOND 1000000000ull
+
+void game_clock_init(game_clock_t* p_clock, uint32_t tick_rate, uint32_t max_ticks_per_frame)
+{
+    if(p_clock == NULL) {
+        LOG_ERROR("%s: p_clock is NULL", __func__);
+        return;
+    }
+
+    *p_clock = (game_clock_t){0};
+    p_clock->tick_ns = NS_PER_SECOND / (tick_rate > 0 ? tick_rate : GAME_TICK_RATE);
+    p_clock->max_ticks_per_frame = max_ticks_per_frame > 0 ? max_ticks_per_frame : 1;
+}
+
+uint32_t game_clock_advance(game_clock_t* p_clock, uint64_t frame_ns)
+{
+    if(p_clock == NULL) {
+        LOG_ERROR("%s: p_clock is NULL", __func__);
+        return 0;
+    }
+
+    p_clock->accumulator_ns += frame_ns;
+
+    uint64_t ticks = p_clock->accumulator_ns / p_clock->tick_ns;
+
+    // Drop whole ticks over the cap but keep the fraction, so the interpolation does not jump
+    if(ticks > p_clock->max_ticks_per_frame) {
+        uint64_t dropped_ns = (ticks - p_clock->max_ticks_per_frame) * p_clock->tick_ns;
+        p_clock->accumulator_ns -= dropped_ns;
+        p_clock->dropped_ns += dropped_ns;
+        ticks = p_clock->max_ticks_per_frame;
+
+        LOG_TRACE("Simulation behind, dropped %llu ns", (unsigned long long)dropped_ns);
+    }
+
+    p_clock->accumulator_ns -= ticks * p_clock->tick_ns;
+    p_clock->ticks += ticks;
+
+    return (uint32_t)ticks;
+}
+
+float game_clock_alpha(const game_clock_t* p_clock)
+{
+    if(p_clock == NULL)
+        return 0.0f;
+
+    return (float)((double)p_clock->accumulator_ns / (double)p_clock->tick_ns);
+}
+
+float game_clock_dt(const game_clock_t* p_clock)
+{
+    if(p_clock == NULL)
+        return 0.0f;
+
+    return (float)((double)p_clock->tick_ns / (double)NS_PER_SECOND);
+}
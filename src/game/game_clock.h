@@ -0,0 +1,58 @@
+#ifndef GAME_CLOCK_H_
+#define GAME_CLOCK_H_
+
+#include <stdint.h>
+
+#include "config.h"
+
+// Simulation ticks per second
+#define GAME_TICK_RATE 120
+
+// Most ticks simulated for a single frame. If the simulation falls further behind than this the rest of the time is
+// dropped, so a slow frame can not make the next frame even slower (spiral of death).
+#define GAME_MAX_TICKS_PER_FRAME 8
+
+/**
+ * Fixed timestep clock. Frame time is added to an accumulator and the simulation runs one tick for every whole tick
+ * length in it, so the simulation advances at the same rate whatever the frame rate is. The leftover fraction of a
+ * tick is used to interpolate the rendered state between the last two ticks.
+ */
+typedef struct game_clock_s {
+    uint64_t tick_ns;             // Length of one tick
+    uint64_t accumulator_ns;      // Time not yet simulated
+    uint64_t dropped_ns;          // Total time dropped by the tick cap
+    uint64_t ticks;               // Total ticks handed out
+    uint32_t max_ticks_per_frame;
+} game_clock_t;
+
+/**
+ * Initiate the clock.
+ *
+ * \param[out] p_clock Pointer to the game_clock_t to initiate.
+ * \param[in] tick_rate Ticks per second, must not be 0.
+ * \param[in] max_ticks_per_frame Most ticks game_clock_advance returns for one frame, must not be 0.
+ */
+void game_clock_init(game_clock_t* p_clock, uint32_t tick_rate, uint32_t max_ticks_per_frame);
+
+/**
+ * Add the time of a frame to the clock.
+ *
+ * \param[in] p_clock Pointer to the game_clock_t.
+ * \param[in] frame_ns The time since the last call.
+ *
+ * \return The number of ticks to simulate this frame, never more than max_ticks_per_frame.
+ */
+uint32_t game_clock_advance(game_clock_t* p_clock, uint64_t frame_ns);
+
+/**
+ * Get how far the clock is between the last tick and the next one, in [0, 1). Used as the weight of the last tick when
+ * interpolating the rendered state.
+ */
+float game_clock_alpha(const game_clock_t* p_clock) PURE_ATTR;
+
+/**
+ * Get the length of a tick in seconds.
+ */
+float game_clock_dt(const game_clock_t* p_clock) PURE_ATTR;
+
+#endif // GAME_CLOCK_H_
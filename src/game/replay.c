@@ -0,0 +1,242 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error/error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "game/sim.h"
+#include "game/replay.h"
+
+// Size of the header and of an event on disk
+#define REPLAY_HEADER_SIZE 24
+#define REPLAY_EVENT_SIZE 6
+
+/**
+ * \brief Free the events of a replay.
+ *
+ * \param[in] p_void_replay Pointer to the replay_t.
+ */
+static void replay_deinit(void* p_void_replay);
+
+static void put_u32(uint8_t* p_bytes, uint32_t value)
+{
+    p_bytes[0] = (uint8_t)value;
+    p_bytes[1] = (uint8_t)(value >> 8);
+    p_bytes[2] = (uint8_t)(value >> 16);
+    p_bytes[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32(const uint8_t* p_bytes)
+{
+    return (uint32_t)p_bytes[0] | (uint32_t)p_bytes[1] << 8 | (uint32_t)p_bytes[2] << 16 | (uint32_t)p_bytes[3] << 24;
+}
+
+error_t replay_init(deletion_stack_t* p_dstack, uint32_t seed, uint32_t tick_rate, replay_t* p_replay)
+{
+    if(p_dstack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_dstack is NULL", __func__);
+
+    if(p_replay == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_replay is NULL", __func__);
+
+    *p_replay = (replay_t){0};
+    p_replay->seed = seed;
+    p_replay->tick_rate = tick_rate;
+
+    // CLEANUP, pushed before anything is allocated, the events grow as they are recorded
+    return deletion_stack_push(p_dstack, p_replay, replay_deinit);
+}
+
+error_t replay_record(replay_t* p_replay, const sim_input_t* p_input)
+{
+    if(p_replay == NULL || p_input == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_replay or p_input is NULL", __func__);
+
+    const replay_event_t* p_last = p_replay->events_count > 0 ? &p_replay->p_events[p_replay->events_count - 1] : NULL;
+    bool changed = p_last == NULL || p_last->input.paddle_dir != p_input->paddle_dir ||
+        p_last->input.launch != p_input->launch;
+
+    if(changed) {
+        if(p_replay->events_count == p_replay->events_capacity) {
+            uint32_t capacity = p_replay->events_capacity * 2 + 64;
+            replay_event_t* p_grown =
+                (replay_event_t*)realloc(p_replay->p_events, capacity * sizeof(replay_event_t));
+            if(p_grown == NULL)
+                return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %u events", __func__, capacity);
+
+            p_replay->p_events = p_grown;
+            p_replay->events_capacity = capacity;
+        }
+
+        replay_event_t* p_event = &p_replay->p_events[p_replay->events_count++];
+        p_event->tick = p_replay->ticks_count;
+        p_event->input = *p_input;
+    }
+
+    ++p_replay->ticks_count;
+
+    return SUCCESS;
+}
+
+bool replay_play(replay_t* p_replay, sim_input_t* p_input)
+{
+    if(p_replay == NULL || p_input == NULL) {
+        LOG_ERROR("%s: p_replay or p_input is NULL", __func__);
+        return false;
+    }
+
+    if(p_replay->tick >= p_replay->ticks_count)
+        return false;
+
+    if(p_replay->cursor < p_replay->events_count && p_replay->p_events[p_replay->cursor].tick == p_replay->tick)
+        p_replay->input = p_replay->p_events[p_replay->cursor++].input;
+
+    *p_input = p_replay->input;
+    ++p_replay->tick;
+
+    return true;
+}
+
+void replay_rewind(replay_t* p_replay)
+{
+    if(p_replay == NULL) {
+        LOG_ERROR("%s: p_replay is NULL", __func__);
+        return;
+    }
+
+    p_replay->tick = 0;
+    p_replay->cursor = 0;
+    p_replay->input = (sim_input_t){0};
+}
+
+error_t replay_save(const replay_t* p_replay, const char* p_path)
+{
+    if(p_replay == NULL || p_path == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_replay or p_path is NULL", __func__);
+
+    FILE* p_file = fopen(p_path, "wb");
+    if(p_file == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "Failed to open file: %s: %s", p_path, strerror(errno));
+
+    uint8_t p_header[REPLAY_HEADER_SIZE];
+    put_u32(p_header, REPLAY_MAGIC);
+    put_u32(p_header + 4, REPLAY_VERSION);
+    put_u32(p_header + 8, p_replay->seed);
+    put_u32(p_header + 12, p_replay->tick_rate);
+    put_u32(p_header + 16, p_replay->ticks_count);
+    put_u32(p_header + 20, p_replay->events_count);
+    bool written = fwrite(p_header, 1, REPLAY_HEADER_SIZE, p_file) == REPLAY_HEADER_SIZE;
+
+    for(uint32_t i = 0; i < p_replay->events_count && written; ++i) {
+        uint8_t p_event[REPLAY_EVENT_SIZE];
+        put_u32(p_event, p_replay->p_events[i].tick);
+        p_event[4] = (uint8_t)p_replay->p_events[i].input.paddle_dir;
+        p_event[5] = p_replay->p_events[i].input.launch ? 1 : 0;
+        written = fwrite(p_event, 1, REPLAY_EVENT_SIZE, p_file) == REPLAY_EVENT_SIZE;
+    }
+
+    if(fclose(p_file) != 0 || !written)
+        return error_init(ERR_SRC_CORE, ERR_FWRITE, "Failed to write file: %s", p_path);
+
+    LOG_INFO("Replay saved: %s, %u ticks, %u events", p_path, p_replay->ticks_count, p_replay->events_count);
+
+    return SUCCESS;
+}
+
+error_t replay_load(deletion_stack_t* p_dstack, const char* p_path, replay_t* p_replay)
+{
+    if(p_path == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_path is NULL", __func__);
+
+    FILE* p_file = fopen(p_path, "rb");
+    if(p_file == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "Failed to open file: %s: %s", p_path, strerror(errno));
+
+    uint8_t p_header[REPLAY_HEADER_SIZE];
+    if(fread(p_header, 1, REPLAY_HEADER_SIZE, p_file) != REPLAY_HEADER_SIZE) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "Failed to read file: %s", p_path);
+    }
+
+    if(get_u32(p_header) != REPLAY_MAGIC || get_u32(p_header + 4) != REPLAY_VERSION) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_REPLAY_FORMAT, "Not a version %u replay: %s", REPLAY_VERSION, p_path);
+    }
+
+    error_t err = replay_init(p_dstack, get_u32(p_header + 8), get_u32(p_header + 12), p_replay);
+    if(err.code != 0) {
+        fclose(p_file);
+        return err;
+    }
+    p_replay->ticks_count = get_u32(p_header + 16);
+    uint32_t events_count = get_u32(p_header + 20);
+
+    // Every event changes the input of a tick of its own
+    if(events_count > p_replay->ticks_count) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_REPLAY_FORMAT, "%u events for %u ticks: %s", events_count,
+            p_replay->ticks_count, p_path);
+    }
+
+    if(events_count > 0) {
+        p_replay->p_events = (replay_event_t*)malloc(events_count * sizeof(replay_event_t));
+        if(p_replay->p_events == NULL) {
+            fclose(p_file);
+            return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %u events", __func__, events_count);
+        }
+        p_replay->events_capacity = events_count;
+    }
+
+    for(uint32_t i = 0; i < events_count; ++i) {
+        uint8_t p_event[REPLAY_EVENT_SIZE];
+        if(fread(p_event, 1, REPLAY_EVENT_SIZE, p_file) != REPLAY_EVENT_SIZE) {
+            fclose(p_file);
+            return error_init(ERR_SRC_CORE, ERR_FREAD, "Failed to read file: %s", p_path);
+        }
+
+        replay_event_t event = {0};
+        event.tick = get_u32(p_event);
+        event.input.paddle_dir = (int8_t)p_event[4];
+        event.input.launch = p_event[5] != 0;
+
+        bool in_order = i == 0 ? event.tick == 0 : event.tick > p_replay->p_events[i - 1].tick;
+        if(!in_order || event.tick >= p_replay->ticks_count || event.input.paddle_dir < -1 ||
+            event.input.paddle_dir > 1 || p_event[5] > 1) {
+            fclose(p_file);
+            return error_init(ERR_SRC_CORE, ERR_REPLAY_FORMAT, "Bad event %u: %s", i, p_path);
+        }
+
+        p_replay->p_events[p_replay->events_count++] = event;
+    }
+
+    if(fclose(p_file) != 0)
+        return error_init(ERR_SRC_CORE, ERR_FCLOSE, "Failed to close file: %s", p_path);
+
+    LOG_INFO("Replay loaded: %s, %u ticks, %u events", p_path, p_replay->ticks_count, p_replay->events_count);
+
+    return SUCCESS;
+}
+
+static void replay_deinit(void* p_void_replay)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_replay == NULL) {
+        LOG_ERROR("%s: p_void_replay is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    replay_t* p_replay = (replay_t*)p_void_replay;
+
+    free(p_replay->p_events);
+    p_replay->p_events = NULL;
+    p_replay->events_count = 0;
+    p_replay->events_capacity = 0;
+
+    p_void_replay = NULL;
+}
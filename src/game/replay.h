@@ -0,0 +1,86 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "game/sim.h"
+
+// First bytes of a replay file, "BRKR"
+#define REPLAY_MAGIC 0x524b5242u
+#define REPLAY_VERSION 1u
+
+/**
+ * The input from a tick on, until the next event.
+ */
+typedef struct replay_event_s {
+    uint32_t tick;
+    sim_input_t input;
+} replay_event_t;
+
+/**
+ * \brief A recorded session: the seed and tick rate it was played with and its input, tick by tick.
+ *
+ * Only the ticks where the input changes are stored, a launch press counting as a change, so an hour of play is a few
+ * kilobytes. The simulation is deterministic, so the seed, the tick rate and the input are all it takes to play the
+ * session out again.
+ *
+ * On disk the header and the events are stored little endian: magic, version, seed, tick rate, ticks count and events
+ * count as 32 bit words, then 6 bytes per event, the tick followed by the paddle direction and the launch flag.
+ */
+typedef struct replay_s {
+    uint32_t seed;
+    uint32_t tick_rate;
+    uint32_t ticks_count; // Ticks recorded
+    replay_event_t* p_events;
+    uint32_t events_count;
+    uint32_t events_capacity;
+
+    // Playback
+    uint32_t tick;   // Next tick to play
+    uint32_t cursor; // Next event to play
+    sim_input_t input;
+} replay_t;
+
+/**
+ * \brief Initiate an empty recording.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack, the events are freed when it is flushed.
+ * \param[in] seed The seed the simulation was initiated with.
+ * \param[in] tick_rate The simulation ticks per second.
+ * \param[out] p_replay Pointer to the replay_t to initiate.
+ */
+error_t replay_init(deletion_stack_t* p_dstack, uint32_t seed, uint32_t tick_rate, replay_t* p_replay);
+
+/**
+ * Record the input of the next tick.
+ */
+error_t replay_record(replay_t* p_replay, const sim_input_t* p_input);
+
+/**
+ * Get the input of the next tick. Returns false once every recorded tick has been played.
+ */
+bool replay_play(replay_t* p_replay, sim_input_t* p_input);
+
+/**
+ * Restart the playback from the first tick.
+ */
+void replay_rewind(replay_t* p_replay);
+
+/**
+ * \brief Write a recording to a file.
+ */
+error_t replay_save(const replay_t* p_replay, const char* p_path);
+
+/**
+ * \brief Read a recording from a file, ready to be played.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack, the events are freed when it is flushed.
+ * \param[in] p_path Path of the file.
+ * \param[out] p_replay Pointer to the replay_t to initiate.
+ */
+error_t replay_load(deletion_stack_t* p_dstack, const char* p_path, replay_t* p_replay);
+
+#endif // REPLAY_H_
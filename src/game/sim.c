@@ -0,0 +1,318 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "logger.h"
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/collide.h"
+#include "game/sim.h"
+
+/**
+ * What the ball batches share during a tick.
+ */
+typedef struct ball_batch_s {
+    sim_state_t* p_state;
+    sim_world_t* p_world;
+    float dt;
+} ball_batch_t;
+
+/**
+ * A job moving the balls [begin, end) of a tick. Only reads the bricks and only writes its own balls, so any number of
+ * batches can run at once.
+ */
+static void move_balls(void* p_void_batch, uint32_t begin, uint32_t end);
+
+/**
+ * Move a launched ball for a tick, bouncing off the walls, the paddle and the bricks in the order it reaches them. The
+ * bricks it hits are written to p_impacts.
+ */
+static uint8_t move_ball(sim_ball_t* p_ball, float paddle_x, const sim_world_t* p_world, float dt,
+    uint32_t* p_impacts);
+
+/**
+ * Shorten a sweep to a plane the ball is moving towards, if the ball reaches it sooner than *p_t.
+ */
+static void sweep_wall(float pos, float move, float limit, float nx, float ny, float* p_t, float* p_nx, float* p_ny);
+
+/**
+ * Put a single ball back onto the paddle.
+ */
+static void reset_ball(sim_state_t* p_state);
+
+/**
+ * The next random number of the state, in [0, 1).
+ */
+static float next_random(sim_state_t* p_state);
+
+static float clampf(float value, float min, float max)
+{
+    if(value < min)
+        return min;
+    if(value > max)
+        return max;
+    return value;
+}
+
+static float lerpf(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+void sim_init(sim_state_t* p_state, uint32_t seed)
+{
+    if(p_state == NULL) {
+        LOG_ERROR("%s: p_state is NULL", __func__);
+        return;
+    }
+
+    *p_state = (sim_state_t){0};
+    p_state->paddle_x = SIM_FIELD_WIDTH * 0.5f;
+
+    // Xorshift gets stuck at zero
+    p_state->rng = seed != 0 ? seed : 0x9e3779b9u;
+
+    reset_ball(p_state);
+}
+
+bool sim_add_ball(sim_state_t* p_state, float x, float y, float vx, float vy)
+{
+    if(p_state == NULL) {
+        LOG_ERROR("%s: p_state is NULL", __func__);
+        return false;
+    }
+
+    // A ball resting on the paddle is replaced, there are only ever balls in flight or a single one resting
+    if(!p_state->ball_launched)
+        p_state->balls_count = 0;
+
+    if(p_state->balls_count >= SIM_MAX_BALLS)
+        return false;
+
+    sim_ball_t* p_ball = &p_state->p_balls[p_state->balls_count++];
+    p_ball->x = x;
+    p_ball->y = y;
+    p_ball->vx = vx;
+    p_ball->vy = vy;
+    p_state->ball_launched = true;
+
+    return true;
+}
+
+void sim_tick(sim_state_t* p_state, sim_world_t* p_world, const sim_input_t* p_input, float dt)
+{
+    if(p_state == NULL || p_input == NULL) {
+        LOG_ERROR("%s: p_state or p_input is NULL", __func__);
+        return;
+    }
+
+    ++p_state->tick;
+
+    // Paddle
+    p_state->paddle_x = clampf(p_state->paddle_x + (float)p_input->paddle_dir * SIM_PADDLE_SPEED * dt,
+        SIM_PADDLE_WIDTH * 0.5f, SIM_FIELD_WIDTH - SIM_PADDLE_WIDTH * 0.5f);
+
+    if(!p_state->ball_launched) {
+        reset_ball(p_state);
+
+        if(p_input->launch) {
+            // Up at a random angle, at most 37 degrees from straight up
+            float dir_x = (next_random(p_state) * 2.0f - 1.0f) * 0.6f;
+            p_state->p_balls[0].vx = dir_x * SIM_BALL_SPEED;
+            p_state->p_balls[0].vy = sqrtf(1.0f - dir_x * dir_x) * SIM_BALL_SPEED;
+            p_state->ball_launched = true;
+        }
+        return;
+    }
+
+    ball_batch_t batch = {0};
+    batch.p_state = p_state;
+    batch.p_world = p_world;
+    batch.dt = dt;
+
+    job_system_parallel_for(p_world != NULL ? p_world->p_jobs : NULL, p_state->balls_count, SIM_BALL_BATCH,
+        move_balls, &batch);
+
+    // Damage the bricks in ball order, a brick destroyed by an earlier ball still bounced the later ones this tick
+    if(p_world != NULL && p_world->p_bricks != NULL) {
+        for(uint32_t i = 0; i < p_state->balls_count; ++i) {
+            for(uint8_t j = 0; j < p_world->p_impacts_count[i]; ++j) {
+                uint32_t brick = p_world->pp_impacts[i][j];
+                if(!brick_field_is_alive(p_world->p_bricks, brick))
+                    continue;
+
+                if(brick_field_hit(p_world->p_bricks, brick) && p_world->p_broadphase != NULL)
+                    broadphase_remove_brick(p_world->p_broadphase, p_world->p_bricks, brick);
+            }
+        }
+    }
+
+    // Lost balls are dropped, keeping the order of the others
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < p_state->balls_count; ++i) {
+        if(!(p_state->p_balls[i].y < -SIM_BALL_RADIUS))
+            p_state->p_balls[kept++] = p_state->p_balls[i];
+    }
+    p_state->balls_count = kept;
+
+    // All lost, back onto the paddle
+    if(p_state->balls_count == 0)
+        reset_ball(p_state);
+}
+
+void sim_interpolate(const sim_state_t* p_prev, const sim_state_t* p_curr, float alpha, render_state_t* p_out)
+{
+    if(p_prev == NULL || p_curr == NULL || p_out == NULL) {
+        LOG_ERROR("%s: NULL argument", __func__);
+        return;
+    }
+
+    alpha = clampf(alpha, 0.0f, 1.0f);
+
+    p_out->paddle_x = lerpf(p_prev->paddle_x, p_curr->paddle_x, alpha);
+    p_out->balls_count = p_curr->balls_count;
+
+    // A ball that was launched or lost this tick teleported, and losing a ball shifts the ones after it, so blending
+    // would draw balls halfway across the field
+    bool blend = p_prev->ball_launched == p_curr->ball_launched && p_prev->balls_count == p_curr->balls_count;
+
+    for(uint32_t i = 0; i < p_curr->balls_count; ++i) {
+        const sim_ball_t* p_ball = &p_curr->p_balls[i];
+        if(!blend) {
+            p_out->p_balls[i].x = p_ball->x;
+            p_out->p_balls[i].y = p_ball->y;
+            continue;
+        }
+
+        p_out->p_balls[i].x = lerpf(p_prev->p_balls[i].x, p_ball->x, alpha);
+        p_out->p_balls[i].y = lerpf(p_prev->p_balls[i].y, p_ball->y, alpha);
+    }
+}
+
+static void move_balls(void* p_void_batch, uint32_t begin, uint32_t end)
+{
+    ball_batch_t* p_batch = (ball_batch_t*)p_void_batch;
+    sim_world_t* p_world = p_batch->p_world;
+
+    uint32_t p_scratch[SIM_MAX_IMPACTS];
+    for(uint32_t i = begin; i < end; ++i) {
+        uint32_t* p_impacts = p_world != NULL ? p_world->pp_impacts[i] : p_scratch;
+        uint8_t impacts_count =
+            move_ball(&p_batch->p_state->p_balls[i], p_batch->p_state->paddle_x, p_world, p_batch->dt, p_impacts);
+
+        if(p_world != NULL)
+            p_world->p_impacts_count[i] = impacts_count;
+    }
+}
+
+static uint8_t move_ball(sim_ball_t* p_ball, float paddle_x, const sim_world_t* p_world, float dt,
+    uint32_t* p_impacts)
+{
+    uint8_t impacts_count = 0;
+    float remaining = 1.0f;
+
+    for(int impact = 0; impact < SIM_MAX_IMPACTS; ++impact) {
+        float dx = p_ball->vx * dt * remaining;
+        float dy = p_ball->vy * dt * remaining;
+
+        float t = 1.0f;
+        float nx = 0.0f;
+        float ny = 0.0f;
+        bool hit = false;
+        uint32_t brick = UINT32_MAX;
+
+        // Walls and ceiling, the floor is open
+        if(dx < 0.0f)
+            sweep_wall(p_ball->x, dx, SIM_BALL_RADIUS, 1.0f, 0.0f, &t, &nx, &ny);
+        else if(dx > 0.0f)
+            sweep_wall(p_ball->x, dx, SIM_FIELD_WIDTH - SIM_BALL_RADIUS, -1.0f, 0.0f, &t, &nx, &ny);
+        if(dy > 0.0f)
+            sweep_wall(p_ball->y, dy, SIM_FIELD_HEIGHT - SIM_BALL_RADIUS, 0.0f, -1.0f, &t, &nx, &ny);
+        hit = nx < 0.0f || nx > 0.0f || ny < 0.0f || ny > 0.0f;
+
+        // Paddle
+        float paddle_t = 0.0f;
+        float paddle_nx = 0.0f;
+        float paddle_ny = 0.0f;
+        if(collide_sweep_ball_box(p_ball->x, p_ball->y, dx, dy, SIM_BALL_RADIUS, paddle_x - SIM_PADDLE_WIDTH * 0.5f,
+               SIM_PADDLE_Y - SIM_PADDLE_HEIGHT * 0.5f, paddle_x + SIM_PADDLE_WIDTH * 0.5f,
+               SIM_PADDLE_Y + SIM_PADDLE_HEIGHT * 0.5f, &paddle_t, &paddle_nx, &paddle_ny) &&
+            paddle_t < t) {
+            t = paddle_t;
+            nx = paddle_nx;
+            ny = paddle_ny;
+            hit = true;
+        }
+
+        // Bricks, culled to the swept path by the broadphase
+        brick_hit_t brick_hit;
+        if(p_world != NULL && p_world->p_bricks != NULL &&
+            collide_sweep_ball_bricks(p_world->p_bricks, p_world->p_broadphase, p_ball->x, p_ball->y, dx, dy,
+                SIM_BALL_RADIUS, &brick_hit) &&
+            brick_hit.t < t) {
+            t = brick_hit.t;
+            nx = brick_hit.nx;
+            ny = brick_hit.ny;
+            brick = brick_hit.index;
+            hit = true;
+        }
+
+        p_ball->x += dx * t;
+        p_ball->y += dy * t;
+
+        if(!hit)
+            break;
+
+        // Reflect the velocity about the contact normal
+        float dot = p_ball->vx * nx + p_ball->vy * ny;
+        p_ball->vx -= 2.0f * dot * nx;
+        p_ball->vy -= 2.0f * dot * ny;
+
+        if(brick != UINT32_MAX)
+            p_impacts[impacts_count++] = brick;
+
+        remaining *= 1.0f - t;
+        if(!(remaining > 0.0f))
+            break;
+    }
+
+    return impacts_count;
+}
+
+static void sweep_wall(float pos, float move, float limit, float nx, float ny, float* p_t, float* p_nx, float* p_ny)
+{
+    // A ball already past the plane hits it right away
+    float t = (limit - pos) / move;
+    if(t < 0.0f)
+        t = 0.0f;
+
+    if(t < *p_t) {
+        *p_t = t;
+        *p_nx = nx;
+        *p_ny = ny;
+    }
+}
+
+static void reset_ball(sim_state_t* p_state)
+{
+    p_state->ball_launched = false;
+    p_state->balls_count = 1;
+    p_state->p_balls[0].x = p_state->paddle_x;
+    p_state->p_balls[0].y = SIM_PADDLE_Y + SIM_PADDLE_HEIGHT * 0.5f + SIM_BALL_RADIUS;
+    p_state->p_balls[0].vx = 0.0f;
+    p_state->p_balls[0].vy = 0.0f;
+}
+
+static float next_random(sim_state_t* p_state)
+{
+    uint32_t x = p_state->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_state->rng = x;
+
+    // The top 24 bits, exactly representable as a float
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
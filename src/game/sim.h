@@ -0,0 +1,135 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+
+// Size of the playfield in world units, the origin is the bottom left corner
+#define SIM_FIELD_WIDTH 16.0f
+#define SIM_FIELD_HEIGHT 9.0f
+
+#define SIM_PADDLE_WIDTH 2.0f
+#define SIM_PADDLE_HEIGHT 0.25f
+#define SIM_PADDLE_Y 0.5f
+#define SIM_PADDLE_SPEED 12.0f
+
+#define SIM_BALL_RADIUS 0.125f
+#define SIM_BALL_SPEED 8.0f
+#define SIM_MAX_BALLS 1024
+
+// Balls moved per job, a batch is small enough to stay in cache and large enough to be worth handing to a worker
+#define SIM_BALL_BATCH 64
+
+// Most bricks the render state carries the alive bits of, bricks past it are never drawn. As many as the renderer
+// takes static sprites.
+#define SIM_MAX_RENDER_BRICKS 65536
+
+// Most impacts a ball resolves in one tick, the rest of the tick is dropped if it hits more (wedged in a corner)
+#define SIM_MAX_IMPACTS 8
+
+/**
+ * The player input for one simulation tick.
+ */
+typedef struct sim_input_s {
+    int8_t paddle_dir; // -1 left, 0 still, 1 right
+    bool launch;
+} sim_input_t;
+
+/**
+ * A ball in flight.
+ */
+typedef struct sim_ball_s {
+    float x;
+    float y;
+    float vx;
+    float vy;
+} sim_ball_t;
+
+/**
+ * The state of the simulation after a tick. Only this and the input decide the next tick, so two states can be
+ * interpolated between and a tick can be replayed.
+ */
+typedef struct sim_state_s {
+    uint64_t tick;
+    float paddle_x;     // Center of the paddle
+    bool ball_launched; // While false there is a single ball, following the paddle until it is launched
+    uint32_t rng;       // State of the random numbers, part of the state so a replay plays out the same
+    uint32_t balls_count;
+    sim_ball_t p_balls[SIM_MAX_BALLS];
+} sim_state_t;
+
+/**
+ * What the simulation collides with and runs on. Kept out of sim_state_t since the bricks are large and only change
+ * when hit, so they are not copied every tick.
+ */
+typedef struct sim_world_s {
+    brick_field_t* p_bricks;    // NULL for no bricks
+    broadphase_t* p_broadphase; // The bricks bucketed, destroyed bricks are removed from it. NULL to test every brick.
+    job_system_t* p_jobs;       // Moves the balls in parallel batches, NULL to move them on the calling thread
+
+    // Bricks each ball hit this tick, applied in ball order once every ball has moved
+    uint32_t pp_impacts[SIM_MAX_BALLS][SIM_MAX_IMPACTS];
+    uint8_t p_impacts_count[SIM_MAX_BALLS];
+} sim_world_t;
+
+/**
+ * A ball as the renderer needs it.
+ */
+typedef struct render_ball_s {
+    float x;
+    float y;
+} render_ball_t;
+
+/**
+ * What the renderer needs from the simulation, interpolated between the last two ticks.
+ */
+typedef struct render_state_s {
+    float paddle_x;
+    uint32_t balls_count;
+    render_ball_t p_balls[SIM_MAX_BALLS];
+    uint64_t p_bricks_alive[SIM_MAX_RENDER_BRICKS / 64]; // Alive bits of the bricks, the bricks themselves never move
+} render_state_t;
+
+/**
+ * Set the state to the start of a game, with one ball resting on the paddle. The same seed and input give the same
+ * game.
+ */
+void sim_init(sim_state_t* p_state, uint32_t seed);
+
+/**
+ * Add a ball in flight. Returns false if there are SIM_MAX_BALLS balls already.
+ */
+bool sim_add_ball(sim_state_t* p_state, float x, float y, float vx, float vy);
+
+/**
+ * \brief Advance the state by one tick.
+ *
+ * The balls are swept along their paths, so they can not tunnel through a brick or the paddle however fast they move.
+ * A ball can bounce off several things within one tick. Balls do not collide with each other.
+ *
+ * The balls move in parallel against the bricks as they were at the start of the tick, then the bricks they hit are
+ * damaged in ball order. The result is the same whatever the number of workers, so ticks can be replayed.
+ *
+ * \param[in,out] p_state Pointer to the state, overwritten by the state after the tick.
+ * \param[in,out] p_world Pointer to the world, bricks destroyed this tick are removed from it. NULL for an empty field.
+ * \param[in] p_input The input for this tick.
+ * \param[in] dt The length of a tick in seconds.
+ */
+void sim_tick(sim_state_t* p_state, sim_world_t* p_world, const sim_input_t* p_input, float dt);
+
+/**
+ * Blend two consecutive states into the state to render. Balls are only blended if no ball was added or lost between
+ * the two states, otherwise the balls of p_curr are used as they are.
+ *
+ * \param[in] p_prev The state of the previous tick.
+ * \param[in] p_curr The state of the last tick.
+ * \param[in] alpha The weight of p_curr, in [0, 1]. The rendered state lags the simulation by up to one tick.
+ * \param[out] p_out The state to render.
+ */
+void sim_interpolate(const sim_state_t* p_prev, const sim_state_t* p_curr, float alpha, render_state_t* p_out);
+
+#endif // SIM_H_
@@ -0,0 +1,156 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+
+#include "error/error.h"
+#include "error/sdl_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "game/sim.h"
+#include "game/sim_thread.h"
+
+// Set in sim_thread_t.middle while the middle buffer holds a snapshot the render thread has not acquired
+#define SIM_SNAPSHOT_FRESH 4
+
+/**
+ * The main loop of the simulation thread. Simulates posted frames until it is told to quit.
+ */
+static int SDLCALL sim_thread_main(void* p_void_sim);
+
+/**
+ * \brief Stop the simulation thread.
+ *
+ * \param[in] p_void_sim Pointer to the sim_thread_t.
+ */
+static void sim_thread_deinit(void* p_void_sim);
+
+error_t sim_thread_init(deletion_stack_t* p_dstack, sim_frame_func_t func, void* p_data,
+    const render_state_t* p_initial, sim_thread_t* p_sim)
+{
+    if(func == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: func is NULL", __func__);
+
+    if(p_initial == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_initial is NULL", __func__);
+
+    if(p_sim == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_sim is NULL", __func__);
+
+    p_sim->p_thread = NULL;
+    p_sim->p_frames_sem = NULL;
+    SDL_SetAtomicInt(&p_sim->quit, 0);
+    p_sim->func = func;
+    p_sim->p_data = p_data;
+    SDL_SetAtomicU32(&p_sim->frames_head, 0);
+    SDL_SetAtomicU32(&p_sim->frames_tail, 0);
+
+    for(int i = 0; i < 3; ++i)
+        p_sim->p_snapshots[i] = *p_initial;
+    p_sim->front = 0;
+    SDL_SetAtomicInt(&p_sim->middle, 1);
+    p_sim->back = 2;
+
+    // CLEANUP, pushed before anything is created, the deinit skips whatever has not been created yet
+    error_t err = deletion_stack_push(p_dstack, p_sim, sim_thread_deinit);
+    if(err.code != 0)
+        return err;
+
+    p_sim->p_frames_sem = SDL_CreateSemaphore(0);
+    if(p_sim->p_frames_sem == NULL)
+        return error_init(ERR_SRC_SDL, SDL_ERR_CREATE_SEMAPHORE, "%s: Failed to create semaphore: %s", __func__,
+            SDL_GetError());
+
+    p_sim->p_thread = SDL_CreateThread(sim_thread_main, "simulation", p_sim);
+    if(p_sim->p_thread == NULL)
+        return error_init(ERR_SRC_SDL, SDL_ERR_CREATE_THREAD, "%s: Failed to create simulation thread: %s", __func__,
+            SDL_GetError());
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+static void sim_thread_deinit(void* p_void_sim)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_sim == NULL) {
+        LOG_ERROR("%s: p_void_sim is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    sim_thread_t* p_sim = (sim_thread_t*)p_void_sim;
+
+    // Wake the thread up and let it exit, frames still queued are dropped
+    SDL_SetAtomicInt(&p_sim->quit, 1);
+    if(p_sim->p_thread != NULL) {
+        SDL_SignalSemaphore(p_sim->p_frames_sem);
+        SDL_WaitThread(p_sim->p_thread, NULL);
+        p_sim->p_thread = NULL;
+    }
+
+    SDL_DestroySemaphore(p_sim->p_frames_sem);
+    p_sim->p_frames_sem = NULL;
+
+    p_void_sim = NULL;
+}
+
+bool sim_thread_post(sim_thread_t* p_sim, const sim_frame_t* p_frame)
+{
+    if(p_sim == NULL || p_frame == NULL) {
+        LOG_ERROR("%s: p_sim or p_frame is NULL", __func__);
+        return false;
+    }
+
+    uint32_t tail = SDL_GetAtomicU32(&p_sim->frames_tail);
+    if(tail - SDL_GetAtomicU32(&p_sim->frames_head) >= SIM_FRAME_QUEUE_SIZE)
+        return false;
+
+    // The frame is written before the tail is published, so the simulation thread never reads a half written frame
+    p_sim->p_frames[tail & (SIM_FRAME_QUEUE_SIZE - 1)] = *p_frame;
+    SDL_SetAtomicU32(&p_sim->frames_tail, tail + 1);
+    SDL_SignalSemaphore(p_sim->p_frames_sem);
+
+    return true;
+}
+
+const render_state_t* sim_thread_acquire(sim_thread_t* p_sim)
+{
+    if(p_sim == NULL) {
+        LOG_ERROR("%s: p_sim is NULL", __func__);
+        return NULL;
+    }
+
+    // Swap the front buffer for the middle one if it holds a newer snapshot
+    if((SDL_GetAtomicInt(&p_sim->middle) & SIM_SNAPSHOT_FRESH) != 0)
+        p_sim->front = SDL_SetAtomicInt(&p_sim->middle, p_sim->front) & ~SIM_SNAPSHOT_FRESH;
+
+    return &p_sim->p_snapshots[p_sim->front];
+}
+
+static int SDLCALL sim_thread_main(void* p_void_sim)
+{
+    sim_thread_t* p_sim = (sim_thread_t*)p_void_sim;
+
+    for(;;) {
+        SDL_WaitSemaphore(p_sim->p_frames_sem);
+        if(SDL_GetAtomicInt(&p_sim->quit) != 0)
+            break;
+
+        uint32_t head = SDL_GetAtomicU32(&p_sim->frames_head);
+        sim_frame_t frame = p_sim->p_frames[head & (SIM_FRAME_QUEUE_SIZE - 1)];
+        SDL_SetAtomicU32(&p_sim->frames_head, head + 1);
+
+        p_sim->func(p_sim->p_data, &frame, &p_sim->p_snapshots[p_sim->back]);
+
+        // Publish the snapshot and take the old middle buffer as the next back buffer
+        p_sim->back = SDL_SetAtomicInt(&p_sim->middle, p_sim->back | SIM_SNAPSHOT_FRESH) & ~SIM_SNAPSHOT_FRESH;
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#ifndef SIM_THREAD_H_
+#define SIM_THREAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL3/SDL_atomic.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "game/sim.h"
+
+// Frames the render thread can post ahead of the simulation thread, must be a power of two
+#define SIM_FRAME_QUEUE_SIZE 16
+
+/**
+ * A frame posted by the render thread: when it started and the input gathered for it.
+ */
+typedef struct sim_frame_s {
+    uint64_t now_ns;
+    sim_input_t input;
+} sim_frame_t;
+
+/**
+ * Simulates a posted frame and writes the snapshot to render into p_out. Called on the simulation thread.
+ */
+typedef void (*sim_frame_func_t)(void* p_data, const sim_frame_t* p_frame, render_state_t* p_out);
+
+/**
+ * \brief Runs the simulation on a thread of its own, pipelined with the render thread.
+ *
+ * The render thread posts a frame and picks up the newest snapshot, which was simulated while it rendered the frame
+ * before. Rendering frame N and simulating frame N + 1 then overlap, so a frame costs max(sim, render) instead of
+ * their sum, for one frame of extra latency.
+ *
+ * Both hand overs are lock free. Frames go through a single producer single consumer ring, and snapshots through a
+ * triple buffer: the simulation thread always has a back buffer to write, the render thread always has a front buffer
+ * to read, and the newest finished snapshot waits in the middle. Publishing and acquiring swap a buffer with the middle
+ * one, so neither thread ever waits on the other.
+ */
+typedef struct sim_thread_s {
+    struct SDL_Thread* p_thread;
+    struct SDL_Semaphore* p_frames_sem; // Counts the posted frames, the simulation thread sleeps on it
+    SDL_AtomicInt quit;
+    sim_frame_func_t func;
+    void* p_data;
+
+    // Posted frames
+    sim_frame_t p_frames[SIM_FRAME_QUEUE_SIZE];
+    SDL_AtomicU32 frames_head; // Next frame to simulate, only written by the simulation thread
+    SDL_AtomicU32 frames_tail; // Next free slot, only written by the render thread
+
+    // Snapshots
+    render_state_t p_snapshots[3];
+    SDL_AtomicInt middle; // Index of the middle buffer, with SIM_SNAPSHOT_FRESH set while it has not been acquired
+    int back;             // Only used by the simulation thread
+    int front;            // Only used by the render thread
+} sim_thread_t;
+
+/**
+ * \brief Start the simulation thread.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack, the thread is stopped when it is flushed.
+ * \param[in] func Called for every posted frame.
+ * \param[in] p_data Passed to func. Only the simulation thread may touch what func touches.
+ * \param[in] p_initial The snapshot acquired until the first frame has been simulated.
+ * \param[out] p_sim Pointer to the sim_thread_t to initiate. The thread and the deletion stack keep the pointer, so it
+ * must stay valid until the stack is flushed.
+ */
+error_t sim_thread_init(deletion_stack_t* p_dstack, sim_frame_func_t func, void* p_data,
+    const render_state_t* p_initial, sim_thread_t* p_sim);
+
+/**
+ * Post a frame to simulate. Returns false if the simulation thread is SIM_FRAME_QUEUE_SIZE frames behind, then post
+ * it again next frame.
+ */
+bool sim_thread_post(sim_thread_t* p_sim, const sim_frame_t* p_frame);
+
+/**
+ * Get the newest snapshot. It stays untouched until the next call, which only the render thread may make.
+ */
+const render_state_t* sim_thread_acquire(sim_thread_t* p_sim);
+
+#endif // SIM_THREAD_H_
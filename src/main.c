@@ -8,22 +8,32 @@
 // SDL_MAIN_IMPLEMENTATION
 #include <SDL3/SDL_main.h>
 
-// STB headers. Move to vulkan_engine.c?
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 // My headers
 #include "error/error.h"
 #include "version.h"
 #include "logger.h"
+#include "util/asset_pack.h"
 #include "vulkan/vulkan_context.h"
 #include "game/game.h"
 
+/**
+ * Parse the command line into the game options. Returns false and prints the usage if it can not be parsed.
+ */
+static bool parse_args(int argc, char** argv, game_options_t* p_options, bool* p_headless);
+
 int main(int argc, char** argv)
 {
-    // UNUSED
-    (void)argc;
-    (void)argv;
+    game_options_t options = {0};
+    bool headless = false;
+    if(!parse_args(argc, argv, &options, &headless))
+        return EXIT_FAILURE;
 
     logger_open(NULL);
 
@@ -37,6 +47,28 @@ int main(int argc, char** argv)
 
     int success = 0;
 
+    // A replay played headless needs neither a window nor vulkan
+    if(headless) {
+        game_t game;
+        error_t err = game_init(NULL, &options, &game);
+        if(err.code == 0)
+            err = game_run_headless(&game);
+        if(err.code != 0) {
+            LOG_ERROR("Failed to run replay: %s", err.msg);
+            error_deinit(&err);
+            success = 1;
+        }
+        game_deinit(&game);
+
+        logger_close();
+
+        return success != 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // The shaders and textures are read from the pack when the break_pack target was built, loose files otherwise.
+    // Debug builds read a loose file that is newer than the pack instead.
+    asset_pack_mount("break.pack");
+
     vulkan_context_t vkctx;
     error_t err = vulkan_init(&vkctx);
     success += err.code;
@@ -47,9 +79,30 @@ int main(int argc, char** argv)
     else {
         // vulkan engine initiated successfully, start game
         game_t game;
-        game_init(&vkctx, &game);
-        game_run(&vkctx, &game);
-        game_deinit(&game);
+        err = game_init(&vkctx, &options, &game);
+        success += err.code;
+        if(err.code != 0) {
+            LOG_ERROR("Failed to initiate game: %s", err.msg);
+            error_deinit(&err);
+        }
+        else {
+            err = game_run(&vkctx, &game);
+            success += err.code;
+            if(err.code != 0) {
+                LOG_ERROR("Failed to run game: %s", err.msg);
+                error_deinit(&err);
+            }
+        }
+
+        // Also releases whatever a failed game_init created before it failed, nothing if it never got a deletion stack
+        if(game.p_dstack != NULL) {
+            err = game_deinit(&game);
+            success += err.code;
+            if(err.code != 0) {
+                LOG_ERROR("Failed to destroy game: %s", err.msg);
+                error_deinit(&err);
+            }
+        }
     }
 
     // Destroy vulkan engine
@@ -60,6 +113,9 @@ int main(int argc, char** argv)
         error_deinit(&err);
     }
 
+    // Nothing points into the pack once vulkan is destroyed
+    asset_pack_unmount();
+
     // Close logger
     logger_close();
 
@@ -73,3 +129,49 @@ int main(int argc, char** argv)
         return EXIT_SUCCESS;
     }
 }
+
+static bool parse_args(int argc, char** argv, game_options_t* p_options, bool* p_headless)
+{
+    // A new game every time unless a seed is given
+    p_options->mode = GAME_MODE_PLAY;
+    p_options->p_replay_path = NULL;
+    p_options->seed = (uint32_t)time(NULL);
+    *p_headless = false;
+
+    bool valid = true;
+    for(int i = 1; i < argc && valid; ++i) {
+        bool has_value = i + 1 < argc;
+        if(strcmp(argv[i], "--record") == 0 && has_value) {
+            p_options->mode = GAME_MODE_RECORD;
+            p_options->p_replay_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "--replay") == 0 && has_value) {
+            p_options->mode = GAME_MODE_REPLAY;
+            p_options->p_replay_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && has_value) {
+            p_options->seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "--headless") == 0) {
+            *p_headless = true;
+        }
+        else {
+            valid = false;
+        }
+    }
+
+    if(*p_headless && p_options->mode != GAME_MODE_REPLAY)
+        valid = false;
+
+    if(!valid) {
+        fprintf(stderr,
+            "Usage: %s [--seed <n>] [--record <file> | --replay <file> [--headless]]\n"
+            "  --seed <n>        Seed a new game, a replay uses the seed it was recorded with\n"
+            "  --record <file>   Save the input of the game to a replay when it ends\n"
+            "  --replay <file>   Play a replay back, one tick per frame\n"
+            "  --headless        Play the replay as fast as possible without a window\n",
+            argv[0]);
+    }
+
+    return valid;
+}
@@ -1,4 +1,14 @@
-glslc shader.vert -o shader.vert.spv
-glslc shader.frag -o shader.frag.spv
-glslc gradient.comp -o gradient.comp.spv
+glslc --target-env=vulkan1.3 shader.vert -o shader.vert.spv
+glslc --target-env=vulkan1.3 shader.frag -o shader.frag.spv
+glslc --target-env=vulkan1.3 gradient.comp -o gradient.comp.spv
+glslc --target-env=vulkan1.3 present.comp -o present.comp.spv
+glslc --target-env=vulkan1.3 present_upscale.comp -o present_upscale.comp.spv
+glslc --target-env=vulkan1.3 sprite.vert -o sprite.vert.spv
+glslc --target-env=vulkan1.3 sprite.frag -o sprite.frag.spv
+glslc --target-env=vulkan1.3 sprite_cull.comp -o sprite_cull.comp.spv
+glslc --target-env=vulkan1.3 sprite_cull_subgroup.comp -o sprite_cull_subgroup.comp.spv
+glslc --target-env=vulkan1.3 particle_emit.comp -o particle_emit.comp.spv
+glslc --target-env=vulkan1.3 particle_sim.comp -o particle_sim.comp.spv
+glslc --target-env=vulkan1.3 bloom_down.comp -o bloom_down.comp.spv
+glslc --target-env=vulkan1.3 bloom_up.comp -o bloom_up.comp.spv
 pause
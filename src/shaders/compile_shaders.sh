@@ -3,3 +3,13 @@
 glslangValidator --target-env vulkan1.3 -V shader.frag
 glslangValidator --target-env vulkan1.3 -V shader.vert
 glslangValidator --target-env vulkan1.3 -V gradient.comp
+glslangValidator --target-env vulkan1.3 -V present.comp -o present.comp.spv
+glslangValidator --target-env vulkan1.3 -V present_upscale.comp -o present_upscale.comp.spv
+glslangValidator --target-env vulkan1.3 -V sprite.vert -o sprite.vert.spv
+glslangValidator --target-env vulkan1.3 -V sprite.frag -o sprite.frag.spv
+glslangValidator --target-env vulkan1.3 -V sprite_cull.comp -o sprite_cull.comp.spv
+glslangValidator --target-env vulkan1.3 -V sprite_cull_subgroup.comp -o sprite_cull_subgroup.comp.spv
+glslangValidator --target-env vulkan1.3 -V particle_emit.comp -o particle_emit.comp.spv
+glslangValidator --target-env vulkan1.3 -V particle_sim.comp -o particle_sim.comp.spv
+glslangValidator --target-env vulkan1.3 -V bloom_down.comp -o bloom_down.comp.spv
+glslangValidator --target-env vulkan1.3 -V bloom_up.comp -o bloom_up.comp.spv
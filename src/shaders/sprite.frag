@@ -0,0 +1,32 @@
+// GLSL version
+#version 450
+
+// The material is a specialization constant, so each material is a pipeline of its own. Must match
+// sprite_material_t.
+layout(constant_id = 0) const uint material = 0;
+
+const uint MATERIAL_SOLID = 0;
+const uint MATERIAL_ROUND = 1;
+
+layout(location = 0) in vec4 frag_color;
+layout(location = 1) in vec2 frag_local;
+layout(location = 2) in vec2 frag_uv; // Sampled once an atlas texture is bound
+
+layout(location = 0) out vec4 out_color;
+
+void main() {
+    float coverage = 1.0;
+
+    // A disc inscribed in the quad, the edge is smoothed over about a pixel
+    if(material == MATERIAL_ROUND) {
+        float dist = length(frag_local);
+        float edge = fwidth(dist);
+        coverage = 1.0 - smoothstep(1.0 - edge, 1.0, dist);
+        if(coverage <= 0.0)
+            discard;
+    }
+
+    // Premultiplied alpha
+    float alpha = frag_color.a * coverage;
+    out_color = vec4(frag_color.rgb * alpha, alpha);
+}
@@ -0,0 +1,44 @@
+// GLSL version
+#version 450
+
+// Instanced sprites without vertex buffers. Each instance is a quad of two triangles, the corner comes from
+// gl_VertexIndex and the instance is pulled from the instance buffer with gl_InstanceIndex, which includes the
+// firstInstance of the draw, so every material reads its own slice of the buffer.
+
+struct Instance {
+    vec2 pos;
+    vec2 size;
+    vec4 color;
+    vec4 atlas_rect;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer {
+    Instance instances[];
+};
+
+layout(push_constant) uniform constants {
+    vec2 view_scale;
+    vec2 view_offset;
+} pc;
+
+layout(location = 0) out vec4 frag_color;
+layout(location = 1) out vec2 frag_local; // In [-1, 1] across the quad
+layout(location = 2) out vec2 frag_uv;    // In the atlas rect
+
+// Two counter clockwise triangles
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
+
+void main() {
+    Instance inst = instances[gl_InstanceIndex];
+    vec2 corner = corners[gl_VertexIndex];
+
+    vec2 world = inst.pos + (corner - 0.5) * inst.size;
+    gl_Position = vec4(world * pc.view_scale + pc.view_offset, 0.0, 1.0);
+
+    frag_color = inst.color;
+    frag_local = corner * 2.0 - 1.0;
+    frag_uv = mix(inst.atlas_rect.xy, inst.atlas_rect.zw, vec2(corner.x, 1.0 - corner.y));
+}
@@ -0,0 +1,390 @@
+// mmap is POSIX, which the C99 headers leave out unless asked for
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "error/error.h"
+#include "logger.h"
+#include "util/asset_pack.h"
+
+/**
+ * An entry with its name, sorted when the pack is built.
+ */
+typedef struct pack_build_entry_s {
+    asset_pack_entry_t entry;
+    const char* p_name;
+    size_t source_index;
+} pack_build_entry_t;
+
+// The pack mounted for the whole process, only written before and after every thread that reads it
+static asset_pack_t mounted_pack; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static bool pack_mounted = false; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static time_t pack_mtime = 0;     // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+/**
+ * Order entries by hash, then by name so equal hashes still give the same pack every build.
+ */
+static int compare_build_entries(const void* p_a, const void* p_b);
+
+/**
+ * Round a size up to the next multiple of ASSET_PACK_ALIGNMENT.
+ */
+static uint64_t align_up(uint64_t size);
+
+uint64_t asset_pack_hash(const char* p_name, size_t name_size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t i = 0; i < name_size; ++i) {
+        hash ^= (uint8_t)p_name[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+error_t asset_pack_build(const asset_pack_source_t* p_sources, uint32_t count, uint8_t** pp_data, size_t* p_size)
+{
+    if((p_sources == NULL && count > 0) || pp_data == NULL || p_size == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_sources, pp_data or p_size is NULL", __func__);
+
+    pack_build_entry_t* p_build = (pack_build_entry_t*)calloc(count > 0 ? count : 1, sizeof(pack_build_entry_t));
+    if(p_build == NULL)
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate %u entries", __func__, count);
+
+    // The names and the entries come first, the blobs follow them in the sorted order
+    uint64_t names_size = 0;
+    for(uint32_t i = 0; i < count; ++i) {
+        size_t name_size = strlen(p_sources[i].p_name);
+        if(name_size > UINT32_MAX || names_size + name_size > UINT32_MAX) {
+            free(p_build);
+            return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: The names do not fit in a pack", __func__);
+        }
+
+        p_build[i].p_name = p_sources[i].p_name;
+        p_build[i].source_index = i;
+        p_build[i].entry.hash = asset_pack_hash(p_sources[i].p_name, name_size);
+        p_build[i].entry.size = (uint64_t)p_sources[i].size;
+        p_build[i].entry.name_size = (uint32_t)name_size;
+        names_size += name_size;
+    }
+
+    qsort(p_build, count, sizeof(pack_build_entry_t), compare_build_entries);
+
+    uint64_t size = sizeof(asset_pack_header_t) + (uint64_t)count * sizeof(asset_pack_entry_t) + names_size;
+    uint32_t name_offset = 0;
+    for(uint32_t i = 0; i < count; ++i) {
+        if(i > 0 && compare_build_entries(&p_build[i - 1], &p_build[i]) == 0) {
+            const char* p_name = p_build[i].p_name;
+            free(p_build);
+            return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: %s is in the pack twice", __func__, p_name);
+        }
+
+        p_build[i].entry.name_offset = name_offset;
+        name_offset += p_build[i].entry.name_size;
+
+        size = align_up(size);
+        p_build[i].entry.offset = size;
+        size += p_build[i].entry.size;
+    }
+
+    if((uint64_t)(size_t)size != size) {
+        free(p_build);
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: The pack does not fit in memory", __func__);
+    }
+
+    // Zeroed so the padding between the blobs is the same every build
+    uint8_t* p_data = (uint8_t*)calloc((size_t)size, 1);
+    if(p_data == NULL) {
+        free(p_build);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate a pack of %llu bytes", __func__,
+            (unsigned long long)size);
+    }
+
+    asset_pack_header_t header = {0};
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entries_count = count;
+    header.names_size = (uint32_t)names_size;
+    header.size = size;
+    memcpy(p_data, &header, sizeof(header));
+
+    uint8_t* p_entries = p_data + sizeof(asset_pack_header_t);
+    uint8_t* p_names = p_entries + (size_t)count * sizeof(asset_pack_entry_t);
+    for(uint32_t i = 0; i < count; ++i) {
+        const asset_pack_source_t* p_source = &p_sources[p_build[i].source_index];
+        memcpy(p_entries + (size_t)i * sizeof(asset_pack_entry_t), &p_build[i].entry, sizeof(asset_pack_entry_t));
+        memcpy(p_names + p_build[i].entry.name_offset, p_source->p_name, p_build[i].entry.name_size);
+        if(p_source->size > 0)
+            memcpy(p_data + p_build[i].entry.offset, p_source->p_data, p_source->size);
+    }
+
+    free(p_build);
+
+    *pp_data = p_data;
+    *p_size = (size_t)size;
+
+    return SUCCESS;
+}
+
+error_t asset_pack_init(const void* p_data, size_t size, asset_pack_t* p_pack)
+{
+    if(p_data == NULL || p_pack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_data or p_pack is NULL", __func__);
+
+    if((uintptr_t)p_data % sizeof(uint64_t) != 0)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: The pack is not 8 byte aligned", __func__);
+
+    asset_pack_header_t header;
+    if(size < sizeof(header))
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: The pack is smaller than its header", __func__);
+    memcpy(&header, p_data, sizeof(header));
+
+    if(header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Not a version %u asset pack", __func__, ASSET_PACK_VERSION);
+
+    if(header.size != (uint64_t)size)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: The pack is %llu bytes, its header says %llu", __func__,
+            (unsigned long long)size, (unsigned long long)header.size);
+
+    uint64_t table_end = sizeof(asset_pack_header_t) + (uint64_t)header.entries_count * sizeof(asset_pack_entry_t) +
+        header.names_size;
+    if(table_end > (uint64_t)size)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: The entries do not fit in the pack", __func__);
+
+    const uint8_t* p_bytes = (const uint8_t*)p_data;
+    const asset_pack_entry_t* p_entries = (const asset_pack_entry_t*)(p_bytes + sizeof(asset_pack_header_t));
+
+    // Checked once here so a lookup never has to
+    for(uint32_t i = 0; i < header.entries_count; ++i) {
+        const asset_pack_entry_t* p_entry = &p_entries[i];
+        if((uint64_t)p_entry->name_offset + p_entry->name_size > header.names_size ||
+            p_entry->offset % ASSET_PACK_ALIGNMENT != 0 || p_entry->offset < table_end ||
+            p_entry->offset > (uint64_t)size || p_entry->size > (uint64_t)size - p_entry->offset)
+            return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Entry %u is out of bounds", __func__, i);
+
+        if(i > 0 && p_entries[i - 1].hash > p_entry->hash)
+            return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: The entries are not sorted", __func__);
+    }
+
+    p_pack->p_data = p_bytes;
+    p_pack->size = size;
+    p_pack->p_entries = p_entries;
+    p_pack->entries_count = header.entries_count;
+    p_pack->p_names = (const char*)(p_entries + header.entries_count);
+    p_pack->p_mapping = NULL;
+
+    return SUCCESS;
+}
+
+error_t asset_pack_open(const char* p_path, asset_pack_t* p_pack)
+{
+    if(p_path == NULL || p_pack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_path or p_pack is NULL", __func__);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(p_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "%s: Failed to open %s", __func__, p_path);
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0 ||
+        (LONGLONG)(size_t)file_size.QuadPart != file_size.QuadPart) {
+        CloseHandle(file);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to get the size of %s", __func__, p_path);
+    }
+
+    // The view keeps the mapping and the file open, so both handles can be closed right away
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if(mapping == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to map %s", __func__, p_path);
+
+    void* p_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(p_view == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to map %s", __func__, p_path);
+
+    size_t size = (size_t)file_size.QuadPart;
+#else
+    int fd = open(p_path, O_RDONLY);
+    if(fd < 0)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "%s: Failed to open %s: %s", __func__, p_path, strerror(errno));
+
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0 || (off_t)(size_t)file_stat.st_size != file_stat.st_size) {
+        close(fd);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to get the size of %s", __func__, p_path);
+    }
+    size_t size = (size_t)file_stat.st_size;
+
+    // The mapping keeps the file open, so the descriptor can be closed right away
+    void* p_view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(p_view == MAP_FAILED)
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to map %s: %s", __func__, p_path, strerror(errno));
+#endif
+
+    error_t err = asset_pack_init(p_view, size, p_pack);
+    if(err.code != 0) {
+#ifdef _WIN32
+        UnmapViewOfFile(p_view);
+#else
+        munmap(p_view, size);
+#endif
+        return err;
+    }
+
+    p_pack->p_mapping = p_view;
+
+    LOG_DEBUG("Asset pack %s mapped: %u assets, %zu bytes", p_path, p_pack->entries_count, size);
+
+    return SUCCESS;
+}
+
+void asset_pack_close(asset_pack_t* p_pack)
+{
+    if(p_pack == NULL || p_pack->p_mapping == NULL)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(p_pack->p_mapping);
+#else
+    munmap(p_pack->p_mapping, p_pack->size);
+#endif
+
+    p_pack->p_mapping = NULL;
+    p_pack->p_data = NULL;
+    p_pack->p_entries = NULL;
+    p_pack->entries_count = 0;
+}
+
+const void* asset_pack_find(const asset_pack_t* p_pack, const char* p_name, size_t* p_size)
+{
+    if(p_pack == NULL || p_name == NULL)
+        return NULL;
+
+    // Paths relative to the build directory name the same assets as paths relative to the repository root
+    for(;;) {
+        if(strncmp(p_name, "./", 2) == 0)
+            p_name += 2;
+        else if(strncmp(p_name, "../", 3) == 0)
+            p_name += 3;
+        else
+            break;
+    }
+
+    size_t name_size = strlen(p_name);
+    uint64_t hash = asset_pack_hash(p_name, name_size);
+
+    // The first entry with the hash, then every entry that shares it
+    uint32_t lo = 0;
+    uint32_t hi = p_pack->entries_count;
+    while(lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if(p_pack->p_entries[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for(uint32_t i = lo; i < p_pack->entries_count && p_pack->p_entries[i].hash == hash; ++i) {
+        const asset_pack_entry_t* p_entry = &p_pack->p_entries[i];
+        if(p_entry->name_size != name_size || memcmp(p_pack->p_names + p_entry->name_offset, p_name, name_size) != 0)
+            continue;
+
+        if(p_size != NULL)
+            *p_size = (size_t)p_entry->size;
+
+        return p_pack->p_data + p_entry->offset;
+    }
+
+    return NULL;
+}
+
+bool asset_pack_mount(const char* p_path)
+{
+    asset_pack_unmount();
+
+    error_t err = asset_pack_open(p_path, &mounted_pack);
+    if(err.code != 0) {
+        LOG_INFO("No asset pack mounted, assets are read from loose files: %s", err.msg);
+        error_deinit(&err);
+        return false;
+    }
+
+    // Loose files changed after this are read instead of their packed copies in debug builds
+    struct stat pack_stat;
+    pack_mtime = stat(p_path, &pack_stat) == 0 ? pack_stat.st_mtime : 0;
+    pack_mounted = true;
+
+    LOG_INFO("Asset pack mounted: %s, %u assets, %zu bytes", p_path, mounted_pack.entries_count, mounted_pack.size);
+
+    return true;
+}
+
+void asset_pack_unmount(void)
+{
+    if(!pack_mounted)
+        return;
+
+    asset_pack_close(&mounted_pack);
+    pack_mounted = false;
+}
+
+const asset_pack_t* asset_pack_mounted(void)
+{
+    return pack_mounted ? &mounted_pack : NULL;
+}
+
+const void* asset_pack_find_mounted(const char* p_path, size_t* p_size)
+{
+    if(!pack_mounted || p_path == NULL)
+        return NULL;
+
+#ifndef NDEBUG
+    // A shader recompiled or a texture edited since the pack was built must not be shadowed by a stale pack
+    struct stat loose_stat;
+    if(stat(p_path, &loose_stat) == 0 && loose_stat.st_mtime > pack_mtime) {
+        LOG_INFO("%s is newer than the asset pack, reading the loose file", p_path);
+        return NULL;
+    }
+#endif
+
+    return asset_pack_find(&mounted_pack, p_path, p_size);
+}
+
+static int compare_build_entries(const void* p_a, const void* p_b)
+{
+    const pack_build_entry_t* p_entry_a = (const pack_build_entry_t*)p_a;
+    const pack_build_entry_t* p_entry_b = (const pack_build_entry_t*)p_b;
+
+    if(p_entry_a->entry.hash != p_entry_b->entry.hash)
+        return p_entry_a->entry.hash < p_entry_b->entry.hash ? -1 : 1;
+
+    return strcmp(p_entry_a->p_name, p_entry_b->p_name);
+}
+
+static uint64_t align_up(uint64_t size)
+{
+    return (size + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
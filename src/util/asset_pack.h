@@ -0,0 +1,148 @@
+#ifndef ASSET_PACK_H_
+#define ASSET_PACK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "error/error.h"
+
+// "BKPK" read as a little endian 32 bit word
+#define ASSET_PACK_MAGIC 0x4B504B42u
+
+#define ASSET_PACK_VERSION 1u
+
+// Every blob starts on this boundary, enough for SPIR-V words and SIMD loads of pixel data
+#define ASSET_PACK_ALIGNMENT 16u
+
+/**
+ * \brief Start of a pack file, 32 bytes. All fields are little endian.
+ *
+ * The header is followed by entries_count entries sorted by hash, then the names, then the blobs.
+ */
+typedef struct asset_pack_header_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entries_count;
+    uint32_t names_size; // Bytes of names following the entries
+    uint64_t size;       // Size of the whole file, a truncated file is rejected
+    uint64_t reserved;
+} asset_pack_header_t;
+
+/**
+ * An entry of the hash table, 32 bytes. Entries with the same hash are told apart by their names.
+ */
+typedef struct asset_pack_entry_s {
+    uint64_t hash;        // asset_pack_hash of the name
+    uint64_t offset;      // Offset of the blob from the start of the file, a multiple of ASSET_PACK_ALIGNMENT
+    uint64_t size;        // Size of the blob in bytes
+    uint32_t name_offset; // Offset of the name from the start of the names, not NUL terminated
+    uint32_t name_size;
+} asset_pack_entry_t;
+
+/**
+ * An asset to put in a pack.
+ */
+typedef struct asset_pack_source_s {
+    const char* p_name; // Path relative to the repository root with '/' separators, e.g. "assets/icon.bmp"
+    const void* p_data;
+    size_t size;
+} asset_pack_source_t;
+
+/**
+ * \brief A pack, either mapped from a file or read from memory the caller owns.
+ *
+ * The blobs are never copied, asset_pack_find returns pointers into the pack which stay valid until it is closed.
+ */
+typedef struct asset_pack_s {
+    const uint8_t* p_data;
+    size_t size;
+    const asset_pack_entry_t* p_entries;
+    uint32_t entries_count;
+    const char* p_names;
+    void* p_mapping; // Platform handle of the mapping, NULL if the memory is not owned by the pack
+} asset_pack_t;
+
+/**
+ * FNV-1a hash of a name, the key of the hash table.
+ */
+uint64_t asset_pack_hash(const char* p_name, size_t name_size) PURE_ATTR;
+
+/**
+ * \brief Build a pack in memory.
+ *
+ * \param[in] p_sources The assets, names must be unique.
+ * \param[in] count Number of assets.
+ * \param[out] pp_data The pack, allocated with malloc and owned by the caller.
+ * \param[out] p_size Size of the pack in bytes.
+ */
+error_t asset_pack_build(const asset_pack_source_t* p_sources, uint32_t count, uint8_t** pp_data, size_t* p_size);
+
+/**
+ * \brief Read a pack from memory, which must stay valid while the pack is used.
+ *
+ * The memory must be at least 8 byte aligned for the entries, and 16 byte aligned for the blobs to be. The header and
+ * every entry are checked against the size, so a damaged pack is rejected instead of read out of bounds later.
+ */
+error_t asset_pack_init(const void* p_data, size_t size, asset_pack_t* p_pack);
+
+/**
+ * \brief Map a pack file into memory with a single open and mmap, MapViewOfFile on Windows.
+ */
+error_t asset_pack_open(const char* p_path, asset_pack_t* p_pack);
+
+/**
+ * Unmap a pack opened with asset_pack_open. Does nothing for a pack read with asset_pack_init.
+ */
+void asset_pack_close(asset_pack_t* p_pack);
+
+/**
+ * \brief Find an asset by name.
+ *
+ * Leading "./" and "../" are skipped, so the relative paths the loose files are opened with from the build directory
+ * find the same asset.
+ *
+ * \param[in] p_pack Pointer to the pack.
+ * \param[in] p_name Name of the asset.
+ * \param[out] p_size Optional, the size of the asset.
+ *
+ * \return Pointer to the asset inside the pack, NULL if there is no such asset.
+ */
+const void* asset_pack_find(const asset_pack_t* p_pack, const char* p_name, size_t* p_size);
+
+/**
+ * \brief Open the pack used by asset_pack_mounted for the rest of the process.
+ *
+ * Call it once before any thread looks up assets. Without a mounted pack every asset is read from its loose file.
+ *
+ * The pack is logged at info level, so a run can tell whether its assets came from a pack.
+ *
+ * \return False if the pack could not be opened, in which case nothing is mounted.
+ */
+bool asset_pack_mount(const char* p_path);
+
+/**
+ * Close the mounted pack. No pointer into it may be used afterwards.
+ */
+void asset_pack_unmount(void);
+
+/**
+ * Get the mounted pack, NULL if none is mounted.
+ */
+const asset_pack_t* asset_pack_mounted(void) PURE_ATTR;
+
+/**
+ * \brief Find an asset in the mounted pack, the lookup the loaders use before they fall back to the loose file.
+ *
+ * In debug builds an asset whose loose file is newer than the pack is not looked up, so a stale pack does not shadow
+ * a shader or texture changed after it was built.
+ *
+ * \param[in] p_path Path of the loose file, relative to the working directory.
+ * \param[out] p_size Optional, the size of the asset.
+ *
+ * \return Pointer to the asset inside the pack, NULL if nothing is mounted, the asset is not packed or it is stale.
+ */
+const void* asset_pack_find_mounted(const char* p_path, size_t* p_size);
+
+#endif // ASSET_PACK_H_
@@ -0,0 +1,419 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include "error/error.h"
+#include "error/sdl_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+
+// Times an idle worker looks for work before it goes to sleep
+#define JOB_SPIN_COUNT 64
+
+/**
+ * The main loop of a worker thread. Runs jobs until there are none, spins a little and then sleeps until more are
+ * submitted.
+ */
+static int SDLCALL job_thread(void* p_void_worker);
+
+/**
+ * Find a job for a worker: its own deque first, then the shared deque, then the other workers' deques.
+ */
+static bool find_job(job_system_t* p_jobs, job_worker_t* p_worker, job_t* p_job);
+
+/**
+ * Run a job and count it as finished.
+ */
+static void run_job(const job_t* p_job);
+
+/**
+ * Push a job from the calling thread and wake a sleeping worker for it.
+ */
+static void push_job(job_system_t* p_jobs, uint32_t worker_index, const job_t* p_job);
+
+/**
+ * Push a job onto the bottom of a deque, only called by the owner. Returns false if the deque is full.
+ */
+static bool deque_push(job_deque_t* p_deque, const job_t* p_job);
+
+/**
+ * Pop the newest job off the bottom of a deque, only called by the owner.
+ */
+static bool deque_pop(job_deque_t* p_deque, job_t* p_job);
+
+/**
+ * Steal the oldest job off the top of a deque, called by any thread.
+ */
+static bool deque_steal(job_deque_t* p_deque, job_t* p_job);
+
+/**
+ * \brief Stop the worker threads and free the deques.
+ *
+ * \param[in] p_void_jobs Pointer to the job_system_t.
+ */
+static void job_system_deinit(void* p_void_jobs);
+
+error_t job_system_init(deletion_stack_t* p_dstack, uint32_t workers_count, job_system_t* p_jobs)
+{
+    if(p_jobs == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_jobs is NULL", __func__);
+
+    // At least one worker thread, the calling thread only runs jobs while it waits. Without one, the jobs of a thread
+    // that is not a worker would only run while the calling thread happened to wait on the pool.
+    if(workers_count < 2)
+        workers_count = 2;
+    if(workers_count > JOB_MAX_WORKERS)
+        workers_count = JOB_MAX_WORKERS;
+
+    *p_jobs = (job_system_t){0};
+
+    // CLEANUP, pushed before anything is created, the deinit skips whatever has not been created yet
+    error_t err = deletion_stack_push(p_dstack, p_jobs, job_system_deinit);
+    if(err.code != 0)
+        return err;
+
+    // The deques are too large to live inside the struct, which usually sits on the stack
+    p_jobs->p_workers = (job_worker_t*)calloc(workers_count, sizeof(job_worker_t));
+    p_jobs->p_shared = (job_deque_t*)calloc(1, sizeof(job_deque_t));
+    if(p_jobs->p_workers == NULL || p_jobs->p_shared == NULL)
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate the deques", __func__);
+
+    p_jobs->p_shared_mutex = SDL_CreateMutex();
+    if(p_jobs->p_shared_mutex == NULL)
+        return error_init(ERR_SRC_SDL, SDL_ERR_CREATE_MUTEX, "%s: Failed to create mutex: %s", __func__,
+            SDL_GetError());
+
+    p_jobs->p_wake_sem = SDL_CreateSemaphore(0);
+    if(p_jobs->p_wake_sem == NULL)
+        return error_init(ERR_SRC_SDL, SDL_ERR_CREATE_SEMAPHORE, "%s: Failed to create semaphore: %s", __func__,
+            SDL_GetError());
+
+    for(uint32_t i = 0; i < workers_count; ++i) {
+        p_jobs->p_workers[i].p_system = p_jobs;
+        p_jobs->p_workers[i].index = i;
+        p_jobs->p_workers[i].rng = 0x9e3779b9u * (i + 1);
+    }
+
+    // Worker 0 is the calling thread, the others get their own thread
+    p_jobs->p_workers[0].thread_id = SDL_GetCurrentThreadID();
+    p_jobs->workers_count = workers_count;
+
+    for(uint32_t i = 1; i < workers_count; ++i) {
+        job_worker_t* p_worker = &p_jobs->p_workers[i];
+
+        p_worker->p_thread = SDL_CreateThread(job_thread, "job_worker", p_worker);
+        if(p_worker->p_thread == NULL)
+            return error_init(ERR_SRC_SDL, SDL_ERR_CREATE_THREAD, "%s: Failed to create worker thread: %s", __func__,
+                SDL_GetError());
+
+        p_worker->thread_id = SDL_GetThreadID(p_worker->p_thread);
+    }
+
+    LOG_DEBUG("Job system workers: %u", workers_count);
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+static void job_system_deinit(void* p_void_jobs)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_jobs == NULL) {
+        LOG_ERROR("%s: p_void_jobs is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    job_system_t* p_jobs = (job_system_t*)p_void_jobs;
+
+    // Wake every worker up and let them exit
+    SDL_SetAtomicInt(&p_jobs->quit, 1);
+    if(p_jobs->p_wake_sem != NULL) {
+        for(uint32_t i = 1; i < p_jobs->workers_count; ++i)
+            SDL_SignalSemaphore(p_jobs->p_wake_sem);
+    }
+
+    if(p_jobs->p_workers != NULL) {
+        for(uint32_t i = 1; i < p_jobs->workers_count; ++i) {
+            if(p_jobs->p_workers[i].p_thread != NULL) {
+                SDL_WaitThread(p_jobs->p_workers[i].p_thread, NULL);
+                p_jobs->p_workers[i].p_thread = NULL;
+            }
+        }
+    }
+
+    SDL_DestroySemaphore(p_jobs->p_wake_sem);
+    SDL_DestroyMutex(p_jobs->p_shared_mutex);
+    p_jobs->p_wake_sem = NULL;
+    p_jobs->p_shared_mutex = NULL;
+
+    free(p_jobs->p_shared);
+    free(p_jobs->p_workers);
+    p_jobs->p_shared = NULL;
+    p_jobs->p_workers = NULL;
+    p_jobs->workers_count = 0;
+
+    p_void_jobs = NULL;
+}
+
+uint32_t job_system_worker_index(const job_system_t* p_jobs)
+{
+    if(p_jobs == NULL)
+        return JOB_NOT_A_WORKER;
+
+    SDL_ThreadID thread_id = SDL_GetCurrentThreadID();
+    for(uint32_t i = 0; i < p_jobs->workers_count; ++i) {
+        if(p_jobs->p_workers[i].thread_id == thread_id)
+            return i;
+    }
+
+    return JOB_NOT_A_WORKER;
+}
+
+void job_system_run(job_system_t* p_jobs, const job_t* p_batch, uint32_t batch_count, job_counter_t* p_counter)
+{
+    if(p_jobs == NULL || p_batch == NULL || p_counter == NULL) {
+        LOG_ERROR("%s: NULL argument", __func__);
+        return;
+    }
+
+    if(batch_count == 0)
+        return;
+
+    // Counted before any of them can finish
+    SDL_AddAtomicInt(&p_counter->value, (int)batch_count);
+
+    uint32_t worker_index = job_system_worker_index(p_jobs);
+    for(uint32_t i = 0; i < batch_count; ++i) {
+        job_t job = p_batch[i];
+        job.p_counter = p_counter;
+        push_job(p_jobs, worker_index, &job);
+    }
+}
+
+void job_system_wait(job_system_t* p_jobs, job_counter_t* p_counter)
+{
+    if(p_jobs == NULL || p_counter == NULL) {
+        LOG_ERROR("%s: p_jobs or p_counter is NULL", __func__);
+        return;
+    }
+
+    uint32_t worker_index = job_system_worker_index(p_jobs);
+    job_worker_t* p_worker = worker_index != JOB_NOT_A_WORKER ? &p_jobs->p_workers[worker_index] : NULL;
+
+    uint32_t spins = 0;
+    while(SDL_GetAtomicInt(&p_counter->value) > 0) {
+        job_t job;
+        if(p_worker != NULL && find_job(p_jobs, p_worker, &job)) {
+            run_job(&job);
+            spins = 0;
+            continue;
+        }
+
+        // The last jobs are running elsewhere, give the core away now and then if they take a while
+        if(++spins < JOB_SPIN_COUNT) {
+            SDL_CPUPauseInstruction();
+        }
+        else {
+            SDL_DelayNS(0);
+            spins = 0;
+        }
+    }
+}
+
+void job_system_parallel_for(job_system_t* p_jobs, uint32_t count, uint32_t batch_size, job_func_t func,
+    void* p_data)
+{
+    if(func == NULL) {
+        LOG_ERROR("%s: func is NULL", __func__);
+        return;
+    }
+
+    if(batch_size < 1)
+        batch_size = 1;
+
+    // A single batch is not worth the hand over
+    if(p_jobs == NULL || count <= batch_size) {
+        if(count > 0)
+            func(p_data, 0, count);
+        return;
+    }
+
+    job_counter_t counter = {0};
+    uint32_t batches_count = (count + batch_size - 1) / batch_size;
+    SDL_AddAtomicInt(&counter.value, (int)batches_count);
+
+    uint32_t worker_index = job_system_worker_index(p_jobs);
+    for(uint32_t begin = 0; begin < count; begin += batch_size) {
+        job_t job = {0};
+        job.func = func;
+        job.p_data = p_data;
+        job.begin = begin;
+        job.end = count - begin < batch_size ? count : begin + batch_size;
+        job.p_counter = &counter;
+        push_job(p_jobs, worker_index, &job);
+    }
+
+    job_system_wait(p_jobs, &counter);
+}
+
+static int SDLCALL job_thread(void* p_void_worker)
+{
+    job_worker_t* p_worker = (job_worker_t*)p_void_worker;
+    job_system_t* p_jobs = p_worker->p_system;
+
+    for(;;) {
+        job_t job;
+        bool found = false;
+        for(int i = 0; i < JOB_SPIN_COUNT && !found; ++i) {
+            found = find_job(p_jobs, p_worker, &job);
+            if(!found)
+                SDL_CPUPauseInstruction();
+        }
+
+        if(found) {
+            run_job(&job);
+            continue;
+        }
+
+        // Announce the sleep before the last look, a job pushed after the look sees the announcement and wakes us
+        SDL_AddAtomicInt(&p_jobs->sleeping, 1);
+
+        if(find_job(p_jobs, p_worker, &job)) {
+            SDL_AddAtomicInt(&p_jobs->sleeping, -1);
+            run_job(&job);
+            continue;
+        }
+
+        if(SDL_GetAtomicInt(&p_jobs->quit) != 0) {
+            SDL_AddAtomicInt(&p_jobs->sleeping, -1);
+            break;
+        }
+
+        SDL_WaitSemaphore(p_jobs->p_wake_sem);
+        SDL_AddAtomicInt(&p_jobs->sleeping, -1);
+    }
+
+    return 0;
+}
+
+static bool find_job(job_system_t* p_jobs, job_worker_t* p_worker, job_t* p_job)
+{
+    if(deque_pop(&p_worker->deque, p_job))
+        return true;
+
+    if(deque_steal(p_jobs->p_shared, p_job))
+        return true;
+
+    if(p_jobs->workers_count < 2)
+        return false;
+
+    // Start at a random victim so the thieves spread out
+    p_worker->rng ^= p_worker->rng << 13;
+    p_worker->rng ^= p_worker->rng >> 17;
+    p_worker->rng ^= p_worker->rng << 5;
+    uint32_t start = p_worker->rng % p_jobs->workers_count;
+
+    for(uint32_t i = 0; i < p_jobs->workers_count; ++i) {
+        uint32_t victim = (start + i) % p_jobs->workers_count;
+        if(victim != p_worker->index && deque_steal(&p_jobs->p_workers[victim].deque, p_job))
+            return true;
+    }
+
+    return false;
+}
+
+static void run_job(const job_t* p_job)
+{
+    p_job->func(p_job->p_data, p_job->begin, p_job->end);
+
+    if(p_job->p_counter != NULL)
+        SDL_AddAtomicInt(&p_job->p_counter->value, -1);
+}
+
+static void push_job(job_system_t* p_jobs, uint32_t worker_index, const job_t* p_job)
+{
+    if(worker_index != JOB_NOT_A_WORKER) {
+        // A full deque means there is plenty of work queued already, running this one right away is as good
+        if(!deque_push(&p_jobs->p_workers[worker_index].deque, p_job)) {
+            run_job(p_job);
+            return;
+        }
+    }
+    else {
+        // Only workers run jobs, so wait for them to make room
+        for(;;) {
+            SDL_LockMutex(p_jobs->p_shared_mutex);
+            bool pushed = deque_push(p_jobs->p_shared, p_job);
+            SDL_UnlockMutex(p_jobs->p_shared_mutex);
+            if(pushed)
+                break;
+            SDL_DelayNS(0);
+        }
+    }
+
+    if(SDL_GetAtomicInt(&p_jobs->sleeping) > 0)
+        SDL_SignalSemaphore(p_jobs->p_wake_sem);
+}
+
+// The SDL atomics are sequentially consistent, which is what the deque needs between publishing bottom and reading top
+
+static bool deque_push(job_deque_t* p_deque, const job_t* p_job)
+{
+    uint32_t bottom = SDL_GetAtomicU32(&p_deque->bottom);
+    uint32_t top = SDL_GetAtomicU32(&p_deque->top);
+
+    if(bottom - top >= JOB_DEQUE_CAPACITY)
+        return false;
+
+    p_deque->p_jobs[bottom & (JOB_DEQUE_CAPACITY - 1)] = *p_job;
+    SDL_SetAtomicU32(&p_deque->bottom, bottom + 1);
+
+    return true;
+}
+
+static bool deque_pop(job_deque_t* p_deque, job_t* p_job)
+{
+    uint32_t bottom = SDL_GetAtomicU32(&p_deque->bottom) - 1;
+    SDL_SetAtomicU32(&p_deque->bottom, bottom);
+    uint32_t top = SDL_GetAtomicU32(&p_deque->top);
+
+    // Empty, top is past bottom
+    if(bottom - top >= 0x80000000u) {
+        SDL_SetAtomicU32(&p_deque->bottom, top);
+        return false;
+    }
+
+    *p_job = p_deque->p_jobs[bottom & (JOB_DEQUE_CAPACITY - 1)];
+    if(bottom != top)
+        return true;
+
+    // The last job, a thief may be taking it at the same time
+    bool won = SDL_CompareAndSwapAtomicU32(&p_deque->top, top, top + 1);
+    SDL_SetAtomicU32(&p_deque->bottom, top + 1);
+
+    return won;
+}
+
+static bool deque_steal(job_deque_t* p_deque, job_t* p_job)
+{
+    uint32_t top = SDL_GetAtomicU32(&p_deque->top);
+    uint32_t bottom = SDL_GetAtomicU32(&p_deque->bottom);
+
+    // Empty, or the owner is in the middle of popping the last job
+    if(bottom - top - 1 >= 0x80000000u)
+        return false;
+
+    // The owner never overwrites this slot before top moves past it, so a failed swap only means someone else took it
+    *p_job = p_deque->p_jobs[top & (JOB_DEQUE_CAPACITY - 1)];
+
+    return SDL_CompareAndSwapAtomicU32(&p_deque->top, top, top + 1);
+}
@@ -0,0 +1,136 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+
+// Maximum number of workers, including the thread that initiated the job system
+#define JOB_MAX_WORKERS 16
+
+// Number of jobs a deque holds, must be a power of two. A worker with a full deque runs the job it is pushing itself.
+#define JOB_DEQUE_CAPACITY 1024
+
+// Returned by job_system_worker_index for threads that are not workers
+#define JOB_NOT_A_WORKER UINT32_MAX
+
+/**
+ * A job function. Runs on the items [begin, end) of p_data, plain jobs can ignore the range.
+ */
+typedef void (*job_func_t)(void* p_data, uint32_t begin, uint32_t end);
+
+/**
+ * Counts the unfinished jobs of a batch. Jobs that wait on another batch's counter are how dependencies are expressed.
+ * Zero initiate it, e.g. job_counter_t counter = {0}.
+ */
+typedef struct job_counter_s {
+    SDL_AtomicInt value;
+} job_counter_t;
+
+/**
+ * A job, copied into the deques by value so the caller's array can go out of scope once it is submitted.
+ */
+typedef struct job_s {
+    job_func_t func;
+    void* p_data;
+    uint32_t begin;
+    uint32_t end;
+    job_counter_t* p_counter; // Decremented when the job has run, set by job_system_run
+} job_t;
+
+/**
+ * A Chase-Lev work-stealing deque. The owner pushes and pops at the bottom without contention, thieves take from the
+ * top and only race each other (and the owner for the last job) through one compare and swap. The indices only ever
+ * grow and wrap around, they are compared by their difference.
+ */
+typedef struct job_deque_s {
+    SDL_AtomicU32 top;
+    char p_pad[60]; // Keep the thieves' index off the owner's cache line
+    SDL_AtomicU32 bottom;
+    job_t p_jobs[JOB_DEQUE_CAPACITY];
+} job_deque_t;
+
+/**
+ * A worker. Worker 0 is the thread that initiated the job system, it only runs jobs while it waits on a counter.
+ */
+typedef struct job_worker_s {
+    struct job_system_s* p_system;
+    struct SDL_Thread* p_thread; // NULL for worker 0
+    SDL_ThreadID thread_id;
+    uint32_t index;
+    uint32_t rng; // Picks the victim to steal from
+    job_deque_t deque;
+} job_worker_t;
+
+/**
+ * A pool of worker threads sized to the core count, shared by the game and the renderer.
+ *
+ * Every worker has its own deque, jobs pushed by a worker go to its own deque and idle workers steal from the others.
+ * Threads that are not workers can submit jobs as well, they go to a shared deque behind a mutex. Those threads never
+ * run jobs themselves, so a job can rely on job_system_worker_index to pick per worker resources such as command pools.
+ */
+typedef struct job_system_s {
+    job_worker_t* p_workers;
+    uint32_t workers_count;
+    job_deque_t* p_shared;              // Jobs submitted by threads that are not workers
+    struct SDL_Mutex* p_shared_mutex;   // Serializes the pushes onto p_shared
+    struct SDL_Semaphore* p_wake_sem;   // Idle workers sleep on it
+    SDL_AtomicInt sleeping;             // Number of workers sleeping or about to
+    SDL_AtomicInt quit;
+} job_system_t;
+
+/**
+ * \brief Initiate the job system and start its worker threads.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] workers_count Number of workers including the calling thread, clamped to [2, JOB_MAX_WORKERS] so there
+ * is always a worker thread to run the jobs of threads that are not workers. Usually the number of logical cores.
+ * \param[out] p_jobs Pointer to the job_system_t to initiate. The worker threads and the deletion stack keep the
+ * pointer, so it must stay valid until the stack is flushed. All jobs must have finished by then.
+ */
+error_t job_system_init(deletion_stack_t* p_dstack, uint32_t workers_count, job_system_t* p_jobs);
+
+/**
+ * Get the index of the worker the calling thread is, in [0, workers_count), or JOB_NOT_A_WORKER.
+ */
+uint32_t job_system_worker_index(const job_system_t* p_jobs);
+
+/**
+ * \brief Submit a batch of jobs.
+ *
+ * \param[in] p_jobs Pointer to the job_system_t.
+ * \param[in] p_batch Array of jobs, their counters are overwritten with p_counter.
+ * \param[in] batch_count Number of jobs.
+ * \param[in] p_counter Counter incremented by batch_count now and decremented as each job finishes. Can be shared by
+ * several batches.
+ */
+void job_system_run(job_system_t* p_jobs, const job_t* p_batch, uint32_t batch_count, job_counter_t* p_counter);
+
+/**
+ * \brief Wait until a counter reaches zero.
+ *
+ * A worker runs other jobs while it waits, so a job can wait on the jobs it submitted without tying up its thread.
+ * Other threads spin and yield.
+ */
+void job_system_wait(job_system_t* p_jobs, job_counter_t* p_counter);
+
+/**
+ * \brief Run a function over [0, count) in parallel and wait for it.
+ *
+ * The range is split into batches of batch_size items, one job each. The calling thread helps if it is a worker.
+ *
+ * \param[in] p_jobs Pointer to the job_system_t, or NULL to run everything on the calling thread.
+ * \param[in] count Number of items.
+ * \param[in] batch_size Items per job, at least 1.
+ * \param[in] func The function, called with p_data and the range of each batch.
+ * \param[in] p_data Passed to func.
+ */
+void job_system_parallel_for(job_system_t* p_jobs, uint32_t count, uint32_t batch_size, job_func_t func,
+    void* p_data);
+
+#endif // JOB_SYSTEM_H_
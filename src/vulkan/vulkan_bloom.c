@@ -0,0 +1,34 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_bloom.h"
+
+uint32_t bloom_mips_count(uint32_t width, uint32_t height)
+{
+    uint32_t min_side = width < height ? width : height;
+
+    uint32_t count = 0;
+    while(count < BLOOM_MAX_MIPS && (min_side >> (count + 1)) >= BLOOM_MIN_SIZE)
+        ++count;
+
+    return count;
+}
+
+void bloom_mip_extent(uint32_t width, uint32_t height, uint32_t level, uint32_t* p_width, uint32_t* p_height)
+{
+    if(p_width == NULL || p_height == NULL) {
+        LOG_ERROR("%s: p_width or p_height is NULL", __func__);
+        return;
+    }
+
+    // Shifting by 32 or more is undefined, every level that deep is 1x1 anyway
+    if(level >= 32) {
+        *p_width = 1;
+        *p_height = 1;
+        return;
+    }
+
+    *p_width = (width >> level) > 0 ? width >> level : 1;
+    *p_height = (height >> level) > 0 ? height >> level : 1;
+}
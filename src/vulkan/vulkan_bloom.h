@@ -0,0 +1,35 @@
+#ifndef VULKAN_BLOOM_H_
+#define VULKAN_BLOOM_H_
+
+#include <stdint.h>
+
+#include "config.h"
+
+// Most levels of the bloom pyramid, not counting the draw image itself. Each level is half the size of the one above,
+// so six levels spread a bright pixel over about a 128 pixel radius.
+#define BLOOM_MAX_MIPS 6
+
+// The smallest level of the pyramid is at least this many texels on its shorter side
+#define BLOOM_MIN_SIZE 4
+
+/**
+ * \brief Number of levels of the bloom pyramid below an image.
+ *
+ * Levels are added while the shorter side of the next one stays at least BLOOM_MIN_SIZE texels, up to BLOOM_MAX_MIPS.
+ *
+ * \param[in] width Width of the draw image.
+ * \param[in] height Height of the draw image.
+ *
+ * \return The number of levels, 0 if the image is too small for any.
+ */
+uint32_t bloom_mips_count(uint32_t width, uint32_t height) CONST_ATTR;
+
+/**
+ * \brief Extent of a level of the pyramid, with the draw image as level 0. Never smaller than 1x1.
+ *
+ * Only the part of each level covered by the draw extent is written, so this is called with the draw extent rather
+ * than the extent of the image.
+ */
+void bloom_mip_extent(uint32_t width, uint32_t height, uint32_t level, uint32_t* p_width, uint32_t* p_height);
+
+#endif // VULKAN_BLOOM_H_
@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "error/vulkan_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_buffer.h"
+
+/**
+ * Struct used for deleting a buffer
+ */
+typedef struct buffer_del_s {
+    VkDevice device;
+    allocated_buffer_t buffer;
+} buffer_del_t;
+
+/**
+ * Destroy a buffer and free its memory, which also unmaps it.
+ */
+static void vulkan_buffer_deinit(void* p_void_buffer_del);
+
+/**
+ * Find a memory type allowed by type_bits that has all of the flags.
+ *
+ * \return False if there is none.
+ */
+static bool find_memory_type(VkPhysicalDevice physical_device, uint32_t type_bits, VkMemoryPropertyFlags flags,
+    uint32_t* p_index);
+
+error_t vulkan_buffer_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem_flags, allocated_buffer_t* p_buffer)
+{
+    return vulkan_buffer_create_shared(p_dstack, device, physical_device, size, usage, mem_flags, NULL, p_buffer);
+}
+
+error_t vulkan_buffer_create_shared(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem_flags, const queue_family_data_t* p_queues,
+    allocated_buffer_t* p_buffer)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(physical_device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: physical_device is NULL", __func__);
+
+    if(p_buffer == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_buffer is NULL", __func__);
+
+    *p_buffer = (allocated_buffer_t){0};
+    p_buffer->size = size;
+
+    VkBufferCreateInfo buffer_info = {0};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Concurrent sharing costs a little on some hardware, but saves a queue family ownership transfer every time the
+    // other queue touches the buffer
+    uint32_t p_families[2] = {0};
+    if(p_queues != NULL && p_queues->async_compute) {
+        p_families[0] = p_queues->graphics_index;
+        p_families[1] = p_queues->compute_index;
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = 2;
+        buffer_info.pQueueFamilyIndices = p_families;
+    }
+
+    if(vkCreateBuffer(device, &buffer_info, VK_NULL_HANDLE, &p_buffer->buffer) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_BUFFER, "Failed to create buffer of size %llu",
+            (unsigned long long)size);
+
+    // CLEANUP, pushed before the memory is allocated, destroying a null handle does nothing
+    buffer_del_t* p_buffer_del = (buffer_del_t*)malloc(sizeof(buffer_del_t));
+    if(p_buffer_del == NULL) {
+        vkDestroyBuffer(device, p_buffer->buffer, VK_NULL_HANDLE);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate memory of size %lu", __func__,
+            sizeof(buffer_del_t));
+    }
+    p_buffer_del->device = device;
+    p_buffer_del->buffer = *p_buffer;
+
+    error_t err = deletion_stack_push(p_dstack, p_buffer_del, vulkan_buffer_deinit);
+    if(err.code != 0) {
+        vulkan_buffer_deinit(p_buffer_del);
+        return err;
+    }
+
+    VkMemoryRequirements mem_req;
+    vkGetBufferMemoryRequirements(device, p_buffer->buffer, &mem_req);
+
+    VkMemoryAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_req.size;
+
+    if(!find_memory_type(physical_device, mem_req.memoryTypeBits, mem_flags, &alloc_info.memoryTypeIndex))
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_MEMORY, "No memory type with flags 0x%x for buffer",
+            (unsigned int)mem_flags);
+
+    if(vkAllocateMemory(device, &alloc_info, VK_NULL_HANDLE, &p_buffer->mem) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_MEMORY, "Failed to allocate buffer memory of size %llu",
+            (unsigned long long)mem_req.size);
+    p_buffer_del->buffer.mem = p_buffer->mem;
+
+    if(vkBindBufferMemory(device, p_buffer->buffer, p_buffer->mem, 0) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_MEMORY, "Failed to bind buffer memory");
+
+    // Host visible buffers stay mapped, so writing them every frame costs nothing but the writes
+    if((mem_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+        if(vkMapMemory(device, p_buffer->mem, 0, VK_WHOLE_SIZE, 0, &p_buffer->p_mapped) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_MEMORY, "Failed to map buffer memory");
+    }
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+void vulkan_buffer_barrier(VkCommandBuffer cmd, VkBuffer buffer, VkPipelineStageFlags2 src_stage,
+    VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access)
+{
+    VkBufferMemoryBarrier2 buffer_barrier2 = {0};
+    buffer_barrier2.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    buffer_barrier2.srcStageMask = src_stage;
+    buffer_barrier2.srcAccessMask = src_access;
+    buffer_barrier2.dstStageMask = dst_stage;
+    buffer_barrier2.dstAccessMask = dst_access;
+    buffer_barrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier2.buffer = buffer;
+    buffer_barrier2.offset = 0;
+    buffer_barrier2.size = VK_WHOLE_SIZE;
+
+    VkDependencyInfo dep_info = {0};
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.bufferMemoryBarrierCount = 1;
+    dep_info.pBufferMemoryBarriers = &buffer_barrier2;
+
+    vkCmdPipelineBarrier2(cmd, &dep_info);
+}
+
+static bool find_memory_type(VkPhysicalDevice physical_device, uint32_t type_bits, VkMemoryPropertyFlags flags,
+    uint32_t* p_index)
+{
+    VkPhysicalDeviceMemoryProperties mem_prop;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_prop);
+
+    for(uint32_t i = 0; i < mem_prop.memoryTypeCount; ++i) {
+        if((type_bits & (1u << i)) != 0 && (mem_prop.memoryTypes[i].propertyFlags & flags) == flags) {
+            *p_index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void vulkan_buffer_deinit(void* p_void_buffer_del)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_buffer_del == NULL) {
+        LOG_ERROR("%s: p_void_buffer_del is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    buffer_del_t* p_buffer_del = (buffer_del_t*)p_void_buffer_del;
+
+    vkDestroyBuffer(p_buffer_del->device, p_buffer_del->buffer.buffer, VK_NULL_HANDLE);
+    vkFreeMemory(p_buffer_del->device, p_buffer_del->buffer.mem, VK_NULL_HANDLE);
+
+    free(p_buffer_del);
+    p_buffer_del = NULL;
+    p_void_buffer_del = NULL;
+}
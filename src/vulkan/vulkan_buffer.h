@@ -0,0 +1,53 @@
+#ifndef VULKAN_BUFFER_H_
+#define VULKAN_BUFFER_H_
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+
+/**
+ * \brief Create a buffer with its own memory allocation.
+ *
+ * If mem_flags contains VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT the memory is mapped for the lifetime of the buffer and
+ * p_mapped points at it, otherwise p_mapped is NULL.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] physical_device The physical device the memory type is picked from.
+ * \param[in] size Size of the buffer in bytes.
+ * \param[in] usage How the buffer is used.
+ * \param[in] mem_flags Properties the memory must have.
+ * \param[out] p_buffer Pointer to the allocated_buffer_t to create.
+ */
+error_t vulkan_buffer_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem_flags, allocated_buffer_t* p_buffer);
+
+/**
+ * \brief Create a buffer like vulkan_buffer_create that is also used on the async compute queue.
+ *
+ * The buffer is shared concurrently between the graphics and the compute family if the device has an async compute
+ * queue, so it needs no queue family ownership transfers. Otherwise it is exclusive to the graphics family like any
+ * other buffer.
+ *
+ * \param[in] p_queues The queue families, may be NULL for an exclusive buffer.
+ */
+error_t vulkan_buffer_create_shared(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem_flags, const queue_family_data_t* p_queues,
+    allocated_buffer_t* p_buffer);
+
+/**
+ * \brief Record a barrier on the whole of a buffer.
+ *
+ * \param[in] cmd The command buffer to record into.
+ * \param[in] buffer The buffer.
+ * \param[in] src_stage The stages the accesses before the barrier are made in.
+ * \param[in] src_access The accesses before the barrier that are made available.
+ * \param[in] dst_stage The stages that wait for the barrier.
+ * \param[in] dst_access The accesses after the barrier that the writes are made visible to.
+ */
+void vulkan_buffer_barrier(VkCommandBuffer cmd, VkBuffer buffer, VkPipelineStageFlags2 src_stage,
+    VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access);
+
+#endif // VULKAN_BUFFER_H_
@@ -72,13 +72,46 @@ error_t vulkan_cmd_frame_init(deletion_stack_t* p_dstack, VkDevice device, const
         }
     }
 
+    // Command buffers are tied to the family of their pool, so the async compute queue gets pools of its own
+    for(int i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        p_frames[i].compute_cmd_pool = VK_NULL_HANDLE;
+        p_frames[i].compute_cmd = VK_NULL_HANDLE;
+    }
+
+    if(!p_queues->async_compute) {
+        LOG_DEBUG("%s: Successful", __func__);
+        return SUCCESS;
+    }
+
+    cmd_pool_info.queueFamilyIndex = p_queues->compute_index;
+    for(int i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        if(vkCreateCommandPool(device, &cmd_pool_info, VK_NULL_HANDLE, &p_frames[i].compute_cmd_pool) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_POOL, "Failed to create frame compute command pool");
+
+        // CLEANUP
+        cmd_pool_del_t* p_cmd_pool = (cmd_pool_del_t*)malloc(sizeof(cmd_pool_del_t));
+        p_cmd_pool->device = device;
+        p_cmd_pool->cmd_pool = p_frames[i].compute_cmd_pool;
+
+        error_t err = deletion_stack_push(p_dstack, p_cmd_pool, vulkan_cmd_pool_deinit);
+        if(err.code != 0) {
+            vulkan_cmd_pool_deinit(p_cmd_pool);
+            return err;
+        }
+
+        render_cmd_alloc_info.commandPool = p_frames[i].compute_cmd_pool;
+
+        if(vkAllocateCommandBuffers(device, &render_cmd_alloc_info, &p_frames[i].compute_cmd) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "Failed to create frame compute command buffer");
+    }
+
     LOG_DEBUG("%s: Successful", __func__);
 
     return SUCCESS;
 }
 
-error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues, VkCommandPool* p_imm_cmd_pool,
-    VkCommandBuffer* p_imm_cmd_buff)
+error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    uint32_t cmds_count, VkCommandPool* p_imm_cmd_pool, VkCommandBuffer* p_imm_cmds)
 {
     if(device == NULL)
         return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
@@ -86,7 +119,7 @@ error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const q
     if(p_queues == NULL)
         return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_queues is NULL", __func__);
 
-    // Create immediate submit command pool and command buffer
+    // Create immediate submit command pool and command buffers. The buffers are reset one by one as they are reused.
     VkCommandPoolCreateInfo cmd_pool_info = {0};
 
     cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -96,16 +129,6 @@ error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const q
     if(vkCreateCommandPool(device, &cmd_pool_info, VK_NULL_HANDLE, p_imm_cmd_pool) != VK_SUCCESS)
         return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_POOL, "Failed to create immediate command pool");
 
-    VkCommandBufferAllocateInfo imm_cmd_alloc_info = {0};
-
-    imm_cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    imm_cmd_alloc_info.commandBufferCount = 1;
-    imm_cmd_alloc_info.commandPool = *p_imm_cmd_pool;
-    imm_cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-    if(vkAllocateCommandBuffers(device, &imm_cmd_alloc_info, p_imm_cmd_buff) != VK_SUCCESS)
-        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "Failed to create frame command buffer");
-
     // CLEANUP
     cmd_pool_del_t* p_cmd_pool = (cmd_pool_del_t*)malloc(sizeof(cmd_pool_del_t));
     p_cmd_pool->device = device;
@@ -117,6 +140,16 @@ error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const q
         return err;
     }
 
+    VkCommandBufferAllocateInfo imm_cmd_alloc_info = {0};
+
+    imm_cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    imm_cmd_alloc_info.commandBufferCount = cmds_count;
+    imm_cmd_alloc_info.commandPool = *p_imm_cmd_pool;
+    imm_cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+    if(vkAllocateCommandBuffers(device, &imm_cmd_alloc_info, p_imm_cmds) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "Failed to create immediate command buffers");
+
     LOG_DEBUG("%s: Successful", __func__);
 
     return SUCCESS;
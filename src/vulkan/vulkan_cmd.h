@@ -8,15 +8,16 @@
 #include "vulkan/vulkan_types.h"
 
 /**
- * Initiate the command pool and buffer in the frame_data_t.
+ * Initiate the command pool and buffer in the frame_data_t, and the compute command pool and buffer if the device has
+ * an async compute queue.
  */
 error_t vulkan_cmd_frame_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues, frame_data_t* p_frames);
 
 /**
- * Initiate the immediate command pool and command buffer
+ * Initiate the immediate command pool and cmds_count primary command buffers allocated from it.
  */
-error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues, VkCommandPool* p_imm_cmd_pool,
-    VkCommandBuffer* p_imm_cmd_buff);
+error_t vulkan_cmd_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    uint32_t cmds_count, VkCommandPool* p_imm_cmd_pool, VkCommandBuffer* p_imm_cmds);
 
 /**
  * Get a VkCommandBufferSubmitInfo.
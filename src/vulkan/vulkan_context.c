@@ -1,10 +1,16 @@
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <vulkan/vulkan_core.h>
 
+#include <SDL3/SDL_cpuinfo.h>
 #include <SDL3/SDL_error.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_video.h>
 #include <SDL3/SDL_vulkan.h>
 
 #include "logger.h"
@@ -17,19 +23,41 @@
 #include "vulkan/vulkan_device.h"
 #include "vulkan/vulkan_swapchain.h"
 #include "vulkan/vulkan_image.h"
+#include "vulkan/vulkan_buffer.h"
 #include "vulkan/vulkan_cmd.h"
 #include "vulkan/vulkan_sync.h"
 #include "vulkan/vulkan_descriptor.h"
 #include "vulkan/vulkan_pipeline.h"
+#include "vulkan/vulkan_query.h"
+#include "vulkan/vulkan_dynres.h"
+#include "vulkan/vulkan_frame_arena.h"
+#include "vulkan/vulkan_imm.h"
+#include "vulkan/vulkan_recorder.h"
+#include "vulkan/vulkan_particle_batch.h"
+#include "vulkan/vulkan_sprite_batch.h"
 #include "vulkan/vulkan_context.h"
 
 #include "util/deletion_stack.h"
+#include "util/job_system.h"
 
 #include "SDL/sdl_backend.h"
 
 #define HEIGHT 1080
 #define WIDTH  1920
 
+// Number of frames between each log of the gpu timings
+#define GPU_TIMINGS_LOG_INTERVAL 600
+
+// Lowest render scale the dynamic resolution controller may use
+#define DYNRES_MIN_SCALE 0.5f
+
+// Longest time to wait for a frame to reach the screen in the low latency present policy. Presents can stall for a long
+// time while the window is hidden, the frame loop must keep running anyway.
+#define PRESENT_WAIT_TIMEOUT_NS 100000000ull
+
+// Downward acceleration of the particles in world units per second squared
+#define PARTICLE_GRAVITY 6.0f
+
 static const uint32_t device_extensions_count = 1;
 static const char* const device_extensions[1] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
@@ -57,7 +85,170 @@ typedef struct surface_del_struct_s {
 static void surface_destroy(void* p_void_surface_del_struct);
 
 static void draw_background(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout pipeline_layout,
-    VkDescriptorSet desc_set, VkExtent2D draw_extent);
+    VkDescriptorSet desc_set, const background_push_constants_t* p_push, VkExtent2D draw_extent);
+
+/**
+ * The data the background pass is recorded from.
+ */
+typedef struct background_pass_s {
+    VkPipeline pipeline;
+    VkPipelineLayout pipeline_layout;
+    VkDescriptorSet desc_set;
+    VkExtent2D draw_extent;
+    background_push_constants_t push;
+} background_pass_t;
+
+/**
+ * Record function of the background pass, p_data is a background_pass_t.
+ */
+static void record_background(VkCommandBuffer cmd, void* p_data);
+
+/**
+ * The indirect buffer of the static sprites. Must match the layout of the indirect buffer in sprite_cull.comp.
+ */
+typedef struct sprite_indirect_s {
+    VkDrawIndirectCommand p_commands[SPRITE_MATERIAL_COUNT]; // instanceCount is the number of sprites left
+    uint32_t p_draw_counts[SPRITE_MATERIAL_COUNT];           // 1 if any sprite of the material is left, else 0
+} sprite_indirect_t;
+
+/**
+ * The data the cull pass is recorded from.
+ */
+typedef struct cull_pass_s {
+    VkPipeline pipeline;
+    VkPipelineLayout pipeline_layout;
+    VkDescriptorSet desc_set;
+    VkBuffer culled;
+    VkBuffer indirect;
+    sprite_indirect_t indirect_init; // Empty draws starting at the slice of each material
+    sprite_cull_push_constants_t push;
+} cull_pass_t;
+
+/**
+ * Record function of the cull pass, p_data is a cull_pass_t. The pass resets the indirect draws, culls the static
+ * sprites into them and makes the result visible to the indirect draws of the sprite pass.
+ */
+static void record_cull(VkCommandBuffer cmd, void* p_data);
+
+/**
+ * The data the particle pass is recorded from.
+ */
+typedef struct particle_pass_s {
+    VkPipeline emit_pipeline;
+    VkPipeline sim_pipeline;
+    VkPipelineLayout pipeline_layout;
+    VkDescriptorSet desc_set;
+    uint32_t emitters_offset; // Dynamic offset of the emitters of the frame
+    VkBuffer instances;
+    VkBuffer motions;
+    VkBuffer head;
+    uint32_t used; // Slots of the ring to move, after the emitters of the frame
+    bool async;    // Recorded for the async compute queue, the semaphores order it against the sprite pass
+    particle_push_constants_t push;
+} particle_pass_t;
+
+/**
+ * Record function of the particle pass, p_data is a particle_pass_t. The pass spawns the particles of the emitters of
+ * the frame, moves every particle of the ring and makes the result visible to the vertex shader of the sprite pass.
+ */
+static void record_particles(VkCommandBuffer cmd, void* p_data);
+
+/**
+ * \brief Record the particle pass into the compute command buffer of the frame and submit it to the async compute
+ * queue.
+ *
+ * The submit waits for the sprite pass of the last frame to be done drawing the ring and for the immediate batch with
+ * imm_value, and signals the next value of the compute timeline for the frame submit to wait on.
+ */
+static VkResult submit_async_particles(vulkan_context_t* p_ctx, frame_data_t* p_frame, particle_pass_t* p_pass,
+    uint64_t imm_value);
+
+/**
+ * The data the sprite pass is recorded from.
+ */
+typedef struct sprite_pass_s {
+    const VkPipeline* p_pipelines; // Indexed by material
+    VkPipelineLayout pipeline_layout;
+    VkDescriptorSet desc_set;
+    uint32_t desc_offset;            // Dynamic offset of the instances of the frame
+    VkDescriptorSet static_desc_set; // The culled static sprites
+    VkBuffer indirect;               // The indirect draws of the static sprites, VK_NULL_HANDLE if there are none
+    bool draw_indirect_count;
+    VkDescriptorSet particle_desc_set; // The particle ring
+    uint32_t particles_count;          // Slots of the ring to draw, 0 if none were ever written
+    VkExtent2D draw_extent;
+    uint32_t p_counts[SPRITE_MATERIAL_COUNT];
+    sprite_push_constants_t push;
+} sprite_pass_t;
+
+/**
+ * Record function of the sprite pass, p_data is a sprite_pass_t. The pass is executed inside dynamic rendering to the
+ * draw image. The static sprites left by the cull pass are drawn first with an indirect draw per material, then the
+ * sprites of the batch with a single instanced draw per material and last the particles with one draw of the ring.
+ */
+static void record_sprites(VkCommandBuffer cmd, void* p_data);
+
+/**
+ * Create the buffers, descriptor sets and pipeline of the static sprites, with no sprites uploaded.
+ */
+static error_t static_sprites_init(vulkan_context_t* p_ctx);
+
+/**
+ * Create the buffers, descriptor sets and pipelines of the particle system, with an empty ring.
+ */
+static error_t particle_system_init(vulkan_context_t* p_ctx);
+
+/**
+ * Create the frame arena buffer and the arena over it, every allocation aligned to the offset alignment limits of the
+ * device.
+ */
+static error_t frame_arena_buffer_init(vulkan_context_t* p_ctx);
+
+/**
+ * Create the mip views, descriptor sets and pipelines of the bloom pyramid on the mips of the draw image.
+ */
+static error_t bloom_init(vulkan_context_t* p_ctx);
+
+/**
+ * \brief Record the bloom pyramid of the draw extent, down to the smallest level and back up to mip 1.
+ *
+ * The draw image must be in VK_IMAGE_LAYOUT_GENERAL with the sprites written to mip 0.
+ */
+static void record_bloom(VkCommandBuffer cmd, const bloom_t* p_bloom, VkImage draw_image, VkExtent2D draw_extent,
+    VkQueryPool timestamps);
+
+/**
+ * \brief Flush the deletion stack a staging buffer was created on.
+ *
+ * \param[in] p_void_dstack Pointer to the deletion_stack_t.
+ */
+static void staging_deinit(void* p_void_dstack);
+
+/**
+ * \brief Record the present compute pass which writes the draw image to the swapchain image.
+ *
+ * The draw image and the swapchain image must be in VK_IMAGE_LAYOUT_GENERAL.
+ */
+static void draw_present(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout pipeline_layout,
+    VkDescriptorSet desc_set, const present_push_constants_t* p_push, VkExtent2D swapchain_extent);
+
+/**
+ * Check if a format is one of the 8 bit sRGB formats, for which the sRGB encode is done by the hardware.
+ */
+static bool format_is_srgb(VkFormat format);
+
+/**
+ * Log the moving average of the gpu timings.
+ */
+static void log_gpu_timings(const gpu_timings_t* p_timings, present_path_t present_path);
+
+/**
+ * \brief Wait for the device to go idle and recreate the swapchain with the current present policy.
+ *
+ * Everything that references the swapchain images is updated. On failure swapchain_dirty stays set so it is tried
+ * again next frame.
+ */
+static error_t recreate_swapchain(vulkan_context_t* p_ctx);
 
 error_t vulkan_init(vulkan_context_t* p_ctx)
 {
@@ -82,6 +273,12 @@ error_t vulkan_init(vulkan_context_t* p_ctx)
     if(err.code != 0)
         return err;
 
+    // Initiate the job system shared by the renderer and the game, one worker per logical core including this thread
+    int cpu_count = SDL_GetNumLogicalCPUCores();
+    err = job_system_init(p_ctx->p_dstack, cpu_count > 0 ? (uint32_t)cpu_count : 1, &p_ctx->jobs);
+    if(err.code != 0)
+        return err;
+
     // Initiate vulkan instance
     err = vulkan_instance_init(p_ctx->p_dstack, &p_ctx->instance);
     if(err.code != 0)
@@ -114,19 +311,32 @@ error_t vulkan_init(vulkan_context_t* p_ctx)
         return err;
 
     // Initiate device
-    err = vulkan_device_init(p_ctx->p_dstack, p_ctx->surface, p_ctx->physical_device, &p_ctx->device, &p_ctx->queues);
+    err = vulkan_device_init(p_ctx->p_dstack, p_ctx->surface, p_ctx->physical_device, &p_ctx->device, &p_ctx->queues,
+        &p_ctx->device_caps);
     if(err.code != 0)
         return err;
 
+    // vkWaitForPresentKHR is a device extension function which is not exported by the loader, so it is looked up
+    p_ctx->pfn_wait_for_present = NULL;
+    if(p_ctx->device_caps.present_wait)
+        p_ctx->pfn_wait_for_present = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(p_ctx->device,
+            "vkWaitForPresentKHR");
+
+    // Mailbox is the default, it was the only present mode before the present policy could be changed at runtime
+    p_ctx->present_policy = PRESENT_POLICY_MAILBOX;
+    p_ctx->present_id = 0;
+    p_ctx->swapchain_dirty = false;
+
     // Initiate swapchain
     err = vulkan_swapchain_init(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, p_ctx->surface, p_ctx->p_window,
-        &p_ctx->vulkan_swapchain);
+        p_ctx->present_policy, &p_ctx->vulkan_swapchain);
     if(err.code != 0)
         return err;
 
-    // Create draw image
+    // Create draw image, its mips below mip 0 hold the bloom pyramid
+    p_ctx->bloom.mips_count = bloom_mips_count(p_ctx->window_extent.width, p_ctx->window_extent.height);
     err = vulkan_image_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, p_ctx->window_extent.width,
-        p_ctx->window_extent.height, &p_ctx->draw_image);
+        p_ctx->window_extent.height, 1 + p_ctx->bloom.mips_count, &p_ctx->draw_image);
     if(err.code != 0) {
         LOG_ERROR("Failed to create image");
         return err;
@@ -137,9 +347,8 @@ error_t vulkan_init(vulkan_context_t* p_ctx)
     if(err.code != 0)
         return err;
 
-    // Initiate immediate cmd
-    err = vulkan_cmd_imm_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->queues, &p_ctx->imm_cmd_pool,
-        &p_ctx->imm_cmd_buffer);
+    // Initiate the parallel command recorder on the job system workers
+    err = vulkan_recorder_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->queues, &p_ctx->jobs, &p_ctx->recorder);
     if(err.code != 0)
         return err;
 
@@ -148,11 +357,19 @@ error_t vulkan_init(vulkan_context_t* p_ctx)
     if(err.code != 0)
         return err;
 
-    // Initiate immediate sync structs
-    err = vulkan_sync_imm_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->imm_fence);
+    // Initiate the immediate submit batcher
+    err = vulkan_imm_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->queues, &p_ctx->imm);
     if(err.code != 0)
         return err;
 
+    // The particle pass moves to the async compute queue when there is one
+    p_ctx->async_compute = (async_compute_t){0};
+    if(p_ctx->queues.async_compute) {
+        err = vulkan_sync_async_compute_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->async_compute);
+        if(err.code != 0)
+            return err;
+    }
+
     err = vulkan_descriptor_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->draw_image, &p_ctx->desc_alloc,
         &p_ctx->draw_img_desc, &p_ctx->draw_img_desc_layout);
     if(err.code != 0)
@@ -163,6 +380,102 @@ error_t vulkan_init(vulkan_context_t* p_ctx)
     if(err.code != 0)
         return err;
 
+    // A deep blue fading to near black, with slow bands of light. The draw image is linear HDR.
+    background_push_constants_t background = {
+        {0.02f, 0.04f, 0.12f, 1.0f},
+        {0.0f, 0.0f, 0.02f, 1.0f},
+        {0.0f, 0.0f},
+        0.0f,
+        0.5f,
+        0.04f,
+        6.2831853f
+    };
+    p_ctx->background = background;
+    p_ctx->start_ns = SDL_GetTicksNS();
+
+    // Initiate the timestamp queries used to measure the gpu time of each pass
+    err = vulkan_query_timestamp_init(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, &p_ctx->queues,
+        p_ctx->p_frames, &p_ctx->gpu_timings);
+    if(err.code != 0)
+        return err;
+
+    // The dynamic resolution controller holds the GPU frame time under the refresh interval of the display the window
+    // is on, or 60 Hz if the refresh rate is unknown. It needs the frame timestamps to do anything.
+    double refresh_rate = 60.0;
+    const SDL_DisplayMode* p_display_mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(p_ctx->p_window));
+    if(p_display_mode != NULL && p_display_mode->refresh_rate > 0.0f)
+        refresh_rate = (double)p_display_mode->refresh_rate;
+
+    dynres_init(&p_ctx->dynres, 1000.0 / refresh_rate, DYNRES_MIN_SCALE, 1.0f);
+    if(!p_ctx->gpu_timings.supported)
+        dynres_set_enabled(&p_ctx->dynres, false);
+
+    LOG_DEBUG("Dynamic resolution target: %.2f ms", p_ctx->dynres.target_ms);
+
+    // The present compute pass is only available if the swapchain images can be written from a compute shader,
+    // otherwise the draw image is always blitted
+    p_ctx->present_path = PRESENT_PATH_BLIT;
+    p_ctx->exposure = 1.0f;
+    p_ctx->draw_img_sampler = VK_NULL_HANDLE;
+    p_ctx->present_desc_layout = VK_NULL_HANDLE;
+    p_ctx->present_pipeline = VK_NULL_HANDLE;
+    p_ctx->present_upscale_pipeline = VK_NULL_HANDLE;
+    p_ctx->upscale_filter = UPSCALE_FILTER_LINEAR;
+    p_ctx->sharpness = 0.8f;
+    p_ctx->present_pipeline_layout = VK_NULL_HANDLE;
+
+    if(p_ctx->vulkan_swapchain.storage_capable) {
+        err = vulkan_image_sampler_init(p_ctx->p_dstack, p_ctx->device, VK_FILTER_LINEAR, &p_ctx->draw_img_sampler);
+        if(err.code != 0)
+            return err;
+
+        err = bloom_init(p_ctx);
+        if(err.code != 0)
+            return err;
+
+        err = vulkan_descriptor_present_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->desc_alloc,
+            p_ctx->draw_img_sampler, &p_ctx->draw_image, p_ctx->bloom.p_views[1], &p_ctx->vulkan_swapchain,
+            p_ctx->p_present_descs, &p_ctx->present_desc_layout);
+        if(err.code != 0)
+            return err;
+
+        err = vulkan_pipeline_present_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->present_desc_layout,
+            &p_ctx->present_pipeline_layout, &p_ctx->present_pipeline, &p_ctx->present_upscale_pipeline);
+        if(err.code != 0)
+            return err;
+
+        p_ctx->present_path = PRESENT_PATH_COMPUTE;
+    }
+    else {
+        LOG_INFO("Swapchain images are not storage capable, using the blit present path");
+    }
+
+    // The sprites of each frame are written straight into the frame arena, which stays mapped. They are read once per
+    // vertex, so they are not worth staging into device local memory.
+    err = frame_arena_buffer_init(p_ctx);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_descriptor_sprite_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->desc_alloc, &p_ctx->arena_buffer,
+        (VkDeviceSize)sprite_batch_buffer_size(), &p_ctx->sprite_desc, &p_ctx->sprite_desc_layout);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_pipeline_sprite_init(p_ctx->p_dstack, p_ctx->device, p_ctx->draw_image.format,
+        &p_ctx->sprite_desc_layout, &p_ctx->sprite_pipeline_layout, p_ctx->p_sprite_pipelines);
+    if(err.code != 0)
+        return err;
+
+    sprite_batch_init(&p_ctx->sprites);
+
+    err = static_sprites_init(p_ctx);
+    if(err.code != 0)
+        return err;
+
+    err = particle_system_init(p_ctx);
+    if(err.code != 0)
+        return err;
+
     // err = imgui_init(p_ctx->p_dstack, p_ctx->instance, p_ctx->physical_device, p_ctx->device, p_ctx->p_window,
     //     p_ctx->queues.graphics, &p_ctx->vulkan_swapchain.format);
 
@@ -236,104 +549,449 @@ static void surface_destroy(void* p_void_surface_del_struct)
     p_void_surface_del_struct = NULL;
 }
 
+bool vulkan_begin_frame(vulkan_context_t* p_ctx)
+{
+    if(p_ctx == NULL)
+        return false;
+
+    uint32_t frame_index = (uint32_t)(p_ctx->frame_count % FRAMES_IN_FLIGHT);
+    frame_data_t* p_frame = &p_ctx->p_frames[frame_index];
+
+    // Nothing can be pushed until the frame has been waited for
+    sprite_batch_begin(&p_ctx->sprites, NULL);
+    particle_batch_begin(&p_ctx->particles, NULL, 0.0f);
+
+    // The swapchain was out of date or the window was resized, a failure here usually means the window is minimized
+    if(p_ctx->swapchain_dirty) {
+        error_t err = recreate_swapchain(p_ctx);
+        if(err.code != 0) {
+            LOG_DEBUG("Skipping frame, failed to recreate swapchain: %s", err.msg);
+            error_deinit(&err);
+            return false;
+        }
+    }
+
+    // Wait until device has finished rendering the last frame. TIMEOUT of UINT64_MAX nanoseconds
+    VkResult vk_result = vkWaitForFences(p_ctx->device, 1, &p_frame->render_fence, VK_TRUE, UINT64_MAX);
+    if(vk_result != VK_SUCCESS)
+        return false;
+
+    // The frame has finished on the GPU, so its timestamps can be read back without waiting
+    if(p_frame->timestamps_written) {
+        vulkan_query_timestamp_collect(p_ctx->device, p_frame->timestamp_pool, &p_ctx->gpu_timings);
+
+        if(p_ctx->frame_count % GPU_TIMINGS_LOG_INTERVAL == 0)
+            log_gpu_timings(&p_ctx->gpu_timings, p_ctx->present_path);
+
+        dynres_update(&p_ctx->dynres, p_ctx->gpu_timings.p_last_ms[GPU_SCOPE_FRAME]);
+    }
+
+    // The GPU is done with the arena slice of this frame, the sprites and emitters of the new frame go straight into it
+    frame_arena_begin(&p_ctx->arena, frame_index);
+
+    p_ctx->sprites_offset = 0;
+    void* p_instances = frame_arena_alloc(&p_ctx->arena, sprite_batch_buffer_size(), 16, &p_ctx->sprites_offset);
+    sprite_batch_begin(&p_ctx->sprites, p_instances);
+
+    // The particles are moved by the time between frames, so they keep their speed whatever the frame rate is
+    uint64_t now_ns = SDL_GetTicksNS();
+    float dt = p_ctx->last_frame_ns == 0 ? 0.0f : (float)((double)(now_ns - p_ctx->last_frame_ns) / 1e9);
+    p_ctx->last_frame_ns = now_ns;
+
+    p_ctx->emitters_offset = 0;
+    void* p_emitters = frame_arena_alloc(&p_ctx->arena, particle_batch_buffer_size(), 16, &p_ctx->emitters_offset);
+    particle_batch_begin(&p_ctx->particles, p_emitters, dt);
+
+    return true;
+}
+
 void vulkan_render_and_present_frame(vulkan_context_t* p_ctx)
 {
     // The the current frame
-    frame_data_t frame = p_ctx->p_frames[p_ctx->frame_count % FRAMES_IN_FLIGHT];
+    uint32_t frame_index = (uint32_t)(p_ctx->frame_count % FRAMES_IN_FLIGHT);
+    frame_data_t* p_frame = &p_ctx->p_frames[frame_index];
 
     VkResult vk_result = VK_SUCCESS;
 
-    // Wait until device has finished rendering the last frame. TIMEOUT of UINT64_MAX nanoseconds
-    vk_result = vkWaitForFences(p_ctx->device, 1, &frame.render_fence, VK_TRUE, UINT64_MAX);
-    if(vk_result != VK_SUCCESS)
-        return;
-
     // Flush the current frames deletion stack
     // deletion_stack_flush(&frame.p_del_stack);
 
-    // Reset render fence
-    vk_result = vkResetFences(p_ctx->device, 1, &frame.render_fence);
-    if(vk_result != VK_SUCCESS)
+    // Never render more pixels than the swapchain shows, and scale down from there by the dynamic resolution scale.
+    // The present pass scales the draw extent back up to the swapchain extent.
+    uint32_t base_width = p_ctx->draw_image.extent.width < p_ctx->vulkan_swapchain.extent.width ?
+        p_ctx->draw_image.extent.width :
+        p_ctx->vulkan_swapchain.extent.width;
+    uint32_t base_height = p_ctx->draw_image.extent.height < p_ctx->vulkan_swapchain.extent.height ?
+        p_ctx->draw_image.extent.height :
+        p_ctx->vulkan_swapchain.extent.height;
+
+    dynres_apply(&p_ctx->dynres, base_width, base_height, &p_ctx->draw_extent.width, &p_ctx->draw_extent.height);
+
+    // The passes are recorded into secondary command buffers by the recorder workers. None of them depend on the
+    // swapchain image, so they are recorded before the image is acquired and the primary only executes them.
+    error_t err = vulkan_recorder_begin_frame(&p_ctx->recorder, frame_index);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
+        return;
+    }
+
+    background_pass_t background_pass = {0};
+    background_pass.pipeline = p_ctx->gradient_pipline;
+    background_pass.pipeline_layout = p_ctx->gradient_pipline_layout;
+    background_pass.desc_set = p_ctx->draw_img_desc;
+    background_pass.draw_extent = p_ctx->draw_extent;
+    background_pass.push = p_ctx->background;
+    background_pass.push.inv_extent[0] = 1.0f / (float)(p_ctx->draw_extent.width > 0 ? p_ctx->draw_extent.width : 1);
+    background_pass.push.inv_extent[1] = 1.0f / (float)(p_ctx->draw_extent.height > 0 ? p_ctx->draw_extent.height : 1);
+    uint64_t elapsed_ns = p_ctx->last_frame_ns > p_ctx->start_ns ? p_ctx->last_frame_ns - p_ctx->start_ns : 0;
+    background_pass.push.time = (float)((double)elapsed_ns / 1e9);
+
+    // The static sprites are culled against the same view the sprites are drawn with
+    const static_sprites_t* p_static = &p_ctx->static_sprites;
+    bool cull_static = p_static->count > 0;
+
+    cull_pass_t cull_pass = {0};
+    cull_pass.pipeline = p_static->cull_pipeline;
+    cull_pass.pipeline_layout = p_static->cull_pipeline_layout;
+    cull_pass.desc_set = p_static->p_cull_descs[frame_index];
+    cull_pass.culled = p_static->p_culled[frame_index].buffer;
+    cull_pass.indirect = p_static->p_indirect[frame_index].buffer;
+    for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i) {
+        cull_pass.indirect_init.p_commands[i].vertexCount = 6;
+        cull_pass.indirect_init.p_commands[i].firstInstance = (uint32_t)i * SPRITE_MAX_STATIC_INSTANCES;
+    }
+    cull_pass.push.view_scale[0] = p_ctx->sprites.view_scale[0];
+    cull_pass.push.view_scale[1] = p_ctx->sprites.view_scale[1];
+    cull_pass.push.view_offset[0] = p_ctx->sprites.view_offset[0];
+    cull_pass.push.view_offset[1] = p_ctx->sprites.view_offset[1];
+    cull_pass.push.count = p_static->count;
+
+    // The ring fills up from the start, until it first wraps only the slots written so far are moved and drawn
+    particle_system_t* p_particles = &p_ctx->particle_system;
+    uint32_t ring_left = PARTICLE_MAX_COUNT - p_particles->used;
+    p_particles->used += p_ctx->particles.particles_count < ring_left ? p_ctx->particles.particles_count : ring_left;
+    bool move_particles = p_particles->used > 0;
+
+    // The particles only share the ring with the sprite pass, so on an async compute queue they are moved while the
+    // graphics queue fills in the background and culls the static sprites
+    bool async_particles = move_particles && p_ctx->queues.async_compute;
+
+    particle_pass_t particle_pass = {0};
+    particle_pass.emit_pipeline = p_particles->emit_pipeline;
+    particle_pass.sim_pipeline = p_particles->sim_pipeline;
+    particle_pass.pipeline_layout = p_particles->pipeline_layout;
+    particle_pass.desc_set = p_particles->desc;
+    particle_pass.emitters_offset = p_ctx->emitters_offset;
+    particle_pass.instances = p_particles->instances.buffer;
+    particle_pass.motions = p_particles->motions.buffer;
+    particle_pass.head = p_particles->head.buffer;
+    particle_pass.used = p_particles->used;
+    particle_pass.async = async_particles;
+    particle_pass.push.dt = p_ctx->particles.dt;
+    particle_pass.push.gravity = PARTICLE_GRAVITY;
+    particle_pass.push.emitters_count = p_ctx->particles.emitters_count;
+
+    if(p_ctx->particles.dropped > 0)
+        LOG_WARN("%u particles did not fit in the particle ring", p_ctx->particles.dropped);
+
+    // Background first, the optional passes after it in the order they are executed
+    record_job_t p_jobs[3] = {0};
+    uint32_t jobs_count = 0;
+    p_jobs[jobs_count].record = record_background;
+    p_jobs[jobs_count++].p_data = &background_pass;
+
+    uint32_t cull_job = jobs_count;
+    if(cull_static) {
+        p_jobs[jobs_count].record = record_cull;
+        p_jobs[jobs_count++].p_data = &cull_pass;
+    }
+
+    uint32_t particle_job = jobs_count;
+    if(move_particles && !async_particles) {
+        p_jobs[jobs_count].record = record_particles;
+        p_jobs[jobs_count++].p_data = &particle_pass;
+    }
+
+    VkCommandBuffer p_pass_cmds[3] = {0};
+    err = vulkan_recorder_record(&p_ctx->recorder, NULL, p_jobs, jobs_count, p_pass_cmds);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
         return;
+    }
 
-    // Request image from the swapchain
+    // The sprite pass is executed inside dynamic rendering, so it is recorded in a batch of its own
+    sprite_pass_t sprite_pass = {0};
+    sprite_pass.p_pipelines = p_ctx->p_sprite_pipelines;
+    sprite_pass.pipeline_layout = p_ctx->sprite_pipeline_layout;
+    sprite_pass.desc_set = p_ctx->sprite_desc;
+    sprite_pass.desc_offset = p_ctx->sprites_offset;
+    sprite_pass.static_desc_set = p_static->p_draw_descs[frame_index];
+    sprite_pass.indirect = cull_static ? p_static->p_indirect[frame_index].buffer : VK_NULL_HANDLE;
+    sprite_pass.draw_indirect_count = p_ctx->device_caps.draw_indirect_count;
+    sprite_pass.particle_desc_set = p_particles->draw_desc;
+    sprite_pass.particles_count = p_particles->used;
+    sprite_pass.draw_extent = p_ctx->draw_extent;
+    for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i)
+        sprite_pass.p_counts[i] = p_ctx->sprites.p_counts[i];
+    sprite_pass.push.view_scale[0] = p_ctx->sprites.view_scale[0];
+    sprite_pass.push.view_scale[1] = p_ctx->sprites.view_scale[1];
+    sprite_pass.push.view_offset[0] = p_ctx->sprites.view_offset[0];
+    sprite_pass.push.view_offset[1] = p_ctx->sprites.view_offset[1];
+
+    if(p_ctx->sprites.dropped > 0)
+        LOG_WARN("%u sprites did not fit in the instance buffer", p_ctx->sprites.dropped);
+
+    VkCommandBufferInheritanceRenderingInfo sprite_rendering_info = {0};
+    sprite_rendering_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    sprite_rendering_info.colorAttachmentCount = 1;
+    sprite_rendering_info.pColorAttachmentFormats = &p_ctx->draw_image.format;
+    sprite_rendering_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    record_job_t sprite_job = {0};
+    sprite_job.record = record_sprites;
+    sprite_job.p_data = &sprite_pass;
+
+    VkCommandBuffer sprite_cmd = VK_NULL_HANDLE;
+    err = vulkan_recorder_record(&p_ctx->recorder, &sprite_rendering_info, &sprite_job, 1, &sprite_cmd);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
+        return;
+    }
+
+    // Submit the immediate work recorded since the last frame. The frame submit waits on its timeline value.
+    uint64_t imm_value = 0;
+    err = vulkan_imm_flush(&p_ctx->imm, &imm_value);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
+        return;
+    }
+
+    // Request image from the swapchain. This is done before the fence is reset, so the fence is still signaled for the
+    // next attempt if the swapchain turns out to be out of date.
     uint32_t index = 0;
     vk_result = vkAcquireNextImageKHR(p_ctx->device, p_ctx->vulkan_swapchain.swapchain, UINT64_MAX,
-        frame.swapchain_semaphore, VK_NULL_HANDLE, &index);
-    if(vk_result != VK_SUCCESS)
+        p_frame->swapchain_semaphore, VK_NULL_HANDLE, &index);
+    if(vk_result == VK_ERROR_OUT_OF_DATE_KHR) {
+        p_ctx->swapchain_dirty = true;
         return;
+    }
 
-    // Recreate swapchain if Failed
+    // A suboptimal swapchain can still be presented to, it is recreated after this frame
+    if(vk_result == VK_SUBOPTIMAL_KHR)
+        p_ctx->swapchain_dirty = true;
+    else if(vk_result != VK_SUCCESS)
+        return;
+
+    // Reset render fence
+    vk_result = vkResetFences(p_ctx->device, 1, &p_frame->render_fence);
+    if(vk_result != VK_SUCCESS)
+        return;
 
     // Reset cmd buffer
-    vk_result = vkResetCommandBuffer(frame.cmd, 0);
+    vk_result = vkResetCommandBuffer(p_frame->cmd, 0);
     if(vk_result != VK_SUCCESS)
         return;
 
+    // Submitted once the fence is reset, a skipped frame would otherwise leave the compute work unwaited for
+    if(async_particles) {
+        vk_result = submit_async_particles(p_ctx, p_frame, &particle_pass, imm_value);
+        if(vk_result != VK_SUCCESS)
+            return;
+    }
+
     // LOG_TRACE("draw_image.extent.width: %u", p_ctx->draw_image.extent.width);
     // LOG_TRACE("draw_image.extent.height: %u", p_ctx->draw_image.extent.height);
 
-    p_ctx->draw_extent.width = p_ctx->draw_image.extent.width;
-    p_ctx->draw_extent.height = p_ctx->draw_image.extent.height;
-
     // Start cmd buffer recording
     VkCommandBufferBeginInfo cmd_begin_info = {0};
     cmd_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    vk_result = vkBeginCommandBuffer(frame.cmd, &cmd_begin_info);
+    VkCommandBuffer cmd = p_frame->cmd;
+    VkQueryPool timestamps = p_frame->timestamp_pool;
+
+    vk_result = vkBeginCommandBuffer(cmd, &cmd_begin_info);
     if(vk_result != VK_SUCCESS)
         return;
 
+    vulkan_query_timestamp_reset(cmd, timestamps);
+    vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_FRAME);
+
     // Transition our main draw image into general layout so we can write into it, we will overwrite it all so we dont
     // need to care about what the previous layout was
-    vulkan_image_transition(frame.cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    vulkan_image_transition(cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+
+    vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_BACKGROUND);
+    vkCmdExecuteCommands(cmd, 1, &p_pass_cmds[0]);
+    vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_BACKGROUND);
+
+    if(cull_static) {
+        vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_CULL);
+        vkCmdExecuteCommands(cmd, 1, &p_pass_cmds[cull_job]);
+        vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_CULL);
+    }
+
+    // Timestamps are only written on the graphics queue, the particles are not timed while they run asynchronously
+    if(move_particles && !async_particles) {
+        vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_PARTICLES);
+        vkCmdExecuteCommands(cmd, 1, &p_pass_cmds[particle_job]);
+        vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_PARTICLES);
+    }
 
-    draw_background(frame.cmd, p_ctx->gradient_pipline, p_ctx->gradient_pipline_layout, p_ctx->draw_img_desc,
-        p_ctx->draw_extent);
+    // The sprites are drawn over the background with dynamic rendering, the draw image goes back to the general layout
+    // afterwards so the present passes see it as before
+    vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_SPRITES);
+    vulkan_image_transition(cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_GENERAL,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    VkRenderingAttachmentInfo color_attachment = {0};
+    color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    color_attachment.imageView = p_ctx->draw_image.image_view;
+    color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+    VkRenderingInfo rendering_info = {0};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    rendering_info.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    rendering_info.renderArea.extent = p_ctx->draw_extent;
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachments = &color_attachment;
+
+    vkCmdBeginRendering(cmd, &rendering_info);
+    vkCmdExecuteCommands(cmd, 1, &sprite_cmd);
+    vkCmdEndRendering(cmd);
+
+    vulkan_image_transition(cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        VK_IMAGE_LAYOUT_GENERAL);
+    vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_SPRITES);
+
+    if(p_ctx->present_path == PRESENT_PATH_COMPUTE) {
+        record_bloom(cmd, &p_ctx->bloom, p_ctx->draw_image.image, p_ctx->draw_extent, timestamps);
+
+        vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_PRESENT_COMPUTE);
+
+        // The draw image stays in the general layout, the transition only makes the background writes visible to the
+        // present pass. The swapchain image is written as a storage image so it also goes to the general layout.
+        vulkan_image_transition(cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+        vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_GENERAL);
+
+        present_push_constants_t push = {0};
+        push.sharpness = p_ctx->sharpness;
+        push.uv_scale[0] = (float)p_ctx->draw_extent.width / (float)p_ctx->draw_image.extent.width;
+        push.uv_scale[1] = (float)p_ctx->draw_extent.height / (float)p_ctx->draw_image.extent.height;
+        push.exposure = p_ctx->exposure;
+        push.encode_srgb = format_is_srgb(p_ctx->vulkan_swapchain.format) ? 0 : 1;
+
+        // Mip 1 holds the sum of every level, so the strength is split between them
+        if(p_ctx->bloom.mips_count > 0)
+            push.bloom_strength = p_ctx->bloom.strength / (float)p_ctx->bloom.mips_count;
+
+        // The edge adaptive filter only pays off when scaling up, at native resolution it would resample 1:1
+        VkPipeline present_pipeline = p_ctx->present_pipeline;
+        if(p_ctx->upscale_filter == UPSCALE_FILTER_EDGE &&
+            (p_ctx->draw_extent.width < p_ctx->vulkan_swapchain.extent.width ||
+                p_ctx->draw_extent.height < p_ctx->vulkan_swapchain.extent.height))
+            present_pipeline = p_ctx->present_upscale_pipeline;
+
+        draw_present(cmd, present_pipeline, p_ctx->present_pipeline_layout, p_ctx->p_present_descs[index], &push,
+            p_ctx->vulkan_swapchain.extent);
+
+        vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_GENERAL,
+            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+        vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_PRESENT_COMPUTE);
+    }
+    else {
+        vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_PRESENT_BLIT);
 
-    // Transition the draw image and the swapchain image to the correct transfer layouts
-    vulkan_image_transition(frame.cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_GENERAL,
-        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-    vulkan_image_transition(frame.cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        // Transition the draw image and the swapchain image to the correct transfer layouts
+        vulkan_image_transition(cmd, p_ctx->draw_image.image, VK_IMAGE_LAYOUT_GENERAL,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    // Execute a blit from the draw image to the swapchain image
-    vulkan_image_copy_image_to_image(frame.cmd, p_ctx->draw_image.image, p_ctx->vulkan_swapchain.p_images[index],
-        p_ctx->draw_extent, p_ctx->vulkan_swapchain.extent);
+        // Execute a blit from the draw image to the swapchain image
+        vulkan_image_copy_image_to_image(cmd, p_ctx->draw_image.image, p_ctx->vulkan_swapchain.p_images[index],
+            p_ctx->draw_extent, p_ctx->vulkan_swapchain.extent);
 
-    // Set swapchin image layout to Color Attachment Optimal so imgui can render into it
-    // vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-    //     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        // Set swapchin image layout to Color Attachment Optimal so imgui can render into it
+        // vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        //     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
-    // draw_imgui here
+        // draw_imgui here
+
+        vulkan_image_transition(cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+        vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_PRESENT_BLIT);
+    }
 
-    vulkan_image_transition(frame.cmd, p_ctx->vulkan_swapchain.p_images[index], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_FRAME);
 
     // End command buffer
-    vk_result = vkEndCommandBuffer(frame.cmd);
+    vk_result = vkEndCommandBuffer(cmd);
     if(vk_result != VK_SUCCESS)
         return;
 
     // Prepare the submission to the queue. We wat to wait on the _presentSemaphore, as that semaphore is signaled when
     // the swapchain is ready. We will signal the _renderSemaphore, to signal that rendering has finished.
-    VkCommandBufferSubmitInfo cmd_info = vulkan_cmd_get_buffer_submit_info(frame.cmd);
+    VkCommandBufferSubmitInfo cmd_info = vulkan_cmd_get_buffer_submit_info(cmd);
 
-    VkSemaphoreSubmitInfo wait_info =
-        vulkan_sync_get_sem_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR, frame.swapchain_semaphore);
+    VkSemaphoreSubmitInfo wait_info = vulkan_sync_get_sem_submit_info(
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        p_frame->swapchain_semaphore);
 
     VkSemaphoreSubmitInfo signal_info = vulkan_sync_get_sem_submit_info(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
-        frame.render_semaphore);
+        p_frame->render_semaphore);
 
     VkSubmitInfo2 submit_info2 = vulkan_cmd_get_submit_info2(&cmd_info, &signal_info, &wait_info);
 
+    // Wait for the immediate batches as well, anything they uploaded or transitioned is then ready without the CPU
+    // blocking on them
+    VkSemaphoreSubmitInfo p_wait_infos[3] = {wait_info};
+    uint32_t wait_infos_count = 1;
+    if(imm_value != 0)
+        p_wait_infos[wait_infos_count++] = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            p_ctx->imm.timeline, imm_value);
+
+    // Everything before the sprite pass overlaps the particles, only drawing the ring waits for them
+    async_compute_t* p_async = &p_ctx->async_compute;
+    if(async_particles)
+        p_wait_infos[wait_infos_count++] = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+            p_async->compute_timeline, p_async->compute_value);
+
+    submit_info2.waitSemaphoreInfoCount = wait_infos_count;
+    submit_info2.pWaitSemaphoreInfos = p_wait_infos;
+
+    // The next compute submit waits on the graphics timeline before it moves the ring this frame draws
+    VkSemaphoreSubmitInfo p_signal_infos[2] = {signal_info};
+    uint32_t signal_infos_count = 1;
+    uint64_t graphics_value = p_async->graphics_value + 1;
+    if(p_ctx->queues.async_compute)
+        p_signal_infos[signal_infos_count++] = vulkan_sync_get_timeline_submit_info(
+            VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, p_async->graphics_timeline, graphics_value);
+
+    submit_info2.signalSemaphoreInfoCount = signal_infos_count;
+    submit_info2.pSignalSemaphoreInfos = p_signal_infos;
+
     // Submit command buffer to the queue and execute it.
     // _renderFence will now block until the graphics commands finish execution.
-    vk_result = vkQueueSubmit2(p_ctx->queues.graphics, 1, &submit_info2, frame.render_fence);
+    vk_result = vkQueueSubmit2(p_ctx->queues.graphics, 1, &submit_info2, p_frame->render_fence);
     if(vk_result != VK_SUCCESS)
         return;
 
+    if(p_ctx->queues.async_compute)
+        p_async->graphics_value = graphics_value;
+
+    p_frame->timestamps_written = p_frame->timestamp_pool != VK_NULL_HANDLE;
+
     // Prepare present
     // This will present the image we just rendered onto the SDL window.
     // We want to wait on the _renderSemaphore for that, as its necessary that drawing commands have finished before the
@@ -342,21 +1000,270 @@ void vulkan_render_and_present_frame(vulkan_context_t* p_ctx)
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     present_info.pSwapchains = &p_ctx->vulkan_swapchain.swapchain;
     present_info.swapchainCount = 1;
-    present_info.pWaitSemaphores = &frame.render_semaphore;
+    present_info.pWaitSemaphores = &p_frame->render_semaphore;
     present_info.waitSemaphoreCount = 1;
     present_info.pImageIndices = &index;
 
+    // Tag the present with an id so vulkan_wait_for_present can wait until it is on screen
+    VkPresentIdKHR present_id_info = {0};
+    uint64_t present_id = p_ctx->present_id + 1;
+    if(p_ctx->pfn_wait_for_present != NULL) {
+        present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        present_id_info.swapchainCount = 1;
+        present_id_info.pPresentIds = &present_id;
+        present_info.pNext = &present_id_info;
+    }
+
     // Present rendered image
     vk_result = vkQueuePresentKHR(p_ctx->queues.present, &present_info);
-    if(vk_result != VK_SUCCESS)
+    if(vk_result == VK_SUCCESS || vk_result == VK_SUBOPTIMAL_KHR)
+        p_ctx->present_id = present_id;
+
+    if(vk_result == VK_ERROR_OUT_OF_DATE_KHR || vk_result == VK_SUBOPTIMAL_KHR)
+        p_ctx->swapchain_dirty = true;
+    else if(vk_result != VK_SUCCESS)
         return;
 
     // Increase the number of frames drawn
     ++p_ctx->frame_count; // Watch out for overflow!!
 }
 
+error_t vulkan_upload_static_sprites(vulkan_context_t* p_ctx, const sprite_instance_t* p_instances,
+    const sprite_material_t* p_materials, uint32_t count)
+{
+    if(p_ctx == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_ctx is NULL", __func__);
+
+    if(count > 0 && (p_instances == NULL || p_materials == NULL))
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_instances or p_materials is NULL", __func__);
+
+    if(count > SPRITE_MAX_STATIC_INSTANCES)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: %u static sprites, at most %d are supported", __func__,
+            count, SPRITE_MAX_STATIC_INSTANCES);
+
+    for(uint32_t i = 0; i < count; ++i) {
+        if((int)p_materials[i] < 0 || (int)p_materials[i] >= SPRITE_MATERIAL_COUNT)
+            return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Static sprite %u has an invalid material", __func__,
+                i);
+    }
+
+    // Nothing may read the static sprites while they are replaced
+    vkDeviceWaitIdle(p_ctx->device);
+
+    static_sprites_t* p_static = &p_ctx->static_sprites;
+    p_static->count = 0;
+    if(count == 0)
+        return SUCCESS;
+
+    // The staging buffer gets a deletion stack of its own, which the immediate batcher flushes once the copy is done
+    deletion_stack_t* p_staging_dstack = deletion_stack_init();
+    if(p_staging_dstack == NULL)
+        return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "%s: Failed to initiate deletion stack", __func__);
+
+    VkDeviceSize instances_size = (VkDeviceSize)count * sizeof(sprite_instance_t);
+    VkDeviceSize materials_size = (VkDeviceSize)count * sizeof(uint32_t);
+
+    allocated_buffer_t staging;
+    error_t err = vulkan_buffer_create(p_staging_dstack, p_ctx->device, p_ctx->physical_device,
+        instances_size + materials_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &staging);
+    if(err.code != 0) {
+        deletion_stack_flush(&p_staging_dstack);
+        return err;
+    }
+
+    // The instances followed by the materials, which the shader reads as 32 bit words whatever the size of the enum
+    memcpy(staging.p_mapped, p_instances, (size_t)instances_size);
+    uint32_t* p_staged_materials = (uint32_t*)((uint8_t*)staging.p_mapped + instances_size);
+    for(uint32_t i = 0; i < count; ++i)
+        p_staged_materials[i] = (uint32_t)p_materials[i];
+
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    err = vulkan_imm_begin(&p_ctx->imm, &cmd, NULL);
+    if(err.code != 0) {
+        deletion_stack_flush(&p_staging_dstack);
+        return err;
+    }
+
+    err = vulkan_imm_defer_delete(&p_ctx->imm, p_staging_dstack, staging_deinit);
+    if(err.code != 0) {
+        deletion_stack_flush(&p_staging_dstack);
+        return err;
+    }
+
+    // The frame submit waits on the batch, so the copies are done before the first cull reads them
+    VkBufferCopy instances_copy = {0};
+    instances_copy.size = instances_size;
+    vkCmdCopyBuffer(cmd, staging.buffer, p_static->instances.buffer, 1, &instances_copy);
+
+    VkBufferCopy materials_copy = {0};
+    materials_copy.srcOffset = instances_size;
+    materials_copy.size = materials_size;
+    vkCmdCopyBuffer(cmd, staging.buffer, p_static->materials.buffer, 1, &materials_copy);
+
+    // Every sprite is drawn until it is hidden
+    for(uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+        memset(p_static->p_visible[i].p_mapped, 0xff, (size_t)p_static->p_visible[i].size);
+
+    p_static->count = count;
+
+    LOG_DEBUG("%u static sprites uploaded", count);
+
+    return SUCCESS;
+}
+
+void vulkan_set_static_sprites_visible(vulkan_context_t* p_ctx, const uint64_t* p_bits, uint32_t count)
+{
+    if(p_ctx == NULL || p_bits == NULL)
+        return;
+
+    uint32_t frame_index = (uint32_t)(p_ctx->frame_count % FRAMES_IN_FLIGHT);
+    if(count > p_ctx->static_sprites.count)
+        count = p_ctx->static_sprites.count;
+
+    // The shader reads the bits as 32 bit words, on a little endian host those are the same bytes as the 64 bit ones
+    memcpy(p_ctx->static_sprites.p_visible[frame_index].p_mapped, p_bits,
+        ((size_t)count + 63) / 64 * sizeof(uint64_t));
+}
+
+error_t vulkan_load_textures(vulkan_context_t* p_ctx, texture_load_t* p_loads, uint32_t count)
+{
+    if(p_ctx == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_ctx is NULL", __func__);
+
+    uint64_t start_ns = SDL_GetTicksNS();
+
+    uint64_t value = 0;
+    error_t err = vulkan_texture_load(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, &p_ctx->jobs,
+        &p_ctx->imm, p_loads, count, &value);
+    if(err.code != 0 || count == 0)
+        return err;
+
+    // The copies and the mip blits of the whole batch run in one submit
+    uint64_t upload_start_ns = SDL_GetTicksNS();
+    err = vulkan_imm_wait(&p_ctx->imm, value);
+    if(err.code != 0)
+        return err;
+
+    uint64_t end_ns = SDL_GetTicksNS();
+    LOG_INFO("%u textures loaded in %.2f ms, uploading took %.2f ms", count, (double)(end_ns - start_ns) / 1e6,
+        (double)(end_ns - upload_start_ns) / 1e6);
+
+    return SUCCESS;
+}
+
+bool vulkan_set_present_path(vulkan_context_t* p_ctx, present_path_t path)
+{
+    if(p_ctx == NULL)
+        return false;
+
+    if(path == PRESENT_PATH_COMPUTE &&
+        (p_ctx->present_pipeline == VK_NULL_HANDLE || !p_ctx->vulkan_swapchain.storage_capable)) {
+        LOG_WARN("Compute present path not supported by the swapchain");
+        return false;
+    }
+
+    p_ctx->present_path = path;
+
+    LOG_INFO("Present path: %s", path == PRESENT_PATH_COMPUTE ? "compute" : "blit");
+
+    return true;
+}
+
+bool vulkan_set_upscale_filter(vulkan_context_t* p_ctx, upscale_filter_t filter)
+{
+    if(p_ctx == NULL)
+        return false;
+
+    if(filter == UPSCALE_FILTER_EDGE && p_ctx->present_upscale_pipeline == VK_NULL_HANDLE) {
+        LOG_WARN("Edge adaptive upscale needs the compute present path, which is not supported by the swapchain");
+        return false;
+    }
+
+    p_ctx->upscale_filter = filter;
+
+    LOG_INFO("Upscale filter: %s", filter == UPSCALE_FILTER_EDGE ? "edge adaptive" : "linear");
+
+    return true;
+}
+
+bool vulkan_set_present_policy(vulkan_context_t* p_ctx, present_policy_t policy)
+{
+    if(p_ctx == NULL)
+        return false;
+
+    if(policy == PRESENT_POLICY_LOW_LATENCY && p_ctx->pfn_wait_for_present == NULL) {
+        LOG_WARN("Low latency present policy needs present_wait which is not supported by the device");
+        return false;
+    }
+
+    if(policy == p_ctx->present_policy)
+        return true;
+
+    present_policy_t old_policy = p_ctx->present_policy;
+    p_ctx->present_policy = policy;
+
+    error_t err = recreate_swapchain(p_ctx);
+    if(err.code != 0) {
+        LOG_ERROR("Failed to change present policy: %s", err.msg);
+        error_deinit(&err);
+        p_ctx->present_policy = old_policy;
+        return false;
+    }
+
+    LOG_INFO("Present policy: %s", vulkan_swapchain_present_policy_name(policy));
+
+    return true;
+}
+
+void vulkan_wait_for_present(vulkan_context_t* p_ctx)
+{
+    if(p_ctx == NULL || p_ctx->present_policy != PRESENT_POLICY_LOW_LATENCY || p_ctx->pfn_wait_for_present == NULL)
+        return;
+
+    if(p_ctx->present_id == 0 || p_ctx->swapchain_dirty)
+        return;
+
+    // With FIFO each present is shown at a vertical blank. Waiting for the last one to be shown leaves the queue empty,
+    // so the frame built from the input sampled next is the one shown at the following vertical blank. A timeout or an
+    // out of date swapchain just means the loop runs unpaced for a frame.
+    VkResult vk_result = p_ctx->pfn_wait_for_present(p_ctx->device, p_ctx->vulkan_swapchain.swapchain,
+        p_ctx->present_id, PRESENT_WAIT_TIMEOUT_NS);
+    if(vk_result == VK_ERROR_OUT_OF_DATE_KHR)
+        p_ctx->swapchain_dirty = true;
+}
+
+static error_t recreate_swapchain(vulkan_context_t* p_ctx)
+{
+    // Nothing may use the old swapchain images while they are replaced
+    vkDeviceWaitIdle(p_ctx->device);
+
+    error_t err = vulkan_swapchain_recreate(p_ctx->device, p_ctx->physical_device, p_ctx->surface, p_ctx->p_window,
+        p_ctx->present_policy, &p_ctx->vulkan_swapchain);
+    if(err.code != 0)
+        return err;
+
+    // Present ids are per swapchain
+    p_ctx->present_id = 0;
+
+    // The surface usage flags are queried again on recreation, fall back to the blit if storage is no longer supported
+    if(!p_ctx->vulkan_swapchain.storage_capable)
+        p_ctx->present_path = PRESENT_PATH_BLIT;
+
+    if(p_ctx->present_pipeline != VK_NULL_HANDLE && p_ctx->vulkan_swapchain.storage_capable) {
+        err = vulkan_descriptor_present_update(p_ctx->device, p_ctx->draw_img_sampler, &p_ctx->draw_image,
+            p_ctx->bloom.p_views[1], &p_ctx->vulkan_swapchain, p_ctx->p_present_descs);
+        if(err.code != 0)
+            return err;
+    }
+
+    p_ctx->swapchain_dirty = false;
+
+    return SUCCESS;
+}
+
 static void draw_background(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout pipeline_layout,
-    VkDescriptorSet desc_set, VkExtent2D draw_extent)
+    VkDescriptorSet desc_set, const background_push_constants_t* p_push, VkExtent2D draw_extent)
 {
     // Bind the gradient drawing compute pipeline
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
@@ -364,6 +1271,10 @@ static void draw_background(VkCommandBuffer cmd, VkPipeline pipeline, VkPipeline
     // Bind the descriptor set containting the draw image for the compute pipeline
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &desc_set, 0, VK_NULL_HANDLE);
 
+    // The parameters of the effect, recorded with the commands so no descriptor is written per frame
+    vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(background_push_constants_t),
+        p_push);
+
     // Guard against range overflow when casting from double to uint32
     uint32_t group_count_x = 0;
     uint32_t group_count_y = 0;
@@ -385,3 +1296,512 @@ static void draw_background(VkCommandBuffer cmd, VkPipeline pipeline, VkPipeline
     // Dispatch compute pipeline
     vkCmdDispatch(cmd, group_count_x, group_count_y, 1);
 }
+
+static void record_background(VkCommandBuffer cmd, void* p_data)
+{
+    const background_pass_t* p_pass = (const background_pass_t*)p_data;
+
+    draw_background(cmd, p_pass->pipeline, p_pass->pipeline_layout, p_pass->desc_set, &p_pass->push,
+        p_pass->draw_extent);
+}
+
+static void record_cull(VkCommandBuffer cmd, void* p_data)
+{
+    const cull_pass_t* p_pass = (const cull_pass_t*)p_data;
+
+    // The draws of the last frame that used the buffers are done, the fence of the frame has been waited for
+    vkCmdUpdateBuffer(cmd, p_pass->indirect, 0, sizeof(sprite_indirect_t), &p_pass->indirect_init);
+    vulkan_buffer_barrier(cmd, p_pass->indirect, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_pass->pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_pass->pipeline_layout, 0, 1, &p_pass->desc_set, 0,
+        VK_NULL_HANDLE);
+    vkCmdPushConstants(cmd, p_pass->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+        sizeof(sprite_cull_push_constants_t), &p_pass->push);
+
+    // One invocation per static sprite, the work group size in sprite_cull.comp is 64
+    vkCmdDispatch(cmd, (p_pass->push.count + 63) / 64, 1, 1);
+
+    // The draw commands are read as indirect arguments and the culled sprites by the vertex shader
+    vulkan_buffer_barrier(cmd, p_pass->indirect, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+    vulkan_buffer_barrier(cmd, p_pass->culled, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+static void record_particles(VkCommandBuffer cmd, void* p_data)
+{
+    const particle_pass_t* p_pass = (const particle_pass_t*)p_data;
+
+    // The ring was last drawn and moved by the previous frame, possibly still running on the same queue. On the async
+    // compute queue the drawing is waited for with the graphics timeline and a compute queue has no vertex stage.
+    VkPipelineStageFlags2 drawn_stage = p_pass->async ? 0 : VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+    vulkan_buffer_barrier(cmd, p_pass->instances, drawn_stage | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    vulkan_buffer_barrier(cmd, p_pass->motions, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_pass->pipeline_layout, 0, 1, &p_pass->desc_set, 1,
+        &p_pass->emitters_offset);
+    vkCmdPushConstants(cmd, p_pass->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+        sizeof(particle_push_constants_t), &p_pass->push);
+
+    // One work group per emitter, the head is only touched by the emit pass so it needs no barrier against the sim
+    if(p_pass->push.emitters_count > 0) {
+        vulkan_buffer_barrier(cmd, p_pass->head, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_pass->emit_pipeline);
+        vkCmdDispatch(cmd, p_pass->push.emitters_count, 1, 1);
+
+        vulkan_buffer_barrier(cmd, p_pass->instances, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+        vulkan_buffer_barrier(cmd, p_pass->motions, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    }
+
+    // One invocation per slot in use, the work group size in particle_sim.comp is 256
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_pass->sim_pipeline);
+    vkCmdDispatch(cmd, (p_pass->used + 255) / 256, 1, 1);
+
+    // The frame submit waiting on the compute timeline makes the writes visible to the sprite pass instead
+    if(p_pass->async)
+        return;
+
+    vulkan_buffer_barrier(cmd, p_pass->instances, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+static VkResult submit_async_particles(vulkan_context_t* p_ctx, frame_data_t* p_frame, particle_pass_t* p_pass,
+    uint64_t imm_value)
+{
+    // The frame fence was waited for, and the frame submit that signals it waited on the last compute submit of the
+    // frame, so the command buffer is no longer in use
+    VkCommandBuffer cmd = p_frame->compute_cmd;
+    VkResult vk_result = vkResetCommandBuffer(cmd, 0);
+    if(vk_result != VK_SUCCESS)
+        return vk_result;
+
+    VkCommandBufferBeginInfo cmd_begin_info = {0};
+    cmd_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vk_result = vkBeginCommandBuffer(cmd, &cmd_begin_info);
+    if(vk_result != VK_SUCCESS)
+        return vk_result;
+
+    record_particles(cmd, p_pass);
+
+    vk_result = vkEndCommandBuffer(cmd);
+    if(vk_result != VK_SUCCESS)
+        return vk_result;
+
+    // The last frame submit drew the ring, and the immediate batch may have just cleared it
+    async_compute_t* p_async = &p_ctx->async_compute;
+    VkSemaphoreSubmitInfo p_wait_infos[2] = {0};
+    uint32_t wait_infos_count = 0;
+    if(p_async->graphics_value != 0)
+        p_wait_infos[wait_infos_count++] = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            p_async->graphics_timeline, p_async->graphics_value);
+    if(imm_value != 0)
+        p_wait_infos[wait_infos_count++] = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            p_ctx->imm.timeline, imm_value);
+
+    uint64_t compute_value = p_async->compute_value + 1;
+    VkSemaphoreSubmitInfo signal_info = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        p_async->compute_timeline, compute_value);
+
+    VkCommandBufferSubmitInfo cmd_info = vulkan_cmd_get_buffer_submit_info(cmd);
+    VkSubmitInfo2 submit_info2 = vulkan_cmd_get_submit_info2(&cmd_info, &signal_info, NULL);
+    submit_info2.waitSemaphoreInfoCount = wait_infos_count;
+    submit_info2.pWaitSemaphoreInfos = p_wait_infos;
+
+    vk_result = vkQueueSubmit2(p_ctx->queues.compute, 1, &submit_info2, VK_NULL_HANDLE);
+    if(vk_result != VK_SUCCESS)
+        return vk_result;
+
+    p_async->compute_value = compute_value;
+
+    return VK_SUCCESS;
+}
+
+static void record_sprites(VkCommandBuffer cmd, void* p_data)
+{
+    const sprite_pass_t* p_pass = (const sprite_pass_t*)p_data;
+
+    VkViewport viewport = {0};
+    viewport.width = (float)p_pass->draw_extent.width;
+    viewport.height = (float)p_pass->draw_extent.height;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor = {0};
+    scissor.extent = p_pass->draw_extent;
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    // The layout is shared by every material, so the view is pushed once
+    vkCmdPushConstants(cmd, p_pass->pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(sprite_push_constants_t),
+        &p_pass->push);
+
+    // Every set with the sprite layout takes a dynamic offset, only the sprites of the batch live in the frame arena
+    uint32_t zero_offset = 0;
+
+    // The static sprites left by the cull pass, the GPU wrote how many there are of each material. Without
+    // drawIndirectCount a material with none left is still drawn, with zero instances.
+    if(p_pass->indirect != VK_NULL_HANDLE) {
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->pipeline_layout, 0, 1,
+            &p_pass->static_desc_set, 1, &zero_offset);
+
+        for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i) {
+            VkDeviceSize offset = offsetof(sprite_indirect_t, p_commands) +
+                (VkDeviceSize)i * sizeof(VkDrawIndirectCommand);
+
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->p_pipelines[i]);
+            if(p_pass->draw_indirect_count)
+                vkCmdDrawIndirectCount(cmd, p_pass->indirect, offset, p_pass->indirect,
+                    offsetof(sprite_indirect_t, p_draw_counts) + (VkDeviceSize)i * sizeof(uint32_t), 1,
+                    sizeof(VkDrawIndirectCommand));
+            else
+                vkCmdDrawIndirect(cmd, p_pass->indirect, offset, 1, sizeof(VkDrawIndirectCommand));
+        }
+    }
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->pipeline_layout, 0, 1, &p_pass->desc_set, 1,
+        &p_pass->desc_offset);
+
+    // One draw per material however many sprites there are, six vertices per quad
+    for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i) {
+        if(p_pass->p_counts[i] == 0)
+            continue;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->p_pipelines[i]);
+        vkCmdDraw(cmd, 6, p_pass->p_counts[i], 0, sprite_batch_first_instance((sprite_material_t)i));
+    }
+
+    // The particles are soft discs over everything else. Dead ones have no size, so the whole ring is drawn.
+    if(p_pass->particles_count > 0) {
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->pipeline_layout, 0, 1,
+            &p_pass->particle_desc_set, 1, &zero_offset);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, p_pass->p_pipelines[SPRITE_MATERIAL_ROUND]);
+        vkCmdDraw(cmd, 6, p_pass->particles_count, 0, 0);
+    }
+}
+
+static error_t static_sprites_init(vulkan_context_t* p_ctx)
+{
+    static_sprites_t* p_static = &p_ctx->static_sprites;
+    p_static->count = 0;
+
+    // Written once per level, so they are staged into device local memory
+    error_t err = vulkan_buffer_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+        (VkDeviceSize)SPRITE_MAX_STATIC_INSTANCES * sizeof(sprite_instance_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &p_static->instances);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_buffer_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+        (VkDeviceSize)SPRITE_MAX_STATIC_INSTANCES * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &p_static->materials);
+    if(err.code != 0)
+        return err;
+
+    for(uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        // One bit per sprite written every frame, small enough to be read straight from host memory
+        err = vulkan_buffer_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+            (VkDeviceSize)SPRITE_MAX_STATIC_INSTANCES / 8, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &p_static->p_visible[i]);
+        if(err.code != 0)
+            return err;
+
+        // A slice per material that fits every static sprite, so appending never overflows
+        err = vulkan_buffer_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+            (VkDeviceSize)SPRITE_MATERIAL_COUNT * SPRITE_MAX_STATIC_INSTANCES * sizeof(sprite_instance_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &p_static->p_culled[i]);
+        if(err.code != 0)
+            return err;
+
+        err = vulkan_buffer_create(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, sizeof(sprite_indirect_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &p_static->p_indirect[i]);
+        if(err.code != 0)
+            return err;
+    }
+
+    err = vulkan_descriptor_static_sprite_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->desc_alloc,
+        p_ctx->sprite_desc_layout, p_static);
+    if(err.code != 0)
+        return err;
+
+    return vulkan_pipeline_cull_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->device_caps, &p_static->cull_desc_layout,
+        &p_static->cull_pipeline_layout, &p_static->cull_pipeline);
+}
+
+static error_t particle_system_init(vulkan_context_t* p_ctx)
+{
+    particle_system_t* p_particles = &p_ctx->particle_system;
+    p_particles->used = 0;
+
+    // Only ever touched by the GPU, on the async compute queue as well as the graphics queue if there is one
+    error_t err = vulkan_buffer_create_shared(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+        (VkDeviceSize)PARTICLE_MAX_COUNT * sizeof(sprite_instance_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &p_ctx->queues, &p_particles->instances);
+    if(err.code != 0)
+        return err;
+
+    // Velocity, life and max life, 16 bytes per particle
+    err = vulkan_buffer_create_shared(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+        (VkDeviceSize)PARTICLE_MAX_COUNT * 4 * sizeof(float),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &p_ctx->queues, &p_particles->motions);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_buffer_create_shared(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device, sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &p_ctx->queues, &p_particles->head);
+    if(err.code != 0)
+        return err;
+
+    // Every particle starts out dead with no size. The frame submit waits on the batch, so the ring is cleared before
+    // the first frame moves it.
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    err = vulkan_imm_begin(&p_ctx->imm, &cmd, NULL);
+    if(err.code != 0)
+        return err;
+
+    vkCmdFillBuffer(cmd, p_particles->instances.buffer, 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(cmd, p_particles->motions.buffer, 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(cmd, p_particles->head.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    // The emitters are written once per frame and read once per emitter, like the sprite instances they are allocated
+    // from the frame arena
+    err = vulkan_descriptor_particle_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->desc_alloc,
+        p_ctx->sprite_desc_layout, &p_ctx->arena_buffer, (VkDeviceSize)particle_batch_buffer_size(), p_particles);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_pipeline_particle_init(p_ctx->p_dstack, p_ctx->device, &p_particles->desc_layout,
+        &p_particles->pipeline_layout, &p_particles->emit_pipeline, &p_particles->sim_pipeline);
+    if(err.code != 0)
+        return err;
+
+    particle_batch_init(&p_ctx->particles);
+    p_ctx->last_frame_ns = 0;
+
+    return SUCCESS;
+}
+
+static error_t frame_arena_buffer_init(vulkan_context_t* p_ctx)
+{
+    // Storage and uniform buffers bound at a dynamic offset must be aligned to the device limits, which are powers of
+    // two, so aligning to the larger one satisfies both
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_ctx->physical_device, &properties);
+
+    VkDeviceSize min_alignment = properties.limits.minStorageBufferOffsetAlignment;
+    if(properties.limits.minUniformBufferOffsetAlignment > min_alignment)
+        min_alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+    // The emitters in the arena are read by the async compute queue
+    error_t err = vulkan_buffer_create_shared(p_ctx->p_dstack, p_ctx->device, p_ctx->physical_device,
+        (VkDeviceSize)FRAMES_IN_FLIGHT * FRAME_ARENA_SIZE,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &p_ctx->queues,
+        &p_ctx->arena_buffer);
+    if(err.code != 0)
+        return err;
+
+    frame_arena_init(&p_ctx->arena, p_ctx->arena_buffer.p_mapped, FRAME_ARENA_SIZE, (size_t)min_alignment);
+
+    LOG_DEBUG("Frame arena: %u bytes per frame, %llu byte alignment", FRAME_ARENA_SIZE,
+        (unsigned long long)min_alignment);
+
+    return SUCCESS;
+}
+
+static error_t bloom_init(vulkan_context_t* p_ctx)
+{
+    bloom_t* p_bloom = &p_ctx->bloom;
+    p_bloom->threshold = 1.0f;
+    p_bloom->knee = 0.5f;
+    p_bloom->strength = 0.5f;
+
+    // With no levels the present pass still needs a view to bind, it reads the draw image with a strength of 0
+    p_bloom->p_views[0] = p_ctx->draw_image.image_view;
+    p_bloom->p_views[1] = p_ctx->draw_image.image_view;
+    if(p_bloom->mips_count == 0) {
+        LOG_INFO("Draw image is too small for bloom");
+        return SUCCESS;
+    }
+
+    for(uint32_t i = 1; i <= p_bloom->mips_count; ++i) {
+        error_t err = vulkan_image_view_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->draw_image, i,
+            &p_bloom->p_views[i]);
+        if(err.code != 0)
+            return err;
+    }
+
+    error_t err = vulkan_descriptor_bloom_init(p_ctx->p_dstack, p_ctx->device, &p_ctx->desc_alloc, p_bloom);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_pipeline_bloom_init(p_ctx->p_dstack, p_ctx->device, &p_bloom->desc_layout, &p_bloom->pipeline_layout,
+        &p_bloom->down_pipeline, &p_bloom->up_pipeline);
+    if(err.code != 0)
+        return err;
+
+    LOG_DEBUG("Bloom: %u levels", p_bloom->mips_count);
+
+    return SUCCESS;
+}
+
+static void record_bloom(VkCommandBuffer cmd, const bloom_t* p_bloom, VkImage draw_image, VkExtent2D draw_extent,
+    VkQueryPool timestamps)
+{
+    if(p_bloom->mips_count == 0)
+        return;
+
+    // Each level reads what the dispatch before it wrote, the sprites are already visible after their transition
+    const VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    const VkAccessFlags2 access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+    bloom_push_constants_t push = {0};
+    push.threshold = p_bloom->threshold;
+    push.knee = p_bloom->knee;
+
+    // The levels cover the draw extent rather than the whole mip, so a lower resolution blooms the same
+    vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_BLOOM_DOWN);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_bloom->down_pipeline);
+
+    for(uint32_t level = 0; level < p_bloom->mips_count; ++level) {
+        uint32_t src_w = 0;
+        uint32_t src_h = 0;
+        uint32_t dst_w = 0;
+        uint32_t dst_h = 0;
+        bloom_mip_extent(draw_extent.width, draw_extent.height, level, &src_w, &src_h);
+        bloom_mip_extent(draw_extent.width, draw_extent.height, level + 1, &dst_w, &dst_h);
+
+        push.src_size[0] = (int32_t)src_w;
+        push.src_size[1] = (int32_t)src_h;
+        push.dst_size[0] = (int32_t)dst_w;
+        push.dst_size[1] = (int32_t)dst_h;
+        push.prefilter = level == 0 ? 1 : 0;
+
+        if(level > 0)
+            vulkan_image_barrier(cmd, draw_image, stage, access, stage, access);
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_bloom->pipeline_layout, 0, 1,
+            &p_bloom->p_down_descs[level], 0, VK_NULL_HANDLE);
+        vkCmdPushConstants(cmd, p_bloom->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+            sizeof(bloom_push_constants_t), &push);
+
+        // The work group size in bloom_down.comp is 8x8, one invocation per texel written
+        vkCmdDispatch(cmd, (dst_w + 7) / 8, (dst_h + 7) / 8, 1);
+    }
+    vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_BLOOM_DOWN);
+
+    vulkan_query_timestamp_begin(cmd, timestamps, GPU_SCOPE_BLOOM_UP);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_bloom->up_pipeline);
+    push.prefilter = 0;
+
+    // From the smallest level up, each one adds into the level above it which holds the sum of those below it after
+    for(uint32_t level = p_bloom->mips_count - 1; level >= 1; --level) {
+        uint32_t src_w = 0;
+        uint32_t src_h = 0;
+        uint32_t dst_w = 0;
+        uint32_t dst_h = 0;
+        bloom_mip_extent(draw_extent.width, draw_extent.height, level + 1, &src_w, &src_h);
+        bloom_mip_extent(draw_extent.width, draw_extent.height, level, &dst_w, &dst_h);
+
+        push.src_size[0] = (int32_t)src_w;
+        push.src_size[1] = (int32_t)src_h;
+        push.dst_size[0] = (int32_t)dst_w;
+        push.dst_size[1] = (int32_t)dst_h;
+
+        vulkan_image_barrier(cmd, draw_image, stage, access, stage, access);
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_bloom->pipeline_layout, 0, 1,
+            &p_bloom->p_up_descs[level - 1], 0, VK_NULL_HANDLE);
+        vkCmdPushConstants(cmd, p_bloom->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+            sizeof(bloom_push_constants_t), &push);
+
+        // The work group size in bloom_up.comp is 8x8, one invocation per texel written
+        vkCmdDispatch(cmd, (dst_w + 7) / 8, (dst_h + 7) / 8, 1);
+    }
+    vulkan_query_timestamp_end(cmd, timestamps, GPU_SCOPE_BLOOM_UP);
+}
+
+static void staging_deinit(void* p_void_dstack)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_dstack == NULL) {
+        LOG_ERROR("%s: p_void_dstack is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    deletion_stack_t* p_dstack = (deletion_stack_t*)p_void_dstack;
+
+    error_t err = deletion_stack_flush(&p_dstack);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
+    }
+
+    p_void_dstack = NULL;
+}
+
+static void draw_present(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout pipeline_layout,
+    VkDescriptorSet desc_set, const present_push_constants_t* p_push, VkExtent2D swapchain_extent)
+{
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &desc_set, 0, VK_NULL_HANDLE);
+
+    vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(present_push_constants_t), p_push);
+
+    // One invocation per swapchain pixel, the work group size in present.comp is 16x16
+    vkCmdDispatch(cmd, (swapchain_extent.width + 15) / 16, (swapchain_extent.height + 15) / 16, 1);
+}
+
+static bool format_is_srgb(VkFormat format)
+{
+    switch(format) { // NOLINT
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void log_gpu_timings(const gpu_timings_t* p_timings, present_path_t present_path)
+{
+    // UNUSED if LOG_LEVEL < LOG_LEVEL_DEBUG
+    (void)present_path;
+
+    LOG_DEBUG("GPU timings (moving average), present path: %s",
+        present_path == PRESENT_PATH_COMPUTE ? "compute" : "blit");
+    for(int i = 0; i < GPU_SCOPE_COUNT; ++i) {
+        if(p_timings->p_avg_ms[i] > 0.0)
+            LOG_DEBUG("    %s: %.3f ms", vulkan_query_scope_name((gpu_scope_t)i), p_timings->p_avg_ms[i]);
+    }
+}
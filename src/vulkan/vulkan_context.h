@@ -2,11 +2,20 @@
 #define VULKAN_CONTEXT_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <vulkan/vulkan_core.h>
 
 #include "error/error.h"
+#include "util/job_system.h"
 #include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_dynres.h"
+#include "vulkan/vulkan_frame_arena.h"
+#include "vulkan/vulkan_imm.h"
+#include "vulkan/vulkan_particle_batch.h"
+#include "vulkan/vulkan_texture_loader.h"
+#include "vulkan/vulkan_recorder.h"
+#include "vulkan/vulkan_sprite_batch.h"
 
 /**
  * A struct containing all the necessary vulkan fields.
@@ -14,27 +23,61 @@
 typedef struct vulkan_context_s {
     struct deletion_stack_s* p_dstack; // Make embedded struct?
     struct SDL_Window* p_window;
+    job_system_t jobs; // Shared with the game
     VkExtent2D window_extent;
     VkInstance instance;
     VkDebugUtilsMessengerEXT debug_msg;
     VkSurfaceKHR surface;
     VkPhysicalDevice physical_device;
     VkDevice device;
+    device_caps_t device_caps;
     queue_family_data_t queues;
     VkSampleCountFlagBits msaa_samples;
     vulkan_swapchain_t vulkan_swapchain;
+    present_policy_t present_policy;
+    PFN_vkWaitForPresentKHR pfn_wait_for_present; // NULL unless device_caps.present_wait
+    uint64_t present_id;                          // Id of the last present, 0 if none on the current swapchain
+    bool swapchain_dirty;                         // The swapchain must be recreated before the next frame
     allocated_image_t draw_image;
     VkExtent2D draw_extent;
     long frame_count;
     frame_data_t p_frames[FRAMES_IN_FLIGHT];
-    VkCommandPool imm_cmd_pool;
-    VkCommandBuffer imm_cmd_buffer;
-    VkFence imm_fence;
+    cmd_recorder_t recorder;
+    imm_batcher_t imm;
+    async_compute_t async_compute; // Unused unless queues.async_compute
     descriptor_allocator_t desc_alloc;
     VkDescriptorSet draw_img_desc;
     VkDescriptorSetLayout draw_img_desc_layout;
     VkPipeline gradient_pipline;
     VkPipelineLayout gradient_pipline_layout;
+    background_push_constants_t background; // Colors and bands set by the game, time and extent are set every frame
+    uint64_t start_ns;                      // When the context was initiated, the time of the background
+    VkSampler draw_img_sampler;
+    VkDescriptorSetLayout present_desc_layout;
+    VkDescriptorSet p_present_descs[MAX_SWAPCHAIN_IMAGES];
+    VkPipeline present_pipeline;
+    VkPipeline present_upscale_pipeline; // present_pipeline with the edge adaptive upscale
+    VkPipelineLayout present_pipeline_layout;
+    bloom_t bloom; // Only used by the compute present path
+    allocated_buffer_t arena_buffer; // Host visible and persistently mapped, a slice per frame in flight
+    frame_arena_t arena;             // Per frame data, reset by vulkan_begin_frame
+    sprite_batch_t sprites; // Written by the game between vulkan_begin_frame and vulkan_render_and_present_frame
+    uint32_t sprites_offset; // Offset of the instances of the open frame in the arena buffer
+    VkDescriptorSetLayout sprite_desc_layout;
+    VkDescriptorSet sprite_desc; // Bound at sprites_offset
+    VkPipelineLayout sprite_pipeline_layout;
+    VkPipeline p_sprite_pipelines[SPRITE_MATERIAL_COUNT];
+    static_sprites_t static_sprites;
+    particle_batch_t particles; // Written by the game between vulkan_begin_frame and vulkan_render_and_present_frame
+    uint32_t emitters_offset;   // Offset of the emitters of the open frame in the arena buffer
+    particle_system_t particle_system;
+    uint64_t last_frame_ns; // When the last frame was begun, 0 before the first
+    present_path_t present_path;
+    float exposure;
+    upscale_filter_t upscale_filter; // Only used by the compute present path
+    float sharpness;                 // Sharpening of UPSCALE_FILTER_EDGE in [0, 1]
+    gpu_timings_t gpu_timings;
+    dynres_t dynres;
 } vulkan_context_t;
 
 /**
@@ -57,6 +100,106 @@ error_t vulkan_init(vulkan_context_t* p_vkctx);
  */
 error_t vulkan_deinit(vulkan_context_t* p_vkctx);
 
+/**
+ * \brief Wait until the next frame can be built.
+ *
+ * Waits for the GPU to finish the last frame that used the same frame in flight resources, then empties the frame's
+ * slice of the frame arena and opens the sprite batch and the particle batch on allocations from it. Sprites are pushed
+ * to p_vkctx->sprites and emitters to p_vkctx->particles after this returns true, and drawn by the following
+ * vulkan_render_and_present_frame. Other per frame data can be allocated from p_vkctx->arena until then.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ *
+ * \return False if the frame must be skipped, for example while the swapchain can not be recreated.
+ */
+bool vulkan_begin_frame(vulkan_context_t* p_vkctx);
+
+/**
+ * Record, submit and present the frame opened by vulkan_begin_frame.
+ */
 void vulkan_render_and_present_frame(vulkan_context_t* p_vkctx);
 
+/**
+ * \brief Upload the static sprites, the sprites that never move such as the bricks of a level. Replaces the ones
+ * uploaded before.
+ *
+ * Every frame the static sprites are culled against the view of p_vkctx->sprites on the GPU and the ones left are drawn
+ * with one indirect draw per material, under the sprites of the batch. They all start out visible. Waits for the device
+ * to go idle, so it belongs in level loading and not in the frame loop.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in] p_instances The sprites.
+ * \param[in] p_materials The material of each sprite.
+ * \param[in] count Number of sprites, at most SPRITE_MAX_STATIC_INSTANCES.
+ */
+error_t vulkan_upload_static_sprites(vulkan_context_t* p_vkctx, const sprite_instance_t* p_instances,
+    const sprite_material_t* p_materials, uint32_t count);
+
+/**
+ * \brief Set which static sprites are drawn in the frame opened by vulkan_begin_frame.
+ *
+ * Each frame in flight has its own bits, so once a sprite has been hidden this must be called every frame.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in] p_bits One bit per static sprite in upload order, bit i & 63 of word i / 64 is set if sprite i is drawn.
+ * \param[in] count Number of sprites the bits cover, at most the number uploaded are used.
+ */
+void vulkan_set_static_sprites_visible(vulkan_context_t* p_vkctx, const uint64_t* p_bits, uint32_t count);
+
+/**
+ * \brief Load a batch of textures and wait until they are uploaded.
+ *
+ * The files are decoded in parallel on the job system and the mips are generated on the GPU, see vulkan_texture_load.
+ * The decode and copy time of each texture is written to its texture_load_t and the upload time of the batch is
+ * logged. The images live as long as the context.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in,out] p_loads The textures to load, p_path of each must be set.
+ * \param[in] count Number of textures.
+ */
+error_t vulkan_load_textures(vulkan_context_t* p_vkctx, texture_load_t* p_loads, uint32_t count);
+
+/**
+ * Set the path used to copy the draw image onto the swapchain image.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in] path The present path to use.
+ *
+ * \return False if the path is not supported by the swapchain, in which case the current path is kept.
+ */
+bool vulkan_set_present_path(vulkan_context_t* p_vkctx, present_path_t path);
+
+/**
+ * Set the filter the compute present path upscales the draw extent with. The edge adaptive filter is only run while
+ * the draw extent is smaller than the swapchain extent, at native resolution the plain present pass is used either way.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in] filter The upscale filter to use.
+ *
+ * \return False if the compute present path is not supported, in which case the current filter is kept.
+ */
+bool vulkan_set_upscale_filter(vulkan_context_t* p_vkctx, upscale_filter_t filter);
+
+/**
+ * Set the present policy. Changing the policy recreates the swapchain with the matching present mode.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ * \param[in] policy The present policy to use.
+ *
+ * \return False if the policy is not supported or the swapchain could not be recreated, in which case the current
+ * policy is kept.
+ */
+bool vulkan_set_present_policy(vulkan_context_t* p_vkctx, present_policy_t policy);
+
+/**
+ * \brief Pace the frame loop for the low latency present policy.
+ *
+ * Blocks until the last presented frame is on screen, so that input sampled right after this returns goes into a frame
+ * that is displayed at the next vertical blank instead of sitting behind queued frames. Does nothing for the other
+ * policies. Call it right before polling input.
+ *
+ * \param[in] p_vkctx Pointer to the vulkan_context.
+ */
+void vulkan_wait_for_present(vulkan_context_t* p_vkctx);
+
 #endif // VULKAN_CONTEXT_H_
@@ -27,8 +27,19 @@ error_t vulkan_descriptor_init(deletion_stack_t* p_dstack, VkDevice device, allo
     descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSet* p_draw_image_desc,
     VkDescriptorSetLayout* p_draw_image_desc_layout)
 {
-    pool_size_ratio_t sizes = {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1};
-    if(!pool_init(device, 10, &sizes, 1, &p_descriptor_allocator->pool))
+    // The draw image set uses one storage image, each present set uses a sampled draw image, a sampled bloom mip and
+    // one storage swapchain image. Every set with the sprite layout uses one dynamic storage buffer, each cull set five
+    // storage buffers and the particle set three and a dynamic one. Per frame in flight there are a cull set and a
+    // static sprite draw set, the sprite, particle and particle draw sets are shared by every frame. Each level of the
+    // bloom pyramid has a downsample and an upsample set of two storage images.
+    pool_size_ratio_t p_sizes[4] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          2},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1}
+    };
+    uint32_t max_sets = 4 + MAX_SWAPCHAIN_IMAGES + 2 * FRAMES_IN_FLIGHT + 2 * BLOOM_MAX_MIPS;
+    if(!pool_init(device, max_sets, p_sizes, 4, &p_descriptor_allocator->pool))
         return error_init(ERR_SRC_CORE, ERR_TEMP, "Failed to init pool");
 
     uint32_t bindings_count = 1;
@@ -95,6 +106,514 @@ error_t vulkan_descriptor_init(deletion_stack_t* p_dstack, VkDevice device, allo
     return SUCCESS;
 }
 
+error_t vulkan_descriptor_present_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkSampler sampler, allocated_image_t* p_draw_image,
+    VkImageView bloom_view, vulkan_swapchain_t* p_swapchain, VkDescriptorSet* p_present_descs,
+    VkDescriptorSetLayout* p_present_desc_layout)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_draw_image == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_draw_image is NULL", __func__);
+
+    if(p_swapchain == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_swapchain is NULL", __func__);
+
+    // Binding 0 is the draw image which is sampled, binding 1 is the swapchain image which is written and binding 2 is
+    // the top of the bloom pyramid which is sampled
+    VkDescriptorSetLayoutBinding p_bindings[3] = {0};
+
+    p_bindings[0].binding = 0;
+    p_bindings[0].descriptorCount = 1;
+    p_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    p_bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    p_bindings[1].binding = 1;
+    p_bindings[1].descriptorCount = 1;
+    p_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    p_bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    p_bindings[2].binding = 2;
+    p_bindings[2].descriptorCount = 1;
+    p_bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    p_bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pBindings = p_bindings;
+    layout_info.bindingCount = 3;
+
+    if(vkCreateDescriptorSetLayout(device, &layout_info, VK_NULL_HANDLE, p_present_desc_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_DESCRIPTOR_SET_LAYOUT,
+            "Failed to create present descriptor set layout");
+
+    // CLEANUP, the sets are freed together with the pool
+    desc_del_t* p_desc_del = (desc_del_t*)malloc(sizeof(desc_del_t));
+    p_desc_del->device = device;
+    p_desc_del->pool = VK_NULL_HANDLE;
+    p_desc_del->desc_layout = *p_present_desc_layout;
+
+    error_t err = deletion_stack_push(p_dstack, p_desc_del, vulkan_descriptor_deinit);
+    if(err.code != 0) {
+        vulkan_descriptor_deinit(p_desc_del);
+        return err;
+    }
+
+    // One set per swapchain image, the set to bind is picked by the acquired image index. Sets are allocated for the
+    // maximum number of swapchain images so a recreated swapchain with more images does not need new sets.
+    VkDescriptorSetLayout p_layouts[MAX_SWAPCHAIN_IMAGES];
+    for(uint32_t i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
+        p_layouts[i] = *p_present_desc_layout;
+
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = p_descriptor_allocator->pool;
+    alloc_info.descriptorSetCount = MAX_SWAPCHAIN_IMAGES;
+    alloc_info.pSetLayouts = p_layouts;
+
+    if(vkAllocateDescriptorSets(device, &alloc_info, p_present_descs) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
+            "Failed to allocate present descriptor sets");
+
+    err = vulkan_descriptor_present_update(device, sampler, p_draw_image, bloom_view, p_swapchain, p_present_descs);
+    if(err.code != 0)
+        return err;
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_descriptor_present_update(VkDevice device, VkSampler sampler, allocated_image_t* p_draw_image,
+    VkImageView bloom_view, vulkan_swapchain_t* p_swapchain, VkDescriptorSet* p_present_descs)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_draw_image == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_draw_image is NULL", __func__);
+
+    if(p_swapchain == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_swapchain is NULL", __func__);
+
+    if(p_swapchain->images_count > MAX_SWAPCHAIN_IMAGES)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: %u swapchain images, at most %d are supported",
+            __func__, p_swapchain->images_count, MAX_SWAPCHAIN_IMAGES);
+
+    VkDescriptorImageInfo draw_img_info = {0};
+    draw_img_info.sampler = sampler;
+    draw_img_info.imageView = p_draw_image->image_view;
+    draw_img_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorImageInfo bloom_img_info = {0};
+    bloom_img_info.sampler = sampler;
+    bloom_img_info.imageView = bloom_view;
+    bloom_img_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    for(uint32_t i = 0; i < p_swapchain->images_count; ++i) {
+        VkDescriptorImageInfo swapchain_img_info = {0};
+        swapchain_img_info.imageView = p_swapchain->p_image_views[i];
+        swapchain_img_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet p_writes[3] = {0};
+
+        p_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        p_writes[0].dstSet = p_present_descs[i];
+        p_writes[0].dstBinding = 0;
+        p_writes[0].descriptorCount = 1;
+        p_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        p_writes[0].pImageInfo = &draw_img_info;
+
+        p_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        p_writes[1].dstSet = p_present_descs[i];
+        p_writes[1].dstBinding = 1;
+        p_writes[1].descriptorCount = 1;
+        p_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        p_writes[1].pImageInfo = &swapchain_img_info;
+
+        p_writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        p_writes[2].dstSet = p_present_descs[i];
+        p_writes[2].dstBinding = 2;
+        p_writes[2].descriptorCount = 1;
+        p_writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        p_writes[2].pImageInfo = &bloom_img_info;
+
+        vkUpdateDescriptorSets(device, 3, p_writes, 0, VK_NULL_HANDLE);
+    }
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_descriptor_sprite_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, const allocated_buffer_t* p_arena_buffer, VkDeviceSize range,
+    VkDescriptorSet* p_sprite_desc, VkDescriptorSetLayout* p_sprite_desc_layout)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_arena_buffer == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_arena_buffer is NULL", __func__);
+
+    // Binding 0 is the instance buffer, read by the vertex shader. It is dynamic so the instances of every frame are
+    // bound with one set, at the offset of the frame's allocation.
+    VkDescriptorSetLayoutBinding binding = {0};
+    binding.binding = 0;
+    binding.descriptorCount = 1;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pBindings = &binding;
+    layout_info.bindingCount = 1;
+
+    if(vkCreateDescriptorSetLayout(device, &layout_info, VK_NULL_HANDLE, p_sprite_desc_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_DESCRIPTOR_SET_LAYOUT,
+            "Failed to create sprite descriptor set layout");
+
+    // CLEANUP, the sets are freed together with the pool
+    desc_del_t* p_desc_del = (desc_del_t*)malloc(sizeof(desc_del_t));
+    p_desc_del->device = device;
+    p_desc_del->pool = VK_NULL_HANDLE;
+    p_desc_del->desc_layout = *p_sprite_desc_layout;
+
+    error_t err = deletion_stack_push(p_dstack, p_desc_del, vulkan_descriptor_deinit);
+    if(err.code != 0) {
+        vulkan_descriptor_deinit(p_desc_del);
+        return err;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = p_descriptor_allocator->pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = p_sprite_desc_layout;
+
+    if(vkAllocateDescriptorSets(device, &alloc_info, p_sprite_desc) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
+            "Failed to allocate sprite descriptor set");
+
+    // The range is the size of one frame's instances, the dynamic offset picks the frame
+    VkDescriptorBufferInfo buffer_info = {0};
+    buffer_info.buffer = p_arena_buffer->buffer;
+    buffer_info.offset = 0;
+    buffer_info.range = range;
+
+    VkWriteDescriptorSet write = {0};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = *p_sprite_desc;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    write.pBufferInfo = &buffer_info;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, VK_NULL_HANDLE);
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_descriptor_static_sprite_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSetLayout sprite_desc_layout,
+    static_sprites_t* p_static)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_static == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_static is NULL", __func__);
+
+    // Binding 0 and 1 are the static instances and their materials, 2 the visible bits, 3 the culled instances and 4
+    // the indirect draws, all read or written by the cull shader
+    VkDescriptorSetLayoutBinding p_bindings[5];
+    for(uint32_t i = 0; i < 5; ++i) {
+        VkDescriptorSetLayoutBinding new_bind = {0};
+        new_bind.binding = i;
+        new_bind.descriptorCount = 1;
+        new_bind.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        new_bind.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        p_bindings[i] = new_bind;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pBindings = p_bindings;
+    layout_info.bindingCount = 5;
+
+    if(vkCreateDescriptorSetLayout(device, &layout_info, VK_NULL_HANDLE, &p_static->cull_desc_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_DESCRIPTOR_SET_LAYOUT,
+            "Failed to create cull descriptor set layout");
+
+    // CLEANUP, the sets are freed together with the pool
+    desc_del_t* p_desc_del = (desc_del_t*)malloc(sizeof(desc_del_t));
+    p_desc_del->device = device;
+    p_desc_del->pool = VK_NULL_HANDLE;
+    p_desc_del->desc_layout = p_static->cull_desc_layout;
+
+    error_t err = deletion_stack_push(p_dstack, p_desc_del, vulkan_descriptor_deinit);
+    if(err.code != 0) {
+        vulkan_descriptor_deinit(p_desc_del);
+        return err;
+    }
+
+    // A cull set and a draw set per frame in flight, the draw sets use the layout of the sprite pipelines
+    VkDescriptorSetLayout p_layouts[2 * FRAMES_IN_FLIGHT];
+    VkDescriptorSet p_sets[2 * FRAMES_IN_FLIGHT];
+    for(uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        p_layouts[i] = p_static->cull_desc_layout;
+        p_layouts[FRAMES_IN_FLIGHT + i] = sprite_desc_layout;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = p_descriptor_allocator->pool;
+    alloc_info.descriptorSetCount = 2 * FRAMES_IN_FLIGHT;
+    alloc_info.pSetLayouts = p_layouts;
+
+    if(vkAllocateDescriptorSets(device, &alloc_info, p_sets) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
+            "Failed to allocate static sprite descriptor sets");
+
+    for(uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        p_static->p_cull_descs[i] = p_sets[i];
+        p_static->p_draw_descs[i] = p_sets[FRAMES_IN_FLIGHT + i];
+
+        const allocated_buffer_t* p_cull_buffers[5] = {&p_static->instances, &p_static->materials,
+            &p_static->p_visible[i], &p_static->p_culled[i], &p_static->p_indirect[i]};
+
+        VkDescriptorBufferInfo p_buffer_infos[6];
+        VkWriteDescriptorSet p_writes[6];
+        for(uint32_t j = 0; j < 6; ++j) {
+            // The last write is binding 0 of the draw set, the culled instances
+            bool draw_set = j == 5;
+
+            VkDescriptorBufferInfo buffer_info = {0};
+            buffer_info.buffer = draw_set ? p_static->p_culled[i].buffer : p_cull_buffers[j]->buffer;
+            buffer_info.offset = 0;
+            buffer_info.range = VK_WHOLE_SIZE;
+            p_buffer_infos[j] = buffer_info;
+
+            VkWriteDescriptorSet write = {0};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = draw_set ? p_static->p_draw_descs[i] : p_static->p_cull_descs[i];
+            write.dstBinding = draw_set ? 0 : j;
+            write.descriptorCount = 1;
+            write.descriptorType = draw_set ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC :
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = &p_buffer_infos[j];
+            p_writes[j] = write;
+        }
+
+        vkUpdateDescriptorSets(device, 6, p_writes, 0, VK_NULL_HANDLE);
+    }
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_descriptor_particle_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSetLayout sprite_desc_layout,
+    const allocated_buffer_t* p_arena_buffer, VkDeviceSize emitters_range, particle_system_t* p_particles)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_arena_buffer == NULL || p_particles == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_arena_buffer or p_particles is NULL", __func__);
+
+    // Binding 0 and 1 are the particle instances and motions, 2 the ring head and 3 the emitters of the frame, all
+    // used by the particle compute shaders. The emitters are allocated from the frame arena, so binding 3 is dynamic.
+    VkDescriptorSetLayoutBinding p_bindings[4];
+    for(uint32_t i = 0; i < 4; ++i) {
+        VkDescriptorSetLayoutBinding new_bind = {0};
+        new_bind.binding = i;
+        new_bind.descriptorCount = 1;
+        new_bind.descriptorType = i == 3 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC :
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        new_bind.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        p_bindings[i] = new_bind;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pBindings = p_bindings;
+    layout_info.bindingCount = 4;
+
+    if(vkCreateDescriptorSetLayout(device, &layout_info, VK_NULL_HANDLE, &p_particles->desc_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_DESCRIPTOR_SET_LAYOUT,
+            "Failed to create particle descriptor set layout");
+
+    // CLEANUP, the sets are freed together with the pool
+    desc_del_t* p_desc_del = (desc_del_t*)malloc(sizeof(desc_del_t));
+    p_desc_del->device = device;
+    p_desc_del->pool = VK_NULL_HANDLE;
+    p_desc_del->desc_layout = p_particles->desc_layout;
+
+    error_t err = deletion_stack_push(p_dstack, p_desc_del, vulkan_descriptor_deinit);
+    if(err.code != 0) {
+        vulkan_descriptor_deinit(p_desc_del);
+        return err;
+    }
+
+    // The compute set and the draw set
+    VkDescriptorSetLayout p_layouts[2] = {p_particles->desc_layout, sprite_desc_layout};
+    VkDescriptorSet p_sets[2];
+
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = p_descriptor_allocator->pool;
+    alloc_info.descriptorSetCount = 2;
+    alloc_info.pSetLayouts = p_layouts;
+
+    if(vkAllocateDescriptorSets(device, &alloc_info, p_sets) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
+            "Failed to allocate particle descriptor sets");
+
+    p_particles->desc = p_sets[0];
+    p_particles->draw_desc = p_sets[1];
+
+    const allocated_buffer_t* p_buffers[4] = {&p_particles->instances, &p_particles->motions, &p_particles->head,
+        p_arena_buffer};
+
+    // The last write is binding 0 of the draw set, the particle instances
+    VkDescriptorBufferInfo p_buffer_infos[5];
+    VkWriteDescriptorSet p_writes[5];
+    for(uint32_t i = 0; i < 5; ++i) {
+        bool draw_set = i == 4;
+
+        VkDescriptorBufferInfo buffer_info = {0};
+        buffer_info.buffer = draw_set ? p_particles->instances.buffer : p_buffers[i]->buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = i == 3 ? emitters_range : VK_WHOLE_SIZE;
+        p_buffer_infos[i] = buffer_info;
+
+        VkWriteDescriptorSet write = {0};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = draw_set ? p_particles->draw_desc : p_particles->desc;
+        write.dstBinding = draw_set ? 0 : i;
+        write.descriptorCount = 1;
+        write.descriptorType = i >= 3 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &p_buffer_infos[i];
+        p_writes[i] = write;
+    }
+
+    vkUpdateDescriptorSets(device, 5, p_writes, 0, VK_NULL_HANDLE);
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_descriptor_bloom_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, bloom_t* p_bloom)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_bloom == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_bloom is NULL", __func__);
+
+    // Binding 0 is the level read and binding 1 the level written, both storage images so every pass can load single
+    // texels into shared memory without a sampler
+    VkDescriptorSetLayoutBinding p_bindings[2] = {0};
+    for(uint32_t i = 0; i < 2; ++i) {
+        p_bindings[i].binding = i;
+        p_bindings[i].descriptorCount = 1;
+        p_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        p_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pBindings = p_bindings;
+    layout_info.bindingCount = 2;
+
+    if(vkCreateDescriptorSetLayout(device, &layout_info, VK_NULL_HANDLE, &p_bloom->desc_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_DESCRIPTOR_SET_LAYOUT,
+            "Failed to create bloom descriptor set layout");
+
+    // CLEANUP, the sets are freed together with the pool
+    desc_del_t* p_desc_del = (desc_del_t*)malloc(sizeof(desc_del_t));
+    p_desc_del->device = device;
+    p_desc_del->pool = VK_NULL_HANDLE;
+    p_desc_del->desc_layout = p_bloom->desc_layout;
+
+    error_t err = deletion_stack_push(p_dstack, p_desc_del, vulkan_descriptor_deinit);
+    if(err.code != 0) {
+        vulkan_descriptor_deinit(p_desc_del);
+        return err;
+    }
+
+    // A downsample set per level and an upsample set per level but the smallest, which has nothing below it
+    uint32_t down_count = p_bloom->mips_count;
+    uint32_t up_count = p_bloom->mips_count > 0 ? p_bloom->mips_count - 1 : 0;
+    if(down_count == 0)
+        return SUCCESS;
+
+    VkDescriptorSetLayout p_layouts[2 * BLOOM_MAX_MIPS];
+    for(uint32_t i = 0; i < down_count + up_count; ++i)
+        p_layouts[i] = p_bloom->desc_layout;
+
+    VkDescriptorSet p_sets[2 * BLOOM_MAX_MIPS];
+
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = p_descriptor_allocator->pool;
+    alloc_info.descriptorSetCount = down_count + up_count;
+    alloc_info.pSetLayouts = p_layouts;
+
+    if(vkAllocateDescriptorSets(device, &alloc_info, p_sets) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_ALLOCATE_DESCRIPTOR_SETS,
+            "Failed to allocate bloom descriptor sets");
+
+    VkDescriptorImageInfo p_img_infos[4 * BLOOM_MAX_MIPS];
+    VkWriteDescriptorSet p_writes[4 * BLOOM_MAX_MIPS];
+    uint32_t writes_count = 0;
+    for(uint32_t i = 0; i < down_count + up_count; ++i) {
+        bool down = i < down_count;
+        uint32_t level = down ? i : i - down_count + 1;
+
+        // Downsampling reads mip level and writes the one below, upsampling reads the one below and adds into level
+        VkImageView p_views[2] = {p_bloom->p_views[level], p_bloom->p_views[level + 1]};
+        if(!down) {
+            p_views[0] = p_bloom->p_views[level + 1];
+            p_views[1] = p_bloom->p_views[level];
+        }
+
+        if(down)
+            p_bloom->p_down_descs[i] = p_sets[i];
+        else
+            p_bloom->p_up_descs[level - 1] = p_sets[i];
+
+        for(uint32_t j = 0; j < 2; ++j) {
+            VkDescriptorImageInfo img_info = {0};
+            img_info.imageView = p_views[j];
+            img_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            p_img_infos[writes_count] = img_info;
+
+            VkWriteDescriptorSet write = {0};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = p_sets[i];
+            write.dstBinding = j;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            write.pImageInfo = &p_img_infos[writes_count];
+            p_writes[writes_count++] = write;
+        }
+    }
+
+    vkUpdateDescriptorSets(device, writes_count, p_writes, 0, VK_NULL_HANDLE);
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
 static void vulkan_descriptor_deinit(void* p_void_desc_del)
 {
     LOG_DEBUG("Callback: %s", __func__);
@@ -124,8 +643,8 @@ static bool pool_init(VkDevice device, uint32_t max_sets, pool_size_ratio_t* p_p
     }
 
     for(size_t i = 0; i < pool_ratios_count; ++i) {
-        p_pool_sizes[i].type = p_pool_ratios->type;
-        p_pool_sizes[i].descriptorCount = (uint32_t)p_pool_ratios->ratio * max_sets;
+        p_pool_sizes[i].type = p_pool_ratios[i].type;
+        p_pool_sizes[i].descriptorCount = (uint32_t)(p_pool_ratios[i].ratio * (float)max_sets);
     }
 
     VkDescriptorPoolCreateInfo pool_info = {0};
@@ -14,5 +14,59 @@ error_t vulkan_descriptor_init(deletion_stack_t* p_dstack, VkDevice device, allo
     descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSet* p_draw_image_desc_set,
     VkDescriptorSetLayout* p_draw_image_desc_set_layout);
 
+/**
+ * Initiate the descriptor sets of the present compute pass, one set per possible swapchain image (p_present_descs must
+ * hold MAX_SWAPCHAIN_IMAGES sets). The sets are allocated from the pool created in vulkan_descriptor_init which must be
+ * called first.
+ */
+error_t vulkan_descriptor_present_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkSampler sampler, allocated_image_t* p_draw_image,
+    VkImageView bloom_view, vulkan_swapchain_t* p_swapchain, VkDescriptorSet* p_present_descs,
+    VkDescriptorSetLayout* p_present_desc_layout);
+
+/**
+ * Write the draw image, the bloom view and the swapchain image views to the present descriptor sets. Must be called
+ * again after the swapchain has been recreated.
+ */
+error_t vulkan_descriptor_present_update(VkDevice device, VkSampler sampler, allocated_image_t* p_draw_image,
+    VkImageView bloom_view, vulkan_swapchain_t* p_swapchain, VkDescriptorSet* p_present_descs);
+
+/**
+ * Initiate the descriptor set of the sprite pipelines. Its instance buffer is a dynamic storage buffer of range bytes
+ * over the frame arena buffer, bound at the offset of the instances allocated for the frame. Every set with the sprite
+ * layout is bound with one dynamic offset. The set is allocated from the pool created in vulkan_descriptor_init which
+ * must be called first.
+ */
+error_t vulkan_descriptor_sprite_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, const allocated_buffer_t* p_arena_buffer, VkDeviceSize range,
+    VkDescriptorSet* p_sprite_desc, VkDescriptorSetLayout* p_sprite_desc_layout);
+
+/**
+ * Initiate the descriptor sets of the static sprites, a cull set and a draw set per frame in flight. The cull sets
+ * point at the buffers of p_static the cull shader reads and writes, the draw sets use sprite_desc_layout and point at
+ * the culled instances. The buffers of p_static must be created first and the sets are allocated from the pool created
+ * in vulkan_descriptor_init.
+ */
+error_t vulkan_descriptor_static_sprite_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSetLayout sprite_desc_layout,
+    static_sprites_t* p_static);
+
+/**
+ * Initiate the descriptor sets of the particle system, a compute set pointing at the particle buffers and at
+ * emitters_range bytes of the frame arena buffer as a dynamic storage buffer, and a draw set using sprite_desc_layout
+ * pointing at the particle instances. The buffers of p_particles must be created first and the sets are allocated from
+ * the pool created in vulkan_descriptor_init.
+ */
+error_t vulkan_descriptor_particle_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, VkDescriptorSetLayout sprite_desc_layout,
+    const allocated_buffer_t* p_arena_buffer, VkDeviceSize emitters_range, particle_system_t* p_particles);
+
+/**
+ * Initiate the descriptor sets of the bloom pyramid, a downsample set per level and an upsample set per level but the
+ * smallest. The mip views of p_bloom must be created first and the sets are allocated from the pool created in
+ * vulkan_descriptor_init.
+ */
+error_t vulkan_descriptor_bloom_init(deletion_stack_t* p_dstack, VkDevice device,
+    descriptor_allocator_t* p_descriptor_allocator, bloom_t* p_bloom);
 
 #endif // VULKAN_DESCRIPTOR_H_
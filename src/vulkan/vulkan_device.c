@@ -42,6 +42,23 @@ static bool is_device_suitable(VkSurfaceKHR surface, VkPhysicalDevice physical_d
  */
 static bool check_device_extension_support(VkPhysicalDevice physical_device);
 
+/**
+ * Check if a device extension is available on the physical device.
+ *
+ * \param[in] physical_device The physical device.
+ * \param[in] extension_name The name of the extension.
+ * \return True if the extension is available.
+ */
+static bool is_device_extension_available(VkPhysicalDevice physical_device, const char* extension_name);
+
+/**
+ * Check if the physical device supports present_id and present_wait, both the extensions and the features.
+ *
+ * \param[in] physical_device The physical device.
+ * \return True if present_wait can be enabled.
+ */
+static bool check_present_wait_support(VkPhysicalDevice physical_device);
+
 /**
  * \brief Deinit a vulkan device.
  *
@@ -287,12 +304,8 @@ bool vulkan_device_get_queue_families(VkSurfaceKHR surface, VkPhysicalDevice phy
         }
 
         // When we have found the graphics queue and present queue we are done
-        if(got_graphics && got_present) {
-            free(queue_families);
-            queue_families = NULL;
-
-            return true;
-        }
+        if(got_graphics && got_present)
+            break;
     }
 
     // Note that it’s very likely that these end up being the same queue family after all, but throughout the
@@ -300,10 +313,31 @@ bool vulkan_device_get_queue_families(VkSurfaceKHR surface, VkPhysicalDevice phy
     // add logic to explicitly prefer a physical device that supports drawing and presentation in the same queue for
     // improved performance.
 
+    if(!got_graphics || !got_present) {
+        free(queue_families);
+        queue_families = NULL;
+
+        return false;
+    }
+
+    // A family with compute but no graphics is usually backed by hardware queues of its own, so compute work submitted
+    // there overlaps the graphics queue. Optional, without one compute runs on the graphics queue.
+    p_queues->compute_index = p_queues->graphics_index;
+    p_queues->async_compute = false;
+    for(uint32_t i = 0; i < queue_family_count; ++i) {
+        if((queue_families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 &&
+            (queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+            p_queues->compute_index = i;
+            p_queues->async_compute = true;
+            LOG_TRACE("async compute queue family index: %u", i);
+            break;
+        }
+    }
+
     free(queue_families);
     queue_families = NULL;
 
-    return false;
+    return true;
 }
 
 static bool check_device_extension_support(VkPhysicalDevice physical_device)
@@ -354,6 +388,59 @@ static bool check_device_extension_support(VkPhysicalDevice physical_device)
     return true;
 }
 
+static bool is_device_extension_available(VkPhysicalDevice physical_device, const char* extension_name)
+{
+    uint32_t available_extensions_count = 0;
+    vkEnumerateDeviceExtensionProperties(physical_device, VK_NULL_HANDLE, &available_extensions_count, VK_NULL_HANDLE);
+
+    VkExtensionProperties* available_extensions = (VkExtensionProperties*)malloc(
+        available_extensions_count * sizeof(VkExtensionProperties));
+
+    if(available_extensions == NULL) {
+        LOG_ERROR("%s: Failed to allocated memory of size %lu", __func__,
+            available_extensions_count * sizeof(VkExtensionProperties));
+        return false;
+    }
+
+    vkEnumerateDeviceExtensionProperties(physical_device, VK_NULL_HANDLE, &available_extensions_count,
+        available_extensions);
+
+    bool found = false;
+    for(uint32_t i = 0; i < available_extensions_count; ++i) {
+        if(strcmp(extension_name, available_extensions[i].extensionName) == 0) {
+            found = true;
+            break;
+        }
+    }
+
+    free(available_extensions);
+    available_extensions = NULL;
+
+    return found;
+}
+
+static bool check_present_wait_support(VkPhysicalDevice physical_device)
+{
+    if(!is_device_extension_available(physical_device, VK_KHR_PRESENT_ID_EXTENSION_NAME) ||
+        !is_device_extension_available(physical_device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+        return false;
+
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {0};
+    present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {0};
+    present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    present_id_features.pNext = &present_wait_features;
+
+    VkPhysicalDeviceFeatures2 features2 = {0};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &present_id_features;
+
+    vkGetPhysicalDeviceFeatures2(physical_device, &features2);
+
+    return present_id_features.presentId == VK_TRUE && present_wait_features.presentWait == VK_TRUE;
+}
+
 bool vulkan_device_get_swapchain_support(VkSurfaceKHR surface, VkPhysicalDevice physical_device,
     swapchain_support_details_t* p_details)
 {
@@ -413,7 +500,7 @@ bool vulkan_device_get_swapchain_support(VkSurfaceKHR surface, VkPhysicalDevice
 }
 
 error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkPhysicalDevice physical_device,
-    VkDevice* p_device, queue_family_data_t* p_queues)
+    VkDevice* p_device, queue_family_data_t* p_queues, device_caps_t* p_caps)
 {
     if(surface == NULL)
         return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: surface is NULL", __func__);
@@ -427,41 +514,28 @@ error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkP
     if(p_queues == NULL)
         return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_queues is NULL", __func__);
 
+    if(p_caps == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_caps is NULL", __func__);
+
     // Check device graphics and present queue family support and store their indices p_queues
     if(!vulkan_device_get_queue_families(surface, physical_device, p_queues))
         return error_init(ERR_SRC_CORE, ERR_TEMP, "Required queue families not supported by device");
 
-    // Hard coded, make dynamic in future?
+    // One queue is created per unique family, graphics first and then present and compute if they are families of
+    // their own
+    uint32_t p_families[3] = {p_queues->graphics_index, p_queues->present_index, p_queues->compute_index};
+    uint32_t unique_q_fams[3] = {0};
     uint32_t unique_q_fams_count = 0;
-    if(p_queues->graphics_index == p_queues->present_index) {
-        // The graphics and present queue families are the same, this is the most common situation
-        unique_q_fams_count = 1;
-    }
-    else {
-        // They are not the same, not common but we will support it?
-        unique_q_fams_count = 2;
-    }
+    for(uint32_t i = 0; i < 3; ++i) {
+        bool seen = false;
+        for(uint32_t j = 0; j < unique_q_fams_count; ++j)
+            seen = seen || unique_q_fams[j] == p_families[i];
 
-    LOG_DEBUG("Unique queue families:  %u", unique_q_fams_count);
-
-    // Allocate array of ints to hold the queue family indices
-    uint32_t* unique_q_fams = (uint32_t*)malloc(unique_q_fams_count * sizeof(uint32_t));
-    if(unique_q_fams == NULL) {
-        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate memory of size %lu", __func__,
-            unique_q_fams_count * sizeof(uint32_t));
+        if(!seen)
+            unique_q_fams[unique_q_fams_count++] = p_families[i];
     }
 
-    // Fill allocated arrat with the queue family indices
-    if(unique_q_fams_count == 1) {
-        unique_q_fams[0] = p_queues->graphics_index;
-    }
-    else if(unique_q_fams_count == 2) {
-        unique_q_fams[0] = p_queues->graphics_index;
-        unique_q_fams[1] = p_queues->present_index;
-    }
-    else {
-        return error_init(ERR_SRC_CORE, ERR_TEMP, "More than two queue families is unsupported currently");
-    }
+    LOG_DEBUG("Unique queue families:  %u", unique_q_fams_count);
 
     // Create array of device queue create infos
     VkDeviceQueueCreateInfo* q_create_infos = (VkDeviceQueueCreateInfo*)malloc(
@@ -497,12 +571,76 @@ error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkP
     features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     features2.pNext = &features11;
 
+    // Optional features, only enabled if the device supports them
+    VkPhysicalDeviceVulkan12Features supported_features12 = {0};
+    supported_features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supported_features = {0};
+    supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features.pNext = &supported_features12;
+    vkGetPhysicalDeviceFeatures2(physical_device, &supported_features);
+
     // Enable the features we want
     features2.features.samplerAnisotropy = VK_TRUE;
+    features2.features.shaderStorageImageWriteWithoutFormat =
+        supported_features.features.shaderStorageImageWriteWithoutFormat;
+    features12.timelineSemaphore = VK_TRUE; // Core and required since 1.2, used by the immediate submit batcher
+    features12.drawIndirectCount = supported_features12.drawIndirectCount; // Optional, lets the GPU skip empty draws
     features13.dynamicRendering = VK_TRUE;
     features13.synchronization2 = VK_TRUE;
     features13.maintenance4 = VK_TRUE; // Must be enabled when using SPIR-V OpExecutionMode LocalSizeId
 
+    // The required extensions followed by the optional ones the device supports
+    const char* p_extensions[3] = {0};
+    uint32_t extensions_count = 0;
+    for(uint32_t i = 0; i < device_extensions_count; ++i)
+        p_extensions[extensions_count++] = device_extensions[i];
+
+    // present_id tags each present with an id and present_wait lets the CPU wait until a given id has been shown on
+    // screen, which is what the low latency present policy paces the frame loop with
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {0};
+    present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {0};
+    present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    p_caps->present_wait = check_present_wait_support(physical_device);
+    if(p_caps->present_wait) {
+        p_extensions[extensions_count++] = VK_KHR_PRESENT_ID_EXTENSION_NAME;
+        p_extensions[extensions_count++] = VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+
+        present_id_features.presentId = VK_TRUE;
+        present_id_features.pNext = &present_wait_features;
+        present_wait_features.presentWait = VK_TRUE;
+        features13.pNext = &present_id_features;
+    }
+
+    p_caps->draw_indirect_count = supported_features12.drawIndirectCount == VK_TRUE;
+
+    // Subgroup operations are core since 1.1, but which ones are supported and in which stages is up to the device.
+    // The compute passes pick their shader variants from these.
+    VkPhysicalDeviceSubgroupProperties subgroup_properties = {0};
+    subgroup_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2 = {0};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &subgroup_properties;
+    vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+    p_caps->subgroup_size = subgroup_properties.subgroupSize;
+    p_caps->subgroup_ops = (subgroup_properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 ?
+        subgroup_properties.supportedOperations :
+        0;
+
+    LOG_DEBUG("Optional device features:");
+    LOG_DEBUG("    present wait: %s", strbool(p_caps->present_wait));
+    LOG_DEBUG("    draw indirect count: %s", strbool(p_caps->draw_indirect_count));
+    LOG_DEBUG("    subgroup size: %u", p_caps->subgroup_size);
+    LOG_DEBUG("    subgroup ballot in compute: %s",
+        strbool((p_caps->subgroup_ops & VK_SUBGROUP_FEATURE_BALLOT_BIT) != 0));
+    LOG_DEBUG("    subgroup arithmetic in compute: %s",
+        strbool((p_caps->subgroup_ops & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT) != 0));
+
     // Start filling the main VkDeviceCreateInfo structure.
     VkDeviceCreateInfo create_dev_info = {0};
     create_dev_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -512,8 +650,8 @@ error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkP
     create_dev_info.pNext = &features2;
 
     // Enabeling device extensions, like swapchain
-    create_dev_info.enabledExtensionCount = device_extensions_count;
-    create_dev_info.ppEnabledExtensionNames = device_extensions;
+    create_dev_info.enabledExtensionCount = extensions_count;
+    create_dev_info.ppEnabledExtensionNames = p_extensions;
 
     if(vkCreateDevice(physical_device, &create_dev_info, VK_NULL_HANDLE, p_device) != VK_SUCCESS)
         return error_init(ERR_SRC_VULKAN, VULKAN_ERR_DEVICE, "Failed to create vulkan logical device");
@@ -526,10 +664,14 @@ error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkP
     // Because we’re only creating a single queue from "each" family, we’ll simply use index 0.
     vkGetDeviceQueue(*p_device, p_queues->graphics_index, 0, &p_queues->graphics);
     vkGetDeviceQueue(*p_device, p_queues->present_index, 0, &p_queues->present);
+    vkGetDeviceQueue(*p_device, p_queues->compute_index, 0, &p_queues->compute);
+
+    if(p_queues->async_compute)
+        LOG_INFO("Async compute queue family: %u", p_queues->compute_index);
+    else
+        LOG_INFO("No dedicated compute queue family, compute runs on the graphics queue");
 
     // Free dynamically allocated arrays
-    free(unique_q_fams);
-    unique_q_fams = NULL;
     free(q_create_infos);
     q_create_infos = NULL;
 
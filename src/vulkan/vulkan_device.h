@@ -40,7 +40,8 @@ bool vulkan_device_get_swapchain_support(VkSurfaceKHR surface, VkPhysicalDevice
  * \brief Check and get queue family indices.
  *
  * Check for and fetches the graphics queue family index and the present queue family index and stores them in a
- * queue_family_data_t.
+ * queue_family_data_t. A compute family without graphics is picked as the async compute family if there is one,
+ * otherwise the compute index is the graphics index.
  *
  * \param[in] p_engine Pointer to the vulkan_engine.
  * \param[in] device The physical device from wich the queuf family indeices are fetched from.
@@ -59,9 +60,10 @@ bool vulkan_device_get_queue_families(VkSurfaceKHR surface, VkPhysicalDevice phy
  * \param[in] physical_device The physical device.
  * \param[out] p_device Pointer to the vulkan device to be initiated.
  * \param[out] p_queues Pointer to the queue_family_data_t which will hold the queue information.
+ * \param[out] p_caps Pointer to the device_caps_t which will hold the optional features that were enabled.
  * \return True if successful, else false.
  */
 error_t vulkan_device_init(deletion_stack_t* p_dstack, VkSurfaceKHR surface, VkPhysicalDevice physical_device, VkDevice* p_device,
-    queue_family_data_t* p_queue_family_data);
+    queue_family_data_t* p_queue_family_data, device_caps_t* p_caps);
 
 #endif // VULKAN_DEVICE_H_
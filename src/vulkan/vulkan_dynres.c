@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_dynres.h"
+
+// Weight of the newest sample in the smoothed frame time
+#define DYNRES_AVG_WEIGHT 0.1
+
+// The scale is lowered above the upper threshold and raised below the lower threshold, both relative to the target
+#define DYNRES_UPPER_THRESHOLD 0.95
+#define DYNRES_LOWER_THRESHOLD 0.75
+
+// The frame time the controller aims for when it changes the scale, relative to the target
+#define DYNRES_AIM 0.85
+
+// Lowering reacts quickly to avoid dropped frames, raising waits longer so a short dip does not cause a bounce
+#define DYNRES_FRAMES_TO_LOWER 8
+#define DYNRES_FRAMES_TO_RAISE 60
+
+// The scale is snapped to multiples of this step so tiny changes do not cause a new draw extent every frame
+#define DYNRES_SCALE_STEP (1.0f / 32.0f)
+
+static float clampf(float value, float min, float max)
+{
+    if(value < min)
+        return min;
+    if(value > max)
+        return max;
+    return value;
+}
+
+void dynres_init(dynres_t* p_dynres, double target_ms, float min_scale, float max_scale)
+{
+    if(p_dynres == NULL) {
+        LOG_ERROR("%s: p_dynres is NULL", __func__);
+        return;
+    }
+
+    if(max_scale <= 0.0f)
+        max_scale = 1.0f;
+
+    if(min_scale <= 0.0f || min_scale > max_scale)
+        min_scale = max_scale;
+
+    p_dynres->target_ms = target_ms;
+    p_dynres->avg_ms = 0.0;
+    p_dynres->scale = max_scale;
+    p_dynres->min_scale = min_scale;
+    p_dynres->max_scale = max_scale;
+    p_dynres->frames_over = 0;
+    p_dynres->frames_under = 0;
+    p_dynres->enabled = true;
+}
+
+bool dynres_update(dynres_t* p_dynres, double gpu_frame_ms)
+{
+    if(p_dynres == NULL || !p_dynres->enabled || gpu_frame_ms <= 0.0 || p_dynres->target_ms <= 0.0)
+        return false;
+
+    if(p_dynres->avg_ms > 0.0)
+        p_dynres->avg_ms += DYNRES_AVG_WEIGHT * (gpu_frame_ms - p_dynres->avg_ms);
+    else
+        p_dynres->avg_ms = gpu_frame_ms;
+
+    const double upper = DYNRES_UPPER_THRESHOLD * p_dynres->target_ms;
+    const double lower = DYNRES_LOWER_THRESHOLD * p_dynres->target_ms;
+
+    if(p_dynres->avg_ms > upper) {
+        ++p_dynres->frames_over;
+        p_dynres->frames_under = 0;
+    }
+    else if(p_dynres->avg_ms < lower) {
+        ++p_dynres->frames_under;
+        p_dynres->frames_over = 0;
+    }
+    else {
+        p_dynres->frames_over = 0;
+        p_dynres->frames_under = 0;
+        return false;
+    }
+
+    bool lower_scale = p_dynres->frames_over >= DYNRES_FRAMES_TO_LOWER && p_dynres->scale > p_dynres->min_scale;
+    bool raise_scale = p_dynres->frames_under >= DYNRES_FRAMES_TO_RAISE && p_dynres->scale < p_dynres->max_scale;
+    if(!lower_scale && !raise_scale)
+        return false;
+
+    // The GPU time is roughly proportional to the number of pixels, which goes with the square of the scale
+    float new_scale = p_dynres->scale * (float)sqrt(DYNRES_AIM * p_dynres->target_ms / p_dynres->avg_ms);
+    new_scale = floorf(new_scale / DYNRES_SCALE_STEP + 0.5f) * DYNRES_SCALE_STEP;
+
+    // Always move at least one step in the requested direction
+    if(lower_scale && new_scale >= p_dynres->scale)
+        new_scale = p_dynres->scale - DYNRES_SCALE_STEP;
+    else if(raise_scale && new_scale <= p_dynres->scale)
+        new_scale = p_dynres->scale + DYNRES_SCALE_STEP;
+
+    new_scale = clampf(new_scale, p_dynres->min_scale, p_dynres->max_scale);
+
+    p_dynres->frames_over = 0;
+    p_dynres->frames_under = 0;
+
+    if(fabsf(new_scale - p_dynres->scale) < 0.5f * DYNRES_SCALE_STEP)
+        return false;
+
+    LOG_DEBUG("Render scale %.3f -> %.3f (gpu frame %.2f ms, target %.2f ms)", (double)p_dynres->scale,
+        (double)new_scale, p_dynres->avg_ms, p_dynres->target_ms);
+
+    p_dynres->scale = new_scale;
+
+    // The old average was measured at the old scale, start over with the samples at the new one
+    p_dynres->avg_ms = 0.0;
+
+    return true;
+}
+
+void dynres_set_enabled(dynres_t* p_dynres, bool enabled)
+{
+    if(p_dynres == NULL)
+        return;
+
+    p_dynres->enabled = enabled;
+    p_dynres->scale = p_dynres->max_scale;
+    p_dynres->avg_ms = 0.0;
+    p_dynres->frames_over = 0;
+    p_dynres->frames_under = 0;
+}
+
+void dynres_apply(const dynres_t* p_dynres, uint32_t width, uint32_t height, uint32_t* p_width, uint32_t* p_height)
+{
+    float scale = p_dynres != NULL ? p_dynres->scale : 1.0f;
+
+    float scaled_width = floorf((float)width * scale);
+    float scaled_height = floorf((float)height * scale);
+
+    *p_width = scaled_width < 1.0f ? 1 : (uint32_t)scaled_width;
+    *p_height = scaled_height < 1.0f ? 1 : (uint32_t)scaled_height;
+}
@@ -0,0 +1,56 @@
+#ifndef VULKAN_DYNRES_H_
+#define VULKAN_DYNRES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Dynamic resolution controller. Adjusts the render scale of the draw extent from the measured GPU frame time so the
+ * frame time is held below a target budget.
+ *
+ * The controller has hysteresis: the scale is only lowered after the frame time has been over the budget for a number
+ * of consecutive frames, and only raised after it has been well under the budget for a longer run of frames. Between
+ * the two thresholds the scale is left alone, so it does not oscillate around the budget.
+ */
+typedef struct dynres_s {
+    double target_ms;       // GPU frame time budget
+    double avg_ms;          // Smoothed GPU frame time
+    float scale;            // Current render scale, applied to both dimensions
+    float min_scale;        // Lowest allowed render scale
+    float max_scale;        // Highest allowed render scale
+    uint32_t frames_over;   // Consecutive frames over the upper threshold
+    uint32_t frames_under;  // Consecutive frames under the lower threshold
+    bool enabled;
+} dynres_t;
+
+/**
+ * Initiate the dynamic resolution controller, it starts enabled at max_scale.
+ *
+ * \param[out] p_dynres Pointer to the dynres_t to initiate.
+ * \param[in] target_ms The GPU frame time budget in milliseconds.
+ * \param[in] min_scale The lowest allowed render scale, in (0, max_scale].
+ * \param[in] max_scale The highest allowed render scale, usually 1.
+ */
+void dynres_init(dynres_t* p_dynres, double target_ms, float min_scale, float max_scale);
+
+/**
+ * Feed the controller a new GPU frame time sample.
+ *
+ * \param[in] p_dynres Pointer to the dynres_t.
+ * \param[in] gpu_frame_ms The GPU time of the last finished frame in milliseconds.
+ *
+ * \return True if the render scale changed.
+ */
+bool dynres_update(dynres_t* p_dynres, double gpu_frame_ms);
+
+/**
+ * Enable or disable the controller. When disabled the scale is reset to max_scale.
+ */
+void dynres_set_enabled(dynres_t* p_dynres, bool enabled);
+
+/**
+ * Scale an extent by the current render scale. The result is never smaller than 1x1.
+ */
+void dynres_apply(const dynres_t* p_dynres, uint32_t width, uint32_t height, uint32_t* p_width, uint32_t* p_height);
+
+#endif // VULKAN_DYNRES_H_
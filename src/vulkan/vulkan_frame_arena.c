@@ -0,0 +1,65 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_frame_arena.h"
+
+void frame_arena_init(frame_arena_t* p_arena, void* p_mapped, size_t frame_size, size_t min_alignment)
+{
+    if(p_arena == NULL) {
+        LOG_ERROR("%s: p_arena is NULL", __func__);
+        return;
+    }
+
+    if(min_alignment == 0)
+        min_alignment = 1;
+
+    p_arena->p_mapped = (uint8_t*)p_mapped;
+    p_arena->frame_size = frame_size & ~(min_alignment - 1);
+    p_arena->min_alignment = min_alignment;
+    p_arena->begin = 0;
+    p_arena->used = 0;
+    p_arena->dropped = 0;
+    p_arena->open = false;
+}
+
+void frame_arena_begin(frame_arena_t* p_arena, uint32_t frame_index)
+{
+    if(p_arena == NULL) {
+        LOG_ERROR("%s: p_arena is NULL", __func__);
+        return;
+    }
+
+    p_arena->begin = (size_t)frame_index * p_arena->frame_size;
+    p_arena->used = 0;
+    p_arena->dropped = 0;
+    p_arena->open = p_arena->p_mapped != NULL;
+}
+
+void* frame_arena_alloc(frame_arena_t* p_arena, size_t size, size_t alignment, uint32_t* p_offset)
+{
+    if(p_arena == NULL) {
+        LOG_ERROR("%s: p_arena is NULL", __func__);
+        return NULL;
+    }
+
+    if(alignment < p_arena->min_alignment)
+        alignment = p_arena->min_alignment;
+
+    // Aligned in the whole buffer, since that offset is the dynamic offset the GPU checks
+    size_t offset = (p_arena->begin + p_arena->used + alignment - 1) & ~(alignment - 1);
+    size_t end = p_arena->begin + p_arena->frame_size;
+
+    if(!p_arena->open || offset > end || size > end - offset) {
+        p_arena->dropped += size;
+        return NULL;
+    }
+
+    p_arena->used = offset + size - p_arena->begin;
+
+    if(p_offset != NULL)
+        *p_offset = (uint32_t)offset;
+
+    return p_arena->p_mapped + offset;
+}
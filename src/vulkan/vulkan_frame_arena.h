@@ -0,0 +1,64 @@
+#ifndef VULKAN_FRAME_ARENA_H_
+#define VULKAN_FRAME_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes each frame in flight can allocate from the arena
+#define FRAME_ARENA_SIZE (4u * 1024u * 1024u)
+
+/**
+ * \brief A linear allocator for the data of a frame, over one persistently mapped buffer shared by every frame in
+ * flight.
+ *
+ * The buffer is split into one slice of frame_size bytes per frame in flight. Opening a frame empties its slice and
+ * every allocation bumps a pointer through it, so per frame data needs no buffer creation, no mapping and no malloc.
+ * Allocations are handed out as an offset into the whole buffer, which is what the dynamic offset of a descriptor set
+ * pointing at the start of the buffer is set to.
+ *
+ * The mapped memory is usually write combined, so allocations must only be written, never read back.
+ */
+typedef struct frame_arena_s {
+    uint8_t* p_mapped;    // Start of the whole mapped buffer
+    size_t frame_size;    // Bytes per frame, a multiple of min_alignment
+    size_t min_alignment; // Every allocation is aligned to at least this, a power of two
+    size_t begin;         // Offset of the slice of the open frame
+    size_t used;          // Bytes of the slice handed out, including padding
+    size_t dropped;       // Bytes that did not fit this frame
+    bool open;            // False until a frame is opened
+} frame_arena_t;
+
+/**
+ * \brief Initiate an arena with no frame open.
+ *
+ * \param[in] p_arena Pointer to the frame_arena_t.
+ * \param[in] p_mapped The mapped buffer, at least frame_size bytes per frame in flight.
+ * \param[in] frame_size Bytes per frame, rounded down to a multiple of min_alignment.
+ * \param[in] min_alignment Alignment of every allocation, the offset alignment limits of the device. Must be a power of
+ * two.
+ */
+void frame_arena_init(frame_arena_t* p_arena, void* p_mapped, size_t frame_size, size_t min_alignment);
+
+/**
+ * \brief Open a frame, its slice starts out empty.
+ *
+ * \param[in] p_arena Pointer to the frame_arena_t.
+ * \param[in] frame_index Index of the frame in flight. The GPU must be done with the last frame that used it.
+ */
+void frame_arena_begin(frame_arena_t* p_arena, uint32_t frame_index);
+
+/**
+ * \brief Allocate from the slice of the open frame.
+ *
+ * \param[in] p_arena Pointer to the frame_arena_t.
+ * \param[in] size Bytes to allocate.
+ * \param[in] alignment Alignment of the allocation, a power of two, raised to min_alignment if lower.
+ * \param[out] p_offset Offset of the allocation in the whole buffer, may be NULL.
+ *
+ * \return Pointer to the mapped allocation, or NULL if no frame is open or it does not fit, in which case its size is
+ * counted as dropped.
+ */
+void* frame_arena_alloc(frame_arena_t* p_arena, size_t size, size_t alignment, uint32_t* p_offset);
+
+#endif // VULKAN_FRAME_ARENA_H_
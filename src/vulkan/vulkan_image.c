@@ -17,58 +17,123 @@ typedef struct alloc_img_del_s {
     allocated_image_t allocated_image;
 } alloc_img_del_t;
 
+/**
+ * Struct used for deleting a sampler
+ */
+typedef struct sampler_del_s {
+    VkDevice device;
+    VkSampler sampler;
+} sampler_del_t;
+
+/**
+ * Struct used for deleting an image view
+ */
+typedef struct view_del_s {
+    VkDevice device;
+    VkImageView view;
+} view_del_t;
+
 /**
  * Deinitialize a vulkan image.
  */
 void vulkan_image_deinit(void* p_void_allocated_image_del_struct);
 
 /**
- * \brief blablabla
+ * Deinitialize a vulkan sampler.
  */
-static VkImageSubresourceRange img_subresource_Range(VkImageAspectFlags aspect_mask);
+static void vulkan_image_sampler_deinit(void* p_void_sampler_del);
 
-error_t vulkan_image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
-    uint32_t width, uint32_t height, allocated_image_t* p_allocated_image)
-{
-    if(device == NULL)
-        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+/**
+ * Deinitialize a vulkan image view.
+ */
+static void vulkan_image_view_deinit(void* p_void_view_del);
 
-    if(physical_device == NULL)
-        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: physical_device is NULL", __func__);
+/**
+ * \brief blablabla
+ */
+static VkImageSubresourceRange img_subresource_Range(VkImageAspectFlags aspect_mask);
 
-    // CREATE DRAW IMAGE
+/**
+ * \brief Create an image in device local memory and a view of it.
+ *
+ * \param[in] view_levels Number of mips the view covers from mip 0.
+ */
+static error_t image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkFormat format, VkImageUsageFlags usage, uint32_t width, uint32_t height, uint32_t mip_levels,
+    uint32_t view_levels, allocated_image_t* p_allocated_image);
 
-    p_allocated_image->format = VK_FORMAT_R16G16B16A16_SFLOAT;
-    VkExtent3D draw_image_extent = {width, height, 1};
-    p_allocated_image->extent = draw_image_extent;
+/**
+ * Record a barrier on a single mip of an image.
+ */
+static void mip_barrier(VkCommandBuffer cmd, VkImage img, uint32_t mip_level, VkImageLayout old_layout,
+    VkImageLayout new_layout, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access,
+    VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access);
 
+error_t vulkan_image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    uint32_t width, uint32_t height, uint32_t mip_levels, allocated_image_t* p_allocated_image)
+{
     VkImageUsageFlags draw_image_usage = 0;
 
     draw_image_usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     draw_image_usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     draw_image_usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     draw_image_usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    draw_image_usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
     draw_image_usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+    return image_create(p_dstack, device, physical_device, VK_FORMAT_R16G16B16A16_SFLOAT, draw_image_usage, width,
+        height, mip_levels, 1, p_allocated_image);
+}
+
+error_t vulkan_image_create_texture(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    uint32_t width, uint32_t height, uint32_t mip_levels, allocated_image_t* p_allocated_image)
+{
+    // Linear blits of R8G8B8A8_SRGB are supported by every device, so the mips can always be generated with them
+    VkImageUsageFlags texture_usage =
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    uint32_t levels = mip_levels > 0 ? mip_levels : 1;
+
+    return image_create(p_dstack, device, physical_device, VK_FORMAT_R8G8B8A8_SRGB, texture_usage, width, height,
+        levels, levels, p_allocated_image);
+}
+
+static error_t image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkFormat format, VkImageUsageFlags usage, uint32_t width, uint32_t height, uint32_t mip_levels,
+    uint32_t view_levels, allocated_image_t* p_allocated_image)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(physical_device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: physical_device is NULL", __func__);
+
+    // CREATE IMAGE
+
+    p_allocated_image->format = format;
+    VkExtent3D image_extent = {width, height, 1};
+    p_allocated_image->extent = image_extent;
+    p_allocated_image->mip_levels = mip_levels > 0 ? mip_levels : 1;
+
     VkImageCreateInfo img_info = {0};
 
     img_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     img_info.imageType = VK_IMAGE_TYPE_2D;
     img_info.extent = p_allocated_image->extent;
     img_info.extent.depth = 1;
-    img_info.mipLevels = 1;
+    img_info.mipLevels = p_allocated_image->mip_levels;
     img_info.arrayLayers = 1;
     img_info.format = p_allocated_image->format;        // Or your needed format
     img_info.tiling = VK_IMAGE_TILING_OPTIMAL;          // Usually optimal for GPU use
     img_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // = 0 default value
-    img_info.usage = draw_image_usage;                  // Example
+    img_info.usage = usage;
     img_info.samples = VK_SAMPLE_COUNT_1_BIT;
     img_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // = 0 default value
 
     if(vkCreateImage(device, &img_info, VK_NULL_HANDLE, &p_allocated_image->image) != VK_SUCCESS)
-        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE, "Failed to create draw image");
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE, "Failed to create image");
 
-    // For the draw image, we want to allocate it on the GPU local memory
+    // Images are only ever read and written by the GPU, so they are allocated in device local memory
     // ALLOCATE MEMORY ON THE GPU
 
     VkMemoryRequirements mem_req;
@@ -98,7 +163,7 @@ error_t vulkan_image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysi
     vkAllocateMemory(device, &alloc_info, VK_NULL_HANDLE, &p_allocated_image->mem);
     vkBindImageMemory(device, p_allocated_image->image, p_allocated_image->mem, 0);
 
-    // CREATE DRAW IMAGE VIEW
+    // CREATE IMAGE VIEW
 
     VkImageViewCreateInfo img_view_info = {0};
 
@@ -107,13 +172,13 @@ error_t vulkan_image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysi
     img_view_info.image = p_allocated_image->image;
     img_view_info.format = p_allocated_image->format;
     img_view_info.subresourceRange.baseMipLevel = 0;
-    img_view_info.subresourceRange.levelCount = 1;
+    img_view_info.subresourceRange.levelCount = view_levels;
     img_view_info.subresourceRange.baseArrayLayer = 0;
     img_view_info.subresourceRange.layerCount = 1;
     img_view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
     if(vkCreateImageView(device, &img_view_info, VK_NULL_HANDLE, &p_allocated_image->image_view) != VK_SUCCESS)
-        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE_VIEW, "Failed to create draw image view");
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE_VIEW, "Failed to create image view");
 
     // Add cleanup
     alloc_img_del_t* p_img_del = (alloc_img_del_t*)malloc(sizeof(alloc_img_del_t));
@@ -195,6 +260,123 @@ void vulkan_image_deinit(void* p_void_img_del)
     p_void_img_del = NULL;
 }
 
+error_t vulkan_image_sampler_init(deletion_stack_t* p_dstack, VkDevice device, VkFilter filter, VkSampler* p_sampler)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_sampler == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_sampler is NULL", __func__);
+
+    VkSamplerCreateInfo sampler_info = {0};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = filter;
+    sampler_info.minFilter = filter;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    if(vkCreateSampler(device, &sampler_info, VK_NULL_HANDLE, p_sampler) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_SAMPLER, "Failed to create sampler");
+
+    // Add cleanup
+    sampler_del_t* p_sampler_del = (sampler_del_t*)malloc(sizeof(sampler_del_t));
+    p_sampler_del->device = device;
+    p_sampler_del->sampler = *p_sampler;
+
+    error_t err = deletion_stack_push(p_dstack, p_sampler_del, vulkan_image_sampler_deinit);
+    if(err.code != 0) {
+        vulkan_image_sampler_deinit(p_sampler_del);
+        return err;
+    }
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+error_t vulkan_image_view_init(deletion_stack_t* p_dstack, VkDevice device, const allocated_image_t* p_image,
+    uint32_t mip_level, VkImageView* p_view)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_image == NULL || p_view == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_image or p_view is NULL", __func__);
+
+    if(mip_level >= p_image->mip_levels)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: mip %u of an image with %u mips", __func__, mip_level,
+            p_image->mip_levels);
+
+    VkImageViewCreateInfo view_info = {0};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.image = p_image->image;
+    view_info.format = p_image->format;
+    view_info.subresourceRange.baseMipLevel = mip_level;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+
+    if(vkCreateImageView(device, &view_info, VK_NULL_HANDLE, p_view) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE_VIEW, "Failed to create view of mip %u", mip_level);
+
+    // Add cleanup
+    view_del_t* p_view_del = (view_del_t*)malloc(sizeof(view_del_t));
+    p_view_del->device = device;
+    p_view_del->view = *p_view;
+
+    error_t err = deletion_stack_push(p_dstack, p_view_del, vulkan_image_view_deinit);
+    if(err.code != 0) {
+        vulkan_image_view_deinit(p_view_del);
+        return err;
+    }
+
+    return SUCCESS;
+}
+
+static void vulkan_image_view_deinit(void* p_void_view_del)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_view_del == NULL) {
+        LOG_ERROR("%s: p_void_view_del is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    view_del_t* p_view_del = (view_del_t*)p_void_view_del;
+
+    vkDestroyImageView(p_view_del->device, p_view_del->view, VK_NULL_HANDLE);
+
+    free(p_view_del);
+    p_view_del = NULL;
+    p_void_view_del = NULL;
+}
+
+static void vulkan_image_sampler_deinit(void* p_void_sampler_del)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_sampler_del == NULL) {
+        LOG_ERROR("%s: p_void_sampler_del is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    sampler_del_t* p_sampler_del = (sampler_del_t*)p_void_sampler_del;
+
+    vkDestroySampler(p_sampler_del->device, p_sampler_del->sampler, VK_NULL_HANDLE);
+
+    free(p_sampler_del);
+    p_sampler_del = NULL;
+    p_void_sampler_del = NULL;
+}
+
 void vulkan_image_transition(VkCommandBuffer cmd, VkImage img, VkImageLayout old_layout, VkImageLayout new_layout)
 {
     // VkImageMemoryBarrier2 contains the information for a given image barrier. On here, is where we set the old and
@@ -262,6 +444,115 @@ void vulkan_image_transition(VkCommandBuffer cmd, VkImage img, VkImageLayout old
     vkCmdPipelineBarrier2(cmd, &dep_info);
 }
 
+void vulkan_image_barrier(VkCommandBuffer cmd, VkImage img, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access,
+    VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access)
+{
+    VkImageMemoryBarrier2 img_barrier2 = {0};
+    img_barrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    img_barrier2.srcStageMask = src_stage;
+    img_barrier2.srcAccessMask = src_access;
+    img_barrier2.dstStageMask = dst_stage;
+    img_barrier2.dstAccessMask = dst_access;
+    img_barrier2.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    img_barrier2.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    img_barrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier2.subresourceRange = img_subresource_Range(VK_IMAGE_ASPECT_COLOR_BIT);
+    img_barrier2.image = img;
+
+    VkDependencyInfo dep_info = {0};
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.imageMemoryBarrierCount = 1;
+    dep_info.pImageMemoryBarriers = &img_barrier2;
+
+    vkCmdPipelineBarrier2(cmd, &dep_info);
+}
+
+void vulkan_image_generate_mips(VkCommandBuffer cmd, const allocated_image_t* p_image)
+{
+    const VkPipelineStageFlags2 transfer = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    const VkPipelineStageFlags2 shaders =
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+    int32_t width = (int32_t)p_image->extent.width;
+    int32_t height = (int32_t)p_image->extent.height;
+
+    // Each mip is blitted from the one above it, which is then done with and goes to the shader read layout
+    for(uint32_t i = 1; i < p_image->mip_levels; ++i) {
+        mip_barrier(cmd, p_image->image, i - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, transfer, VK_ACCESS_2_TRANSFER_WRITE_BIT, transfer,
+            VK_ACCESS_2_TRANSFER_READ_BIT);
+
+        int32_t mip_width = width > 1 ? width / 2 : 1;
+        int32_t mip_height = height > 1 ? height / 2 : 1;
+
+        VkImageBlit2 blit_region = {0};
+        blit_region.sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2;
+        blit_region.srcOffsets[1].x = width;
+        blit_region.srcOffsets[1].y = height;
+        blit_region.srcOffsets[1].z = 1;
+        blit_region.dstOffsets[1].x = mip_width;
+        blit_region.dstOffsets[1].y = mip_height;
+        blit_region.dstOffsets[1].z = 1;
+        blit_region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit_region.srcSubresource.layerCount = 1;
+        blit_region.srcSubresource.mipLevel = i - 1;
+        blit_region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit_region.dstSubresource.layerCount = 1;
+        blit_region.dstSubresource.mipLevel = i;
+
+        VkBlitImageInfo2 blit_info = {0};
+        blit_info.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2;
+        blit_info.srcImage = p_image->image;
+        blit_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        blit_info.dstImage = p_image->image;
+        blit_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        blit_info.filter = VK_FILTER_LINEAR;
+        blit_info.regionCount = 1;
+        blit_info.pRegions = &blit_region;
+
+        vkCmdBlitImage2(cmd, &blit_info);
+
+        mip_barrier(cmd, p_image->image, i - 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, transfer, 0, shaders, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+
+        width = mip_width;
+        height = mip_height;
+    }
+
+    // The last mip is only ever written
+    mip_barrier(cmd, p_image->image, p_image->mip_levels - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, transfer, VK_ACCESS_2_TRANSFER_WRITE_BIT, shaders,
+        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+}
+
+static void mip_barrier(VkCommandBuffer cmd, VkImage img, uint32_t mip_level, VkImageLayout old_layout,
+    VkImageLayout new_layout, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access,
+    VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access)
+{
+    VkImageMemoryBarrier2 img_barrier2 = {0};
+    img_barrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    img_barrier2.srcStageMask = src_stage;
+    img_barrier2.srcAccessMask = src_access;
+    img_barrier2.dstStageMask = dst_stage;
+    img_barrier2.dstAccessMask = dst_access;
+    img_barrier2.oldLayout = old_layout;
+    img_barrier2.newLayout = new_layout;
+    img_barrier2.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier2.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier2.subresourceRange = img_subresource_Range(VK_IMAGE_ASPECT_COLOR_BIT);
+    img_barrier2.subresourceRange.baseMipLevel = mip_level;
+    img_barrier2.subresourceRange.levelCount = 1;
+    img_barrier2.image = img;
+
+    VkDependencyInfo dep_info = {0};
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.imageMemoryBarrierCount = 1;
+    dep_info.pImageMemoryBarriers = &img_barrier2;
+
+    vkCmdPipelineBarrier2(cmd, &dep_info);
+}
+
 static VkImageSubresourceRange img_subresource_Range(VkImageAspectFlags aspect_mask)
 {
     VkImageSubresourceRange sub_image = {0};
@@ -10,12 +10,50 @@
 
 /**
  * \brief Create vulkan image.
+ *
+ * The image view covers mip 0 only, views of the other mips are created with vulkan_image_view_init.
  */
 error_t vulkan_image_create(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
-    uint32_t width, uint32_t height, allocated_image_t* p_allocated_image);
+    uint32_t width, uint32_t height, uint32_t mip_levels, allocated_image_t* p_allocated_image);
+
+/**
+ * \brief Create a sampled 8 bit sRGB texture image with room for mip_levels mips.
+ *
+ * The image view covers every mip. The mips are filled by copying mip 0 and recording vulkan_image_generate_mips.
+ */
+error_t vulkan_image_create_texture(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    uint32_t width, uint32_t height, uint32_t mip_levels, allocated_image_t* p_allocated_image);
+
+/**
+ * \brief Create a view of a single mip of an image.
+ */
+error_t vulkan_image_view_init(deletion_stack_t* p_dstack, VkDevice device, const allocated_image_t* p_image,
+    uint32_t mip_level, VkImageView* p_view);
+
+/**
+ * \brief Create a clamp-to-edge sampler with the given filter.
+ */
+error_t vulkan_image_sampler_init(deletion_stack_t* p_dstack, VkDevice device, VkFilter filter, VkSampler* p_sampler);
 
 void vulkan_image_transition(VkCommandBuffer cmd, VkImage img, VkImageLayout old_layout, VkImageLayout new_layout);
 
+/**
+ * \brief Record a barrier on every mip of an image that stays in the general layout.
+ *
+ * Lighter than a transition between two general layouts, which waits for all commands, so it suits passes that
+ * follow each other closely such as the levels of a post process chain.
+ */
+void vulkan_image_barrier(VkCommandBuffer cmd, VkImage img, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access,
+    VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access);
+
+/**
+ * \brief Record a blit cascade that fills every mip of an image from mip 0.
+ *
+ * Every mip must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with mip 0 written, afterwards they are all in
+ * VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ */
+void vulkan_image_generate_mips(VkCommandBuffer cmd, const allocated_image_t* p_image);
+
 void vulkan_image_copy_image_to_image(VkCommandBuffer cmd, VkImage src_img, VkImage dst_img, VkExtent2D src_ext,
     VkExtent2D dst_ext);
 
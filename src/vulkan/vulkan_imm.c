@@ -0,0 +1,255 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "error/vulkan_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_cmd.h"
+#include "vulkan/vulkan_sync.h"
+#include "vulkan/vulkan_imm.h"
+
+/**
+ * Wait for a batch to complete and delete the resources deferred to it, so its command buffer can be reused.
+ */
+static error_t reclaim_batch(imm_batcher_t* p_imm, uint32_t index);
+
+/**
+ * \brief Flush the deletion stacks of the batches.
+ *
+ * \param[in] p_void_imm Pointer to the imm_batcher_t.
+ */
+static void vulkan_imm_deinit(void* p_void_imm);
+
+error_t vulkan_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    imm_batcher_t* p_imm)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_queues == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_queues is NULL", __func__);
+
+    if(p_imm == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm is NULL", __func__);
+
+    *p_imm = (imm_batcher_t){0};
+    p_imm->device = device;
+    p_imm->queue = p_queues->graphics;
+
+    error_t err = vulkan_cmd_imm_init(p_dstack, device, p_queues, IMM_BATCHES_IN_FLIGHT, &p_imm->cmd_pool,
+        p_imm->p_cmds);
+    if(err.code != 0)
+        return err;
+
+    err = vulkan_sync_imm_init(p_dstack, device, &p_imm->timeline);
+    if(err.code != 0)
+        return err;
+
+    for(int i = 0; i < IMM_BATCHES_IN_FLIGHT; ++i) {
+        p_imm->p_dstacks[i] = deletion_stack_init();
+        if(p_imm->p_dstacks[i] == NULL) {
+            vulkan_imm_deinit(p_imm);
+            return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "%s: Failed to initiate deletion stack",
+                __func__);
+        }
+    }
+
+    // CLEANUP, pushed after the pool and the semaphore so the deferred resources are deleted before them
+    err = deletion_stack_push(p_dstack, p_imm, vulkan_imm_deinit);
+    if(err.code != 0) {
+        vulkan_imm_deinit(p_imm);
+        return err;
+    }
+
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+static void vulkan_imm_deinit(void* p_void_imm)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_imm == NULL) {
+        LOG_ERROR("%s: p_void_imm is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    imm_batcher_t* p_imm = (imm_batcher_t*)p_void_imm;
+
+    // The device is idle at this point, so every batch has completed
+    for(int i = 0; i < IMM_BATCHES_IN_FLIGHT; ++i) {
+        if(p_imm->p_dstacks[i] == NULL)
+            continue;
+
+        error_t err = deletion_stack_flush(&p_imm->p_dstacks[i]);
+        if(err.code != 0) {
+            LOG_ERROR("%s: %s", __func__, err.msg);
+            error_deinit(&err);
+        }
+    }
+
+    p_void_imm = NULL;
+}
+
+error_t vulkan_imm_begin(imm_batcher_t* p_imm, VkCommandBuffer* p_cmd, uint64_t* p_value)
+{
+    if(p_imm == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm is NULL", __func__);
+
+    if(p_cmd == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_cmd is NULL", __func__);
+
+    if(!p_imm->recording) {
+        uint32_t index = (p_imm->current + 1) % IMM_BATCHES_IN_FLIGHT;
+
+        error_t err = reclaim_batch(p_imm, index);
+        if(err.code != 0)
+            return err;
+
+        if(vkResetCommandBuffer(p_imm->p_cmds[index], 0) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "%s: Failed to reset command buffer", __func__);
+
+        VkCommandBufferBeginInfo begin_info = {0};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if(vkBeginCommandBuffer(p_imm->p_cmds[index], &begin_info) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "%s: Failed to begin command buffer", __func__);
+
+        p_imm->current = index;
+        p_imm->records_count = 0;
+        p_imm->recording = true;
+    }
+
+    ++p_imm->records_count;
+
+    *p_cmd = p_imm->p_cmds[p_imm->current];
+    if(p_value != NULL)
+        *p_value = p_imm->last_submitted + 1;
+
+    return SUCCESS;
+}
+
+error_t vulkan_imm_defer_delete(imm_batcher_t* p_imm, void* p_resource, void (*deletion_func)(void*))
+{
+    if(p_imm == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm is NULL", __func__);
+
+    if(!p_imm->recording)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: No immediate batch is open", __func__);
+
+    return deletion_stack_push(p_imm->p_dstacks[p_imm->current], p_resource, deletion_func);
+}
+
+error_t vulkan_imm_flush(imm_batcher_t* p_imm, uint64_t* p_value)
+{
+    if(p_imm == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm is NULL", __func__);
+
+    if(p_imm->recording) {
+        VkCommandBuffer cmd = p_imm->p_cmds[p_imm->current];
+        uint64_t value = p_imm->last_submitted + 1;
+
+        // The batch is closed even if the submit fails, a half recorded command buffer can not be continued
+        p_imm->recording = false;
+
+        if(vkEndCommandBuffer(cmd) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "%s: Failed to end command buffer", __func__);
+
+        VkCommandBufferSubmitInfo cmd_info = vulkan_cmd_get_buffer_submit_info(cmd);
+        VkSemaphoreSubmitInfo signal_info = vulkan_sync_get_timeline_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            p_imm->timeline, value);
+
+        VkSubmitInfo2 submit_info2 = vulkan_cmd_get_submit_info2(&cmd_info, &signal_info, VK_NULL_HANDLE);
+
+        if(vkQueueSubmit2(p_imm->queue, 1, &submit_info2, VK_NULL_HANDLE) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "%s: Failed to submit immediate batch", __func__);
+
+        p_imm->p_values[p_imm->current] = value;
+        p_imm->last_submitted = value;
+
+        LOG_TRACE("Immediate batch %llu submitted with %u records", (unsigned long long)value, p_imm->records_count);
+    }
+
+    if(p_value != NULL)
+        *p_value = p_imm->last_submitted;
+
+    return SUCCESS;
+}
+
+bool vulkan_imm_is_complete(const imm_batcher_t* p_imm, uint64_t value)
+{
+    if(p_imm == NULL)
+        return false;
+
+    if(value == 0)
+        return true;
+
+    uint64_t completed = 0;
+    if(vkGetSemaphoreCounterValue(p_imm->device, p_imm->timeline, &completed) != VK_SUCCESS)
+        return false;
+
+    return completed >= value;
+}
+
+error_t vulkan_imm_wait(imm_batcher_t* p_imm, uint64_t value)
+{
+    if(p_imm == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm is NULL", __func__);
+
+    if(value == 0)
+        return SUCCESS;
+
+    // Waiting for the open batch would never return, it has to be submitted first
+    if(value > p_imm->last_submitted) {
+        error_t err = vulkan_imm_flush(p_imm, NULL);
+        if(err.code != 0)
+            return err;
+    }
+
+    if(value > p_imm->last_submitted)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Value %llu has not been handed out", __func__,
+            (unsigned long long)value);
+
+    VkSemaphoreWaitInfo wait_info = {0};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &p_imm->timeline;
+    wait_info.pValues = &value;
+
+    if(vkWaitSemaphores(p_imm->device, &wait_info, UINT64_MAX) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_SEMAPHORE, "%s: Failed to wait for value %llu", __func__,
+            (unsigned long long)value);
+
+    return SUCCESS;
+}
+
+static error_t reclaim_batch(imm_batcher_t* p_imm, uint32_t index)
+{
+    if(p_imm->p_values[index] == 0)
+        return SUCCESS;
+
+    error_t err = vulkan_imm_wait(p_imm, p_imm->p_values[index]);
+    if(err.code != 0)
+        return err;
+
+    p_imm->p_values[index] = 0;
+
+    // Flushing frees the stack, so a new one is made for the next batch
+    err = deletion_stack_flush(&p_imm->p_dstacks[index]);
+    if(err.code != 0)
+        return err;
+
+    p_imm->p_dstacks[index] = deletion_stack_init();
+    if(p_imm->p_dstacks[index] == NULL)
+        return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "%s: Failed to initiate deletion stack", __func__);
+
+    return SUCCESS;
+}
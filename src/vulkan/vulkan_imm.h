@@ -0,0 +1,86 @@
+#ifndef VULKAN_IMM_H_
+#define VULKAN_IMM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+
+// Number of immediate batches that can be in flight before vulkan_imm_begin has to wait for the oldest one
+#define IMM_BATCHES_IN_FLIGHT 4
+
+/**
+ * \brief Batches one-off GPU work (layout transitions, clears, uploads) into as few queue submits as possible.
+ *
+ * Commands are recorded into an open batch by any number of vulkan_imm_begin calls and submitted together by
+ * vulkan_imm_flush. Each batch signals the next value of a timeline semaphore when it completes, so callers keep the
+ * value and check or wait for it later instead of blocking on a fence after every submit.
+ *
+ * Not thread safe, all calls must come from the same thread.
+ */
+typedef struct imm_batcher_s {
+    VkDevice device;
+    VkQueue queue;
+    VkCommandPool cmd_pool;
+    VkCommandBuffer p_cmds[IMM_BATCHES_IN_FLIGHT];
+    deletion_stack_t* p_dstacks[IMM_BATCHES_IN_FLIGHT]; // Resources released once the batch has completed
+    uint64_t p_values[IMM_BATCHES_IN_FLIGHT];           // Timeline value signaled by the last submit of each batch
+    VkSemaphore timeline;
+    uint64_t last_submitted; // Timeline value of the last flushed batch, 0 if none
+    uint32_t current;        // Index of the open batch
+    uint32_t records_count;  // Number of vulkan_imm_begin calls recorded into the open batch
+    bool recording;
+} imm_batcher_t;
+
+/**
+ * \brief Initiate the immediate batcher.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] p_queues Pointer to the queue family data, the batches are submitted to the graphics queue.
+ * \param[out] p_imm Pointer to the imm_batcher_t to initiate. The deletion stack keeps the pointer, so it must stay
+ * valid until the stack is flushed.
+ */
+error_t vulkan_imm_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    imm_batcher_t* p_imm);
+
+/**
+ * \brief Get the command buffer of the open batch to record immediate commands into.
+ *
+ * Opens a new batch if none is open, which only blocks if all IMM_BATCHES_IN_FLIGHT batches are still executing.
+ *
+ * \param[in] p_imm Pointer to the imm_batcher_t.
+ * \param[out] p_cmd The command buffer to record into. Only valid until the next vulkan_imm_flush.
+ * \param[out] p_value Optional, the timeline value that is signaled once the recorded commands have completed.
+ */
+error_t vulkan_imm_begin(imm_batcher_t* p_imm, VkCommandBuffer* p_cmd, uint64_t* p_value);
+
+/**
+ * Push a resource used by the open batch, for example a staging buffer, which is deleted once the batch has
+ * completed. Must be called between vulkan_imm_begin and vulkan_imm_flush.
+ */
+error_t vulkan_imm_defer_delete(imm_batcher_t* p_imm, void* p_resource, void (*deletion_func)(void*));
+
+/**
+ * \brief Submit the open batch. Does nothing if no batch is open.
+ *
+ * \param[in] p_imm Pointer to the imm_batcher_t.
+ * \param[out] p_value Optional, the timeline value signaled by the last submitted batch.
+ */
+error_t vulkan_imm_flush(imm_batcher_t* p_imm, uint64_t* p_value);
+
+/**
+ * Check without blocking if the batch that signals value has completed.
+ */
+bool vulkan_imm_is_complete(const imm_batcher_t* p_imm, uint64_t value);
+
+/**
+ * Block until the batch that signals value has completed. The open batch is flushed first if value belongs to it.
+ */
+error_t vulkan_imm_wait(imm_batcher_t* p_imm, uint64_t value);
+
+#endif // VULKAN_IMM_H_
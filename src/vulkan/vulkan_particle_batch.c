@@ -0,0 +1,70 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_particle_batch.h"
+
+size_t particle_batch_buffer_size(void)
+{
+    return (size_t)PARTICLE_MAX_EMITTERS * sizeof(particle_emitter_t);
+}
+
+void particle_batch_init(particle_batch_t* p_batch)
+{
+    if(p_batch == NULL) {
+        LOG_ERROR("%s: p_batch is NULL", __func__);
+        return;
+    }
+
+    p_batch->p_emitters = NULL;
+    p_batch->emitters_count = 0;
+    p_batch->particles_count = 0;
+    p_batch->dropped = 0;
+    p_batch->seed = 0;
+    p_batch->dt = 0.0f;
+}
+
+void particle_batch_begin(particle_batch_t* p_batch, void* p_mapped, float dt)
+{
+    if(p_batch == NULL) {
+        LOG_ERROR("%s: p_batch is NULL", __func__);
+        return;
+    }
+
+    p_batch->p_emitters = (particle_emitter_t*)p_mapped;
+    p_batch->emitters_count = 0;
+    p_batch->particles_count = 0;
+    p_batch->dropped = 0;
+
+    // Written so a NaN ends up as 0 as well
+    if(!(dt > 0.0f))
+        dt = 0.0f;
+    else if(dt > PARTICLE_MAX_DT)
+        dt = PARTICLE_MAX_DT;
+    p_batch->dt = dt;
+}
+
+bool particle_batch_emit(particle_batch_t* p_batch, const particle_emitter_t* p_emitter)
+{
+    if(p_batch == NULL || p_emitter == NULL) {
+        LOG_ERROR("%s: p_batch or p_emitter is NULL", __func__);
+        return false;
+    }
+
+    if(p_batch->p_emitters == NULL || p_batch->emitters_count == PARTICLE_MAX_EMITTERS ||
+        p_emitter->count > PARTICLE_MAX_COUNT - p_batch->particles_count) {
+        p_batch->dropped += p_emitter->count;
+        return false;
+    }
+
+    // Only written, the mapped memory is never read back
+    particle_emitter_t* p_out = &p_batch->p_emitters[p_batch->emitters_count++];
+    *p_out = *p_emitter;
+    p_out->seed = p_batch->seed++;
+    p_out->pad = 0;
+
+    p_batch->particles_count += p_emitter->count;
+
+    return true;
+}
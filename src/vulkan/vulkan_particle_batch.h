@@ -0,0 +1,85 @@
+#ifndef VULKAN_PARTICLE_BATCH_H_
+#define VULKAN_PARTICLE_BATCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Size of the particle ring buffer, a power of two so the ring index wraps with the 32 bit head counter. Must match
+// MAX_PARTICLES in particle_emit.comp and particle_sim.comp.
+#define PARTICLE_MAX_COUNT 262144
+
+// Most emitters in a frame
+#define PARTICLE_MAX_EMITTERS 1024
+
+// Longest step the particles are integrated with, a frame that took longer is slowed down instead of tunneling
+#define PARTICLE_MAX_DT 0.1f
+
+/**
+ * \brief A burst of particles spawned by the emit compute pass. Must match the layout of the emitter buffer in
+ * particle_emit.comp, 48 bytes.
+ *
+ * The particles fly out in random directions from pos with up to speed world units per second and fade out over up to
+ * life seconds.
+ */
+typedef struct particle_emitter_s {
+    float pos[2];   // Center in world units
+    float size;     // Width and height of each particle in world units
+    float speed;    // Highest initial speed in world units per second
+    float color[4]; // Linear RGBA, faded out with the remaining life
+    float life;     // Longest life in seconds
+    uint32_t count; // Number of particles
+    uint32_t seed;  // Set by particle_batch_emit, so no two bursts look alike
+    uint32_t pad;
+} particle_emitter_t;
+
+/**
+ * \brief The emitters of a frame, written straight into the persistently mapped emitter buffer of the frame.
+ *
+ * Only the emitters are written by the CPU, the particles themselves are spawned, moved and drawn on the GPU. The
+ * particles of a frame never add up to more than the ring holds, so a burst can not overwrite one from the same frame.
+ *
+ * The mapped memory is usually write combined, so it is only ever written.
+ */
+typedef struct particle_batch_s {
+    particle_emitter_t* p_emitters; // The mapped buffer of the open frame, NULL if no frame is open
+    uint32_t emitters_count;
+    uint32_t particles_count; // Particles emitted this frame
+    uint32_t dropped;         // Particles that did not fit this frame
+    uint32_t seed;
+    float dt; // Seconds the particles are moved this frame
+} particle_batch_t;
+
+/**
+ * Size in bytes of the emitter buffer of one frame.
+ */
+size_t particle_batch_buffer_size(void) CONST_ATTR;
+
+/**
+ * \brief Initiate an empty batch with no frame open.
+ */
+void particle_batch_init(particle_batch_t* p_batch);
+
+/**
+ * \brief Open a frame with no emitters.
+ *
+ * \param[in] p_batch Pointer to the particle_batch_t.
+ * \param[in] p_mapped The mapped emitter buffer of the frame, at least particle_batch_buffer_size bytes. The GPU must be
+ * done with it.
+ * \param[in] dt Seconds since the last frame, clamped to [0, PARTICLE_MAX_DT].
+ */
+void particle_batch_begin(particle_batch_t* p_batch, void* p_mapped, float dt);
+
+/**
+ * \brief Add an emitter to the open frame.
+ *
+ * \param[in] p_batch Pointer to the particle_batch_t.
+ * \param[in] p_emitter The emitter, its seed is ignored.
+ *
+ * \return False if no frame is open or the emitter does not fit, in which case its particles are counted as dropped.
+ */
+bool particle_batch_emit(particle_batch_t* p_batch, const particle_emitter_t* p_emitter);
+
+#endif // VULKAN_PARTICLE_BATCH_H_
@@ -8,7 +8,10 @@
 #include "error/error.h"
 #include "error/vulkan_error.h"
 #include "logger.h"
+#include "util/asset_pack.h"
 #include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_sprite_batch.h"
 #include "vulkan/vulkan_pipeline.h"
 
 typedef struct pipeline_del_s {
@@ -19,6 +22,62 @@ typedef struct pipeline_del_s {
 
 static void vulkan_pipeline_deinit(void* p_void_vulkan_pipeline_del);
 
+/**
+ * Read a SPIR-V file and create a shader module from it. The module must be destroyed by the caller once the pipelines
+ * using it have been created.
+ *
+ * \param[in] device The vulkan logical device.
+ * \param[in] path Path to the SPIR-V file.
+ * \param[out] p_module Pointer to the shader module to be created.
+ */
+static error_t shader_module_init(VkDevice device, const char* path, VkShaderModule* p_module);
+
+/**
+ * \brief Create a pipeline layout with one descriptor set layout and one push constant range starting at offset 0.
+ *
+ * \param[in] device The vulkan logical device.
+ * \param[in] p_desc_layout Pointer to the descriptor set layout.
+ * \param[in] push_stages Shader stages the push constants are read in.
+ * \param[in] push_size Size of the push constants in bytes, 0 for none.
+ * \param[out] p_layout Pointer to the pipeline layout to be created.
+ */
+static VkResult pipeline_layout_init(VkDevice device, const VkDescriptorSetLayout* p_desc_layout,
+    VkShaderStageFlags push_stages, uint32_t push_size, VkPipelineLayout* p_layout);
+
+/**
+ * \brief Create two compute pipelines sharing a pipeline layout, such as the passes of a multi pass effect.
+ *
+ * The layout is owned by the first pipeline once both are created, it is destroyed here if creating them fails.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] layout The pipeline layout of both pipelines.
+ * \param[in] p_paths Paths to the SPIR-V file of each pipeline.
+ * \param[out] p_pipelines The two pipelines, in the order of p_paths.
+ */
+static error_t compute_pipeline_pair_init(deletion_stack_t* p_dstack, VkDevice device, VkPipelineLayout layout,
+    const char* const* p_paths, VkPipeline* p_pipelines);
+
+/**
+ * A compute shader variant and the subgroup operations it needs in compute shaders, 0 for a portable variant.
+ */
+typedef struct shader_variant_s {
+    const char* path;
+    VkSubgroupFeatureFlags subgroup_ops;
+} shader_variant_t;
+
+/**
+ * \brief Pick the first variant the device supports the subgroup operations of.
+ *
+ * \param[in] p_variants The variants, the most demanding first and a portable one last.
+ * \param[in] variants_count Number of variants.
+ * \param[in] p_caps The device capabilities.
+ *
+ * \return Path of the variant, the last one if the device supports none of the others.
+ */
+static const char* shader_variant_select(const shader_variant_t* p_variants, uint32_t variants_count,
+    const device_caps_t* p_caps);
+
 static error_t background_pipeline_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device, VkExtent2D window_extent,
     VkDescriptorSetLayout* p_draw_image_desc_layout, VkPipelineLayout* p_gradient_pipeline_layout,
     VkPipeline* p_gradient_pipeline);
@@ -50,68 +109,19 @@ static error_t background_pipeline_init(deletion_stack_t* p_dstack, VkDevice dev
     LOG_DEBUG("group_count_x: %g", group_count_x);
     LOG_DEBUG("group_count_y: %g", group_count_y);
 
-    VkPipelineLayoutCreateInfo comp_layout_info = {0};
-    comp_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    comp_layout_info.pSetLayouts = p_draw_image_desc_layout;
-    comp_layout_info.setLayoutCount = 1;
-
-    if(vkCreatePipelineLayout(device, &comp_layout_info, VK_NULL_HANDLE, p_gradient_pipeline_layout) != VK_SUCCESS)
+    // The effect is parameterized by push constants, so animating it needs no descriptor writes
+    if(pipeline_layout_init(device, p_draw_image_desc_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+        sizeof(background_push_constants_t), p_gradient_pipeline_layout) != VK_SUCCESS)
         return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT, "Failed to create Vulkan pipeline layout");
 
     LOG_DEBUG("Background pipeline layout created");
 
     LOG_DEBUG("Creating compute shader module");
-    LOG_DEBUG("Opening shader file");
-
-    FILE* shader_file = fopen("../src/shaders/comp.spv", "rb");
-    if(shader_file == NULL)
-        return error_init(ERR_SRC_CORE, ERR_FOPEN, "Failed to open file: ../src/shaders/comp.spv: %s", strerror(errno));
-
-    int ret = fseek(shader_file, 0, SEEK_END);
-    if(ret != 0)
-        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed");
-
-    long size = ftell(shader_file);
-    if(size < 0)
-        return error_init(ERR_SRC_CORE, ERR_FTELL, "ftell failed");
-    size_t code_size = (size_t)size;
-
-    ret = fseek(shader_file, 0, SEEK_SET);
-    if(ret != 0)
-        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed");
-
-    LOG_DEBUG("File size: %ld", size);
-
-    // If file size is not a multiple of sizeof(uint32_t) = 4
-    if((size_t)size % sizeof(uint32_t) != 0)
-        return error_init(ERR_SRC_CORE, ERR_TEMP, "temp");
-
-    uint32_t* p_buf = (uint32_t*)malloc(code_size);
-    if(p_buf == NULL)
-        return error_init(ERR_SRC_CORE, ERR_MALLOC, "Failed to allocate memory of size %lu",
-            (size_t)size * sizeof(char));
-
-    size_t ret_LU = fread(p_buf, 1, code_size, shader_file);
-    if(ret_LU < code_size)
-        return error_init(ERR_SRC_CORE, ERR_FREAD, "fread failed");
-
-    ret = fclose(shader_file);
-    if(ret != 0)
-        return error_init(ERR_SRC_CORE, ERR_FCLOSE, "fclose failed");
-
-    LOG_DEBUG("Shader file successfully read");
-
-    VkShaderModuleCreateInfo shader_info = {0};
-    shader_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shader_info.codeSize = code_size;
-    shader_info.pCode = p_buf;
 
     VkShaderModule comp_draw_shader = NULL;
-    if(vkCreateShaderModule(device, &shader_info, VK_NULL_HANDLE, &comp_draw_shader) != VK_SUCCESS)
-        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_SHADER_MODULE, "Failed to create shader module");
-
-    free(p_buf);
-    p_buf = NULL;
+    error_t err = shader_module_init(device, "../src/shaders/comp.spv", &comp_draw_shader);
+    if(err.code != 0)
+        return err;
 
     LOG_DEBUG("Shader module created");
 
@@ -164,7 +174,7 @@ static error_t background_pipeline_init(deletion_stack_t* p_dstack, VkDevice dev
     p_pipeline_del->layout = *p_gradient_pipeline_layout;
     p_pipeline_del->pipeline = *p_gradient_pipeline;
 
-    error_t err = deletion_stack_push(p_dstack, p_pipeline_del, vulkan_pipeline_deinit);
+    err = deletion_stack_push(p_dstack, p_pipeline_del, vulkan_pipeline_deinit);
     if(err.code != 0) {
         vulkan_pipeline_deinit(p_pipeline_del);
         return err;
@@ -175,6 +185,502 @@ static error_t background_pipeline_init(deletion_stack_t* p_dstack, VkDevice dev
     return SUCCESS;
 }
 
+error_t vulkan_pipeline_present_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_present_desc_layout, VkPipelineLayout* p_present_pipeline_layout,
+    VkPipeline* p_present_pipeline, VkPipeline* p_upscale_pipeline)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_present_desc_layout == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_present_desc_layout is NULL", __func__);
+
+    if(pipeline_layout_init(device, p_present_desc_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+        sizeof(present_push_constants_t), p_present_pipeline_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT, "Failed to create present pipeline layout");
+
+    const char* p_paths[2] = {"../src/shaders/present.comp.spv", "../src/shaders/present_upscale.comp.spv"};
+    VkPipeline p_pipelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    error_t err = compute_pipeline_pair_init(p_dstack, device, *p_present_pipeline_layout, p_paths, p_pipelines);
+    if(err.code != 0)
+        return err;
+
+    *p_present_pipeline = p_pipelines[0];
+    *p_upscale_pipeline = p_pipelines[1];
+
+    LOG_DEBUG("Vulkan present pipelines initiated");
+
+    return SUCCESS;
+}
+
+error_t vulkan_pipeline_cull_init(deletion_stack_t* p_dstack, VkDevice device, const device_caps_t* p_caps,
+    VkDescriptorSetLayout* p_cull_desc_layout, VkPipelineLayout* p_cull_pipeline_layout, VkPipeline* p_cull_pipeline)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_caps == NULL || p_cull_desc_layout == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_caps or p_cull_desc_layout is NULL", __func__);
+
+    if(pipeline_layout_init(device, p_cull_desc_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+        sizeof(sprite_cull_push_constants_t), p_cull_pipeline_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT, "Failed to create cull pipeline layout");
+
+    // The subgroup variant appends the survivors of a whole subgroup with one atomic add instead of one each
+    static const shader_variant_t p_variants[2] = {
+        {"../src/shaders/sprite_cull_subgroup.comp.spv",
+            VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT},
+        {"../src/shaders/sprite_cull.comp.spv", 0}
+    };
+    const char* p_path = shader_variant_select(p_variants, 2, p_caps);
+
+    VkShaderModule cull_shader = NULL;
+    error_t err = shader_module_init(device, p_path, &cull_shader);
+    if(err.code != 0) {
+        vkDestroyPipelineLayout(device, *p_cull_pipeline_layout, VK_NULL_HANDLE);
+        return err;
+    }
+
+    VkPipelineShaderStageCreateInfo stage_info = {0};
+    stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stage_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    stage_info.module = cull_shader;
+    stage_info.pName = "main";
+
+    VkComputePipelineCreateInfo comp_pipeline_info = {0};
+    comp_pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    comp_pipeline_info.layout = *p_cull_pipeline_layout;
+    comp_pipeline_info.stage = stage_info;
+
+    VkResult vk_result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &comp_pipeline_info, VK_NULL_HANDLE,
+        p_cull_pipeline);
+
+    // Safe to destroy after pipline has been created
+    vkDestroyShaderModule(device, cull_shader, VK_NULL_HANDLE);
+
+    if(vk_result != VK_SUCCESS) {
+        vkDestroyPipelineLayout(device, *p_cull_pipeline_layout, VK_NULL_HANDLE);
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_COMPUTE_PIPELINES, "Failed to create cull pipeline");
+    }
+
+    // CLEANUP
+    pipeline_del_t* p_pipeline_del = (pipeline_del_t*)malloc(sizeof(pipeline_del_t));
+    p_pipeline_del->device = device;
+    p_pipeline_del->layout = *p_cull_pipeline_layout;
+    p_pipeline_del->pipeline = *p_cull_pipeline;
+
+    err = deletion_stack_push(p_dstack, p_pipeline_del, vulkan_pipeline_deinit);
+    if(err.code != 0) {
+        vulkan_pipeline_deinit(p_pipeline_del);
+        return err;
+    }
+
+    LOG_DEBUG("Vulkan cull pipeline initiated with %s", p_path);
+
+    return SUCCESS;
+}
+
+error_t vulkan_pipeline_particle_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_particle_desc_layout, VkPipelineLayout* p_particle_pipeline_layout,
+    VkPipeline* p_emit_pipeline, VkPipeline* p_sim_pipeline)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_particle_desc_layout == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_particle_desc_layout is NULL", __func__);
+
+    if(pipeline_layout_init(device, p_particle_desc_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+        sizeof(particle_push_constants_t), p_particle_pipeline_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT,
+            "Failed to create particle pipeline layout");
+
+    const char* p_paths[2] = {"../src/shaders/particle_emit.comp.spv", "../src/shaders/particle_sim.comp.spv"};
+    VkPipeline p_pipelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    error_t err = compute_pipeline_pair_init(p_dstack, device, *p_particle_pipeline_layout, p_paths, p_pipelines);
+    if(err.code != 0)
+        return err;
+
+    *p_emit_pipeline = p_pipelines[0];
+    *p_sim_pipeline = p_pipelines[1];
+
+    LOG_DEBUG("Vulkan particle pipelines initiated");
+
+    return SUCCESS;
+}
+
+error_t vulkan_pipeline_bloom_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_bloom_desc_layout, VkPipelineLayout* p_bloom_pipeline_layout, VkPipeline* p_down_pipeline,
+    VkPipeline* p_up_pipeline)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_bloom_desc_layout == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_bloom_desc_layout is NULL", __func__);
+
+    if(pipeline_layout_init(device, p_bloom_desc_layout, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(bloom_push_constants_t),
+        p_bloom_pipeline_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT, "Failed to create bloom pipeline layout");
+
+    const char* p_paths[2] = {"../src/shaders/bloom_down.comp.spv", "../src/shaders/bloom_up.comp.spv"};
+    VkPipeline p_pipelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    error_t err = compute_pipeline_pair_init(p_dstack, device, *p_bloom_pipeline_layout, p_paths, p_pipelines);
+    if(err.code != 0)
+        return err;
+
+    *p_down_pipeline = p_pipelines[0];
+    *p_up_pipeline = p_pipelines[1];
+
+    LOG_DEBUG("Vulkan bloom pipelines initiated");
+
+    return SUCCESS;
+}
+
+error_t vulkan_pipeline_sprite_init(deletion_stack_t* p_dstack, VkDevice device, VkFormat color_format,
+    VkDescriptorSetLayout* p_sprite_desc_layout, VkPipelineLayout* p_sprite_pipeline_layout,
+    VkPipeline* p_sprite_pipelines)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_sprite_desc_layout == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_sprite_desc_layout is NULL", __func__);
+
+    if(pipeline_layout_init(device, p_sprite_desc_layout, VK_SHADER_STAGE_VERTEX_BIT,
+        sizeof(sprite_push_constants_t), p_sprite_pipeline_layout) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_PIPELINE_LAYOUT, "Failed to create sprite pipeline layout");
+
+    VkShaderModule vert_shader = NULL;
+    error_t err = shader_module_init(device, "../src/shaders/sprite.vert.spv", &vert_shader);
+    if(err.code != 0) {
+        vkDestroyPipelineLayout(device, *p_sprite_pipeline_layout, VK_NULL_HANDLE);
+        return err;
+    }
+
+    VkShaderModule frag_shader = NULL;
+    err = shader_module_init(device, "../src/shaders/sprite.frag.spv", &frag_shader);
+    if(err.code != 0) {
+        vkDestroyShaderModule(device, vert_shader, VK_NULL_HANDLE);
+        vkDestroyPipelineLayout(device, *p_sprite_pipeline_layout, VK_NULL_HANDLE);
+        return err;
+    }
+
+    // The material is a specialization constant of the fragment shader, so each material is a pipeline of its own
+    // without any branching on it per fragment
+    VkSpecializationMapEntry material_entry = {0};
+    material_entry.constantID = 0; // matches constant_id of material in sprite.frag
+    material_entry.offset = 0;
+    material_entry.size = sizeof(uint32_t);
+
+    VkPipelineShaderStageCreateInfo p_stages[2] = {0};
+    p_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    p_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    p_stages[0].module = vert_shader;
+    p_stages[0].pName = "main";
+
+    p_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    p_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    p_stages[1].module = frag_shader;
+    p_stages[1].pName = "main";
+
+    // No vertex buffers, the vertex shader builds the quad from gl_VertexIndex and pulls the instance from the
+    // instance buffer with gl_InstanceIndex
+    VkPipelineVertexInputStateCreateInfo vertex_input = {0};
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {0};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // The viewport follows the draw extent which changes with the dynamic resolution
+    VkPipelineViewportStateCreateInfo viewport_state = {0};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkDynamicState p_dynamic_states[2] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamic_state = {0};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = 2;
+    dynamic_state.pDynamicStates = p_dynamic_states;
+
+    VkPipelineRasterizationStateCreateInfo rasterization = {0};
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = VK_CULL_MODE_NONE;
+    rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample = {0};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Premultiplied alpha, the fragment shader multiplies the color by the coverage
+    VkPipelineColorBlendAttachmentState blend_attachment = {0};
+    blend_attachment.blendEnable = VK_TRUE;
+    blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+    blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+        VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo color_blend = {0};
+    color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blend.attachmentCount = 1;
+    color_blend.pAttachments = &blend_attachment;
+
+    // Drawn with dynamic rendering straight into the draw image, no render pass
+    VkPipelineRenderingCreateInfo rendering_info = {0};
+    rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachmentFormats = &color_format;
+
+    uint32_t p_materials[SPRITE_MATERIAL_COUNT];
+    VkSpecializationInfo p_spec_infos[SPRITE_MATERIAL_COUNT];
+    VkPipelineShaderStageCreateInfo pp_stages[SPRITE_MATERIAL_COUNT][2];
+    VkGraphicsPipelineCreateInfo p_pipeline_infos[SPRITE_MATERIAL_COUNT];
+
+    for(uint32_t i = 0; i < SPRITE_MATERIAL_COUNT; ++i) {
+        p_materials[i] = i;
+
+        p_spec_infos[i] = (VkSpecializationInfo){0};
+        p_spec_infos[i].mapEntryCount = 1;
+        p_spec_infos[i].pMapEntries = &material_entry;
+        p_spec_infos[i].dataSize = sizeof(uint32_t);
+        p_spec_infos[i].pData = &p_materials[i];
+
+        pp_stages[i][0] = p_stages[0];
+        pp_stages[i][1] = p_stages[1];
+        pp_stages[i][1].pSpecializationInfo = &p_spec_infos[i];
+
+        p_pipeline_infos[i] = (VkGraphicsPipelineCreateInfo){0};
+        p_pipeline_infos[i].sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        p_pipeline_infos[i].pNext = &rendering_info;
+        p_pipeline_infos[i].stageCount = 2;
+        p_pipeline_infos[i].pStages = pp_stages[i];
+        p_pipeline_infos[i].pVertexInputState = &vertex_input;
+        p_pipeline_infos[i].pInputAssemblyState = &input_assembly;
+        p_pipeline_infos[i].pViewportState = &viewport_state;
+        p_pipeline_infos[i].pRasterizationState = &rasterization;
+        p_pipeline_infos[i].pMultisampleState = &multisample;
+        p_pipeline_infos[i].pColorBlendState = &color_blend;
+        p_pipeline_infos[i].pDynamicState = &dynamic_state;
+        p_pipeline_infos[i].layout = *p_sprite_pipeline_layout;
+    }
+
+    for(uint32_t i = 0; i < SPRITE_MATERIAL_COUNT; ++i)
+        p_sprite_pipelines[i] = VK_NULL_HANDLE;
+
+    VkResult vk_result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, SPRITE_MATERIAL_COUNT, p_pipeline_infos,
+        VK_NULL_HANDLE, p_sprite_pipelines);
+
+    // Safe to destroy after pipline has been created
+    vkDestroyShaderModule(device, vert_shader, VK_NULL_HANDLE);
+    vkDestroyShaderModule(device, frag_shader, VK_NULL_HANDLE);
+
+    // CLEANUP, the first pipeline owns the layout. Pipelines that failed to be created are null handles, which are
+    // ignored when destroyed.
+    for(uint32_t i = 0; i < SPRITE_MATERIAL_COUNT; ++i) {
+        pipeline_del_t* p_pipeline_del = (pipeline_del_t*)malloc(sizeof(pipeline_del_t));
+        p_pipeline_del->device = device;
+        p_pipeline_del->layout = i == 0 ? *p_sprite_pipeline_layout : VK_NULL_HANDLE;
+        p_pipeline_del->pipeline = p_sprite_pipelines[i];
+
+        err = deletion_stack_push(p_dstack, p_pipeline_del, vulkan_pipeline_deinit);
+        if(err.code != 0) {
+            vulkan_pipeline_deinit(p_pipeline_del);
+            return err;
+        }
+    }
+
+    if(vk_result != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_GRAPHICS_PIPELINES, "Failed to create sprite pipelines");
+
+    LOG_DEBUG("Vulkan sprite pipelines initiated");
+
+    return SUCCESS;
+}
+
+static error_t shader_module_init(VkDevice device, const char* path, VkShaderModule* p_module)
+{
+    // Straight out of the mapping when the shader is packed, the driver keeps a copy of its own
+    size_t packed_size = 0;
+    const void* p_packed = asset_pack_find_mounted(path, &packed_size);
+    if(p_packed != NULL) {
+        LOG_DEBUG("Shader found in asset pack: %s", path);
+
+        // The blobs are 16 byte aligned, so only the size has to be checked
+        if(packed_size == 0 || packed_size % sizeof(uint32_t) != 0)
+            return error_init(ERR_SRC_CORE, ERR_FREAD, "Invalid SPIR-V size %lu in asset pack: %s", packed_size,
+                path);
+
+        VkShaderModuleCreateInfo packed_info = {0};
+        packed_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        packed_info.codeSize = packed_size;
+        packed_info.pCode = (const uint32_t*)p_packed;
+
+        if(vkCreateShaderModule(device, &packed_info, VK_NULL_HANDLE, p_module) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_SHADER_MODULE, "Failed to create shader module: %s",
+                path);
+
+        return SUCCESS;
+    }
+
+    LOG_DEBUG("Opening shader file: %s", path);
+
+    FILE* shader_file = fopen(path, "rb");
+    if(shader_file == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "Failed to open file: %s: %s", path, strerror(errno));
+
+    if(fseek(shader_file, 0, SEEK_END) != 0) {
+        fclose(shader_file);
+        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed: %s", path);
+    }
+
+    long size = ftell(shader_file);
+    if(size < 0) {
+        fclose(shader_file);
+        return error_init(ERR_SRC_CORE, ERR_FTELL, "ftell failed: %s", path);
+    }
+    size_t code_size = (size_t)size;
+
+    if(fseek(shader_file, 0, SEEK_SET) != 0) {
+        fclose(shader_file);
+        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed: %s", path);
+    }
+
+    LOG_DEBUG("File size: %ld", size);
+
+    // SPIR-V is a stream of 32 bit words
+    if(code_size == 0 || code_size % sizeof(uint32_t) != 0) {
+        fclose(shader_file);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "Invalid SPIR-V file size %lu: %s", code_size, path);
+    }
+
+    uint32_t* p_buf = (uint32_t*)malloc(code_size);
+    if(p_buf == NULL) {
+        fclose(shader_file);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "Failed to allocate memory of size %lu", code_size);
+    }
+
+    size_t ret_LU = fread(p_buf, 1, code_size, shader_file);
+    if(fclose(shader_file) != 0 || ret_LU < code_size) {
+        free(p_buf);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "Failed to read file: %s", path);
+    }
+
+    VkShaderModuleCreateInfo shader_info = {0};
+    shader_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shader_info.codeSize = code_size;
+    shader_info.pCode = p_buf;
+
+    VkResult vk_result = vkCreateShaderModule(device, &shader_info, VK_NULL_HANDLE, p_module);
+
+    free(p_buf);
+    p_buf = NULL;
+
+    if(vk_result != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_SHADER_MODULE, "Failed to create shader module: %s", path);
+
+    return SUCCESS;
+}
+
+static error_t compute_pipeline_pair_init(deletion_stack_t* p_dstack, VkDevice device, VkPipelineLayout layout,
+    const char* const* p_paths, VkPipeline* p_pipelines)
+{
+    VkShaderModule p_shaders[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    for(uint32_t i = 0; i < 2; ++i) {
+        error_t err = shader_module_init(device, p_paths[i], &p_shaders[i]);
+        if(err.code != 0) {
+            vkDestroyShaderModule(device, p_shaders[0], VK_NULL_HANDLE);
+            vkDestroyPipelineLayout(device, layout, VK_NULL_HANDLE);
+            return err;
+        }
+    }
+
+    VkComputePipelineCreateInfo p_comp_pipeline_infos[2];
+    for(uint32_t i = 0; i < 2; ++i) {
+        VkPipelineShaderStageCreateInfo stage_info = {0};
+        stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage_info.module = p_shaders[i];
+        stage_info.pName = "main";
+
+        VkComputePipelineCreateInfo comp_pipeline_info = {0};
+        comp_pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        comp_pipeline_info.layout = layout;
+        comp_pipeline_info.stage = stage_info;
+        p_comp_pipeline_infos[i] = comp_pipeline_info;
+    }
+
+    p_pipelines[0] = VK_NULL_HANDLE;
+    p_pipelines[1] = VK_NULL_HANDLE;
+    VkResult vk_result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 2, p_comp_pipeline_infos, VK_NULL_HANDLE,
+        p_pipelines);
+
+    // Safe to destroy after pipline has been created
+    vkDestroyShaderModule(device, p_shaders[1], VK_NULL_HANDLE);
+    vkDestroyShaderModule(device, p_shaders[0], VK_NULL_HANDLE);
+
+    if(vk_result != VK_SUCCESS) {
+        for(uint32_t i = 0; i < 2; ++i)
+            vkDestroyPipeline(device, p_pipelines[i], VK_NULL_HANDLE);
+        vkDestroyPipelineLayout(device, layout, VK_NULL_HANDLE);
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_COMPUTE_PIPELINES, "Failed to create compute pipelines %s",
+            p_paths[0]);
+    }
+
+    // CLEANUP, the layout is shared and destroyed with the first pipeline
+    for(uint32_t i = 0; i < 2; ++i) {
+        pipeline_del_t* p_pipeline_del = (pipeline_del_t*)malloc(sizeof(pipeline_del_t));
+        p_pipeline_del->device = device;
+        p_pipeline_del->layout = i == 0 ? layout : VK_NULL_HANDLE;
+        p_pipeline_del->pipeline = p_pipelines[i];
+
+        error_t err = deletion_stack_push(p_dstack, p_pipeline_del, vulkan_pipeline_deinit);
+        if(err.code != 0) {
+            vulkan_pipeline_deinit(p_pipeline_del);
+            return err;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static const char* shader_variant_select(const shader_variant_t* p_variants, uint32_t variants_count,
+    const device_caps_t* p_caps)
+{
+    for(uint32_t i = 0; i + 1 < variants_count; ++i) {
+        if((p_variants[i].subgroup_ops & ~p_caps->subgroup_ops) == 0)
+            return p_variants[i].path;
+    }
+
+    return p_variants[variants_count - 1].path;
+}
+
+static VkResult pipeline_layout_init(VkDevice device, const VkDescriptorSetLayout* p_desc_layout,
+    VkShaderStageFlags push_stages, uint32_t push_size, VkPipelineLayout* p_layout)
+{
+    VkPushConstantRange push_range = {0};
+    push_range.stageFlags = push_stages;
+    push_range.offset = 0;
+    push_range.size = push_size;
+
+    VkPipelineLayoutCreateInfo layout_info = {0};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.pSetLayouts = p_desc_layout;
+    layout_info.setLayoutCount = 1;
+    layout_info.pPushConstantRanges = push_size > 0 ? &push_range : VK_NULL_HANDLE;
+    layout_info.pushConstantRangeCount = push_size > 0 ? 1 : 0;
+
+    return vkCreatePipelineLayout(device, &layout_info, VK_NULL_HANDLE, p_layout);
+}
+
 static void vulkan_pipeline_deinit(void* p_void_pipeline_del)
 {
     LOG_DEBUG("Callback: %s", __func__);
@@ -5,9 +5,59 @@
 
 #include "error/error.h"
 #include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
 
 error_t vulkan_pipeline_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device, VkExtent2D window_extent,
     VkDescriptorSetLayout* p_draw_image_desc_layout, VkPipelineLayout* p_gradient_pipeline_layout,
     VkPipeline* p_gradient_pipeline);
 
+/**
+ * Initiate the present compute pipelines which sample the draw image, tonemap it and write the result directly to a
+ * storage capable swapchain image. The upscale pipeline resamples the draw image with the edge adaptive filter, both
+ * share one pipeline layout.
+ */
+error_t vulkan_pipeline_present_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_present_desc_layout, VkPipelineLayout* p_present_pipeline_layout,
+    VkPipeline* p_present_pipeline, VkPipeline* p_upscale_pipeline);
+
+/**
+ * \brief Initiate the sprite pipelines, one graphics pipeline per sprite material.
+ *
+ * The pipelines draw instanced quads with dynamic rendering into a single color attachment. They share one layout
+ * holding the instance buffer descriptor set and the view push constants.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] color_format Format of the color attachment, the draw image.
+ * \param[in] p_sprite_desc_layout Pointer to the layout of the instance buffer descriptor set.
+ * \param[out] p_sprite_pipeline_layout Pointer to the shared pipeline layout.
+ * \param[out] p_sprite_pipelines Array of SPRITE_MATERIAL_COUNT pipelines, indexed by material.
+ */
+error_t vulkan_pipeline_sprite_init(deletion_stack_t* p_dstack, VkDevice device, VkFormat color_format,
+    VkDescriptorSetLayout* p_sprite_desc_layout, VkPipelineLayout* p_sprite_pipeline_layout,
+    VkPipeline* p_sprite_pipelines);
+
+/**
+ * Initiate the compute pipeline that culls the static sprites against the view and writes the indirect draws of the
+ * ones left. Uses the subgroup variant of the shader if p_caps has the subgroup operations it needs.
+ */
+error_t vulkan_pipeline_cull_init(deletion_stack_t* p_dstack, VkDevice device, const device_caps_t* p_caps,
+    VkDescriptorSetLayout* p_cull_desc_layout, VkPipelineLayout* p_cull_pipeline_layout, VkPipeline* p_cull_pipeline);
+
+/**
+ * Initiate the compute pipelines of the particle system, the emit pipeline spawning the particles of the frame and the
+ * sim pipeline moving them. Both share one pipeline layout.
+ */
+error_t vulkan_pipeline_particle_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_particle_desc_layout, VkPipelineLayout* p_particle_pipeline_layout,
+    VkPipeline* p_emit_pipeline, VkPipeline* p_sim_pipeline);
+
+/**
+ * Initiate the compute pipelines of the bloom pyramid, the down pipeline building each level from the one above it and
+ * the up pipeline adding each level into the one above it. Both share one pipeline layout.
+ */
+error_t vulkan_pipeline_bloom_init(deletion_stack_t* p_dstack, VkDevice device,
+    VkDescriptorSetLayout* p_bloom_desc_layout, VkPipelineLayout* p_bloom_pipeline_layout, VkPipeline* p_down_pipeline,
+    VkPipeline* p_up_pipeline);
+
 #endif // VULKAN_PIPELINE_H_
@@ -0,0 +1,191 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "error/vulkan_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_query.h"
+
+// Weight of the newest sample in the moving average of the gpu timings
+#define TIMING_AVG_WEIGHT 0.05
+
+/**
+ * Struct used for deleting a query pool.
+ */
+typedef struct query_pool_del_s {
+    VkDevice device;
+    VkQueryPool pool;
+} query_pool_del_t;
+
+static void vulkan_query_pool_deinit(void* p_void_query_pool_del);
+
+static const char* const scope_names[GPU_SCOPE_COUNT] = {"frame", "background", "cull", "particles", "sprites",
+    "bloom down", "bloom up", "present blit", "present compute"};
+
+error_t vulkan_query_timestamp_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    const queue_family_data_t* p_queues, frame_data_t* p_frames, gpu_timings_t* p_timings)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_queues == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_queues is NULL", __func__);
+
+    if(p_frames == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_frames is NULL", __func__);
+
+    if(p_timings == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_timings is NULL", __func__);
+
+    for(int i = 0; i < GPU_SCOPE_COUNT; ++i) {
+        p_timings->p_last_ms[i] = 0.0;
+        p_timings->p_avg_ms[i] = 0.0;
+    }
+
+    for(int i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        p_frames[i].timestamp_pool = VK_NULL_HANDLE;
+        p_frames[i].timestamps_written = false;
+    }
+
+    // The number of valid bits in a timestamp is a property of the queue family, zero means no timestamp support
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, VK_NULL_HANDLE);
+
+    VkQueueFamilyProperties* queue_families = (VkQueueFamilyProperties*)malloc(
+        queue_family_count * sizeof(VkQueueFamilyProperties));
+    if(queue_families == NULL)
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate memory of size %lu", __func__,
+            queue_family_count * sizeof(VkQueueFamilyProperties));
+
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_families);
+
+    uint32_t valid_bits = 0;
+    if(p_queues->graphics_index < queue_family_count)
+        valid_bits = queue_families[p_queues->graphics_index].timestampValidBits;
+
+    free(queue_families);
+    queue_families = NULL;
+
+    VkPhysicalDeviceProperties properties = {0};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    p_timings->period_ns = properties.limits.timestampPeriod;
+    p_timings->valid_bits_mask = valid_bits >= 64 ? UINT64_MAX : (((uint64_t)1 << valid_bits) - 1);
+    p_timings->supported = valid_bits != 0;
+
+    if(!p_timings->supported) {
+        LOG_WARN("Timestamp queries not supported by the graphics queue, GPU timings disabled");
+        return SUCCESS;
+    }
+
+    VkQueryPoolCreateInfo pool_info = {0};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = 2 * GPU_SCOPE_COUNT;
+
+    for(int i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        if(vkCreateQueryPool(device, &pool_info, VK_NULL_HANDLE, &p_frames[i].timestamp_pool) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CREATE_QUERY_POOL, "Failed to create timestamp query pool");
+
+        // CLEANUP
+        query_pool_del_t* p_pool_del = (query_pool_del_t*)malloc(sizeof(query_pool_del_t));
+        p_pool_del->device = device;
+        p_pool_del->pool = p_frames[i].timestamp_pool;
+
+        error_t err = deletion_stack_push(p_dstack, p_pool_del, vulkan_query_pool_deinit);
+        if(err.code != 0) {
+            vulkan_query_pool_deinit(p_pool_del);
+            return err;
+        }
+    }
+
+    LOG_DEBUG("Timestamp period: %g ns, valid bits: %u", (double)p_timings->period_ns, valid_bits);
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+static void vulkan_query_pool_deinit(void* p_void_query_pool_del)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_query_pool_del == NULL) {
+        LOG_ERROR("%s: p_void_query_pool_del is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    query_pool_del_t* p_pool_del = (query_pool_del_t*)p_void_query_pool_del;
+
+    vkDestroyQueryPool(p_pool_del->device, p_pool_del->pool, VK_NULL_HANDLE);
+
+    free(p_pool_del);
+    p_pool_del = NULL;
+    p_void_query_pool_del = NULL;
+}
+
+void vulkan_query_timestamp_reset(VkCommandBuffer cmd, VkQueryPool pool)
+{
+    if(pool == VK_NULL_HANDLE)
+        return;
+
+    vkCmdResetQueryPool(cmd, pool, 0, 2 * GPU_SCOPE_COUNT);
+}
+
+void vulkan_query_timestamp_begin(VkCommandBuffer cmd, VkQueryPool pool, gpu_scope_t scope)
+{
+    if(pool == VK_NULL_HANDLE)
+        return;
+
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool, 2 * (uint32_t)scope);
+}
+
+void vulkan_query_timestamp_end(VkCommandBuffer cmd, VkQueryPool pool, gpu_scope_t scope)
+{
+    if(pool == VK_NULL_HANDLE)
+        return;
+
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool, 2 * (uint32_t)scope + 1);
+}
+
+void vulkan_query_timestamp_collect(VkDevice device, VkQueryPool pool, gpu_timings_t* p_timings)
+{
+    if(pool == VK_NULL_HANDLE || p_timings == NULL)
+        return;
+
+    // Every query is followed by its availability, scopes that were not written this frame are unavailable
+    uint64_t p_results[2 * 2 * GPU_SCOPE_COUNT] = {0};
+
+    VkResult vk_result = vkGetQueryPoolResults(device, pool, 0, 2 * GPU_SCOPE_COUNT, sizeof(p_results), p_results,
+        2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if(vk_result != VK_SUCCESS && vk_result != VK_NOT_READY)
+        return;
+
+    for(int i = 0; i < GPU_SCOPE_COUNT; ++i) {
+        const uint64_t* p_begin = &p_results[4 * i];
+        const uint64_t* p_end = &p_results[4 * i + 2];
+
+        if(p_begin[1] == 0 || p_end[1] == 0)
+            continue;
+
+        uint64_t ticks = ((p_end[0] - p_begin[0]) & p_timings->valid_bits_mask);
+        double ms = (double)ticks * (double)p_timings->period_ns * 1e-6;
+
+        p_timings->p_last_ms[i] = ms;
+        if(p_timings->p_avg_ms[i] > 0.0)
+            p_timings->p_avg_ms[i] += TIMING_AVG_WEIGHT * (ms - p_timings->p_avg_ms[i]);
+        else
+            p_timings->p_avg_ms[i] = ms;
+    }
+}
+
+const char* vulkan_query_scope_name(gpu_scope_t scope)
+{
+    if((int)scope < 0 || (int)scope >= GPU_SCOPE_COUNT)
+        return "unknown";
+
+    return scope_names[scope];
+}
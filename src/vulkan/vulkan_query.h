@@ -0,0 +1,54 @@
+#ifndef VULKAN_QUERY_H_
+#define VULKAN_QUERY_H_
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "vulkan/vulkan_types.h"
+
+/**
+ * \brief Initiate the per frame timestamp query pools.
+ *
+ * If the graphics queue does not support timestamps, p_timings->supported is set to false, the query pools are set to
+ * VK_NULL_HANDLE and all other timestamp functions become no-ops.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] physical_device The physical device.
+ * \param[in] p_queues Pointer to the queue family data.
+ * \param[out] p_frames Array of FRAMES_IN_FLIGHT frame_data_t whose timestamp pools are created.
+ * \param[out] p_timings Pointer to the gpu_timings_t which will hold the timestamp period and results.
+ */
+error_t vulkan_query_timestamp_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    const queue_family_data_t* p_queues, frame_data_t* p_frames, gpu_timings_t* p_timings);
+
+/**
+ * Reset all the timestamp queries of a pool. Must be recorded before any scope is written in the command buffer.
+ */
+void vulkan_query_timestamp_reset(VkCommandBuffer cmd, VkQueryPool pool);
+
+/**
+ * Write the timestamp marking the start of a scope, after all previously recorded commands have completed.
+ */
+void vulkan_query_timestamp_begin(VkCommandBuffer cmd, VkQueryPool pool, gpu_scope_t scope);
+
+/**
+ * Write the timestamp marking the end of a scope, after all previously recorded commands have completed.
+ */
+void vulkan_query_timestamp_end(VkCommandBuffer cmd, VkQueryPool pool, gpu_scope_t scope);
+
+/**
+ * \brief Read back the timestamps of a finished frame.
+ *
+ * Must only be called after the fence of the frame that wrote to the pool has been signaled. Scopes that were not
+ * written in that frame are left untouched in p_timings.
+ */
+void vulkan_query_timestamp_collect(VkDevice device, VkQueryPool pool, gpu_timings_t* p_timings);
+
+/**
+ * Get a printable name of a gpu scope.
+ */
+const char* vulkan_query_scope_name(gpu_scope_t scope);
+
+#endif // VULKAN_QUERY_H_
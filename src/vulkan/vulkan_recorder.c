@@ -0,0 +1,217 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "error/vulkan_error.h"
+#include "logger.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_recorder.h"
+
+/**
+ * A job recording the record jobs [begin, end) into command buffers of the worker it runs on.
+ */
+static void record_jobs(void* p_void_recorder, uint32_t begin, uint32_t end);
+
+/**
+ * \brief Destroy the command pools.
+ *
+ * \param[in] p_void_recorder Pointer to the cmd_recorder_t.
+ */
+static void vulkan_recorder_deinit(void* p_void_recorder);
+
+error_t vulkan_recorder_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    job_system_t* p_jobs, cmd_recorder_t* p_recorder)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_queues == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_queues is NULL", __func__);
+
+    if(p_jobs == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_jobs is NULL", __func__);
+
+    if(p_recorder == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_recorder is NULL", __func__);
+
+    *p_recorder = (cmd_recorder_t){0};
+    p_recorder->device = device;
+    p_recorder->p_jobs = p_jobs;
+    p_recorder->workers_count = p_jobs->workers_count;
+
+    for(uint32_t i = 0; i < RECORDER_MAX_WORKERS; ++i)
+        p_recorder->p_workers[i].result = VK_SUCCESS;
+
+    // CLEANUP, pushed before anything is created, the deinit skips whatever has not been created yet
+    error_t err = deletion_stack_push(p_dstack, p_recorder, vulkan_recorder_deinit);
+    if(err.code != 0)
+        return err;
+
+    // The buffers are only ever reset together with their pool, once per frame
+    VkCommandPoolCreateInfo cmd_pool_info = {0};
+    cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    cmd_pool_info.queueFamilyIndex = p_queues->graphics_index;
+
+    VkCommandBufferAllocateInfo cmd_alloc_info = {0};
+    cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmd_alloc_info.commandBufferCount = RECORDER_MAX_CMDS_PER_WORKER;
+    cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+    for(uint32_t i = 0; i < p_recorder->workers_count; ++i) {
+        recorder_worker_t* p_worker = &p_recorder->p_workers[i];
+
+        for(int j = 0; j < FRAMES_IN_FLIGHT; ++j) {
+            if(vkCreateCommandPool(device, &cmd_pool_info, VK_NULL_HANDLE, &p_worker->p_pools[j]) != VK_SUCCESS)
+                return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_POOL, "Failed to create recorder command pool");
+
+            cmd_alloc_info.commandPool = p_worker->p_pools[j];
+
+            if(vkAllocateCommandBuffers(device, &cmd_alloc_info, p_worker->pp_cmds[j]) != VK_SUCCESS)
+                return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "Failed to allocate recorder command buffers");
+        }
+    }
+
+    LOG_DEBUG("Command recorder workers: %u", p_recorder->workers_count);
+    LOG_DEBUG("%s: Successful", __func__);
+
+    return SUCCESS;
+}
+
+static void vulkan_recorder_deinit(void* p_void_recorder)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_recorder == NULL) {
+        LOG_ERROR("%s: p_void_recorder is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    cmd_recorder_t* p_recorder = (cmd_recorder_t*)p_void_recorder;
+
+    // The command buffers are freed together with their pool
+    for(uint32_t i = 0; i < RECORDER_MAX_WORKERS; ++i) {
+        for(int j = 0; j < FRAMES_IN_FLIGHT; ++j) {
+            if(p_recorder->p_workers[i].p_pools[j] != VK_NULL_HANDLE)
+                vkDestroyCommandPool(p_recorder->device, p_recorder->p_workers[i].p_pools[j], VK_NULL_HANDLE);
+            p_recorder->p_workers[i].p_pools[j] = VK_NULL_HANDLE;
+        }
+    }
+
+    p_void_recorder = NULL;
+}
+
+error_t vulkan_recorder_begin_frame(cmd_recorder_t* p_recorder, uint32_t frame_index)
+{
+    if(p_recorder == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_recorder is NULL", __func__);
+
+    if(frame_index >= FRAMES_IN_FLIGHT)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: frame_index %u out of range", __func__, frame_index);
+
+    p_recorder->frame_index = frame_index;
+
+    // Resetting the pool resets all of its command buffers at once, which is cheaper than resetting them one by one
+    for(uint32_t i = 0; i < p_recorder->workers_count; ++i) {
+        recorder_worker_t* p_worker = &p_recorder->p_workers[i];
+
+        if(vkResetCommandPool(p_recorder->device, p_worker->p_pools[frame_index], 0) != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_POOL, "Failed to reset recorder command pool");
+
+        p_worker->cmds_used = 0;
+    }
+
+    return SUCCESS;
+}
+
+error_t vulkan_recorder_record(cmd_recorder_t* p_recorder,
+    const VkCommandBufferInheritanceRenderingInfo* p_rendering_info, const record_job_t* p_jobs, uint32_t jobs_count,
+    VkCommandBuffer* p_cmds)
+{
+    if(p_recorder == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_recorder is NULL", __func__);
+
+    if(jobs_count == 0)
+        return SUCCESS;
+
+    if(p_jobs == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_jobs is NULL", __func__);
+
+    if(p_cmds == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_cmds is NULL", __func__);
+
+    // A batch small enough to be recorded inline is recorded on the calling thread, which needs its own pools
+    if(job_system_worker_index(p_recorder->p_jobs) == JOB_NOT_A_WORKER)
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: Not called from a job system worker", __func__);
+
+    p_recorder->p_record_jobs = p_jobs;
+    p_recorder->p_out_cmds = p_cmds;
+    p_recorder->p_rendering_info = p_rendering_info;
+
+    for(uint32_t i = 0; i < p_recorder->workers_count; ++i)
+        p_recorder->p_workers[i].result = VK_SUCCESS;
+
+    // One job per secondary, each is picked up by whichever worker is free
+    job_system_parallel_for(p_recorder->p_jobs, jobs_count, 1, record_jobs, p_recorder);
+
+    for(uint32_t i = 0; i < p_recorder->workers_count; ++i) {
+        if(p_recorder->p_workers[i].result != VK_SUCCESS)
+            return error_init(ERR_SRC_VULKAN, VULKAN_ERR_CMD_BUF, "%s: Worker %u failed to record, VkResult %d",
+                __func__, i, p_recorder->p_workers[i].result);
+    }
+
+    return SUCCESS;
+}
+
+static void record_jobs(void* p_void_recorder, uint32_t begin, uint32_t end)
+{
+    cmd_recorder_t* p_recorder = (cmd_recorder_t*)p_void_recorder;
+
+    // Jobs only run on workers, so this is always a valid index
+    uint32_t worker_index = job_system_worker_index(p_recorder->p_jobs);
+    recorder_worker_t* p_worker = &p_recorder->p_workers[worker_index];
+
+    VkCommandBufferInheritanceInfo inheritance_info = {0};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext = p_recorder->p_rendering_info;
+
+    VkCommandBufferBeginInfo begin_info = {0};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    // Secondaries executed inside dynamic rendering must say so
+    if(p_recorder->p_rendering_info != NULL)
+        begin_info.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+    for(uint32_t i = begin; i < end; ++i) {
+        if(p_worker->cmds_used >= RECORDER_MAX_CMDS_PER_WORKER) {
+            p_worker->result = VK_ERROR_OUT_OF_POOL_MEMORY;
+            return;
+        }
+
+        VkCommandBuffer cmd = p_worker->pp_cmds[p_recorder->frame_index][p_worker->cmds_used++];
+
+        VkResult result = vkBeginCommandBuffer(cmd, &begin_info);
+        if(result != VK_SUCCESS) {
+            p_worker->result = result;
+            return;
+        }
+
+        p_recorder->p_record_jobs[i].record(cmd, p_recorder->p_record_jobs[i].p_data);
+
+        result = vkEndCommandBuffer(cmd);
+        if(result != VK_SUCCESS) {
+            p_worker->result = result;
+            return;
+        }
+
+        p_recorder->p_out_cmds[i] = cmd;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef VULKAN_RECORDER_H_
+#define VULKAN_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "vulkan/vulkan_types.h"
+
+// One recording worker per job system worker
+#define RECORDER_MAX_WORKERS JOB_MAX_WORKERS
+
+// Number of secondary command buffers each worker has per frame
+#define RECORDER_MAX_CMDS_PER_WORKER 16
+
+/**
+ * A function recording the commands of a pass into a secondary command buffer. It is called on a job system worker, so
+ * it must only touch data that no other job is writing.
+ */
+typedef void (*record_func_t)(VkCommandBuffer cmd, void* p_data);
+
+/**
+ * A recording job, one secondary command buffer is recorded per job.
+ */
+typedef struct record_job_s {
+    record_func_t record;
+    void* p_data;
+} record_job_t;
+
+/**
+ * The command pools of a job system worker. Each worker owns one command pool per frame in flight, so workers never
+ * share a pool and no locking is needed while recording.
+ */
+typedef struct recorder_worker_s {
+    VkCommandPool p_pools[FRAMES_IN_FLIGHT];
+    VkCommandBuffer pp_cmds[FRAMES_IN_FLIGHT][RECORDER_MAX_CMDS_PER_WORKER];
+    uint32_t cmds_used; // Secondary command buffers handed out in the current frame
+    VkResult result;
+} recorder_worker_t;
+
+/**
+ * Records secondary command buffers in parallel on the workers of the job system.
+ */
+typedef struct cmd_recorder_s {
+    VkDevice device;
+    job_system_t* p_jobs;
+    recorder_worker_t p_workers[RECORDER_MAX_WORKERS];
+    uint32_t workers_count;
+    uint32_t frame_index;
+
+    // The batch currently being recorded
+    const record_job_t* p_record_jobs;
+    VkCommandBuffer* p_out_cmds;
+    const VkCommandBufferInheritanceRenderingInfo* p_rendering_info;
+} cmd_recorder_t;
+
+/**
+ * \brief Initiate the command recorder.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack.
+ * \param[in] device The vulkan logical device.
+ * \param[in] p_queues Pointer to the queue family data, the command pools are created for the graphics queue.
+ * \param[in] p_jobs Pointer to the job system the recording runs on, one set of command pools is created per worker.
+ * \param[out] p_recorder Pointer to the cmd_recorder_t to initiate. The deletion stack keeps the pointer, so it must
+ * stay valid until the stack is flushed.
+ */
+error_t vulkan_recorder_init(deletion_stack_t* p_dstack, VkDevice device, const queue_family_data_t* p_queues,
+    job_system_t* p_jobs, cmd_recorder_t* p_recorder);
+
+/**
+ * \brief Start recording a new frame.
+ *
+ * Resets the command pools of the frame, which must only be done once the fence of the last submit that used them has
+ * been signaled.
+ *
+ * \param[in] p_recorder Pointer to the cmd_recorder_t.
+ * \param[in] frame_index The index of the frame in flight, in [0, FRAMES_IN_FLIGHT).
+ */
+error_t vulkan_recorder_begin_frame(cmd_recorder_t* p_recorder, uint32_t frame_index);
+
+/**
+ * \brief Record a batch of jobs in parallel, one secondary command buffer per job.
+ *
+ * The jobs are spread over the job system workers, a worker calling this helps record. Returns once every job has been
+ * recorded. Can be called several times per frame as long as the workers have command buffers left. Must be called
+ * from a job system worker, usually worker 0 which is the thread that initiated the job system.
+ *
+ * \param[in] p_recorder Pointer to the cmd_recorder_t.
+ * \param[in] p_rendering_info The dynamic rendering the secondaries are executed inside, or NULL if they are executed
+ * outside of rendering (compute and transfer).
+ * \param[in] p_jobs Array of jobs to record.
+ * \param[in] jobs_count Number of jobs.
+ * \param[out] p_cmds Array of jobs_count secondary command buffers, in the same order as p_jobs. Execute them with
+ * vkCmdExecuteCommands.
+ */
+error_t vulkan_recorder_record(cmd_recorder_t* p_recorder,
+    const VkCommandBufferInheritanceRenderingInfo* p_rendering_info, const record_job_t* p_jobs, uint32_t jobs_count,
+    VkCommandBuffer* p_cmds);
+
+#endif // VULKAN_RECORDER_H_
@@ -0,0 +1,81 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_sprite_batch.h"
+
+size_t sprite_batch_buffer_size(void)
+{
+    return (size_t)SPRITE_MATERIAL_COUNT * SPRITE_MAX_INSTANCES * sizeof(sprite_instance_t);
+}
+
+uint32_t sprite_batch_first_instance(sprite_material_t material)
+{
+    return (uint32_t)material * SPRITE_MAX_INSTANCES;
+}
+
+void sprite_batch_init(sprite_batch_t* p_batch)
+{
+    if(p_batch == NULL) {
+        LOG_ERROR("%s: p_batch is NULL", __func__);
+        return;
+    }
+
+    p_batch->p_instances = NULL;
+    for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i)
+        p_batch->p_counts[i] = 0;
+    p_batch->dropped = 0;
+
+    sprite_batch_set_view(p_batch, -1.0f, -1.0f, 1.0f, 1.0f);
+}
+
+void sprite_batch_begin(sprite_batch_t* p_batch, void* p_mapped)
+{
+    if(p_batch == NULL) {
+        LOG_ERROR("%s: p_batch is NULL", __func__);
+        return;
+    }
+
+    p_batch->p_instances = (sprite_instance_t*)p_mapped;
+    for(int i = 0; i < SPRITE_MATERIAL_COUNT; ++i)
+        p_batch->p_counts[i] = 0;
+    p_batch->dropped = 0;
+}
+
+void sprite_batch_set_view(sprite_batch_t* p_batch, float min_x, float min_y, float max_x, float max_y)
+{
+    if(p_batch == NULL) {
+        LOG_ERROR("%s: p_batch is NULL", __func__);
+        return;
+    }
+
+    if(!(max_x > min_x) || !(max_y > min_y)) {
+        LOG_ERROR("%s: Empty view", __func__);
+        return;
+    }
+
+    // Clip space y points down in vulkan, so the world y axis is flipped
+    p_batch->view_scale[0] = 2.0f / (max_x - min_x);
+    p_batch->view_scale[1] = -2.0f / (max_y - min_y);
+    p_batch->view_offset[0] = -1.0f - min_x * p_batch->view_scale[0];
+    p_batch->view_offset[1] = 1.0f - min_y * p_batch->view_scale[1];
+}
+
+sprite_instance_t* sprite_batch_push(sprite_batch_t* p_batch, sprite_material_t material, uint32_t count)
+{
+    if(p_batch == NULL || (int)material < 0 || (int)material >= SPRITE_MATERIAL_COUNT) {
+        LOG_ERROR("%s: p_batch is NULL or the material is invalid", __func__);
+        return NULL;
+    }
+
+    if(p_batch->p_instances == NULL || count > SPRITE_MAX_INSTANCES - p_batch->p_counts[material]) {
+        p_batch->dropped += count;
+        return NULL;
+    }
+
+    sprite_instance_t* p_out = p_batch->p_instances + sprite_batch_first_instance(material) +
+        p_batch->p_counts[material];
+    p_batch->p_counts[material] += count;
+
+    return p_out;
+}
@@ -0,0 +1,94 @@
+#ifndef VULKAN_SPRITE_BATCH_H_
+#define VULKAN_SPRITE_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Most instances of one material in a frame
+#define SPRITE_MAX_INSTANCES 16384
+
+// Most static sprites, uploaded once and culled on the GPU. Must match MAX_STATIC_INSTANCES in sprite_cull.comp.
+#define SPRITE_MAX_STATIC_INSTANCES 65536
+
+/**
+ * How a sprite is shaded. Each material is a pipeline of its own and is drawn with a single instanced draw.
+ */
+typedef enum {
+    SPRITE_MATERIAL_SOLID = 0, // Filled rectangle, bricks and the paddle
+    SPRITE_MATERIAL_ROUND,     // Anti-aliased disc inscribed in the rectangle, balls
+    SPRITE_MATERIAL_COUNT
+} sprite_material_t;
+
+/**
+ * The per-instance data of a sprite. Must match the layout of the instance buffer in sprite.vert, 48 bytes with
+ * nothing but vec2 and vec4 members so the C and std430 layouts agree.
+ */
+typedef struct sprite_instance_s {
+    float pos[2];        // Center in world units
+    float size[2];       // Width and height in world units
+    float color[4];      // Linear RGBA, the draw image is HDR so values above 1 glow
+    float atlas_rect[4]; // u0, v0, u1, v1 of the sprite in the atlas
+} sprite_instance_t;
+
+/**
+ * \brief The sprites of a frame, written straight into the persistently mapped instance buffer of the frame.
+ *
+ * The buffer is split into one slice of SPRITE_MAX_INSTANCES per material, so sprites can be pushed in any order and
+ * each material still ends up contiguous. Drawing a material is then one vkCmdDraw with firstInstance at the start of
+ * its slice and instanceCount the number pushed, whatever the number of sprites.
+ *
+ * The mapped memory is usually write combined, so the instances returned by sprite_batch_push must only be written,
+ * never read back.
+ */
+typedef struct sprite_batch_s {
+    sprite_instance_t* p_instances;           // The mapped buffer of the open frame, NULL if no frame is open
+    uint32_t p_counts[SPRITE_MATERIAL_COUNT]; // Instances pushed per material
+    uint32_t dropped;                         // Instances that did not fit this frame
+    float view_scale[2];                      // World to clip space, clip = world * view_scale + view_offset
+    float view_offset[2];
+} sprite_batch_t;
+
+/**
+ * Size in bytes of the instance buffer of one frame.
+ */
+size_t sprite_batch_buffer_size(void) CONST_ATTR;
+
+/**
+ * The first instance of a material in the instance buffer, the firstInstance of its draw.
+ */
+uint32_t sprite_batch_first_instance(sprite_material_t material) CONST_ATTR;
+
+/**
+ * \brief Initiate an empty batch with no frame open, the view covers [-1, 1] on both axes.
+ */
+void sprite_batch_init(sprite_batch_t* p_batch);
+
+/**
+ * \brief Open a frame, every material starts out empty.
+ *
+ * \param[in] p_batch Pointer to the sprite_batch_t.
+ * \param[in] p_mapped The mapped instance buffer of the frame, at least sprite_batch_buffer_size bytes. The GPU must be
+ * done with it.
+ */
+void sprite_batch_begin(sprite_batch_t* p_batch, void* p_mapped);
+
+/**
+ * \brief Set the rectangle of the world that fills the viewport. The world y axis points up.
+ */
+void sprite_batch_set_view(sprite_batch_t* p_batch, float min_x, float min_y, float max_x, float max_y);
+
+/**
+ * \brief Reserve instances of a material in the open frame.
+ *
+ * \param[in] p_batch Pointer to the sprite_batch_t.
+ * \param[in] material The material of the sprites.
+ * \param[in] count Number of instances to reserve.
+ *
+ * \return Pointer to count instances to write, or NULL if no frame is open or they do not all fit, in which case they
+ * are counted as dropped.
+ */
+sprite_instance_t* sprite_batch_push(sprite_batch_t* p_batch, sprite_material_t material, uint32_t count);
+
+#endif // VULKAN_SPRITE_BATCH_H_
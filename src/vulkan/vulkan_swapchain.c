@@ -8,6 +8,7 @@
 #include "error/vulkan_error.h"
 #include "logger.h"
 #include "util/deletion_stack.h"
+#include "util/strbool.h"
 #include "vulkan/vulkan_types.h"
 #include "vulkan/vulkan_device.h"
 #include "vulkan/vulkan_swapchain.h"
@@ -17,7 +18,7 @@
  */
 typedef struct swapchain_del_s {
     VkDevice device;
-    vulkan_swapchain_t vulkan_swapchain;
+    vulkan_swapchain_t* p_vulkan_swapchain; // Pointer so a recreated swapchain is the one that gets deleted
 } swapchain_del_t;
 
 /**
@@ -35,10 +36,23 @@ static VkSurfaceFormatKHR choose_swapchain_surface_format(VkSurfaceFormatKHR* p_
  *
  * \param[in] p_present_modes Array of supported swapchain present modes.
  * \param[in] present_modes_count Number of elements in the present modes array.
+ * \param[in] present_policy The present policy the mode is chosen for.
  *
  * \return The chosen present mode.
  */
-static VkPresentModeKHR choose_swapchain_present_mode(VkPresentModeKHR* p_present_modes, size_t present_modes_count);
+static VkPresentModeKHR choose_swapchain_present_mode(VkPresentModeKHR* p_present_modes, size_t present_modes_count,
+    present_policy_t present_policy);
+
+/**
+ * Get a printable name of a present mode.
+ */
+static const char* present_mode_name(VkPresentModeKHR present_mode);
+
+/**
+ * Check if a present mode is in the array of supported present modes.
+ */
+static bool is_present_mode_supported(VkPresentModeKHR* p_present_modes, size_t present_modes_count,
+    VkPresentModeKHR present_mode);
 
 /**
  * Choose the swapchain extent. This is chosen to the pixel size given by SDL_GetWindowSizeInPixels. This is fairly
@@ -53,6 +67,21 @@ static VkPresentModeKHR choose_swapchain_present_mode(VkPresentModeKHR* p_presen
  */
 static VkExtent2D choose_swapchain_extent(SDL_Window* p_window, VkSurfaceCapabilitiesKHR capabilities);
 
+/**
+ * \brief Create the swapchain, get its images and create their image views.
+ *
+ * \param[in] old_swapchain The swapchain being replaced, or VK_NULL_HANDLE. It is not destroyed.
+ * \param[out] p_vulkan_swapchain Pointer to the vulkan_swapchain_t that is filled in.
+ */
+static error_t swapchain_create(VkDevice device, VkPhysicalDevice physical_device, VkSurfaceKHR surface,
+    SDL_Window* p_window, present_policy_t present_policy, VkSwapchainKHR old_swapchain,
+    vulkan_swapchain_t* p_vulkan_swapchain);
+
+/**
+ * Destroy the image views and the swapchain and free the image arrays.
+ */
+static void swapchain_destroy(VkDevice device, vulkan_swapchain_t* p_vulkan_swapchain);
+
 /**
  * \brief Destroy vulkan swapchain.
  *
@@ -61,8 +90,8 @@ static VkExtent2D choose_swapchain_extent(SDL_Window* p_window, VkSurfaceCapabil
  */
 static void vulkan_swapchain_deinit(void* p_void_vulkan_swapchain_del_struct);
 
-error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device, VkSurfaceKHR surface,
-    SDL_Window* p_window, vulkan_swapchain_t* p_vulkan_swapchain)
+error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    VkSurfaceKHR surface, SDL_Window* p_window, present_policy_t present_policy, vulkan_swapchain_t* p_vulkan_swapchain)
 {
 
     if(device == NULL)
@@ -80,6 +109,55 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
     if(p_vulkan_swapchain == NULL)
         return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_vulkan_swapchain is NULL", __func__);
 
+    error_t err = swapchain_create(device, physical_device, surface, p_window, present_policy, VK_NULL_HANDLE,
+        p_vulkan_swapchain);
+    if(err.code != 0)
+        return err;
+
+    swapchain_del_t* p_swp_del = (swapchain_del_t*)malloc(sizeof(swapchain_del_t));
+    p_swp_del->device = device;
+    p_swp_del->p_vulkan_swapchain = p_vulkan_swapchain;
+
+    err = deletion_stack_push(p_dstack, p_swp_del, vulkan_swapchain_deinit);
+    if(err.code != 0) {
+        vulkan_swapchain_deinit(p_swp_del);
+        return err;
+    }
+
+    LOG_INFO("Vulkan swapchain initiated");
+
+    return SUCCESS;
+}
+
+error_t vulkan_swapchain_recreate(VkDevice device, VkPhysicalDevice physical_device, VkSurfaceKHR surface,
+    SDL_Window* p_window, present_policy_t present_policy, vulkan_swapchain_t* p_vulkan_swapchain)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_vulkan_swapchain == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_vulkan_swapchain is NULL", __func__);
+
+    // The new swapchain is created from the old one so the presentation engine can hand over its resources, the old
+    // swapchain is only destroyed once the new one exists. If creation fails the old swapchain is kept as it is.
+    vulkan_swapchain_t new_swapchain = {0};
+    error_t err = swapchain_create(device, physical_device, surface, p_window, present_policy,
+        p_vulkan_swapchain->swapchain, &new_swapchain);
+    if(err.code != 0)
+        return err;
+
+    swapchain_destroy(device, p_vulkan_swapchain);
+    *p_vulkan_swapchain = new_swapchain;
+
+    LOG_INFO("Vulkan swapchain recreated, %ux%u", p_vulkan_swapchain->extent.width, p_vulkan_swapchain->extent.height);
+
+    return SUCCESS;
+}
+
+static error_t swapchain_create(VkDevice device, VkPhysicalDevice physical_device, VkSurfaceKHR surface,
+    SDL_Window* p_window, present_policy_t present_policy, VkSwapchainKHR old_swapchain,
+    vulkan_swapchain_t* p_vulkan_swapchain)
+{
     // Swapchain support has already been checked but we run this function again to retrieve the swapchain support
     // details (the surface formats and present modes)
     swapchain_support_details_t swapchain_support = {0};
@@ -92,14 +170,33 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
 
     // Choose which present modes we want to use
     VkPresentModeKHR present_mode = choose_swapchain_present_mode(swapchain_support.present_modes,
-        swapchain_support.present_modes_count);
+        swapchain_support.present_modes_count, present_policy);
 
     // Choose our swapchain extent
     VkExtent2D extent = choose_swapchain_extent(p_window, swapchain_support.capabilities);
 
-    // Check that the extent is non-zero
-    if(extent.height == 0 && extent.width == 0)
+    // Check that the extent is non-zero, which it is while the window is minimized
+    if(extent.height == 0 || extent.width == 0) {
+        free(swapchain_support.formats);
+        free(swapchain_support.present_modes);
         return error_init(ERR_SRC_CORE, ERR_WINDOW_EXTENT, "The swapchain extent is zero in one/both dimensions");
+    }
+
+    // Check if the swapchain images can be written from a compute shader. The shader writes the images without a
+    // format qualifier since the swapchain format is only known at runtime, which requires
+    // shaderStorageImageWriteWithoutFormat.
+    VkFormatProperties format_properties = {0};
+    vkGetPhysicalDeviceFormatProperties(physical_device, surface_format.format, &format_properties);
+
+    VkPhysicalDeviceFeatures features = {0};
+    vkGetPhysicalDeviceFeatures(physical_device, &features);
+
+    p_vulkan_swapchain->storage_capable =
+        (swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) != 0 &&
+        (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0 &&
+        features.shaderStorageImageWriteWithoutFormat == VK_TRUE;
+
+    LOG_DEBUG("Swapchain images storage capable: %s", strbool(p_vulkan_swapchain->storage_capable));
 
     // Aside from these properties we also have to decide how many images we would like to have in the swap chain.
     // The implementation specifies the minimum number that it requires to function. However, simply sticking to
@@ -133,6 +230,8 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
     // I am attempting to follow the cppvk13 tutorial where the swapchain is first created with this bit
     // VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT is the default for vk-bootstrap
     create_swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if(p_vulkan_swapchain->storage_capable)
+        create_swapchain_info.imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
 
     // The imageArrayLayers specifies the amount of layers each image consists of. This is always 1 unless you are
     // developing a stereoscopic 3D application. The imageUsage bit field specifies what kind of operations we’ll
@@ -175,16 +274,17 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
     create_swapchain_info.clipped = VK_TRUE;
 
     // That leaves one last field, oldSwapchain. With Vulkan it’s possible that your swap chain becomes invalid or
-    // unoptimized while your application is running, for example because the window was resized. In that case the
-    // swap chain actually needs to be recreated from scratch and a reference to the old one must be specified in
-    // this field. This is a complex topic that we’ll learn more about in a future chapter. For now we’ll assume
-    // that we’ll only ever create one swap chain.
-    create_swapchain_info.oldSwapchain = VK_NULL_HANDLE;
+    // unoptimized while your application is running, for example because the window was resized or the present mode
+    // changed. In that case the swap chain needs to be recreated and a reference to the old one is given here.
+    create_swapchain_info.oldSwapchain = old_swapchain;
 
     // Create swap chain.
     if(vkCreateSwapchainKHR(device, &create_swapchain_info, VK_NULL_HANDLE, &p_vulkan_swapchain->swapchain) !=
-        VK_SUCCESS)
+        VK_SUCCESS) {
+        free(swapchain_support.formats);
+        free(swapchain_support.present_modes);
         return error_init(ERR_SRC_VULKAN, VULKAN_ERR_SWAPCHAIN, "Failed to create swapchain");
+    }
 
     LOG_DEBUG("Vulkan swapchain created");
 
@@ -206,9 +306,10 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
     // Get swapchain images
     vkGetSwapchainImagesKHR(device, p_vulkan_swapchain->swapchain, &image_count, p_vulkan_swapchain->p_images);
 
-    // Store the format and extent we’ve chosen for the swap chain images
+    // Store the format, extent and present mode we’ve chosen for the swap chain images
     p_vulkan_swapchain->format = surface_format.format;
     p_vulkan_swapchain->extent = extent;
+    p_vulkan_swapchain->present_mode = present_mode;
 
     // These are allocated in get swapchain support
     free(swapchain_support.formats);
@@ -260,17 +361,7 @@ error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhy
             return error_init(ERR_SRC_VULKAN, VULKAN_ERR_IMAGE_VIEW, "%s: Failed to create image view", __func__);
     }
 
-    swapchain_del_t* p_swp_del = (swapchain_del_t*)malloc(sizeof(swapchain_del_t));
-    p_swp_del->device = device;
-    p_swp_del->vulkan_swapchain = *p_vulkan_swapchain;
-
-    error_t err = deletion_stack_push(p_dstack, p_swp_del, vulkan_swapchain_deinit);
-    if(err.code != 0) {
-        vulkan_swapchain_deinit(p_swp_del);
-        return err;
-    }
-
-    LOG_INFO("Vulkan swapchain initiated");
+    LOG_INFO("Swapchain present mode: %s", present_mode_name(present_mode));
 
     return SUCCESS;
 }
@@ -292,28 +383,36 @@ static void vulkan_swapchain_deinit(void* p_void_swp_del)
         return;
     }
 
-    if(p_swp_del->vulkan_swapchain.swapchain == NULL) {
+    if(p_swp_del->p_vulkan_swapchain == NULL || p_swp_del->p_vulkan_swapchain->swapchain == NULL) {
         LOG_ERROR("%s: swapchain is NULL", __func__);
         return;
     }
 
-    // Destroy swapchain
-    vkDestroySwapchainKHR(p_swp_del->device, p_swp_del->vulkan_swapchain.swapchain, VK_NULL_HANDLE);
+    swapchain_destroy(p_swp_del->device, p_swp_del->p_vulkan_swapchain);
 
-    free(p_swp_del->vulkan_swapchain.p_images); // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
-    p_swp_del->vulkan_swapchain.p_images = NULL;
+    free(p_swp_del);
+    p_swp_del = NULL;
+    p_void_swp_del = NULL;
+}
 
-    for(uint32_t i = 0; i < p_swp_del->vulkan_swapchain.images_count; ++i) {
+static void swapchain_destroy(VkDevice device, vulkan_swapchain_t* p_vulkan_swapchain)
+{
+    for(uint32_t i = 0; i < p_vulkan_swapchain->images_count; ++i) {
         LOG_DEBUG("    Destroying swapchain image view, index: %u", i);
-        vkDestroyImageView(p_swp_del->device, p_swp_del->vulkan_swapchain.p_image_views[i], VK_NULL_HANDLE);
+        vkDestroyImageView(device, p_vulkan_swapchain->p_image_views[i], VK_NULL_HANDLE);
     }
 
-    free(p_swp_del->vulkan_swapchain.p_image_views); // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
-    p_swp_del->vulkan_swapchain.p_image_views = NULL;
+    // Destroy swapchain
+    vkDestroySwapchainKHR(device, p_vulkan_swapchain->swapchain, VK_NULL_HANDLE);
+    p_vulkan_swapchain->swapchain = VK_NULL_HANDLE;
+
+    free(p_vulkan_swapchain->p_images); // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
+    p_vulkan_swapchain->p_images = NULL;
 
-    free(p_swp_del);
-    p_swp_del = NULL;
-    p_void_swp_del = NULL;
+    free(p_vulkan_swapchain->p_image_views); // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
+    p_vulkan_swapchain->p_image_views = NULL;
+
+    p_vulkan_swapchain->images_count = 0;
 }
 
 static VkSurfaceFormatKHR choose_swapchain_surface_format(VkSurfaceFormatKHR* p_formats, size_t formats_count)
@@ -337,23 +436,76 @@ static VkSurfaceFormatKHR choose_swapchain_surface_format(VkSurfaceFormatKHR* p_
     return p_formats[0];
 }
 
-static VkPresentModeKHR choose_swapchain_present_mode(VkPresentModeKHR* p_present_modes, size_t present_modes_count)
+static VkPresentModeKHR choose_swapchain_present_mode(VkPresentModeKHR* p_present_modes, size_t present_modes_count,
+    present_policy_t present_policy)
 {
-    // Only the VK_PRESENT_MODE_FIFO_KHR mode is guaranteed to be available, so we’ll again have to write a
-    // function that looks for the best mode that is available.
+    // Only the VK_PRESENT_MODE_FIFO_KHR mode is guaranteed to be available, every policy falls back to it.
     // I personally think that VK_PRESENT_MODE_MAILBOX_KHR is a very nice trade-off if energy usage is not a
     // concern. It allows us to avoid tearing while still maintaining a fairly low latency by rendering new images
     // that are as up-to-date as possible right until the vertical blank.
-    for(size_t i = 0; i < present_modes_count; ++i) {
-        if(p_present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
-        // if(p_present_modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-            return p_present_modes[i];
-        }
+    switch(present_policy) { // NOLINT
+    case PRESENT_POLICY_IMMEDIATE:
+        if(is_present_mode_supported(p_present_modes, present_modes_count, VK_PRESENT_MODE_IMMEDIATE_KHR))
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        // Mailbox is the closest to immediate that does not tear
+        // fall through
+    case PRESENT_POLICY_MAILBOX:
+        if(is_present_mode_supported(p_present_modes, present_modes_count, VK_PRESENT_MODE_MAILBOX_KHR))
+            return VK_PRESENT_MODE_MAILBOX_KHR;
+        break;
+    default:
+        // Vsync and low latency both use FIFO, low latency gets its latency from pacing the frame loop with
+        // present_wait instead of from the present mode
+        break;
     }
+
     // Garanteed so okay to return. This is most similar to vsync.
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+static bool is_present_mode_supported(VkPresentModeKHR* p_present_modes, size_t present_modes_count,
+    VkPresentModeKHR present_mode)
+{
+    for(size_t i = 0; i < present_modes_count; ++i) {
+        if(p_present_modes[i] == present_mode)
+            return true;
+    }
+
+    return false;
+}
+
+static const char* present_mode_name(VkPresentModeKHR present_mode)
+{
+    switch(present_mode) { // NOLINT
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo relaxed";
+    default:
+        return "unknown";
+    }
+}
+
+const char* vulkan_swapchain_present_policy_name(present_policy_t present_policy)
+{
+    switch(present_policy) { // NOLINT
+    case PRESENT_POLICY_VSYNC:
+        return "vsync";
+    case PRESENT_POLICY_MAILBOX:
+        return "mailbox";
+    case PRESENT_POLICY_IMMEDIATE:
+        return "immediate";
+    case PRESENT_POLICY_LOW_LATENCY:
+        return "low latency";
+    default:
+        return "unknown";
+    }
+}
+
 static VkExtent2D choose_swapchain_extent(SDL_Window* p_window, VkSurfaceCapabilitiesKHR capabilities)
 {
     // The swap extent is the resolution of the swap chain images and it’s almost always exactly equal to the
@@ -16,11 +16,34 @@
  * \param[in] physical_device The physical device.
  * \param[in] surface The vulkan rendering surface.
  * \param[in] p_window Pointer to the SDL window.
+ * \param[in] present_policy The present policy used to choose the present mode.
  * \param[out] p_vulkan_swapchain Pointer to vulkan_swapchain_t containing the newly initiated swapchain and related
- * objects.
+ * objects. The deletion stack keeps the pointer, so it must stay valid until the stack is flushed.
  * \return True if successful, else false.
  */
 error_t vulkan_swapchain_init(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
-    VkSurfaceKHR surface, SDL_Window* p_window, vulkan_swapchain_t* p_vulkan_swapchain);
+    VkSurfaceKHR surface, SDL_Window* p_window, present_policy_t present_policy,
+    vulkan_swapchain_t* p_vulkan_swapchain);
+
+/**
+ * \brief Recreate the swapchain in place, for example after a resize or to change the present mode.
+ *
+ * The device must be idle, or at least not use any of the swapchain images. If recreation fails the old swapchain is
+ * left untouched. The image count, images and image views may all change, so anything referencing them must be updated.
+ *
+ * \param[in] device The Vulkan logical device.
+ * \param[in] physical_device The physical device.
+ * \param[in] surface The vulkan rendering surface.
+ * \param[in] p_window Pointer to the SDL window.
+ * \param[in] present_policy The present policy used to choose the present mode.
+ * \param[in,out] p_vulkan_swapchain Pointer to the vulkan_swapchain_t initiated by vulkan_swapchain_init.
+ */
+error_t vulkan_swapchain_recreate(VkDevice device, VkPhysicalDevice physical_device, VkSurfaceKHR surface,
+    SDL_Window* p_window, present_policy_t present_policy, vulkan_swapchain_t* p_vulkan_swapchain);
+
+/**
+ * Get a printable name of a present policy.
+ */
+const char* vulkan_swapchain_present_policy_name(present_policy_t present_policy);
 
 #endif // VULKAN_SWAPCHAIN_H_
@@ -19,16 +19,14 @@ typedef struct semaphore_del_s {
     VkSemaphore sem;
 } semaphore_del_t;
 
-typedef struct fence_del_s {
-    VkDevice device;
-    VkFence fence;
-} fence_del_t;
-
 static void vulkan_sync_frame_deinit(void* p_void_vulkan_sync_frame_del_struct);
 
 static void vulkan_sync_semaphore_deinit(void* p_void_semaphore_del_struct);
 
-static void vulkan_sync_fence_deinit(void* p_void_fence_del_struct);
+/**
+ * Create a timeline semaphore starting at value 0.
+ */
+static error_t timeline_semaphore_init(deletion_stack_t* p_dstack, VkDevice device, VkSemaphore* p_timeline);
 
 error_t vulkan_sync_frame_init(deletion_stack_t* p_dstack, VkDevice device, frame_data_t* p_frames)
 {
@@ -107,28 +105,70 @@ static void vulkan_sync_frame_deinit(void* p_void_sync_frame_del)
     p_void_sync_frame_del = NULL;
 }
 
-error_t vulkan_sync_imm_init(deletion_stack_t* p_dstack, VkDevice device, VkFence* p_imm_fence)
+error_t vulkan_sync_imm_init(deletion_stack_t* p_dstack, VkDevice device, VkSemaphore* p_imm_timeline)
 {
-    VkFenceCreateInfo fence_info = {0};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    // The immediate submits signal increasing values on a timeline semaphore instead of a fence, so any number of
+    // batches can be in flight and waited on, or checked, by value
+    error_t err = timeline_semaphore_init(p_dstack, device, p_imm_timeline);
+    if(err.code != 0)
+        return err;
+
+    LOG_INFO("Immediate sync structures initiated");
+
+    return SUCCESS;
+}
+
+error_t vulkan_sync_async_compute_init(deletion_stack_t* p_dstack, VkDevice device, async_compute_t* p_async)
+{
+    if(device == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: device is NULL", __func__);
+
+    if(p_async == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_async is NULL", __func__);
+
+    *p_async = (async_compute_t){0};
+
+    error_t err = timeline_semaphore_init(p_dstack, device, &p_async->compute_timeline);
+    if(err.code != 0)
+        return err;
+
+    err = timeline_semaphore_init(p_dstack, device, &p_async->graphics_timeline);
+    if(err.code != 0)
+        return err;
+
+    LOG_INFO("Async compute sync structures initiated");
 
-    if(vkCreateFence(device, &fence_info, VK_NULL_HANDLE, p_imm_fence) != VK_SUCCESS)
-        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_FENCE, "Failed to create immediate fence");
+    return SUCCESS;
+}
+
+static error_t timeline_semaphore_init(deletion_stack_t* p_dstack, VkDevice device, VkSemaphore* p_timeline)
+{
+    VkSemaphoreTypeCreateInfo type_info = {0};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo sem_info = {0};
+    sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    sem_info.pNext = &type_info;
+
+    if(vkCreateSemaphore(device, &sem_info, VK_NULL_HANDLE, p_timeline) != VK_SUCCESS)
+        return error_init(ERR_SRC_VULKAN, VULKAN_ERR_SEMAPHORE, "Failed to create timeline semaphore");
 
     // CLEANUP
-    fence_del_t* p_fence_del = (fence_del_t*)malloc(sizeof(fence_del_t));
-    p_fence_del->device = device;
-    p_fence_del->fence = *p_imm_fence;
+    semaphore_del_t* p_sem_del = (semaphore_del_t*)malloc(sizeof(semaphore_del_t));
+    p_sem_del->device = device;
+    p_sem_del->sem = *p_timeline;
 
-    error_t err = deletion_stack_push(p_dstack, p_fence_del, vulkan_sync_fence_deinit);
+    error_t err = deletion_stack_push(p_dstack, p_sem_del, vulkan_sync_semaphore_deinit);
     if(err.code != 0) {
-        vulkan_sync_fence_deinit(p_fence_del);
+        vulkan_sync_semaphore_deinit(p_sem_del);
         return err;
     }
 
-    LOG_INFO("Immediate sync structures initiated");
-
     return SUCCESS;
 }
 
@@ -152,25 +192,6 @@ static void vulkan_sync_semaphore_deinit(void* p_void_sem_del)
     p_void_sem_del = NULL;
 }
 
-static void vulkan_sync_fence_deinit(void* p_void_fence_del)
-{
-    LOG_DEBUG("Callback: %s", __func__);
-
-    if(p_void_fence_del == NULL) {
-        LOG_ERROR("%s: p_void_fence_del is NULL", __func__);
-    }
-    // Cast pointer
-    fence_del_t* p_fence_del = (fence_del_t*)p_void_fence_del;
-
-    // NULL check struct fields?
-
-    vkDestroyFence(p_fence_del->device, p_fence_del->fence, VK_NULL_HANDLE);
-
-    free(p_fence_del);
-    p_fence_del = NULL;
-    p_void_fence_del = NULL;
-}
-
 VkSemaphoreSubmitInfo vulkan_sync_get_sem_submit_info(VkPipelineStageFlags2 stage_mask, VkSemaphore semaphore)
 {
     VkSemaphoreSubmitInfo info = {0};
@@ -182,3 +203,12 @@ VkSemaphoreSubmitInfo vulkan_sync_get_sem_submit_info(VkPipelineStageFlags2 stag
 
     return info;
 }
+
+VkSemaphoreSubmitInfo vulkan_sync_get_timeline_submit_info(VkPipelineStageFlags2 stage_mask, VkSemaphore semaphore,
+    uint64_t value)
+{
+    VkSemaphoreSubmitInfo info = vulkan_sync_get_sem_submit_info(stage_mask, semaphore);
+    info.value = value;
+
+    return info;
+}
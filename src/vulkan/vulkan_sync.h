@@ -11,8 +11,23 @@
 
 error_t vulkan_sync_frame_init(deletion_stack_t* p_dstack, VkDevice device, frame_data_t* p_frames);
 
-error_t vulkan_sync_imm_init(deletion_stack_t* p_dstack, VkDevice device, VkFence* p_imm_fence);
+/**
+ * Initiate the timeline semaphore signaled by the immediate submits, starting at value 0.
+ */
+error_t vulkan_sync_imm_init(deletion_stack_t* p_dstack, VkDevice device, VkSemaphore* p_imm_timeline);
+
+/**
+ * Initiate the timeline semaphores the async compute queue and the graphics queue wait on each other with, both
+ * starting at value 0.
+ */
+error_t vulkan_sync_async_compute_init(deletion_stack_t* p_dstack, VkDevice device, async_compute_t* p_async);
 
 VkSemaphoreSubmitInfo vulkan_sync_get_sem_submit_info(VkPipelineStageFlags2 stage_mask, VkSemaphore semaphore);
 
+/**
+ * Get a VkSemaphoreSubmitInfo which waits for or signals a value of a timeline semaphore.
+ */
+VkSemaphoreSubmitInfo vulkan_sync_get_timeline_submit_info(VkPipelineStageFlags2 stage_mask, VkSemaphore semaphore,
+    uint64_t value);
+
 #endif // VULKAN_SYNCH_H_
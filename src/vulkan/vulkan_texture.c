@@ -0,0 +1,50 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "vulkan/vulkan_texture.h"
+
+uint32_t texture_mips_count(uint32_t width, uint32_t height)
+{
+    if(width == 0 || height == 0)
+        return 0;
+
+    uint32_t max_side = width > height ? width : height;
+
+    uint32_t count = 1;
+    while(max_side > 1) {
+        max_side >>= 1;
+        ++count;
+    }
+
+    return count;
+}
+
+size_t texture_staging_layout(const uint32_t* p_widths, const uint32_t* p_heights, uint32_t count,
+    size_t* p_offsets)
+{
+    if(p_widths == NULL || p_heights == NULL || p_offsets == NULL) {
+        LOG_ERROR("%s: p_widths, p_heights or p_offsets is NULL", __func__);
+        return 0;
+    }
+
+    size_t size = 0;
+    for(uint32_t i = 0; i < count; ++i) {
+        // Written so none of the steps can wrap around, a batch that does not fit is rejected as a whole
+        size_t padding = (TEXTURE_STAGING_ALIGNMENT - size % TEXTURE_STAGING_ALIGNMENT) % TEXTURE_STAGING_ALIGNMENT;
+        if(padding > SIZE_MAX - size)
+            return 0;
+        size += padding;
+
+        if(p_heights[i] > 0 && (size_t)p_widths[i] > SIZE_MAX / TEXTURE_TEXEL_SIZE / p_heights[i])
+            return 0;
+        size_t texture_size = (size_t)p_widths[i] * p_heights[i] * TEXTURE_TEXEL_SIZE;
+        if(texture_size > SIZE_MAX - size)
+            return 0;
+
+        p_offsets[i] = size;
+        size += texture_size;
+    }
+
+    return size;
+}
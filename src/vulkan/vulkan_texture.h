@@ -0,0 +1,35 @@
+#ifndef VULKAN_TEXTURE_H_
+#define VULKAN_TEXTURE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Textures are decoded to 8 bit RGBA whatever the channels of the file
+#define TEXTURE_TEXEL_SIZE 4
+
+// Alignment of each texture in the staging buffer, a multiple of the texel size as vkCmdCopyBufferToImage requires
+#define TEXTURE_STAGING_ALIGNMENT 16
+
+/**
+ * \brief Number of mips of a full chain down to 1x1, the longer side halved until it is 1.
+ *
+ * \return The number of mips including mip 0, 0 if either side is 0.
+ */
+uint32_t texture_mips_count(uint32_t width, uint32_t height) CONST_ATTR;
+
+/**
+ * \brief Lay out a batch of decoded textures back to back in one staging buffer.
+ *
+ * \param[in] p_widths Width of each texture.
+ * \param[in] p_heights Height of each texture.
+ * \param[in] count Number of textures.
+ * \param[out] p_offsets Byte offset of each texture in the staging buffer, aligned to TEXTURE_STAGING_ALIGNMENT.
+ *
+ * \return The size of the staging buffer in bytes, 0 if count is 0 or the batch does not fit in a size_t.
+ */
+size_t texture_staging_layout(const uint32_t* p_widths, const uint32_t* p_heights, uint32_t count,
+    size_t* p_offsets);
+
+#endif // VULKAN_TEXTURE_H_
@@ -0,0 +1,265 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_timer.h>
+
+// The only translation unit with the implementation, so it is part of the library the tests link as well
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "logger.h"
+
+#include "error/error.h"
+#include "util/asset_pack.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "vulkan/vulkan_types.h"
+#include "vulkan/vulkan_buffer.h"
+#include "vulkan/vulkan_image.h"
+#include "vulkan/vulkan_imm.h"
+#include "vulkan/vulkan_texture.h"
+#include "vulkan/vulkan_texture_loader.h"
+
+/**
+ * The shared state of the decode jobs, each job decodes a range of p_loads.
+ */
+typedef struct texture_decode_s {
+    texture_load_t* p_loads;
+    const uint32_t* p_widths; // From the headers, a file that decodes to another size is an error
+    const uint32_t* p_heights;
+    const size_t* p_offsets;
+    uint8_t* p_staging;
+    SDL_AtomicInt failed; // Index of a texture that failed to decode plus one, 0 if none did
+} texture_decode_t;
+
+/**
+ * Decode the textures [begin, end) into the staging buffer.
+ */
+static void decode_textures(void* p_data, uint32_t begin, uint32_t end);
+
+/**
+ * \brief Flush the deletion stack the staging buffer was created on.
+ *
+ * \param[in] p_void_dstack Pointer to the deletion_stack_t.
+ */
+static void staging_deinit(void* p_void_dstack);
+
+/**
+ * \brief Find an encoded texture in the mounted asset pack, decoded straight out of the mapping.
+ *
+ * \return NULL if the texture is not packed, or too large for stb_image to take from memory, and is read from its file.
+ */
+static const stbi_uc* packed_texture(const char* p_path, int* p_size);
+
+error_t vulkan_texture_load(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    job_system_t* p_jobs, imm_batcher_t* p_imm, texture_load_t* p_loads, uint32_t count, uint64_t* p_value)
+{
+    if(p_imm == NULL || p_loads == NULL)
+        return error_init(ERR_SRC_CORE, ERR_NULL_ARG, "%s: p_imm or p_loads is NULL", __func__);
+
+    if(count == 0)
+        return SUCCESS;
+
+    uint32_t* p_widths = (uint32_t*)malloc(2 * count * sizeof(uint32_t));
+    size_t* p_offsets = (size_t*)malloc(count * sizeof(size_t));
+    if(p_widths == NULL || p_offsets == NULL) {
+        free(p_widths);
+        free(p_offsets);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "%s: Failed to allocate the layout of %u textures", __func__,
+            count);
+    }
+    uint32_t* p_heights = p_widths + count;
+
+    // Only the headers are read here, which is enough to size the staging buffer before anything is decoded
+    for(uint32_t i = 0; i < count; ++i) {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        int packed_size = 0;
+        const stbi_uc* p_packed = packed_texture(p_loads[i].p_path, &packed_size);
+        int read = p_packed != NULL ? stbi_info_from_memory(p_packed, packed_size, &width, &height, &channels) :
+            stbi_info(p_loads[i].p_path, &width, &height, &channels);
+        if(!read || width <= 0 || height <= 0) {
+            free(p_widths);
+            free(p_offsets);
+            return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to read the header of %s: %s", __func__,
+                p_loads[i].p_path, stbi_failure_reason());
+        }
+
+        p_widths[i] = (uint32_t)width;
+        p_heights[i] = (uint32_t)height;
+    }
+
+    size_t staging_size = texture_staging_layout(p_widths, p_heights, count, p_offsets);
+    if(staging_size == 0) {
+        free(p_widths);
+        free(p_offsets);
+        return error_init(ERR_SRC_CORE, ERR_UNSUPPORTED, "%s: %u textures are too large for one staging buffer",
+            __func__, count);
+    }
+
+    // The staging buffer gets a deletion stack of its own, which the immediate batcher flushes once the copies are done
+    deletion_stack_t* p_staging_dstack = deletion_stack_init();
+    if(p_staging_dstack == NULL) {
+        free(p_widths);
+        free(p_offsets);
+        return error_init(ERR_SRC_CORE, ERR_DELETION_STACK_INIT, "%s: Failed to initiate deletion stack", __func__);
+    }
+
+    allocated_buffer_t staging;
+    error_t err = vulkan_buffer_create(p_staging_dstack, device, physical_device, (VkDeviceSize)staging_size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &staging);
+    if(err.code != 0) {
+        free(p_widths);
+        free(p_offsets);
+        deletion_stack_flush(&p_staging_dstack);
+        return err;
+    }
+
+    // One texture per job, they differ too much in size for larger batches to balance
+    texture_decode_t decode = {0};
+    decode.p_loads = p_loads;
+    decode.p_widths = p_widths;
+    decode.p_heights = p_heights;
+    decode.p_offsets = p_offsets;
+    decode.p_staging = (uint8_t*)staging.p_mapped;
+    SDL_SetAtomicInt(&decode.failed, 0);
+
+    uint64_t decode_start_ns = SDL_GetTicksNS();
+    job_system_parallel_for(p_jobs, count, 1, decode_textures, &decode);
+    double decode_ms = (double)(SDL_GetTicksNS() - decode_start_ns) / 1e6;
+
+    int failed = SDL_GetAtomicInt(&decode.failed);
+    if(failed != 0) {
+        free(p_widths);
+        free(p_offsets);
+        deletion_stack_flush(&p_staging_dstack);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "%s: Failed to decode %s", __func__, p_loads[failed - 1].p_path);
+    }
+
+    for(uint32_t i = 0; i < count; ++i) {
+        err = vulkan_image_create_texture(p_dstack, device, physical_device, p_widths[i], p_heights[i],
+            texture_mips_count(p_widths[i], p_heights[i]), &p_loads[i].image);
+        if(err.code != 0) {
+            free(p_widths);
+            free(p_offsets);
+            deletion_stack_flush(&p_staging_dstack);
+            return err;
+        }
+    }
+
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    err = vulkan_imm_begin(p_imm, &cmd, p_value);
+    if(err.code == 0)
+        err = vulkan_imm_defer_delete(p_imm, p_staging_dstack, staging_deinit);
+    if(err.code != 0) {
+        free(p_widths);
+        free(p_offsets);
+        deletion_stack_flush(&p_staging_dstack);
+        return err;
+    }
+
+    for(uint32_t i = 0; i < count; ++i) {
+        const allocated_image_t* p_image = &p_loads[i].image;
+
+        vulkan_image_transition(cmd, p_image->image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        VkBufferImageCopy copy = {0};
+        copy.bufferOffset = (VkDeviceSize)p_offsets[i];
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageExtent = p_image->extent;
+        vkCmdCopyBufferToImage(cmd, staging.buffer, p_image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+        vulkan_image_generate_mips(cmd, p_image);
+
+        LOG_DEBUG("Texture %s: %ux%u, %u mips, decode %.2f ms, copy %.2f ms", p_loads[i].p_path, p_widths[i],
+            p_heights[i], p_image->mip_levels, p_loads[i].decode_ms, p_loads[i].copy_ms);
+    }
+
+    LOG_DEBUG("%u textures decoded in %.2f ms, %zu bytes staged", count, decode_ms, staging_size);
+
+    free(p_widths);
+    free(p_offsets);
+
+    return SUCCESS;
+}
+
+static void decode_textures(void* p_data, uint32_t begin, uint32_t end)
+{
+    texture_decode_t* p_decode = (texture_decode_t*)p_data;
+
+    for(uint32_t i = begin; i < end; ++i) {
+        texture_load_t* p_load = &p_decode->p_loads[i];
+
+        uint64_t start_ns = SDL_GetTicksNS();
+
+        // Always decoded to RGBA, whatever the channels of the file
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        int packed_size = 0;
+        const stbi_uc* p_packed = packed_texture(p_load->p_path, &packed_size);
+        stbi_uc* p_pixels = p_packed != NULL ?
+            stbi_load_from_memory(p_packed, packed_size, &width, &height, &channels, STBI_rgb_alpha) :
+            stbi_load(p_load->p_path, &width, &height, &channels, STBI_rgb_alpha);
+
+        uint64_t decoded_ns = SDL_GetTicksNS();
+        p_load->decode_ms = (double)(decoded_ns - start_ns) / 1e6;
+
+        if(p_pixels == NULL || (uint32_t)width != p_decode->p_widths[i] || (uint32_t)height != p_decode->p_heights[i]) {
+            LOG_ERROR("%s: Failed to decode %s: %s", __func__, p_load->p_path,
+                p_pixels == NULL ? stbi_failure_reason() : "size differs from the header");
+            stbi_image_free(p_pixels);
+            SDL_SetAtomicInt(&p_decode->failed, (int)i + 1);
+            continue;
+        }
+
+        memcpy(p_decode->p_staging + p_decode->p_offsets[i], p_pixels,
+            (size_t)p_decode->p_widths[i] * p_decode->p_heights[i] * TEXTURE_TEXEL_SIZE);
+        stbi_image_free(p_pixels);
+
+        p_load->copy_ms = (double)(SDL_GetTicksNS() - decoded_ns) / 1e6;
+    }
+}
+
+static void staging_deinit(void* p_void_dstack)
+{
+    LOG_DEBUG("Callback: %s", __func__);
+
+    if(p_void_dstack == NULL) {
+        LOG_ERROR("%s: p_void_dstack is NULL", __func__);
+        return;
+    }
+
+    // Cast pointer
+    deletion_stack_t* p_dstack = (deletion_stack_t*)p_void_dstack;
+
+    error_t err = deletion_stack_flush(&p_dstack);
+    if(err.code != 0) {
+        LOG_ERROR("%s", err.msg);
+        error_deinit(&err);
+    }
+
+    p_void_dstack = NULL;
+}
+
+static const stbi_uc* packed_texture(const char* p_path, int* p_size)
+{
+    size_t size = 0;
+    const stbi_uc* p_packed = (const stbi_uc*)asset_pack_find_mounted(p_path, &size);
+    if(p_packed == NULL || size == 0 || size > (size_t)INT_MAX)
+        return NULL;
+
+    *p_size = (int)size;
+
+    return p_packed;
+}
@@ -0,0 +1,44 @@
+#ifndef VULKAN_TEXTURE_LOADER_H_
+#define VULKAN_TEXTURE_LOADER_H_
+
+#include <stdint.h>
+
+#include <vulkan/vulkan_core.h>
+
+#include "error/error.h"
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "vulkan/vulkan_imm.h"
+#include "vulkan/vulkan_types.h"
+
+/**
+ * A texture to load. p_path is set by the caller, the rest is filled in by vulkan_texture_load.
+ */
+typedef struct texture_load_s {
+    const char* p_path;
+    allocated_image_t image; // 8 bit sRGB with a full mip chain, in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    double decode_ms;        // Time the worker spent decoding the file
+    double copy_ms;          // Time the worker spent copying the pixels into the staging buffer
+} texture_load_t;
+
+/**
+ * \brief Load a batch of textures from image files.
+ *
+ * The headers are read on the calling thread to lay out one staging buffer for the whole batch. The files are then
+ * decoded with stb_image on the job system workers, each straight into its slice of the mapped staging buffer. The
+ * copies to the images and the blit cascades that generate their mips are recorded into the immediate batcher, which
+ * deletes the staging buffer once they are done.
+ *
+ * \param[in] p_dstack Pointer to the deletion stack the images are pushed to.
+ * \param[in] device The vulkan logical device.
+ * \param[in] physical_device The vulkan physical device.
+ * \param[in] p_jobs Pointer to the job system, or NULL to decode on the calling thread.
+ * \param[in] p_imm Pointer to the immediate batcher, must be used from the calling thread only.
+ * \param[in,out] p_loads The textures to load.
+ * \param[in] count Number of textures.
+ * \param[out] p_value Optional, the timeline value of the immediate batch that signals once every texture is ready.
+ */
+error_t vulkan_texture_load(deletion_stack_t* p_dstack, VkDevice device, VkPhysicalDevice physical_device,
+    job_system_t* p_jobs, imm_batcher_t* p_imm, texture_load_t* p_loads, uint32_t count, uint64_t* p_value);
+
+#endif // VULKAN_TEXTURE_LOADER_H_
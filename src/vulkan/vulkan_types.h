@@ -1,9 +1,14 @@
 #ifndef VULKAN_TYPES_H_
 #define VULKAN_TYPES_H_
 
+#include <stdbool.h>
+
 #include <vulkan/vulkan_core.h>
 
-#define FRAMES_IN_FLIGHT 2
+#include "vulkan/vulkan_bloom.h"
+
+#define FRAMES_IN_FLIGHT     2
+#define MAX_SWAPCHAIN_IMAGES 8
 
 /**
  * Struct for holding the queue family information.
@@ -12,10 +17,14 @@ typedef struct queue_family_data_s {
     // Vulkan opaque pointers 8/4 bytes
     VkQueue graphics;
     VkQueue present;
+    VkQueue compute; // The graphics queue unless async_compute is set
 
     // uint32_t 4 bytes
     uint32_t graphics_index;
     uint32_t present_index;
+    uint32_t compute_index;
+
+    bool async_compute; // The device has a compute family without graphics, its work can overlap the graphics queue
 } queue_family_data_t;
 
 /**
@@ -42,11 +51,36 @@ typedef struct vulkan_swapchain_s {
     VkImageView* p_image_views;
     VkFormat format;
     VkExtent2D extent;
+    VkPresentModeKHR present_mode;
 
     // uint32_t 4 bytes
     uint32_t images_count;
+
+    // bool
+    bool storage_capable; // The swapchain images can be written to directly from a compute shader
 } vulkan_swapchain_t;
 
+/**
+ * The optional device features and extensions that were enabled when the logical device was created.
+ */
+typedef struct device_caps_s {
+    bool present_wait;        // VK_KHR_present_id and VK_KHR_present_wait
+    bool draw_indirect_count; // The 1.2 drawIndirectCount feature, vkCmdDrawIndirectCount
+    uint32_t subgroup_size;   // Invocations per subgroup
+    VkSubgroupFeatureFlags subgroup_ops; // Subgroup operations supported in compute shaders, 0 if none
+} device_caps_t;
+
+/**
+ * How frames are handed to the display. The policy decides the swapchain present mode and how the frame loop is paced.
+ */
+typedef enum {
+    PRESENT_POLICY_VSYNC = 0,   // FIFO, never tears, up to a few frames of queued latency
+    PRESENT_POLICY_MAILBOX,     // MAILBOX, never tears, the newest frame replaces the queued one, falls back to FIFO
+    PRESENT_POLICY_IMMEDIATE,   // IMMEDIATE, may tear, lowest latency, falls back to MAILBOX and then FIFO
+    PRESENT_POLICY_LOW_LATENCY, // FIFO paced with present_wait so input is sampled right before the frame is needed
+    PRESENT_POLICY_COUNT
+} present_policy_t;
+
 /**
  * Struct containing all data relevant for an image allocated on the physical device
  */
@@ -57,17 +91,212 @@ typedef struct allocated_image_s {
     VkDeviceMemory mem;
     VkExtent3D extent;
     VkFormat format;
+    uint32_t mip_levels; // image_view only covers mip 0
 } allocated_image_t;
 
+/**
+ * Struct containing all data relevant for a buffer allocated on the physical device
+ */
+typedef struct allocated_buffer_s {
+    VkBuffer buffer;
+    VkDeviceMemory mem;
+    VkDeviceSize size;
+    void* p_mapped; // NULL unless the memory is host visible, then mapped for the lifetime of the buffer
+} allocated_buffer_t;
+
+/**
+ * The GPU work that is measured with timestamp queries. Each scope uses two queries, one written at the start of the
+ * scope and one at the end.
+ */
+typedef enum {
+    GPU_SCOPE_FRAME = 0,
+    GPU_SCOPE_BACKGROUND,
+    GPU_SCOPE_CULL,
+    GPU_SCOPE_PARTICLES,
+    GPU_SCOPE_SPRITES,
+    GPU_SCOPE_BLOOM_DOWN,
+    GPU_SCOPE_BLOOM_UP,
+    GPU_SCOPE_PRESENT_BLIT,
+    GPU_SCOPE_PRESENT_COMPUTE,
+    GPU_SCOPE_COUNT
+} gpu_scope_t;
+
+/**
+ * The GPU timings read back from the timestamp queries, in milliseconds.
+ */
+typedef struct gpu_timings_s {
+    double p_last_ms[GPU_SCOPE_COUNT];
+    double p_avg_ms[GPU_SCOPE_COUNT];
+    float period_ns;          // Nanoseconds per timestamp tick
+    uint64_t valid_bits_mask; // Mask of the valid timestamp bits of the graphics queue
+    bool supported;
+} gpu_timings_t;
+
+/**
+ * The path used to get the draw image onto the swapchain image.
+ */
+typedef enum {
+    PRESENT_PATH_BLIT = 0, // vkCmdBlitImage2 with a linear filter
+    PRESENT_PATH_COMPUTE   // Compute shader that samples the draw image and writes the swapchain image directly
+} present_path_t;
+
+/**
+ * The filter the compute present path scales the draw extent up to the swapchain extent with. The blit path is always
+ * linear.
+ */
+typedef enum {
+    UPSCALE_FILTER_LINEAR = 0, // One bilinear tap per pixel
+    UPSCALE_FILTER_EDGE        // Edge adaptive resampling with sharpening in present_upscale.comp, FSR 1 style
+} upscale_filter_t;
+
+/**
+ * Push constants of the background compute pipeline, a vertical gradient between two colors with bands of light
+ * rolling across it. Must match the layout in gradient.comp.
+ */
+typedef struct background_push_constants_s {
+    float color_top[4];    // Linear RGBA at the top of the draw extent
+    float color_bottom[4]; // Linear RGBA at the bottom of the draw extent
+    float inv_extent[2];   // 1 / draw_extent, the gradient spans the part of the draw image that is shown
+    float time;            // Seconds since the context was initiated
+    float wave_speed;      // Radians per second the bands move with
+    float wave_amplitude;  // How far the bands bend the gradient, 0 for a plain gradient
+    float wave_frequency;  // Radians per draw extent width
+} background_push_constants_t;
+
+/**
+ * Push constants of the present compute pipeline. Must match the layout in present.comp.
+ */
+typedef struct present_push_constants_s {
+    float uv_scale[2]; // draw_extent / draw_image.extent
+    float exposure;
+    uint32_t encode_srgb; // Non-zero if the swapchain format is UNORM and the shader must do the sRGB encode
+    float bloom_strength; // Scale of the bloom added to the draw image before tonemapping, 0 for none
+    float sharpness;      // Sharpening of the edge adaptive upscale in [0, 1], unused by present.comp
+} present_push_constants_t;
+
+/**
+ * Push constants of the bloom compute pipelines. Must match the layout in bloom_down.comp and bloom_up.comp.
+ */
+typedef struct bloom_push_constants_s {
+    int32_t src_size[2]; // Extent of the level read, reads past it are clamped to its edge
+    int32_t dst_size[2]; // Extent of the level written
+    float threshold;     // Brightness the bright pass lets through, only used by the first downsample
+    float knee;          // Width of the soft transition below the threshold
+    uint32_t prefilter;  // Non-zero for the first downsample, which reads the draw image and applies the bright pass
+} bloom_push_constants_t;
+
+/**
+ * \brief The bloom pyramid, built on the mip levels of the draw image.
+ *
+ * Each frame the bright parts of mip 0 are downsampled level by level to the smallest mip, then each level is upsampled
+ * and added into the one above it up to mip 1, which the present pass adds to the draw image before tonemapping.
+ */
+typedef struct bloom_s {
+    uint32_t mips_count;                         // Levels below mip 0, 0 if the draw image is too small for bloom
+    VkImageView p_views[BLOOM_MAX_MIPS + 1];     // One view per mip of the draw image, p_views[0] is not owned
+    VkDescriptorSetLayout desc_layout;
+    VkDescriptorSet p_down_descs[BLOOM_MAX_MIPS]; // Reads mip i, writes mip i + 1
+    VkDescriptorSet p_up_descs[BLOOM_MAX_MIPS];   // Reads mip i + 2, adds into mip i + 1
+    VkPipelineLayout pipeline_layout;
+    VkPipeline down_pipeline;
+    VkPipeline up_pipeline;
+    float threshold;
+    float knee;
+    float strength; // Scale of the bloom on screen, split between the levels it is summed from
+} bloom_t;
+
+/**
+ * Push constants of the sprite pipelines. Must match the layout in sprite.vert.
+ */
+typedef struct sprite_push_constants_s {
+    float view_scale[2]; // World to clip space, clip = world * view_scale + view_offset
+    float view_offset[2];
+} sprite_push_constants_t;
+
+/**
+ * Push constants of the static sprite cull pipeline. Must match the layout in sprite_cull.comp.
+ */
+typedef struct sprite_cull_push_constants_s {
+    float view_scale[2]; // Same view as the sprite pipelines, the sprites are culled in clip space
+    float view_offset[2];
+    uint32_t count; // Number of static sprites
+} sprite_cull_push_constants_t;
+
+/**
+ * \brief Sprites that never move, uploaded once and culled on the GPU.
+ *
+ * Every frame a compute pass culls them against the view, compacts the ones left into one slice per material of the
+ * culled buffer and writes the indirect draws that draw them. The CPU only writes the visible bits.
+ */
+typedef struct static_sprites_s {
+    allocated_buffer_t instances;                    // Device local sprite instances in upload order
+    allocated_buffer_t materials;                    // Device local uint32_t material of each instance
+    allocated_buffer_t p_visible[FRAMES_IN_FLIGHT];  // Host visible, one bit per instance, set if it is drawn
+    allocated_buffer_t p_culled[FRAMES_IN_FLIGHT];   // Device local, the instances left after culling
+    allocated_buffer_t p_indirect[FRAMES_IN_FLIGHT]; // Device local, one draw command per material then the draw counts
+    VkDescriptorSetLayout cull_desc_layout;
+    VkDescriptorSet p_cull_descs[FRAMES_IN_FLIGHT];
+    VkDescriptorSet p_draw_descs[FRAMES_IN_FLIGHT]; // Sprite descriptor sets pointing at the culled buffers
+    VkPipelineLayout cull_pipeline_layout;
+    VkPipeline cull_pipeline;
+    uint32_t count; // Number of uploaded instances
+} static_sprites_t;
+
+/**
+ * Push constants of the particle compute pipelines. Must match the layout in particle_emit.comp and particle_sim.comp.
+ */
+typedef struct particle_push_constants_s {
+    float dt;                // Seconds the particles are moved
+    float gravity;           // Downward acceleration in world units per second squared
+    uint32_t emitters_count; // Emitters of the frame, one work group each
+} particle_push_constants_t;
+
+/**
+ * \brief The GPU side of the particle system.
+ *
+ * The particles live in a ring buffer in device local memory. Each frame the emit pass spawns the particles of the
+ * frame's emitters at the head of the ring, the sim pass moves every particle and the sprite pipelines draw the whole
+ * ring as instanced quads, dead particles having no size.
+ */
+typedef struct particle_system_s {
+    allocated_buffer_t instances; // Device local, sprite instances read by the sprite vertex shader
+    allocated_buffer_t motions;   // Device local, velocity and life of each particle
+    allocated_buffer_t head;      // Device local, uint32_t count of every particle spawned
+    VkDescriptorSetLayout desc_layout;
+    VkDescriptorSet desc;      // The emitters of the frame are bound with a dynamic offset into the frame arena
+    VkDescriptorSet draw_desc; // Sprite descriptor set pointing at the instances
+    VkPipelineLayout pipeline_layout;
+    VkPipeline emit_pipeline;
+    VkPipeline sim_pipeline;
+    uint32_t used; // Slots of the ring written so far, the whole ring once it has wrapped
+} particle_system_t;
+
+/**
+ * \brief The timeline semaphores the async compute queue and the graphics queue wait on each other with.
+ *
+ * Each compute submit signals the next value of compute_timeline and each frame submit the next value of
+ * graphics_timeline, so either queue can wait for the other by value without the CPU blocking.
+ */
+typedef struct async_compute_s {
+    VkSemaphore compute_timeline;
+    VkSemaphore graphics_timeline;
+    uint64_t compute_value;  // Last value submitted to be signaled on compute_timeline
+    uint64_t graphics_value; // Last value submitted to be signaled on graphics_timeline
+} async_compute_t;
+
 /**
  * A struct for holden per frame data and vulkan handles
  */
 typedef struct frame_data_s {
     VkCommandPool cmd_pool;
     VkCommandBuffer cmd;
+    VkCommandPool compute_cmd_pool; // VK_NULL_HANDLE without an async compute queue
+    VkCommandBuffer compute_cmd;    // Submitted to the async compute queue ahead of cmd
     VkSemaphore swapchain_semaphore;
     VkSemaphore render_semaphore;
     VkFence render_fence;
+    VkQueryPool timestamp_pool; // VK_NULL_HANDLE if timestamps are unsupported
+    bool timestamps_written;    // True once a submitted command buffer has written to timestamp_pool
     struct deletion_stack_s* p_dstack;
 } frame_data_t;
 
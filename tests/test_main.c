@@ -18,11 +18,110 @@
 extern const struct CMUnitTest logger_tests[];
 extern const size_t logger_tests_count;
 
+// test_job_system.c
+extern const struct CMUnitTest job_system_tests[];
+extern const size_t job_system_tests_count;
+
+// test_asset_pack.c
+extern const struct CMUnitTest asset_pack_tests[];
+extern const size_t asset_pack_tests_count;
+
+// test_dynres.c
+extern const struct CMUnitTest dynres_tests[];
+extern const size_t dynres_tests_count;
+
+// test_sprite_batch.c
+extern const struct CMUnitTest sprite_batch_tests[];
+extern const size_t sprite_batch_tests_count;
+
+// test_particle_batch.c
+extern const struct CMUnitTest particle_batch_tests[];
+extern const size_t particle_batch_tests_count;
+
+// test_frame_arena.c
+extern const struct CMUnitTest frame_arena_tests[];
+extern const size_t frame_arena_tests_count;
+
+// test_bloom.c
+extern const struct CMUnitTest bloom_tests[];
+extern const size_t bloom_tests_count;
+
+// test_texture.c
+extern const struct CMUnitTest texture_tests[];
+extern const size_t texture_tests_count;
+
+// test_game_clock.c
+extern const struct CMUnitTest game_clock_tests[];
+extern const size_t game_clock_tests_count;
+
+// test_sim_thread.c
+extern const struct CMUnitTest sim_thread_tests[];
+extern const size_t sim_thread_tests_count;
+
+// test_replay.c
+extern const struct CMUnitTest replay_tests[];
+extern const size_t replay_tests_count;
+
+// test_brick_field.c
+extern const struct CMUnitTest brick_field_tests[];
+extern const size_t brick_field_tests_count;
+
+// test_collide.c
+extern const struct CMUnitTest collide_tests[];
+extern const size_t collide_tests_count;
+
+// test_broadphase.c
+extern const struct CMUnitTest broadphase_tests[];
+extern const size_t broadphase_tests_count;
+
 int main(void) {
     int fail = 0;
 
     // Run the logger test group
     fail += _cmocka_run_group_tests("Logger tests", logger_tests, logger_tests_count, NULL, NULL);
 
+    // Run the job system test group
+    fail += _cmocka_run_group_tests("Job system tests", job_system_tests, job_system_tests_count, NULL, NULL);
+
+    // Run the asset pack test group
+    fail += _cmocka_run_group_tests("Asset pack tests", asset_pack_tests, asset_pack_tests_count, NULL, NULL);
+
+    // Run the dynamic resolution test group
+    fail += _cmocka_run_group_tests("Dynamic resolution tests", dynres_tests, dynres_tests_count, NULL, NULL);
+
+    // Run the sprite batch test group
+    fail += _cmocka_run_group_tests("Sprite batch tests", sprite_batch_tests, sprite_batch_tests_count, NULL, NULL);
+
+    // Run the particle batch test group
+    fail += _cmocka_run_group_tests("Particle batch tests", particle_batch_tests, particle_batch_tests_count, NULL,
+        NULL);
+
+    // Run the frame arena test group
+    fail += _cmocka_run_group_tests("Frame arena tests", frame_arena_tests, frame_arena_tests_count, NULL, NULL);
+
+    // Run the bloom pyramid test group
+    fail += _cmocka_run_group_tests("Bloom tests", bloom_tests, bloom_tests_count, NULL, NULL);
+
+    // Run the texture layout test group
+    fail += _cmocka_run_group_tests("Texture tests", texture_tests, texture_tests_count, NULL, NULL);
+
+    // Run the fixed timestep clock test group
+    fail += _cmocka_run_group_tests("Game clock tests", game_clock_tests, game_clock_tests_count, NULL, NULL);
+
+    // Run the simulation thread test group
+    fail += _cmocka_run_group_tests("Simulation thread tests", sim_thread_tests, sim_thread_tests_count, NULL, NULL);
+
+    // Run the input recording and replay test group
+    fail += _cmocka_run_group_tests("Replay tests", replay_tests, replay_tests_count, NULL, NULL);
+
+    // Run the brick field test group
+    fail += _cmocka_run_group_tests("Brick field tests", brick_field_tests, brick_field_tests_count, NULL, NULL);
+
+    // Run the ball versus brick collision test group
+    fail += _cmocka_run_group_tests("Collision tests", collide_tests, collide_tests_count, NULL, NULL);
+
+    // Run the broadphase test group
+    fail += _cmocka_run_group_tests("Broadphase tests", broadphase_tests, broadphase_tests_count, NULL, NULL);
+
     return fail;
 }
@@ -0,0 +1,139 @@
+/*
+  test_brick_field.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+
+// The capacity is rounded up to whole lanes and every array is aligned
+static void test_brick_field_init(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    assert_non_null(p_dstack);
+
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 13, &field);
+    assert_int_equal(err.code, 0);
+
+    assert_int_equal(field.capacity % BRICK_FIELD_LANES, 0);
+    assert_true(field.capacity >= 13);
+    assert_int_equal(field.count, 0);
+    assert_int_equal(field.alive_count, 0);
+
+    assert_int_equal((uintptr_t)field.p_x % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_y % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_half_w % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_half_h % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_hp % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_type % BRICK_FIELD_ALIGNMENT, 0);
+    assert_int_equal((uintptr_t)field.p_alive % BRICK_FIELD_ALIGNMENT, 0);
+
+    // Too large to round up to whole lanes
+    brick_field_t huge;
+    err = brick_field_init(p_dstack, UINT32_MAX, &huge);
+    assert_int_equal(err.code, ERR_UNSUPPORTED);
+    error_deinit(&err);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+    assert_null(field.p_block);
+}
+
+// Adding fills the arrays and the alive mask until the field is full
+static void test_brick_field_add(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 70, &field);
+    assert_int_equal(err.code, 0);
+
+    uint32_t index = 0;
+    for(uint32_t i = 0; i < field.capacity; ++i) {
+        err = brick_field_add(&field, (float)i, 2.0f, 1.0f, 0.5f, 0, 3, &index);
+        assert_int_equal(err.code, 0);
+        assert_int_equal(index, i);
+        assert_true(brick_field_is_alive(&field, i));
+    }
+
+    assert_int_equal(field.alive_count, field.capacity);
+    assert_false(field.p_x[65] < 65.0f || field.p_x[65] > 65.0f);
+    assert_false(field.p_half_w[65] < 0.5f || field.p_half_w[65] > 0.5f);
+    assert_false(field.p_half_h[65] < 0.25f || field.p_half_h[65] > 0.25f);
+    assert_int_equal(field.p_hp[65], 1);
+    assert_int_equal(field.p_type[65], 3);
+
+    err = brick_field_add(&field, 0.0f, 0.0f, 1.0f, 1.0f, 1, 0, NULL);
+    assert_int_equal(err.code, ERR_BRICK_FIELD_FULL);
+    error_deinit(&err);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// A brick dies once its hit points run out and only then leaves the alive mask
+static void test_brick_field_hit(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 100, &field);
+    assert_int_equal(err.code, 0);
+
+    err = brick_field_fill_grid(&field, 10, 10, 0.0f, 0.0f, 1.0f, 0.5f, 0.1f);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(field.count, 100);
+    assert_int_equal(field.alive_count, 100);
+
+    // The top row has 3 hit points, the bottom row 1
+    uint32_t top = 99;
+    assert_int_equal(field.p_hp[top], 3);
+    assert_int_equal(field.p_hp[0], 1);
+
+    assert_false(brick_field_hit(&field, top));
+    assert_false(brick_field_hit(&field, top));
+    assert_true(brick_field_hit(&field, top));
+    assert_false(brick_field_is_alive(&field, top));
+    assert_false(brick_field_hit(&field, top));
+    assert_int_equal(field.alive_count, 99);
+
+    assert_true(brick_field_hit(&field, 0));
+    assert_false(brick_field_is_alive(&field, 0));
+    assert_true(brick_field_is_alive(&field, 1));
+    assert_int_equal(field.alive_count, 98);
+
+    // Refilling brings everything back
+    err = brick_field_fill_grid(&field, 10, 10, 0.0f, 0.0f, 1.0f, 0.5f, 0.1f);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(field.alive_count, 100);
+    assert_true(brick_field_is_alive(&field, 0));
+
+    err = brick_field_fill_grid(&field, 11, 10, 0.0f, 0.0f, 1.0f, 0.5f, 0.1f);
+    assert_int_equal(err.code, ERR_BRICK_FIELD_FULL);
+    error_deinit(&err);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+const struct CMUnitTest brick_field_tests[] = {
+    cmocka_unit_test(test_brick_field_init),
+    cmocka_unit_test(test_brick_field_add),
+    cmocka_unit_test(test_brick_field_hit),
+};
+
+const size_t brick_field_tests_count = sizeof(brick_field_tests) / sizeof(brick_field_tests[0]);
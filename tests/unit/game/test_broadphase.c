@@ -0,0 +1,109 @@
+/*
+  test_broadphase.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "util/deletion_stack.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+
+#define MAX_CANDIDATES 256
+
+static float randf(float min, float max)
+{
+    return min + (float)rand() / (float)RAND_MAX * (max - min);
+}
+
+// Check that a candidate list has no duplicates and holds every brick whose box overlaps the query box
+static void check_brick_candidates(const brick_field_t* p_field, const uint32_t* p_candidates, uint32_t count,
+    float min_x, float min_y, float max_x, float max_y)
+{
+    for(uint32_t a = 0; a < count; ++a) {
+        for(uint32_t b = a + 1; b < count; ++b)
+            assert_int_not_equal(p_candidates[a], p_candidates[b]);
+    }
+
+    for(uint32_t i = 0; i < p_field->count; ++i) {
+        if(!brick_field_is_alive(p_field, i))
+            continue;
+
+        bool overlaps = p_field->p_x[i] - p_field->p_half_w[i] <= max_x &&
+            p_field->p_x[i] + p_field->p_half_w[i] >= min_x && p_field->p_y[i] - p_field->p_half_h[i] <= max_y &&
+            p_field->p_y[i] + p_field->p_half_h[i] >= min_y;
+        if(!overlaps)
+            continue;
+
+        bool found = false;
+        for(uint32_t k = 0; k < count && !found; ++k)
+            found = p_candidates[k] == i;
+        assert_true(found);
+    }
+}
+
+// Brick queries find every overlapping brick exactly once, also after bricks are removed
+static void test_broadphase_bricks(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 400, &field);
+    assert_int_equal(err.code, 0);
+
+    err = brick_field_fill_grid(&field, 20, 20, 0.0f, 0.0f, 1.0f, 0.4f, 0.1f);
+    assert_int_equal(err.code, 0);
+
+    // Cells smaller than the bricks, so bricks cover several cells
+    broadphase_t bp;
+    err = broadphase_init(p_dstack, -1.0f, -1.0f, 23.0f, 11.0f, 0.7f, 0.3f, &bp);
+    assert_int_equal(err.code, 0);
+
+    err = broadphase_build_bricks(&bp, &field);
+    assert_int_equal(err.code, 0);
+
+    srand(99);
+    uint32_t p_candidates[MAX_CANDIDATES];
+    for(int round = 0; round < 2; ++round) {
+        for(int i = 0; i < 2000; ++i) {
+            float x = randf(-2.0f, 24.0f);
+            float y = randf(-2.0f, 12.0f);
+            float radius = randf(0.05f, 1.0f);
+
+            cell_range_t range = broadphase_cell_range(&bp, x - radius, y - radius, x + radius, y + radius);
+            uint32_t count = broadphase_query_bricks(&bp, &field, range, p_candidates, MAX_CANDIDATES);
+            assert_true(count < MAX_CANDIDATES);
+            check_brick_candidates(&field, p_candidates, count, x - radius, y - radius, x + radius, y + radius);
+        }
+
+        // Destroy a third of the bricks and go again
+        for(uint32_t i = 0; i < field.count; i += 3) {
+            while(brick_field_is_alive(&field, i)) {
+                if(brick_field_hit(&field, i))
+                    broadphase_remove_brick(&bp, &field, i);
+            }
+        }
+    }
+
+    // Removed bricks are gone from the cells
+    cell_range_t all = broadphase_cell_range(&bp, -1.0f, -1.0f, 23.0f, 11.0f);
+    uint32_t p_all[512];
+    uint32_t count = broadphase_query_bricks(&bp, &field, all, p_all, 512);
+    assert_int_equal(count, field.alive_count);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+const struct CMUnitTest broadphase_tests[] = {
+    cmocka_unit_test(test_broadphase_bricks),
+};
+
+const size_t broadphase_tests_count = sizeof(broadphase_tests) / sizeof(broadphase_tests[0]);
@@ -0,0 +1,356 @@
+/*
+  test_collide.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/collide.h"
+#include "game/sim.h"
+
+static float randf(float min, float max)
+{
+    return min + (float)rand() / (float)RAND_MAX * (max - min);
+}
+
+// Every implementation finds the brick a ball reaches first, not the one it is closest to
+static void test_collide_sweep_first(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 16, &field);
+    assert_int_equal(err.code, 0);
+
+    // A row of bricks with gaps as wide as a brick
+    for(int i = 0; i < 10; ++i) {
+        err = brick_field_add(&field, (float)i * 2.0f, 0.0f, 1.0f, 1.0f, 1, 0, NULL);
+        assert_int_equal(err.code, 0);
+    }
+
+    for(int impl = 0; impl < COLLIDE_IMPL_COUNT; ++impl) {
+        if(!collide_impl_supported((collide_impl_t)impl))
+            continue;
+
+        brick_hit_t hit;
+
+        // Up into the bottom face of brick 3
+        assert_true(collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, 6.0f, -1.5f, 0.0f, 2.0f, 0.5f,
+            &hit));
+        assert_int_equal(hit.index, 3);
+        assert_true(fabsf(hit.t - 0.25f) <= 1e-6f);
+        assert_true(fabsf(hit.nx) <= 1e-6f);
+        assert_true(fabsf(hit.ny + 1.0f) <= 1e-6f);
+
+        // Inside brick 0 but moving out of it, into the side of brick 1
+        assert_true(collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, 0.25f, -0.25f, 3.0f, 0.0f,
+            0.5f, &hit));
+        assert_int_equal(hit.index, 1);
+        assert_true(fabsf(hit.t - 0.25f) <= 1e-6f);
+        assert_true(fabsf(hit.nx + 1.0f) <= 1e-6f);
+
+        // Resting against brick 0 and pushing into it
+        assert_true(collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, 0.0f, -0.75f, 0.0f, 1.0f, 0.5f,
+            &hit));
+        assert_int_equal(hit.index, 0);
+        assert_false(hit.t < 0.0f || hit.t > 0.0f);
+
+        // Under the row and parallel to it
+        assert_false(collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, -2.0f, -1.5f, 20.0f, 0.0f,
+            0.5f, &hit));
+
+        // Not moving
+        assert_false(collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, 0.0f, -0.75f, 0.0f, 0.0f,
+            0.5f, &hit));
+    }
+
+    // Dead bricks are never hit
+    assert_true(brick_field_hit(&field, 3));
+    brick_hit_t hit;
+    assert_false(collide_sweep_ball_bricks(&field, NULL, 6.0f, -1.5f, 0.0f, 2.0f, 0.5f, &hit));
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// The vector kernels return exactly what the scalar kernel returns, for random sweeps over a field with holes
+static void test_collide_impls_match(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 1003, &field);
+    assert_int_equal(err.code, 0);
+
+    err = brick_field_fill_grid(&field, 40, 25, 0.0f, 0.0f, 1.0f, 0.4f, 0.1f);
+    assert_int_equal(err.code, 0);
+
+    srand(1234);
+    for(int i = 0; i < 300; ++i)
+        brick_field_hit(&field, (uint32_t)rand() % field.count);
+
+    for(int i = 0; i < 20000; ++i) {
+        float x = randf(-2.0f, 44.0f);
+        float y = randf(-1.0f, 13.0f);
+        float radius = randf(0.05f, 0.65f);
+
+        // Every fourth sweep is straight along an axis, to cover the slabs a ball does not move across
+        float dx = i % 4 == 1 ? 0.0f : randf(-3.0f, 3.0f);
+        float dy = i % 4 == 2 ? 0.0f : randf(-3.0f, 3.0f);
+
+        brick_hit_t expected;
+        bool expected_hit =
+            collide_sweep_ball_bricks_impl(COLLIDE_IMPL_SCALAR, &field, NULL, x, y, dx, dy, radius, &expected);
+
+        for(int impl = 1; impl < COLLIDE_IMPL_COUNT; ++impl) {
+            if(!collide_impl_supported((collide_impl_t)impl))
+                continue;
+
+            brick_hit_t hit;
+            bool got_hit = collide_sweep_ball_bricks_impl((collide_impl_t)impl, &field, NULL, x, y, dx, dy, radius,
+                &hit);
+            assert_int_equal(got_hit, expected_hit);
+
+            if(expected_hit) {
+                assert_int_equal(hit.index, expected.index);
+                assert_false(hit.t < expected.t || hit.t > expected.t);
+                assert_false(hit.nx < expected.nx || hit.nx > expected.nx);
+                assert_false(hit.ny < expected.ny || hit.ny > expected.ny);
+            }
+        }
+    }
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// Sweeps against a single box, through a face, onto a rounded corner, past a corner and out of an overlap
+static void test_collide_sweep_box(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    float t = 0.0f;
+    float nx = 0.0f;
+    float ny = 0.0f;
+
+    // Straight into the left face
+    assert_true(collide_sweep_ball_box(-2.0f, 0.5f, 4.0f, 0.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+    assert_true(fabsf(t - 0.375f) <= 1e-6f);
+    assert_true(fabsf(nx + 1.0f) <= 1e-6f);
+    assert_true(fabsf(ny) <= 1e-6f);
+
+    // Diagonally onto the bottom left corner
+    assert_true(collide_sweep_ball_box(-2.0f, -2.0f, 4.0f, 4.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+    assert_true(fabsf(t - (2.0f * sqrtf(2.0f) - 0.5f) / (4.0f * sqrtf(2.0f))) <= 1e-5f);
+    assert_true(fabsf(nx + sqrtf(0.5f)) <= 1e-5f);
+    assert_true(fabsf(ny + sqrtf(0.5f)) <= 1e-5f);
+
+    // Passes over the box
+    assert_false(collide_sweep_ball_box(-2.0f, 2.0f, 4.0f, 0.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+
+    // Cuts through the square corner of the grown box but misses the rounded corner
+    assert_false(collide_sweep_ball_box(-1.5f, 0.3f, 2.0f, 2.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+
+    // Stops short of the box
+    assert_false(collide_sweep_ball_box(-2.0f, 0.5f, 1.0f, 0.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+
+    // Overlapping the top face, only a ball moving further in hits
+    assert_false(collide_sweep_ball_box(1.0f, 1.2f, 0.0f, 1.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+    assert_true(collide_sweep_ball_box(1.0f, 1.2f, 0.0f, -1.0f, 0.5f, 0.0f, 0.0f, 2.0f, 1.0f, &t, &nx, &ny));
+    assert_false(t < 0.0f || t > 0.0f);
+    assert_true(fabsf(nx) <= 1e-6f);
+    assert_true(fabsf(ny - 1.0f) <= 1e-6f);
+}
+
+// Sweeps culled by the broadphase find the same brick at the same time as sweeps over every brick
+static void test_collide_sweep_broadphase(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 400, &field);
+    assert_int_equal(err.code, 0);
+
+    err = brick_field_fill_grid(&field, 20, 20, 0.0f, 0.0f, 1.0f, 0.4f, 0.1f);
+    assert_int_equal(err.code, 0);
+
+    srand(4321);
+    for(int i = 0; i < 100; ++i)
+        brick_field_hit(&field, (uint32_t)rand() % field.count);
+
+    broadphase_t bp;
+    err = broadphase_init(p_dstack, 0.0f, 0.0f, 22.0f, 10.0f, 1.1f, 0.5f, &bp);
+    assert_int_equal(err.code, 0);
+
+    err = broadphase_build_bricks(&bp, &field);
+    assert_int_equal(err.code, 0);
+
+    for(int i = 0; i < 5000; ++i) {
+        float x = randf(-2.0f, 24.0f);
+        float y = randf(-2.0f, 12.0f);
+        float dx = randf(-6.0f, 6.0f);
+        float dy = randf(-6.0f, 6.0f);
+        float radius = randf(0.05f, 0.5f);
+
+        brick_hit_t expected;
+        brick_hit_t hit;
+        bool expected_hit = collide_sweep_ball_bricks(&field, NULL, x, y, dx, dy, radius, &expected);
+        assert_int_equal(collide_sweep_ball_bricks(&field, &bp, x, y, dx, dy, radius, &hit), expected_hit);
+
+        if(expected_hit) {
+            assert_int_equal(hit.index, expected.index);
+            assert_false(hit.t < expected.t || hit.t > expected.t);
+            assert_true(hit.t >= 0.0f && hit.t <= 1.0f);
+        }
+    }
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// A ball moving several times the brick thickness per tick still hits a thin brick and never leaves the field
+static void test_collide_fast_ball(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    brick_field_t field;
+    error_t err = brick_field_init(p_dstack, 1, &field);
+    assert_int_equal(err.code, 0);
+
+    err = brick_field_add(&field, SIM_FIELD_WIDTH * 0.5f, 6.0f, 4.0f, 0.1f, 1, 0, NULL);
+    assert_int_equal(err.code, 0);
+
+    broadphase_t bp;
+    err = broadphase_init(p_dstack, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT, 1.0f, 0.5f, &bp);
+    assert_int_equal(err.code, 0);
+
+    err = broadphase_build_bricks(&bp, &field);
+    assert_int_equal(err.code, 0);
+
+    static sim_world_t world;
+    world.p_bricks = &field;
+    world.p_broadphase = &bp;
+    world.p_jobs = NULL;
+
+    sim_input_t input = {0};
+    float dt = 1.0f / 120.0f;
+
+    // Straight up at 1.6 units per tick, the brick and the ball together are 0.35 thick
+    static sim_state_t sim;
+    sim_init(&sim, 1);
+    assert_true(sim_add_ball(&sim, SIM_FIELD_WIDTH * 0.5f, 2.0f, 0.0f, 192.0f));
+    assert_int_equal(sim.balls_count, 1);
+
+    for(int i = 0; i < 3; ++i) {
+        sim_tick(&sim, &world, &input, dt);
+        assert_true(sim.p_balls[0].y < 6.0f);
+    }
+    assert_int_equal(field.alive_count, 0);
+    assert_true(sim.p_balls[0].vy < 0.0f);
+
+    // Without bricks, bouncing off the walls and the ceiling several times a tick
+    sim_init(&sim, 1);
+    assert_true(sim_add_ball(&sim, SIM_FIELD_WIDTH * 0.5f, 4.0f, 3000.0f, 2200.0f));
+    for(int i = 0; i < 100 && sim.ball_launched; ++i) {
+        sim_tick(&sim, &world, &input, dt);
+        assert_true(sim.p_balls[0].x >= SIM_BALL_RADIUS - 1e-3f);
+        assert_true(sim.p_balls[0].x <= SIM_FIELD_WIDTH - SIM_BALL_RADIUS + 1e-3f);
+        assert_true(sim.p_balls[0].y <= SIM_FIELD_HEIGHT - SIM_BALL_RADIUS + 1e-3f);
+    }
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// Many balls moved in parallel batches end up exactly where they end up moved one by one, bricks included
+static void test_collide_balls_parallel(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, 4, &jobs);
+    assert_int_equal(err.code, 0);
+
+    // Run 0 moves the balls on the calling thread, run 1 on the job system
+    static brick_field_t p_fields[2];
+    static broadphase_t p_bps[2];
+    static sim_world_t p_worlds[2];
+    static sim_state_t p_states[2];
+
+    for(int run = 0; run < 2; ++run) {
+        err = brick_field_init(p_dstack, 14 * 8, &p_fields[run]);
+        assert_int_equal(err.code, 0);
+
+        err = brick_field_fill_grid(&p_fields[run], 14, 8, 0.75f, 4.5f, 1.0f, 0.4f, 0.1f);
+        assert_int_equal(err.code, 0);
+
+        err = broadphase_init(p_dstack, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT, 1.1f, 0.5f, &p_bps[run]);
+        assert_int_equal(err.code, 0);
+
+        err = broadphase_build_bricks(&p_bps[run], &p_fields[run]);
+        assert_int_equal(err.code, 0);
+
+        p_worlds[run].p_bricks = &p_fields[run];
+        p_worlds[run].p_broadphase = &p_bps[run];
+        p_worlds[run].p_jobs = run == 0 ? NULL : &jobs;
+
+        srand(77);
+        sim_init(&p_states[run], 1);
+        for(int i = 0; i < 700; ++i) {
+            float angle = randf(0.3f, 2.8f);
+            assert_true(sim_add_ball(&p_states[run], randf(1.0f, 15.0f), randf(1.0f, 4.0f),
+                cosf(angle) * SIM_BALL_SPEED * 2.0f, sinf(angle) * SIM_BALL_SPEED * 2.0f));
+        }
+    }
+
+    sim_input_t input = {0};
+    for(int tick = 0; tick < 300; ++tick) {
+        input.paddle_dir = (int8_t)((tick / 40) % 3 - 1);
+        for(int run = 0; run < 2; ++run)
+            sim_tick(&p_states[run], &p_worlds[run], &input, 1.0f / 120.0f);
+
+        assert_int_equal(p_states[0].balls_count, p_states[1].balls_count);
+        assert_memory_equal(p_states[0].p_balls, p_states[1].p_balls, p_states[0].balls_count * sizeof(sim_ball_t));
+    }
+
+    // Some bricks were destroyed, the same ones in both runs
+    assert_true(p_fields[0].alive_count < p_fields[0].count);
+    assert_int_equal(p_fields[0].alive_count, p_fields[1].alive_count);
+    assert_memory_equal(p_fields[0].p_hp, p_fields[1].p_hp, p_fields[0].count * sizeof(p_fields[0].p_hp[0]));
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+const struct CMUnitTest collide_tests[] = {
+    cmocka_unit_test(test_collide_sweep_first),
+    cmocka_unit_test(test_collide_impls_match),
+    cmocka_unit_test(test_collide_sweep_box),
+    cmocka_unit_test(test_collide_sweep_broadphase),
+    cmocka_unit_test(test_collide_fast_ball),
+    cmocka_unit_test(test_collide_balls_parallel),
+};
+
+const size_t collide_tests_count = sizeof(collide_tests) / sizeof(collide_tests[0]);
@@ -0,0 +1,123 @@
+/*
+  test_game_clock.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include "game/game_clock.h"
+#include "game/sim.h"
+
+#define TICK_RATE 100
+#define TICK_NS (1000000000ull / TICK_RATE)
+
+// Frame times that are not multiples of the tick carry the remainder over to the next frame
+static void test_game_clock_accumulate(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    game_clock_t clock;
+    game_clock_init(&clock, TICK_RATE, 8);
+
+    assert_int_equal(game_clock_advance(&clock, TICK_NS / 2), 0);
+    assert_true(fabsf(game_clock_alpha(&clock) - 0.5f) <= 1e-5f);
+
+    assert_int_equal(game_clock_advance(&clock, TICK_NS), 1);
+    assert_true(fabsf(game_clock_alpha(&clock) - 0.5f) <= 1e-5f);
+
+    assert_int_equal(game_clock_advance(&clock, TICK_NS / 2), 1);
+    assert_true(fabsf(game_clock_alpha(&clock)) <= 1e-5f);
+
+    assert_int_equal(clock.ticks, 2);
+    assert_true(fabsf(game_clock_dt(&clock) - 0.01f) <= 1e-6f);
+}
+
+// The same total time gives the same number of ticks whatever the frame rate is
+static void test_game_clock_rate_independent(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    game_clock_t fast;
+    game_clock_t slow;
+    game_clock_init(&fast, TICK_RATE, 8);
+    game_clock_init(&slow, TICK_RATE, 8);
+
+    // One second at 240 and at 30 frames per second
+    uint64_t fast_ticks = 0;
+    for(int i = 0; i < 240; ++i)
+        fast_ticks += game_clock_advance(&fast, 1000000000ull / 240);
+
+    uint64_t slow_ticks = 0;
+    for(int i = 0; i < 30; ++i)
+        slow_ticks += game_clock_advance(&slow, 1000000000ull / 30);
+
+    assert_true(fast_ticks >= TICK_RATE - 1 && fast_ticks <= TICK_RATE);
+    assert_true(slow_ticks >= TICK_RATE - 1 && slow_ticks <= TICK_RATE);
+}
+
+// A long stall is capped and the dropped time is not simulated later
+static void test_game_clock_spiral_cap(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    game_clock_t clock;
+    game_clock_init(&clock, TICK_RATE, 4);
+
+    assert_int_equal(game_clock_advance(&clock, 100 * TICK_NS + TICK_NS / 4), 4);
+    assert_int_equal(clock.dropped_ns, 96 * TICK_NS);
+    assert_true(fabsf(game_clock_alpha(&clock) - 0.25f) <= 1e-5f);
+
+    assert_int_equal(game_clock_advance(&clock, TICK_NS), 1);
+}
+
+// Interpolation blends between the last two ticks and does not blend across a teleport
+static void test_sim_interpolate(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    sim_state_t prev;
+    sim_init(&prev, 1);
+
+    sim_input_t input = {0};
+    input.launch = true;
+
+    sim_state_t curr = prev;
+    sim_tick(&curr, NULL, &input, 0.01f);
+    assert_true(curr.ball_launched);
+
+    // The launch tick teleports from resting to flying, so the current state is used as is
+    render_state_t out;
+    sim_interpolate(&prev, &curr, 0.5f, &out);
+    assert_true(fabsf(out.p_balls[0].y - curr.p_balls[0].y) <= 1e-6f);
+
+    prev = curr;
+    input.launch = false;
+    sim_tick(&curr, NULL, &input, 0.01f);
+
+    sim_interpolate(&prev, &curr, 0.0f, &out);
+    assert_true(fabsf(out.p_balls[0].x - prev.p_balls[0].x) <= 1e-6f);
+
+    sim_interpolate(&prev, &curr, 1.0f, &out);
+    assert_true(fabsf(out.p_balls[0].x - curr.p_balls[0].x) <= 1e-6f);
+
+    sim_interpolate(&prev, &curr, 0.5f, &out);
+    assert_true(fabsf(out.p_balls[0].y - ((prev.p_balls[0].y + curr.p_balls[0].y) * 0.5f)) <= 1e-5f);
+}
+
+const struct CMUnitTest game_clock_tests[] = {
+    cmocka_unit_test(test_game_clock_accumulate),
+    cmocka_unit_test(test_game_clock_rate_independent),
+    cmocka_unit_test(test_game_clock_spiral_cap),
+    cmocka_unit_test(test_sim_interpolate),
+};
+
+const size_t game_clock_tests_count = sizeof(game_clock_tests) / sizeof(game_clock_tests[0]);
@@ -0,0 +1,239 @@
+/*
+  test_replay.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+#include "game/brick_field.h"
+#include "game/broadphase.h"
+#include "game/replay.h"
+#include "game/sim.h"
+
+#define REPLAY_PATH "test_replay.brkr"
+#define TICKS_COUNT 6000
+
+// The input of a made up session, a new paddle direction every so often and a launch whenever the ball is resting
+static sim_input_t session_input(uint32_t tick, const sim_state_t* p_state)
+{
+    sim_input_t input = {0};
+    input.paddle_dir = (int8_t)((tick / 37 + tick / 101) % 3) - 1;
+    input.launch = !p_state->ball_launched && tick % 50 == 0;
+
+    return input;
+}
+
+// Every tick plays back the input it was recorded with, and only the changes are stored
+static void test_replay_roundtrip(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    replay_t recording;
+    error_t err = replay_init(p_dstack, 1234, 120, &recording);
+    assert_int_equal(err.code, 0);
+
+    sim_state_t resting = {0};
+    for(uint32_t tick = 0; tick < TICKS_COUNT; ++tick) {
+        sim_input_t input = session_input(tick, &resting);
+        err = replay_record(&recording, &input);
+        assert_int_equal(err.code, 0);
+    }
+    assert_int_equal(recording.ticks_count, TICKS_COUNT);
+    assert_true(recording.events_count < TICKS_COUNT / 10);
+
+    err = replay_save(&recording, REPLAY_PATH);
+    assert_int_equal(err.code, 0);
+
+    replay_t replay;
+    err = replay_load(p_dstack, REPLAY_PATH, &replay);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(replay.seed, 1234);
+    assert_int_equal(replay.tick_rate, 120);
+    assert_int_equal(replay.ticks_count, TICKS_COUNT);
+    assert_int_equal(replay.events_count, recording.events_count);
+
+    for(int pass = 0; pass < 2; ++pass) {
+        sim_input_t input;
+        for(uint32_t tick = 0; tick < TICKS_COUNT; ++tick) {
+            sim_input_t expected = session_input(tick, &resting);
+            assert_true(replay_play(&replay, &input));
+            assert_int_equal(input.paddle_dir, expected.paddle_dir);
+            assert_int_equal(input.launch, expected.launch);
+        }
+        assert_false(replay_play(&replay, &input));
+
+        replay_rewind(&replay);
+    }
+
+    remove(REPLAY_PATH);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// Files that are not replays, or are cut short, are refused
+static void test_replay_bad_file(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    replay_t replay;
+
+    error_t err = replay_load(p_dstack, "does_not_exist.brkr", &replay);
+    assert_int_equal(err.code, ERR_FOPEN);
+    error_deinit(&err);
+
+    FILE* p_file = fopen(REPLAY_PATH, "wb");
+    assert_non_null(p_file);
+    const char p_text[] = "this is not a replay file at all";
+    fwrite(p_text, 1, sizeof(p_text), p_file);
+    fclose(p_file);
+
+    err = replay_load(p_dstack, REPLAY_PATH, &replay);
+    assert_int_equal(err.code, ERR_REPLAY_FORMAT);
+    error_deinit(&err);
+
+    // A valid header promising more events than the file holds
+    replay_t recording;
+    err = replay_init(p_dstack, 1, 120, &recording);
+    assert_int_equal(err.code, 0);
+    for(int i = 0; i < 10; ++i) {
+        sim_input_t input = {0};
+        input.paddle_dir = (int8_t)(i % 2);
+        err = replay_record(&recording, &input);
+        assert_int_equal(err.code, 0);
+    }
+    err = replay_save(&recording, REPLAY_PATH);
+    assert_int_equal(err.code, 0);
+
+    uint8_t p_bytes[256];
+    p_file = fopen(REPLAY_PATH, "rb");
+    assert_non_null(p_file);
+    size_t size = fread(p_bytes, 1, sizeof(p_bytes), p_file);
+    fclose(p_file);
+    assert_true(size > 3);
+
+    p_file = fopen(REPLAY_PATH, "wb");
+    assert_non_null(p_file);
+    assert_int_equal(fwrite(p_bytes, 1, size - 3, p_file), size - 3);
+    fclose(p_file);
+
+    err = replay_load(p_dstack, REPLAY_PATH, &replay);
+    assert_int_equal(err.code, ERR_FREAD);
+    error_deinit(&err);
+
+    remove(REPLAY_PATH);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// A session replayed from its recording ends in exactly the state it ended in, even with the balls moved in parallel
+static void test_replay_deterministic(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, 4, &jobs);
+    assert_int_equal(err.code, 0);
+
+    // Run 0 is played and recorded on the calling thread, run 1 plays the recording back on the job system
+    static brick_field_t p_fields[2];
+    static broadphase_t p_bps[2];
+    static sim_world_t p_worlds[2];
+    static sim_state_t p_states[2];
+
+    replay_t replay;
+    err = replay_init(p_dstack, 99, 120, &replay);
+    assert_int_equal(err.code, 0);
+
+    for(int run = 0; run < 2; ++run) {
+        err = brick_field_init(p_dstack, 14 * 8, &p_fields[run]);
+        assert_int_equal(err.code, 0);
+
+        err = brick_field_fill_grid(&p_fields[run], 14, 8, 0.75f, 4.5f, 1.0f, 0.4f, 0.1f);
+        assert_int_equal(err.code, 0);
+
+        err = broadphase_init(p_dstack, 0.0f, 0.0f, SIM_FIELD_WIDTH, SIM_FIELD_HEIGHT, 1.1f, 0.5f, &p_bps[run]);
+        assert_int_equal(err.code, 0);
+
+        err = broadphase_build_bricks(&p_bps[run], &p_fields[run]);
+        assert_int_equal(err.code, 0);
+
+        p_worlds[run].p_bricks = &p_fields[run];
+        p_worlds[run].p_broadphase = &p_bps[run];
+        p_worlds[run].p_jobs = run == 0 ? NULL : &jobs;
+
+        sim_init(&p_states[run], replay.seed);
+    }
+
+    uint32_t launches = 0;
+    for(uint32_t tick = 0; tick < TICKS_COUNT; ++tick) {
+        sim_input_t input = session_input(tick, &p_states[0]);
+        launches += input.launch ? 1u : 0u;
+
+        err = replay_record(&replay, &input);
+        assert_int_equal(err.code, 0);
+        sim_tick(&p_states[0], &p_worlds[0], &input, 1.0f / 120.0f);
+    }
+    assert_true(launches > 1);
+
+    sim_input_t input;
+    while(replay_play(&replay, &input))
+        sim_tick(&p_states[1], &p_worlds[1], &input, 1.0f / 120.0f);
+
+    assert_int_equal(p_states[0].tick, p_states[1].tick);
+    assert_int_equal(p_states[0].rng, p_states[1].rng);
+    assert_int_equal(p_states[0].balls_count, p_states[1].balls_count);
+    assert_memory_equal(p_states[0].p_balls, p_states[1].p_balls, p_states[0].balls_count * sizeof(sim_ball_t));
+    assert_true(p_fields[0].alive_count < p_fields[0].count);
+    assert_memory_equal(p_fields[0].p_hp, p_fields[1].p_hp, p_fields[0].count * sizeof(p_fields[0].p_hp[0]));
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// The launch direction comes from the seed
+static void test_replay_seed(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    sim_input_t input = {0};
+    input.launch = true;
+
+    sim_state_t p_states[3];
+    const uint32_t p_seeds[3] = {7, 7, 8};
+    for(int i = 0; i < 3; ++i) {
+        sim_init(&p_states[i], p_seeds[i]);
+        sim_tick(&p_states[i], NULL, &input, 1.0f / 120.0f);
+        assert_true(p_states[i].ball_launched);
+        assert_true(p_states[i].p_balls[0].vy > 0.0f);
+    }
+
+    assert_memory_equal(&p_states[0].p_balls[0], &p_states[1].p_balls[0], sizeof(sim_ball_t));
+    assert_memory_not_equal(&p_states[0].p_balls[0], &p_states[2].p_balls[0], sizeof(sim_ball_t));
+}
+
+const struct CMUnitTest replay_tests[] = {
+    cmocka_unit_test(test_replay_roundtrip),
+    cmocka_unit_test(test_replay_bad_file),
+    cmocka_unit_test(test_replay_deterministic),
+    cmocka_unit_test(test_replay_seed),
+};
+
+const size_t replay_tests_count = sizeof(replay_tests) / sizeof(replay_tests[0]);
@@ -0,0 +1,112 @@
+/*
+  test_sim_thread.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "util/deletion_stack.h"
+#include "game/sim.h"
+#include "game/sim_thread.h"
+
+#define FRAMES_COUNT 20000
+#define STAMPED_BALLS 256
+
+typedef struct stamper_s {
+    uint64_t frames_count;
+    uint64_t last_now_ns;
+    bool out_of_order;
+    uint32_t launches;
+} stamper_t;
+
+// Stamps every field of the snapshot with the frame, so a snapshot read while it is written shows mixed stamps
+static void stamp_frame(void* p_void_stamper, const sim_frame_t* p_frame, render_state_t* p_out)
+{
+    stamper_t* p_stamper = (stamper_t*)p_void_stamper;
+
+    if(p_frame->now_ns != p_stamper->last_now_ns + 1)
+        p_stamper->out_of_order = true;
+    p_stamper->last_now_ns = p_frame->now_ns;
+    ++p_stamper->frames_count;
+
+    if(p_frame->input.launch)
+        ++p_stamper->launches;
+
+    float stamp = (float)p_frame->now_ns;
+    p_out->paddle_x = stamp;
+    p_out->balls_count = STAMPED_BALLS;
+    for(uint32_t i = 0; i < STAMPED_BALLS; ++i) {
+        p_out->p_balls[i].x = stamp;
+        p_out->p_balls[i].y = stamp;
+    }
+}
+
+// Every posted frame is simulated once and in order, and the snapshots acquired are whole and never go back in time
+static void test_sim_thread_pipeline(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    static render_state_t initial;
+    memset(&initial, 0, sizeof(initial));
+
+    static sim_thread_t sim;
+    stamper_t stamper = {0};
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    error_t err = sim_thread_init(p_dstack, stamp_frame, &stamper, &initial, &sim);
+    assert_int_equal(err.code, 0);
+
+    // Nothing simulated yet
+    const render_state_t* p_snapshot = sim_thread_acquire(&sim);
+    assert_non_null(p_snapshot);
+    assert_int_equal(p_snapshot->balls_count, 0);
+
+    uint64_t posted = 0;
+    uint32_t launches = 0;
+    float last_stamp = 0.0f;
+    while(posted < FRAMES_COUNT) {
+        sim_frame_t frame = {0};
+        frame.now_ns = posted + 1;
+        frame.input.launch = posted % 7 == 0;
+        if(sim_thread_post(&sim, &frame)) {
+            ++posted;
+            launches += frame.input.launch ? 1u : 0u;
+        }
+
+        p_snapshot = sim_thread_acquire(&sim);
+        if(p_snapshot->balls_count == 0)
+            continue;
+
+        assert_int_equal(p_snapshot->balls_count, STAMPED_BALLS);
+        float stamp = p_snapshot->paddle_x;
+        assert_false(stamp < last_stamp);
+        for(uint32_t i = 0; i < STAMPED_BALLS; ++i) {
+            assert_false(p_snapshot->p_balls[i].x < stamp || p_snapshot->p_balls[i].x > stamp);
+            assert_false(p_snapshot->p_balls[i].y < stamp || p_snapshot->p_balls[i].y > stamp);
+        }
+        last_stamp = stamp;
+    }
+
+    // Stopping the thread drops queued frames, so wait for the last one to be published
+    while(!(sim_thread_acquire(&sim)->paddle_x > (float)(FRAMES_COUNT - 1)))
+        ;
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+
+    assert_false(stamper.out_of_order);
+    assert_int_equal(stamper.frames_count, FRAMES_COUNT);
+    assert_int_equal(stamper.launches, launches);
+}
+
+const struct CMUnitTest sim_thread_tests[] = {
+    cmocka_unit_test(test_sim_thread_pipeline),
+};
+
+const size_t sim_thread_tests_count = sizeof(sim_thread_tests) / sizeof(sim_thread_tests[0]);
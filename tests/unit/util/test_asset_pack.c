@@ -0,0 +1,255 @@
+/*
+  test_asset_pack.c
+*/
+
+// utime is POSIX, the tests only build on UNIX
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <time.h>
+#include <utime.h>
+#include <cmocka.h>
+
+#include "error/error.h"
+#include "util/asset_pack.h"
+
+static const char shader_code[] = "\x03\x02\x23\x07 spirv";
+static const char texture_data[] = "not really a png";
+static const char font_data[] = "glyphs";
+
+static const asset_pack_source_t sources[] = {
+    {"src/shaders/sprite.vert.spv", shader_code, sizeof(shader_code)},
+    {"assets/icon.png", texture_data, sizeof(texture_data)},
+    {"assets/font.ttf", font_data, sizeof(font_data)},
+    {"assets/empty.bin", NULL, 0},
+};
+
+#define SOURCES_COUNT ((uint32_t)(sizeof(sources) / sizeof(sources[0])))
+
+// Every asset comes back byte for byte, aligned, and straight out of the pack memory
+static void test_asset_pack_find(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint8_t* p_data = NULL;
+    size_t size = 0;
+    error_t err = asset_pack_build(sources, SOURCES_COUNT, &p_data, &size);
+    assert_int_equal(err.code, 0);
+
+    asset_pack_t pack;
+    err = asset_pack_init(p_data, size, &pack);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(pack.entries_count, SOURCES_COUNT);
+
+    for(uint32_t i = 0; i < SOURCES_COUNT; ++i) {
+        size_t asset_size = 1;
+        const uint8_t* p_asset = (const uint8_t*)asset_pack_find(&pack, sources[i].p_name, &asset_size);
+        assert_non_null(p_asset);
+        assert_int_equal(asset_size, sources[i].size);
+        assert_true(p_asset >= p_data && p_asset + asset_size <= p_data + size);
+        assert_int_equal((size_t)(p_asset - p_data) % ASSET_PACK_ALIGNMENT, 0);
+        if(asset_size > 0)
+            assert_memory_equal(p_asset, sources[i].p_data, asset_size);
+    }
+
+    // The paths the loose files are opened with from the build directory find the same assets
+    assert_true(asset_pack_find(&pack, "../src/shaders/sprite.vert.spv", NULL) ==
+        asset_pack_find(&pack, "src/shaders/sprite.vert.spv", NULL));
+    assert_true(asset_pack_find(&pack, "./assets/icon.png", NULL) == asset_pack_find(&pack, "assets/icon.png", NULL));
+
+    assert_null(asset_pack_find(&pack, "assets/missing.png", NULL));
+    assert_null(asset_pack_find(&pack, "assets/icon.pn", NULL));
+    assert_null(asset_pack_find(&pack, "", NULL));
+
+    // Not mapped, so closing leaves the memory alone
+    asset_pack_close(&pack);
+    assert_int_equal(pack.entries_count, SOURCES_COUNT);
+
+    free(p_data);
+}
+
+// The same sources give the same bytes, whatever order they come in
+static void test_asset_pack_build_stable(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    asset_pack_source_t reversed[SOURCES_COUNT];
+    for(uint32_t i = 0; i < SOURCES_COUNT; ++i)
+        reversed[i] = sources[SOURCES_COUNT - 1 - i];
+
+    uint8_t* p_data_a = NULL;
+    uint8_t* p_data_b = NULL;
+    size_t size_a = 0;
+    size_t size_b = 0;
+    error_t err = asset_pack_build(sources, SOURCES_COUNT, &p_data_a, &size_a);
+    assert_int_equal(err.code, 0);
+    err = asset_pack_build(reversed, SOURCES_COUNT, &p_data_b, &size_b);
+    assert_int_equal(err.code, 0);
+
+    assert_int_equal(size_a, size_b);
+    assert_memory_equal(p_data_a, p_data_b, size_a);
+
+    free(p_data_a);
+    free(p_data_b);
+
+    // A name twice is an error rather than an asset that can never be found
+    asset_pack_source_t twice[2] = {sources[0], sources[0]};
+    uint8_t* p_data = NULL;
+    size_t size = 0;
+    err = asset_pack_build(twice, 2, &p_data, &size);
+    assert_int_not_equal(err.code, 0);
+    assert_null(p_data);
+    error_deinit(&err);
+
+    // An empty pack is only a header
+    err = asset_pack_build(NULL, 0, &p_data, &size);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(size, sizeof(asset_pack_header_t));
+
+    asset_pack_t pack;
+    err = asset_pack_init(p_data, size, &pack);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(pack.entries_count, 0);
+    assert_null(asset_pack_find(&pack, "assets/icon.png", NULL));
+
+    free(p_data);
+}
+
+// A damaged pack is rejected up front instead of read out of bounds by a lookup
+static void test_asset_pack_damaged(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint8_t* p_data = NULL;
+    size_t size = 0;
+    error_t err = asset_pack_build(sources, SOURCES_COUNT, &p_data, &size);
+    assert_int_equal(err.code, 0);
+
+    asset_pack_t pack;
+
+    // Truncated
+    err = asset_pack_init(p_data, size - 1, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+    err = asset_pack_init(p_data, sizeof(asset_pack_header_t) - 1, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+
+    // Not a pack
+    p_data[0] ^= 0xFF;
+    err = asset_pack_init(p_data, size, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+    p_data[0] ^= 0xFF;
+
+    // An entry pointing past the end of the pack
+    asset_pack_entry_t entry;
+    uint8_t* p_entry = p_data + sizeof(asset_pack_header_t);
+    memcpy(&entry, p_entry, sizeof(entry));
+    uint64_t offset = entry.offset;
+    entry.offset = (uint64_t)size;
+    entry.size = 1;
+    memcpy(p_entry, &entry, sizeof(entry));
+    err = asset_pack_init(p_data, size, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+
+    // A blob that is not aligned
+    entry.offset = offset + 1;
+    entry.size = 0;
+    memcpy(p_entry, &entry, sizeof(entry));
+    err = asset_pack_init(p_data, size, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+
+    err = asset_pack_init(NULL, size, &pack);
+    assert_int_not_equal(err.code, 0);
+    error_deinit(&err);
+
+    free(p_data);
+}
+
+#define TEST_PACK_PATH "test_asset_pack.pack"
+#define TEST_LOOSE_PATH "test_asset_pack_loose.bin"
+
+static void write_file(const char* p_path, const void* p_data, size_t size)
+{
+    FILE* p_file = fopen(p_path, "wb");
+    assert_non_null(p_file);
+    assert_int_equal(fwrite(p_data, 1, size, p_file), size);
+    assert_int_equal(fclose(p_file), 0);
+}
+
+static void set_mtime(const char* p_path, time_t mtime)
+{
+    struct utimbuf times = {mtime, mtime};
+    assert_int_equal(utime(p_path, &times), 0);
+}
+
+// A mounted pack is read straight from the mapping, except in debug builds where a newer loose file wins
+static void test_asset_pack_mount(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    assert_false(asset_pack_mount("test_asset_pack_missing.pack"));
+    assert_null(asset_pack_mounted());
+    assert_null(asset_pack_find_mounted(TEST_LOOSE_PATH, NULL));
+
+    const asset_pack_source_t source = {TEST_LOOSE_PATH, shader_code, sizeof(shader_code)};
+    uint8_t* p_data = NULL;
+    size_t size = 0;
+    error_t err = asset_pack_build(&source, 1, &p_data, &size);
+    assert_int_equal(err.code, 0);
+    write_file(TEST_PACK_PATH, p_data, size);
+    free(p_data);
+
+    // The loose file is older than the pack, so the packed copy is used
+    time_t now = time(NULL);
+    write_file(TEST_LOOSE_PATH, font_data, sizeof(font_data));
+    set_mtime(TEST_LOOSE_PATH, now - 100);
+    set_mtime(TEST_PACK_PATH, now);
+
+    assert_true(asset_pack_mount(TEST_PACK_PATH));
+    assert_non_null(asset_pack_mounted());
+
+    size_t asset_size = 0;
+    const void* p_asset = asset_pack_find_mounted("./" TEST_LOOSE_PATH, &asset_size);
+    assert_non_null(p_asset);
+    assert_int_equal(asset_size, sizeof(shader_code));
+    assert_memory_equal(p_asset, shader_code, sizeof(shader_code));
+
+    // Changed after the pack was built
+    set_mtime(TEST_LOOSE_PATH, now + 100);
+#ifndef NDEBUG
+    assert_null(asset_pack_find_mounted(TEST_LOOSE_PATH, NULL));
+#else
+    assert_non_null(asset_pack_find_mounted(TEST_LOOSE_PATH, NULL));
+#endif
+
+    asset_pack_unmount();
+    assert_null(asset_pack_mounted());
+    assert_null(asset_pack_find_mounted(TEST_LOOSE_PATH, NULL));
+
+    remove(TEST_LOOSE_PATH);
+    remove(TEST_PACK_PATH);
+}
+
+const struct CMUnitTest asset_pack_tests[] = {
+    cmocka_unit_test(test_asset_pack_find),
+    cmocka_unit_test(test_asset_pack_build_stable),
+    cmocka_unit_test(test_asset_pack_damaged),
+    cmocka_unit_test(test_asset_pack_mount),
+};
+
+const size_t asset_pack_tests_count = sizeof(asset_pack_tests) / sizeof(asset_pack_tests[0]);
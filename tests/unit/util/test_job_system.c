@@ -0,0 +1,255 @@
+/*
+  test_job_system.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+
+#include "util/deletion_stack.h"
+#include "util/job_system.h"
+
+#define WORKERS_COUNT 4
+#define ITEMS_COUNT 100000
+#define STAGE_JOBS 32
+
+typedef struct items_s {
+    job_system_t* p_jobs;
+    uint8_t* p_visits;
+    SDL_AtomicInt bad_worker; // Set if a job ran on a thread that is not a worker
+} items_t;
+
+static void visit_items(void* p_void_items, uint32_t begin, uint32_t end)
+{
+    items_t* p_items = (items_t*)p_void_items;
+
+    if(job_system_worker_index(p_items->p_jobs) >= p_items->p_jobs->workers_count)
+        SDL_SetAtomicInt(&p_items->bad_worker, 1);
+
+    for(uint32_t i = begin; i < end; ++i)
+        ++p_items->p_visits[i];
+}
+
+// Every item is visited exactly once, whatever the batch size
+static void test_job_system_parallel_for(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, WORKERS_COUNT, &jobs);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(job_system_worker_index(&jobs), 0);
+
+    items_t items = {0};
+    items.p_jobs = &jobs;
+    items.p_visits = (uint8_t*)calloc(ITEMS_COUNT, 1);
+    assert_non_null(items.p_visits);
+
+    const uint32_t p_batch_sizes[] = {1, 7, 64, 5000, ITEMS_COUNT};
+    for(size_t b = 0; b < sizeof(p_batch_sizes) / sizeof(p_batch_sizes[0]); ++b) {
+        memset(items.p_visits, 0, ITEMS_COUNT);
+        job_system_parallel_for(&jobs, ITEMS_COUNT, p_batch_sizes[b], visit_items, &items);
+
+        for(uint32_t i = 0; i < ITEMS_COUNT; ++i)
+            assert_int_equal(items.p_visits[i], 1);
+    }
+    assert_int_equal(SDL_GetAtomicInt(&items.bad_worker), 0);
+
+    // Without a job system everything runs on the calling thread
+    memset(items.p_visits, 0, ITEMS_COUNT);
+    job_system_parallel_for(NULL, ITEMS_COUNT, 64, visit_items, &items);
+    for(uint32_t i = 0; i < ITEMS_COUNT; ++i)
+        assert_int_equal(items.p_visits[i], 1);
+
+    free(items.p_visits);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+typedef struct stages_s {
+    job_system_t* p_jobs;
+    job_counter_t fill_counter;
+    uint32_t p_values[STAGE_JOBS];
+    uint32_t p_partial[STAGE_JOBS];
+    uint64_t sum;
+} stages_t;
+
+static void fill_value(void* p_void_stages, uint32_t begin, uint32_t end)
+{
+    // UNUSED
+    (void)end;
+
+    stages_t* p_stages = (stages_t*)p_void_stages;
+
+    // Each fill job fans out into a parallel for of its own and waits on it
+    uint8_t p_visits[256] = {0};
+    items_t items = {0};
+    items.p_jobs = p_stages->p_jobs;
+    items.p_visits = p_visits;
+    job_system_parallel_for(p_stages->p_jobs, 256, 16, visit_items, &items);
+
+    uint32_t partial = 0;
+    for(uint32_t i = 0; i < 256; ++i)
+        partial += p_visits[i];
+
+    p_stages->p_partial[begin] = partial;
+    p_stages->p_values[begin] = begin + 1;
+}
+
+static void sum_values(void* p_void_stages, uint32_t begin, uint32_t end)
+{
+    // UNUSED
+    (void)begin;
+    (void)end;
+
+    stages_t* p_stages = (stages_t*)p_void_stages;
+
+    // Depends on every fill job
+    job_system_wait(p_stages->p_jobs, &p_stages->fill_counter);
+
+    p_stages->sum = 0;
+    for(uint32_t i = 0; i < STAGE_JOBS; ++i)
+        p_stages->sum += p_stages->p_values[i] + p_stages->p_partial[i];
+}
+
+// A job waiting on a counter runs after the jobs it depends on, and jobs can wait on jobs they submitted themselves
+static void test_job_system_dependencies(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, WORKERS_COUNT, &jobs);
+    assert_int_equal(err.code, 0);
+
+    for(int round = 0; round < 50; ++round) {
+        stages_t stages;
+        memset(&stages, 0, sizeof(stages));
+        stages.p_jobs = &jobs;
+
+        job_t p_fill_jobs[STAGE_JOBS];
+        for(uint32_t i = 0; i < STAGE_JOBS; ++i) {
+            p_fill_jobs[i] = (job_t){0};
+            p_fill_jobs[i].func = fill_value;
+            p_fill_jobs[i].p_data = &stages;
+            p_fill_jobs[i].begin = i;
+            p_fill_jobs[i].end = i + 1;
+        }
+        job_system_run(&jobs, p_fill_jobs, STAGE_JOBS, &stages.fill_counter);
+
+        // Submitted last, so the owner pops it first and it has to wait for its dependencies
+        job_counter_t sum_counter = {0};
+        job_t sum_job = {0};
+        sum_job.func = sum_values;
+        sum_job.p_data = &stages;
+        job_system_run(&jobs, &sum_job, 1, &sum_counter);
+
+        job_system_wait(&jobs, &sum_counter);
+
+        // 1 + 2 + ... + STAGE_JOBS from the values and 256 visits per fill job
+        assert_int_equal(stages.sum, STAGE_JOBS * (STAGE_JOBS + 1) / 2 + STAGE_JOBS * 256);
+    }
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+typedef struct external_s {
+    items_t items;
+    uint32_t worker_index;
+} external_t;
+
+static int SDLCALL external_thread(void* p_void_external)
+{
+    external_t* p_external = (external_t*)p_void_external;
+
+    p_external->worker_index = job_system_worker_index(p_external->items.p_jobs);
+    job_system_parallel_for(p_external->items.p_jobs, ITEMS_COUNT, 100, visit_items, &p_external->items);
+
+    return 0;
+}
+
+// Threads that are not workers can submit work, and it only ever runs on the workers
+static void test_job_system_external(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, WORKERS_COUNT, &jobs);
+    assert_int_equal(err.code, 0);
+
+    external_t external = {0};
+    external.items.p_jobs = &jobs;
+    external.items.p_visits = (uint8_t*)calloc(ITEMS_COUNT, 1);
+    assert_non_null(external.items.p_visits);
+
+    SDL_Thread* p_thread = SDL_CreateThread(external_thread, "test_external", &external);
+    assert_non_null(p_thread);
+    SDL_WaitThread(p_thread, NULL);
+
+    assert_int_equal(external.worker_index, JOB_NOT_A_WORKER);
+    assert_int_equal(SDL_GetAtomicInt(&external.items.bad_worker), 0);
+    for(uint32_t i = 0; i < ITEMS_COUNT; ++i)
+        assert_int_equal(external.items.p_visits[i], 1);
+
+    free(external.items.p_visits);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+// Even on a single core there is a worker thread, so a thread that is not a worker gets its jobs run without the
+// calling thread ever waiting on the pool
+static void test_job_system_single_core(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    deletion_stack_t* p_dstack = deletion_stack_init();
+    job_system_t jobs;
+    error_t err = job_system_init(p_dstack, 1, &jobs);
+    assert_int_equal(err.code, 0);
+    assert_int_equal(jobs.workers_count, 2);
+
+    external_t external = {0};
+    external.items.p_jobs = &jobs;
+    external.items.p_visits = (uint8_t*)calloc(ITEMS_COUNT, 1);
+    assert_non_null(external.items.p_visits);
+
+    SDL_Thread* p_thread = SDL_CreateThread(external_thread, "test_external", &external);
+    assert_non_null(p_thread);
+    SDL_WaitThread(p_thread, NULL);
+
+    assert_int_equal(external.worker_index, JOB_NOT_A_WORKER);
+    assert_int_equal(SDL_GetAtomicInt(&external.items.bad_worker), 0);
+    for(uint32_t i = 0; i < ITEMS_COUNT; ++i)
+        assert_int_equal(external.items.p_visits[i], 1);
+
+    free(external.items.p_visits);
+
+    err = deletion_stack_flush(&p_dstack);
+    assert_int_equal(err.code, 0);
+}
+
+const struct CMUnitTest job_system_tests[] = {
+    cmocka_unit_test(test_job_system_parallel_for),
+    cmocka_unit_test(test_job_system_dependencies),
+    cmocka_unit_test(test_job_system_external),
+    cmocka_unit_test(test_job_system_single_core),
+};
+
+const size_t job_system_tests_count = sizeof(job_system_tests) / sizeof(job_system_tests[0]);
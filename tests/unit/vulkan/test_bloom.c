@@ -0,0 +1,68 @@
+/*
+  test_bloom.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_bloom.h"
+
+// Large images get every level, small ones stop before a level gets thinner than BLOOM_MIN_SIZE
+static void test_bloom_mips_count(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    assert_int_equal(bloom_mips_count(1920, 1080), BLOOM_MAX_MIPS);
+    assert_int_equal(bloom_mips_count(3840, 2160), BLOOM_MAX_MIPS);
+
+    // 64 >> 4 is the last level with 4 texels
+    assert_int_equal(bloom_mips_count(1920, 64), 4);
+    assert_int_equal(bloom_mips_count(64, 1920), 4);
+
+    assert_int_equal(bloom_mips_count(2 * BLOOM_MIN_SIZE, 1000), 1);
+    assert_int_equal(bloom_mips_count(2 * BLOOM_MIN_SIZE - 1, 1000), 0);
+    assert_int_equal(bloom_mips_count(0, 0), 0);
+}
+
+// Levels halve with the remainder dropped, like the mips of the image, and never reach 0
+static void test_bloom_mip_extent(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bloom_mip_extent(1920, 1080, 0, &width, &height);
+    assert_int_equal(width, 1920);
+    assert_int_equal(height, 1080);
+
+    bloom_mip_extent(1920, 1080, 3, &width, &height);
+    assert_int_equal(width, 240);
+    assert_int_equal(height, 135);
+
+    // A draw extent scaled down by the dynamic resolution is odd more often than not
+    bloom_mip_extent(1477, 831, 1, &width, &height);
+    assert_int_equal(width, 738);
+    assert_int_equal(height, 415);
+
+    bloom_mip_extent(1920, 1080, 11, &width, &height);
+    assert_int_equal(width, 1);
+    assert_int_equal(height, 1);
+
+    bloom_mip_extent(1920, 1080, 40, &width, &height);
+    assert_int_equal(width, 1);
+    assert_int_equal(height, 1);
+}
+
+const struct CMUnitTest bloom_tests[] = {
+    cmocka_unit_test(test_bloom_mips_count),
+    cmocka_unit_test(test_bloom_mip_extent),
+};
+
+const size_t bloom_tests_count = sizeof(bloom_tests) / sizeof(bloom_tests[0]);
@@ -0,0 +1,141 @@
+/*
+  test_dynres.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_dynres.h"
+
+// 60 Hz frame budget
+#define TARGET_MS (1000.0 / 60.0)
+
+// Scale starts at max and stays put while the frame time is inside the hysteresis band
+static void test_dynres_steady(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    dynres_t dynres;
+    dynres_init(&dynres, TARGET_MS, 0.5f, 1.0f);
+    assert_true(dynres.enabled);
+    assert_true(dynres.scale >= 1.0f);
+
+    for(int i = 0; i < 1000; ++i)
+        assert_false(dynres_update(&dynres, 0.85 * TARGET_MS));
+
+    assert_true(dynres.scale >= 1.0f);
+}
+
+// Going over budget lowers the scale, but never below min_scale
+static void test_dynres_lower(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    dynres_t dynres;
+    dynres_init(&dynres, TARGET_MS, 0.5f, 1.0f);
+
+    // A single slow frame is not enough
+    assert_false(dynres_update(&dynres, 2.0 * TARGET_MS));
+    assert_true(dynres.scale >= 1.0f);
+
+    bool changed = false;
+    for(int i = 0; i < 16; ++i)
+        changed |= dynres_update(&dynres, 2.0 * TARGET_MS);
+
+    assert_true(changed);
+    assert_true(dynres.scale < 1.0f);
+
+    for(int i = 0; i < 1000; ++i)
+        dynres_update(&dynres, 10.0 * TARGET_MS);
+
+    assert_true(dynres.scale >= 0.5f);
+    assert_true(dynres.scale < 0.5f + 1.0f / 64.0f);
+}
+
+// Being well under budget raises the scale back, but only after a longer run of frames
+static void test_dynres_raise(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    dynres_t dynres;
+    dynres_init(&dynres, TARGET_MS, 0.5f, 1.0f);
+
+    for(int i = 0; i < 1000; ++i)
+        dynres_update(&dynres, 10.0 * TARGET_MS);
+
+    float low_scale = dynres.scale;
+
+    for(int i = 0; i < 16; ++i)
+        assert_false(dynres_update(&dynres, 0.25 * TARGET_MS));
+
+    for(int i = 0; i < 1000; ++i)
+        dynres_update(&dynres, 0.25 * TARGET_MS);
+
+    assert_true(dynres.scale > low_scale);
+    assert_true(dynres.scale <= 1.0f);
+}
+
+// Disabling resets to max_scale and ignores samples
+static void test_dynres_disabled(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    dynres_t dynres;
+    dynres_init(&dynres, TARGET_MS, 0.5f, 1.0f);
+
+    for(int i = 0; i < 1000; ++i)
+        dynres_update(&dynres, 10.0 * TARGET_MS);
+
+    dynres_set_enabled(&dynres, false);
+    assert_false(dynres.enabled);
+    assert_true(dynres.scale >= 1.0f);
+
+    for(int i = 0; i < 1000; ++i)
+        assert_false(dynres_update(&dynres, 10.0 * TARGET_MS));
+
+    assert_true(dynres.scale >= 1.0f);
+}
+
+static void test_dynres_apply(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    dynres_t dynres;
+    dynres_init(&dynres, TARGET_MS, 0.5f, 1.0f);
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    dynres_apply(&dynres, 1920, 1080, &width, &height);
+    assert_int_equal(width, 1920);
+    assert_int_equal(height, 1080);
+
+    dynres.scale = 0.5f;
+    dynres_apply(&dynres, 1920, 1080, &width, &height);
+    assert_int_equal(width, 960);
+    assert_int_equal(height, 540);
+
+    // Never smaller than 1x1
+    dynres_apply(&dynres, 1, 1, &width, &height);
+    assert_int_equal(width, 1);
+    assert_int_equal(height, 1);
+}
+
+const struct CMUnitTest dynres_tests[] = {
+    cmocka_unit_test(test_dynres_steady),
+    cmocka_unit_test(test_dynres_lower),
+    cmocka_unit_test(test_dynres_raise),
+    cmocka_unit_test(test_dynres_disabled),
+    cmocka_unit_test(test_dynres_apply),
+};
+
+const size_t dynres_tests_count = sizeof(dynres_tests) / sizeof(dynres_tests[0]);
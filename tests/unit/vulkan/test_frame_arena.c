@@ -0,0 +1,107 @@
+/*
+  test_frame_arena.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_frame_arena.h"
+
+// Allocations are aligned to the larger of the requested and the minimum alignment and never overlap
+static void test_frame_arena_align(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint8_t p_buffer[2 * 1024];
+    frame_arena_t arena;
+    frame_arena_init(&arena, p_buffer, 1024, 64);
+
+    // Nothing can be allocated before a frame is open
+    assert_null(frame_arena_alloc(&arena, 16, 1, NULL));
+    assert_int_equal(arena.dropped, 16);
+
+    frame_arena_begin(&arena, 0);
+    assert_int_equal(arena.dropped, 0);
+
+    uint32_t offset = 1;
+    uint8_t* p_first = (uint8_t*)frame_arena_alloc(&arena, 10, 4, &offset);
+    assert_true(p_first == p_buffer);
+    assert_int_equal(offset, 0);
+
+    uint8_t* p_second = (uint8_t*)frame_arena_alloc(&arena, 10, 16, &offset);
+    assert_int_equal(offset, 64);
+    assert_true(p_second == p_buffer + 64);
+
+    frame_arena_alloc(&arena, 10, 256, &offset);
+    assert_int_equal(offset, 256);
+    assert_int_equal(arena.used, 266);
+}
+
+// Each frame in flight allocates from a slice of its own, handed out as offsets into the whole buffer
+static void test_frame_arena_frames(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint8_t p_buffer[2 * 1024];
+    frame_arena_t arena;
+    frame_arena_init(&arena, p_buffer, 1024, 64);
+
+    frame_arena_begin(&arena, 1);
+    uint32_t offset = 0;
+    uint8_t* p_alloc = (uint8_t*)frame_arena_alloc(&arena, 100, 1, &offset);
+    assert_int_equal(offset, 1024);
+    assert_true(p_alloc == p_buffer + 1024);
+
+    // Opening the frame again empties its slice
+    frame_arena_begin(&arena, 1);
+    assert_int_equal(arena.used, 0);
+    frame_arena_alloc(&arena, 100, 1, &offset);
+    assert_int_equal(offset, 1024);
+
+    frame_arena_begin(&arena, 0);
+    frame_arena_alloc(&arena, 100, 1, &offset);
+    assert_int_equal(offset, 0);
+}
+
+// An allocation that does not fit in the slice is dropped whole and the ones after it still fit if they are small enough
+static void test_frame_arena_full(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint8_t p_buffer[2 * 1024];
+    frame_arena_t arena;
+    frame_arena_init(&arena, p_buffer, 1024, 64);
+    frame_arena_begin(&arena, 0);
+
+    // The next allocation starts at 960, leaving room for exactly 64 bytes
+    assert_non_null(frame_arena_alloc(&arena, 900, 1, NULL));
+    assert_null(frame_arena_alloc(&arena, 128, 1, NULL));
+    assert_int_equal(arena.dropped, 128);
+    assert_non_null(frame_arena_alloc(&arena, 64, 1, NULL));
+    assert_null(frame_arena_alloc(&arena, 1, 1, NULL));
+    assert_int_equal(arena.dropped, 129);
+
+    // The size is rounded down so every slice starts aligned
+    frame_arena_init(&arena, p_buffer, 1000, 64);
+    assert_int_equal(arena.frame_size, 960);
+    frame_arena_begin(&arena, 1);
+    uint32_t offset = 0;
+    frame_arena_alloc(&arena, 1, 1, &offset);
+    assert_int_equal(offset, 960);
+}
+
+const struct CMUnitTest frame_arena_tests[] = {
+    cmocka_unit_test(test_frame_arena_align),
+    cmocka_unit_test(test_frame_arena_frames),
+    cmocka_unit_test(test_frame_arena_full),
+};
+
+const size_t frame_arena_tests_count = sizeof(frame_arena_tests) / sizeof(frame_arena_tests[0]);
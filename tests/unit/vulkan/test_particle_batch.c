@@ -0,0 +1,127 @@
+/*
+  test_particle_batch.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_particle_batch.h"
+
+static particle_emitter_t make_emitter(uint32_t count)
+{
+    particle_emitter_t emitter = {0};
+    emitter.pos[0] = 1.0f;
+    emitter.pos[1] = 2.0f;
+    emitter.size = 0.1f;
+    emitter.speed = 3.0f;
+    emitter.life = 1.0f;
+    emitter.count = count;
+
+    return emitter;
+}
+
+// Emitters are written in order and each gets a seed of its own
+static void test_particle_batch_emit(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    particle_emitter_t* p_buffer = (particle_emitter_t*)malloc(particle_batch_buffer_size());
+    assert_non_null(p_buffer);
+
+    particle_batch_t batch;
+    particle_batch_init(&batch);
+
+    // Nothing can be emitted before a frame is open
+    particle_emitter_t emitter = make_emitter(10);
+    assert_false(particle_batch_emit(&batch, &emitter));
+    assert_int_equal(batch.dropped, 10);
+
+    particle_batch_begin(&batch, p_buffer, 0.016f);
+    assert_int_equal(batch.dropped, 0);
+
+    for(uint32_t i = 0; i < 3; ++i) {
+        emitter = make_emitter(i + 1);
+        assert_true(particle_batch_emit(&batch, &emitter));
+        assert_int_equal(p_buffer[i].count, i + 1);
+    }
+    assert_int_equal(batch.emitters_count, 3);
+    assert_int_equal(batch.particles_count, 6);
+    assert_int_not_equal(p_buffer[0].seed, p_buffer[1].seed);
+    assert_int_not_equal(p_buffer[1].seed, p_buffer[2].seed);
+
+    // The seeds keep going across frames, so the next burst does not repeat the first one
+    particle_batch_begin(&batch, p_buffer, 0.016f);
+    assert_int_equal(batch.emitters_count, 0);
+    assert_int_equal(batch.particles_count, 0);
+    emitter = make_emitter(1);
+    assert_true(particle_batch_emit(&batch, &emitter));
+    assert_int_equal(p_buffer[0].seed, 3);
+
+    free(p_buffer);
+}
+
+// An emitter that does not fit is dropped whole, whether it is one too many emitters or too many particles for the ring
+static void test_particle_batch_full(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    particle_emitter_t* p_buffer = (particle_emitter_t*)malloc(particle_batch_buffer_size());
+    assert_non_null(p_buffer);
+
+    particle_batch_t batch;
+    particle_batch_init(&batch);
+    particle_batch_begin(&batch, p_buffer, 0.016f);
+
+    particle_emitter_t emitter = make_emitter(PARTICLE_MAX_COUNT - 10);
+    assert_true(particle_batch_emit(&batch, &emitter));
+    emitter = make_emitter(11);
+    assert_false(particle_batch_emit(&batch, &emitter));
+    assert_int_equal(batch.dropped, 11);
+    assert_int_equal(batch.particles_count, PARTICLE_MAX_COUNT - 10);
+    emitter = make_emitter(10);
+    assert_true(particle_batch_emit(&batch, &emitter));
+
+    particle_batch_begin(&batch, p_buffer, 0.016f);
+    emitter = make_emitter(1);
+    for(uint32_t i = 0; i < PARTICLE_MAX_EMITTERS; ++i)
+        assert_true(particle_batch_emit(&batch, &emitter));
+    assert_false(particle_batch_emit(&batch, &emitter));
+    assert_int_equal(batch.emitters_count, PARTICLE_MAX_EMITTERS);
+    assert_int_equal(batch.dropped, 1);
+
+    free(p_buffer);
+}
+
+// The step is clamped, a long stall does not fling the particles across the field
+static void test_particle_batch_dt(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    particle_batch_t batch;
+    particle_batch_init(&batch);
+
+    particle_batch_begin(&batch, NULL, 0.02f);
+    assert_true(batch.dt > 0.0199f && batch.dt < 0.0201f);
+
+    particle_batch_begin(&batch, NULL, 5.0f);
+    assert_false(batch.dt < PARTICLE_MAX_DT || batch.dt > PARTICLE_MAX_DT);
+
+    particle_batch_begin(&batch, NULL, -1.0f);
+    assert_false(batch.dt > 0.0f);
+}
+
+const struct CMUnitTest particle_batch_tests[] = {
+    cmocka_unit_test(test_particle_batch_emit),
+    cmocka_unit_test(test_particle_batch_full),
+    cmocka_unit_test(test_particle_batch_dt),
+};
+
+const size_t particle_batch_tests_count = sizeof(particle_batch_tests) / sizeof(particle_batch_tests[0]);
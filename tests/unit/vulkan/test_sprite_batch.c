@@ -0,0 +1,121 @@
+/*
+  test_sprite_batch.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_sprite_batch.h"
+
+// Every material gets a slice of its own, so pushes of different materials can be interleaved and each material is
+// still one contiguous run starting at its first instance
+static void test_sprite_batch_slices(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    sprite_instance_t* p_buffer = (sprite_instance_t*)malloc(sprite_batch_buffer_size());
+    assert_non_null(p_buffer);
+
+    sprite_batch_t batch;
+    sprite_batch_init(&batch);
+
+    // Nothing can be pushed before a frame is open
+    assert_null(sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, 1));
+    assert_int_equal(batch.dropped, 1);
+
+    sprite_batch_begin(&batch, p_buffer);
+    assert_int_equal(batch.dropped, 0);
+
+    for(uint32_t i = 0; i < 100; ++i) {
+        sprite_instance_t* p_solid = sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, 1);
+        assert_true(p_solid == p_buffer + sprite_batch_first_instance(SPRITE_MATERIAL_SOLID) + i);
+
+        sprite_instance_t* p_round = sprite_batch_push(&batch, SPRITE_MATERIAL_ROUND, 2);
+        assert_true(p_round == p_buffer + sprite_batch_first_instance(SPRITE_MATERIAL_ROUND) + i * 2);
+    }
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_SOLID], 100);
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_ROUND], 200);
+
+    // The slices do not overlap
+    assert_true(sprite_batch_first_instance(SPRITE_MATERIAL_ROUND) >=
+        sprite_batch_first_instance(SPRITE_MATERIAL_SOLID) + SPRITE_MAX_INSTANCES);
+    assert_true(sprite_batch_buffer_size() >= (size_t)(sprite_batch_first_instance(SPRITE_MATERIAL_COUNT - 1) +
+        SPRITE_MAX_INSTANCES) * sizeof(sprite_instance_t));
+
+    // A new frame starts out empty
+    sprite_batch_begin(&batch, p_buffer);
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_SOLID], 0);
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_ROUND], 0);
+    assert_true(sprite_batch_push(&batch, SPRITE_MATERIAL_ROUND, 1) ==
+        p_buffer + sprite_batch_first_instance(SPRITE_MATERIAL_ROUND));
+
+    free(p_buffer);
+}
+
+// A push that does not fit is dropped whole and leaves the material as it was
+static void test_sprite_batch_full(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    sprite_instance_t* p_buffer = (sprite_instance_t*)malloc(sprite_batch_buffer_size());
+    assert_non_null(p_buffer);
+
+    sprite_batch_t batch;
+    sprite_batch_init(&batch);
+    sprite_batch_begin(&batch, p_buffer);
+
+    assert_non_null(sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, SPRITE_MAX_INSTANCES - 10));
+    assert_null(sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, 11));
+    assert_int_equal(batch.dropped, 11);
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_SOLID], SPRITE_MAX_INSTANCES - 10);
+
+    assert_non_null(sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, 10));
+    assert_null(sprite_batch_push(&batch, SPRITE_MATERIAL_SOLID, 1));
+    assert_int_equal(batch.p_counts[SPRITE_MATERIAL_SOLID], SPRITE_MAX_INSTANCES);
+
+    // The other materials are unaffected
+    assert_non_null(sprite_batch_push(&batch, SPRITE_MATERIAL_ROUND, SPRITE_MAX_INSTANCES));
+
+    free(p_buffer);
+}
+
+// The corners of the view end up on the corners of clip space, with the world y axis pointing up
+static void test_sprite_batch_view(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    sprite_batch_t batch;
+    sprite_batch_init(&batch);
+    sprite_batch_set_view(&batch, 0.0f, 0.0f, 16.0f, 9.0f);
+
+    float p_corners[4][2] = {{0.0f, 0.0f}, {16.0f, 0.0f}, {0.0f, 9.0f}, {16.0f, 9.0f}};
+    float p_clip[4][2] = {{-1.0f, 1.0f}, {1.0f, 1.0f}, {-1.0f, -1.0f}, {1.0f, -1.0f}};
+
+    for(int i = 0; i < 4; ++i) {
+        float x = p_corners[i][0] * batch.view_scale[0] + batch.view_offset[0];
+        float y = p_corners[i][1] * batch.view_scale[1] + batch.view_offset[1];
+        assert_true(x > p_clip[i][0] - 1e-5f && x < p_clip[i][0] + 1e-5f);
+        assert_true(y > p_clip[i][1] - 1e-5f && y < p_clip[i][1] + 1e-5f);
+    }
+
+    // An empty view is refused and the old one kept
+    float scale_x = batch.view_scale[0];
+    sprite_batch_set_view(&batch, 1.0f, 0.0f, 1.0f, 9.0f);
+    assert_false(batch.view_scale[0] < scale_x || batch.view_scale[0] > scale_x);
+}
+
+const struct CMUnitTest sprite_batch_tests[] = {
+    cmocka_unit_test(test_sprite_batch_slices),
+    cmocka_unit_test(test_sprite_batch_full),
+    cmocka_unit_test(test_sprite_batch_view),
+};
+
+const size_t sprite_batch_tests_count = sizeof(sprite_batch_tests) / sizeof(sprite_batch_tests[0]);
@@ -0,0 +1,83 @@
+/*
+  test_texture.c
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "vulkan/vulkan_texture.h"
+
+// The chain goes down to 1x1 along the longer side, whatever the shorter one is
+static void test_texture_mips_count(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    assert_int_equal(texture_mips_count(1, 1), 1);
+    assert_int_equal(texture_mips_count(2, 2), 2);
+    assert_int_equal(texture_mips_count(256, 256), 9);
+    assert_int_equal(texture_mips_count(256, 1), 9);
+    assert_int_equal(texture_mips_count(1, 300), 9);
+    assert_int_equal(texture_mips_count(257, 16), 9);
+    assert_int_equal(texture_mips_count(UINT32_MAX, 1), 32);
+    assert_int_equal(texture_mips_count(0, 16), 0);
+}
+
+// Textures follow each other with only the padding the alignment asks for
+static void test_texture_staging_layout(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint32_t p_widths[3] = {3, 4, 1};
+    uint32_t p_heights[3] = {1, 4, 1};
+    size_t p_offsets[3] = {0};
+
+    size_t size = texture_staging_layout(p_widths, p_heights, 3, p_offsets);
+    assert_int_equal(p_offsets[0], 0);
+    assert_int_equal(p_offsets[1], 16);
+    assert_int_equal(p_offsets[2], 16 + 64);
+    assert_int_equal(size, 16 + 64 + 4);
+
+    for(uint32_t i = 0; i < 3; ++i)
+        assert_int_equal(p_offsets[i] % TEXTURE_STAGING_ALIGNMENT, 0);
+
+    assert_int_equal(texture_staging_layout(p_widths, p_heights, 0, p_offsets), 0);
+}
+
+// A batch too large for a size_t is rejected rather than wrapped around
+static void test_texture_staging_overflow(void** state)
+{
+    // UNUSED
+    (void)state;
+
+    uint32_t p_widths[2] = {UINT32_MAX, UINT32_MAX};
+    uint32_t p_heights[2] = {UINT32_MAX, UINT32_MAX};
+    size_t p_offsets[2] = {0};
+
+    // About 2^66 bytes, which does not fit even a 64 bit size_t
+    assert_int_equal(texture_staging_layout(p_widths, p_heights, 1, p_offsets), 0);
+
+    // 2^34 bytes each, which only fits a 64 bit size_t
+    p_widths[0] = 65536;
+    p_heights[0] = 65536;
+    p_widths[1] = 65536;
+    p_heights[1] = 65536;
+    size_t size = texture_staging_layout(p_widths, p_heights, 2, p_offsets);
+    if(SIZE_MAX <= UINT32_MAX)
+        assert_int_equal(size, 0);
+    else
+        assert_int_equal(size, (size_t)2 * 65536 * 65536 * TEXTURE_TEXEL_SIZE);
+}
+
+const struct CMUnitTest texture_tests[] = {
+    cmocka_unit_test(test_texture_mips_count),
+    cmocka_unit_test(test_texture_staging_layout),
+    cmocka_unit_test(test_texture_staging_overflow),
+};
+
+const size_t texture_tests_count = sizeof(texture_tests) / sizeof(texture_tests[0]);
@@ -0,0 +1,135 @@
+/*
+  asset_packer.c
+
+  Packs files into an asset pack the game maps at startup. Run from the repository root, every file is named by the
+  path it is given, e.g. "src/shaders/sprite.vert.spv", which is the path the game looks it up with.
+
+  Usage: break_asset_packer <output> <file>...
+*/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error/error.h"
+#include "util/asset_pack.h"
+
+/**
+ * \brief Read a whole file into memory.
+ *
+ * \param[in] p_path Path of the file.
+ * \param[out] pp_data The contents, allocated with malloc, NULL for an empty file.
+ * \param[out] p_size Size of the file in bytes.
+ */
+static error_t file_read(const char* p_path, void** pp_data, size_t* p_size);
+
+int main(int argc, char** argv)
+{
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s <output> <file>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t count = (uint32_t)(argc - 2);
+    asset_pack_source_t* p_sources = (asset_pack_source_t*)calloc(count > 0 ? count : 1, sizeof(asset_pack_source_t));
+    if(p_sources == NULL) {
+        fprintf(stderr, "Failed to allocate %u sources\n", count);
+        return EXIT_FAILURE;
+    }
+
+    error_t err = SUCCESS;
+    for(uint32_t i = 0; i < count && err.code == 0; ++i) {
+        // The game looks assets up with '/' separators on every platform
+        char* p_name = argv[i + 2];
+        for(char* p_c = p_name; *p_c != '\0'; ++p_c)
+            if(*p_c == '\\')
+                *p_c = '/';
+
+        void* p_data = NULL;
+        err = file_read(p_name, &p_data, &p_sources[i].size);
+        p_sources[i].p_name = p_name;
+        p_sources[i].p_data = p_data;
+    }
+
+    uint8_t* p_pack = NULL;
+    size_t pack_size = 0;
+    if(err.code == 0)
+        err = asset_pack_build(p_sources, count, &p_pack, &pack_size);
+
+    for(uint32_t i = 0; i < count; ++i)
+        free((void*)(uintptr_t)p_sources[i].p_data);
+    free(p_sources);
+
+    if(err.code != 0) {
+        fprintf(stderr, "%s\n", err.msg);
+        error_deinit(&err);
+        return EXIT_FAILURE;
+    }
+
+    FILE* p_file = fopen(argv[1], "wb");
+    if(p_file == NULL) {
+        fprintf(stderr, "Failed to open %s: %s\n", argv[1], strerror(errno));
+        free(p_pack);
+        return EXIT_FAILURE;
+    }
+
+    size_t written = fwrite(p_pack, 1, pack_size, p_file);
+    free(p_pack);
+    if(fclose(p_file) != 0 || written < pack_size) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        remove(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Packed %u assets into %s, %zu bytes\n", count, argv[1], pack_size);
+
+    return EXIT_SUCCESS;
+}
+
+static error_t file_read(const char* p_path, void** pp_data, size_t* p_size)
+{
+    FILE* p_file = fopen(p_path, "rb");
+    if(p_file == NULL)
+        return error_init(ERR_SRC_CORE, ERR_FOPEN, "Failed to open file: %s: %s", p_path, strerror(errno));
+
+    if(fseek(p_file, 0, SEEK_END) != 0) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed: %s", p_path);
+    }
+
+    long size = ftell(p_file);
+    if(size < 0) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_FTELL, "ftell failed: %s", p_path);
+    }
+
+    if(fseek(p_file, 0, SEEK_SET) != 0) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_FSEEK, "fseek failed: %s", p_path);
+    }
+
+    *pp_data = NULL;
+    *p_size = (size_t)size;
+    if(size == 0) {
+        fclose(p_file);
+        return SUCCESS;
+    }
+
+    void* p_data = malloc((size_t)size);
+    if(p_data == NULL) {
+        fclose(p_file);
+        return error_init(ERR_SRC_CORE, ERR_MALLOC, "Failed to allocate memory of size %ld", size);
+    }
+
+    size_t read = fread(p_data, 1, (size_t)size, p_file);
+    if(fclose(p_file) != 0 || read < (size_t)size) {
+        free(p_data);
+        return error_init(ERR_SRC_CORE, ERR_FREAD, "Failed to read file: %s", p_path);
+    }
+
+    *pp_data = p_data;
+
+    return SUCCESS;
+}
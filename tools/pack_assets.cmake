@@ -0,0 +1,18 @@
+# Run by the break_pack target: pack every compiled shader and every asset, named by their paths relative to the
+# repository root.
+
+file(GLOB SHADERS RELATIVE ${SOURCE_DIR} ${SOURCE_DIR}/src/shaders/*.spv)
+file(GLOB_RECURSE ASSETS RELATIVE ${SOURCE_DIR} ${SOURCE_DIR}/assets/*)
+
+if(NOT SHADERS)
+    message(WARNING "No compiled shaders in src/shaders, run compile_shaders first")
+endif()
+
+execute_process(
+    COMMAND ${PACKER} ${OUTPUT} ${SHADERS} ${ASSETS}
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    RESULT_VARIABLE PACK_RESULT
+)
+if(NOT PACK_RESULT EQUAL 0)
+    message(FATAL_ERROR "Failed to pack assets into ${OUTPUT}")
+endif()